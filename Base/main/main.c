@@ -1,6 +1,188 @@
 #include <stdio.h> // For ESP_LOGI (indirectly)
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+
+#include "utils/CAN/can_config.h"         // For temperature_queue and message IDs
+#include "can_driver_utils.h"   // For CAN driver initialization
+#include "utils/CAN/can_receive_utils.h"  // For CAN receive task
+#include "utils/CAN/can_dispatch_utils.h" // For per-ID RX handlers
+#include "utils/CAN/can_value_utils.h"    // Latest decoded values for other tasks
+
+static const char *TAG_MAIN = "APP_MAIN";
+
+QueueHandle_t temperature_queue = NULL;
+
+static can_value_handle_t temperature_value = -1;
+
+// TEMPERATURE shares its ID with TEMPERATURE_BATCH; DLC tells them apart.
+// DLC 4 is the legacy raw float format.
+static void handle_temperature(const twai_message_t *message, void *ctx) {
+    (void)ctx;
+    if (message->data_length_code == CAN_MSG_TEMPERATURE_DLC) {
+        can_temperature_t msg;
+        can_temperature_unpack(&msg, message->data);
+        float temperature_c = can_temperature_temperature_decode(msg.temperature);
+        can_value_update(temperature_value, temperature_c, esp_timer_get_time());
+        ESP_LOGI(TAG_MAIN, "Temperature: %.2f C", temperature_c);
+    } else if (message->data_length_code == sizeof(float)) {
+        float temperature_c;
+        memcpy(&temperature_c, message->data, sizeof(float));
+        can_value_update(temperature_value, temperature_c, esp_timer_get_time());
+        ESP_LOGI(TAG_MAIN, "Temperature (legacy): %.2f C", temperature_c);
+    } else {
+        can_temperature_batch_t batch;
+        can_temperature_batch_unpack(&batch, message->data);
+        // Samples are in acquisition order, so the newest is the last one sent
+        if (batch.count >= CAN_SIG_TEMPERATURE_BATCH_COUNT_MIN_RAW &&
+            message->data_length_code == 1 + 2 * batch.count) {
+            const int16_t samples[] = { batch.sample0, batch.sample1, batch.sample2 };
+            float temperature_c = can_temperature_batch_sample0_decode(samples[batch.count - 1]);
+            can_value_update(temperature_value, temperature_c, esp_timer_get_time());
+            ESP_LOGI(TAG_MAIN, "Temperature batch #%u (%u samples): %.2f C", batch.sequence, batch.count,
+                     temperature_c);
+        }
+    }
+}
+
+static void handle_heartbeat(const twai_message_t *message, void *ctx) {
+    (void)ctx;
+    can_heartbeat_t heartbeat;
+    can_heartbeat_unpack(&heartbeat, message->data);
+    ESP_LOGD(TAG_MAIN, "Heartbeat: uptime %lus, deadline misses %u, log dropped %u",
+             (unsigned long)heartbeat.uptime, heartbeat.deadline_misses, heartbeat.log_dropped);
+}
+
+// Debug trace of every frame, read by reference from the RX ring
+static void frame_logger_task(void *pvParameters) {
+    can_bcast_ring_t *ring = can_receive_ring();
+    int reader = (int)(intptr_t)pvParameters;
+    can_bcast_set_waiter(ring, reader, xTaskGetCurrentTaskHandle());
+
+    while (1) {
+        const twai_message_t *message;
+        while ((message = can_bcast_peek(ring, reader)) != NULL) {
+            ESP_LOGD(TAG_MAIN, "RX ID=0x%03lX DLC=%d", (unsigned long)message->identifier, message->data_length_code);
+            can_bcast_release(ring, reader);
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+// Frame rate and per-reader overflow once a second
+static void frame_stats_task(void *pvParameters) {
+    can_bcast_ring_t *ring = can_receive_ring();
+    int reader = (int)(intptr_t)pvParameters;
+    can_bcast_set_waiter(ring, reader, xTaskGetCurrentTaskHandle());
+    uint32_t frames = 0;
+    TickType_t last_report = xTaskGetTickCount();
+
+    while (1) {
+        while (can_bcast_peek(ring, reader) != NULL) {
+            frames++;
+            can_bcast_release(ring, reader);
+        }
+
+        if (xTaskGetTickCount() - last_report >= pdMS_TO_TICKS(1000)) {
+            last_report = xTaskGetTickCount();
+            ESP_LOGI(TAG_MAIN, "CAN RX: %lu frames/s", (unsigned long)frames);
+            frames = 0;
+            can_value_t temperature;
+            if (can_value_read(temperature_value, &temperature) && temperature.sequence > 0) {
+                ESP_LOGI(TAG_MAIN, "  latest temperature %.2f C, %lld ms old%s", temperature.value,
+                         (long long)((esp_timer_get_time() - temperature.timestamp_us) / 1000),
+                         temperature.stale ? " (stale)" : "");
+            }
+            uint32_t reader_count = atomic_load(&ring->reader_count);
+            for (uint32_t i = 0; i < reader_count; i++) {
+                can_bcast_reader_stats_t stats;
+                can_bcast_get_reader_stats(ring, i, &stats);
+                if (stats.overflows > 0) {
+                    ESP_LOGW(TAG_MAIN, "  reader %s: %lu overflows, %lu pending",
+                             stats.name, (unsigned long)stats.overflows, (unsigned long)stats.pending);
+                }
+            }
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+    }
+}
 
 void app_main(void)
 {
-   
-}
\ No newline at end of file
+    ESP_LOGI(TAG_MAIN, "Starting application");
+
+    // NVS holds the optional CAN bus settings record
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(ret);
+
+    if (can_driver_init() != ESP_OK) {
+        ESP_LOGE(TAG_MAIN, "Failed to initialize CAN driver. Halting.");
+        return;
+    }
+
+    const can_value_def_t temperature_def = {
+        .name = "temperature", .unit = "C",
+        .identifier = CAN_MSG_TEMPERATURE_ID, .extended = CAN_MSG_TEMPERATURE_EXTENDED,
+        .max_age_ms = CAN_VALUE_TEMPERATURE_MAX_AGE_MS,
+    };
+    temperature_value = can_value_register(&temperature_def);
+
+    // Register every message type before the receive task starts dispatching
+    const can_dispatch_entry_t handlers[] = {
+        {
+            .name = "temperature",
+            .first_id = TEMP_CAN_ID,
+            .last_id = TEMP_CAN_ID,
+            .extended = CAN_MSG_TEMPERATURE_EXTENDED,
+            .min_dlc = CAN_MSG_TEMPERATURE_DLC,
+            .max_dlc = CAN_MSG_TEMPERATURE_BATCH_DLC,
+            .handler = handle_temperature,
+        },
+        {
+            .name = "heartbeat",
+            .first_id = CAN_MSG_HEARTBEAT_ID,
+            .last_id = CAN_MSG_HEARTBEAT_ID,
+            .extended = CAN_MSG_HEARTBEAT_EXTENDED,
+            .min_dlc = CAN_MSG_HEARTBEAT_DLC,
+            .max_dlc = CAN_MSG_HEARTBEAT_DLC,
+            .handler = handle_heartbeat,
+        },
+    };
+    for (size_t i = 0; i < sizeof(handlers) / sizeof(handlers[0]); i++) {
+        if (can_dispatch_register(&handlers[i]) != ESP_OK) {
+            ESP_LOGE(TAG_MAIN, "Failed to register CAN handler %s", handlers[i].name);
+        }
+    }
+
+    // Readers are registered here, before any of the tasks below can run on
+    // either core; each task gets its reader index as the parameter
+    ESP_ERROR_CHECK(can_receive_init());
+    int logger_reader = can_receive_add_reader("logger", NULL);
+    int stats_reader = can_receive_add_reader("stats", NULL);
+    if (logger_reader >= 0) {
+        xTaskCreate(frame_logger_task, "frame_logger", 3072, (void *)(intptr_t)logger_reader, 3, NULL);
+    }
+    if (stats_reader >= 0) {
+        xTaskCreate(frame_stats_task, "frame_stats", 3072, (void *)(intptr_t)stats_reader, 2, NULL);
+    }
+
+    xTaskCreate(can_receive_task,
+                "can_receive_task",
+                4096, // Stack size
+                NULL, // Parameters
+                5,    // Priority
+                NULL); // Task handle
+    ESP_LOGI(TAG_MAIN, "CAN receive task created.");
+
+#if CAN_RX_SELF_TEST
+    // Lower priority than the receive task so it cannot starve the drain
+    xTaskCreate(can_rx_self_test_task, "can_rx_self_test", 4096, NULL, 4, NULL);
+#endif
+}
@@ -4,13 +4,36 @@
 #include "driver/twai.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "can_signals.h"    // generated from CANDatabase/signals.json
+#include "can_driver_config.h" // GPIOs, bitrate and queues from sdkconfig.defaults
 
-// Define CAN GPIOs - ESP32 default: TX GPIO21, RX GPIO22. Adjust if needed.
-#define CAN_TX_GPIO         GPIO_NUM_21
-#define CAN_RX_GPIO         GPIO_NUM_22
+#define CAN_TX_GPIO         CAN_DRIVER_TX_GPIO
+#define CAN_RX_GPIO         CAN_DRIVER_RX_GPIO
 
-// Define a CAN ID for temperature messages
-#define TEMP_CAN_ID         0x1A0 // Example CAN ID
+// CAN ID for temperature messages, shared by all nodes through the signal database
+#define TEMP_CAN_ID         CAN_MSG_TEMPERATURE_ID
+
+// Bus settings used when NVS holds no "can"/"settings" record (can_settings_utils.h)
+#define CAN_DEFAULT_BITRATE         CAN_DRIVER_BITRATE
+#define CAN_DEFAULT_MODE            (CAN_RX_SELF_TEST ? TWAI_MODE_NO_ACK : CAN_DRIVER_MODE)
+#define CAN_DEFAULT_RX_QUEUE_LEN    CAN_RX_QUEUE_LEN
+#define CAN_DEFAULT_TX_QUEUE_LEN    CAN_DRIVER_TX_QUEUE_LEN
+
+// RX path: the driver queue absorbs bursts between task wake-ups, the receive
+// task drains up to CAN_RX_BATCH_MAX frames per wake-up
+#define CAN_RX_QUEUE_LEN    CAN_DRIVER_RX_QUEUE_LEN
+#define CAN_RX_BATCH_MAX    32
+#define CAN_RX_WAIT_MS      100     // bounded wait, bus-off recovery is checked on timeout
+#define CAN_RX_RING_SIZE    128     // broadcast ring shared by frame readers, power of two
+
+// Self-test: NO_ACK mode with self-reception at full bus load, then compare
+// frames sent against frames received. Leave at 0 for normal operation.
+#define CAN_RX_SELF_TEST        0
+#define CAN_RX_SELF_TEST_ID     0x7FF
+#define CAN_RX_SELF_TEST_FRAMES 20000
+
+// Age after which a cached value reads as stale
+#define CAN_VALUE_TEMPERATURE_MAX_AGE_MS    5000
 
 extern QueueHandle_t temperature_queue;
 
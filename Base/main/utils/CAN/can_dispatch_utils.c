@@ -0,0 +1,172 @@
+#include "can_dispatch_utils.h"
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include <string.h>
+
+static const char *TAG_CAN_DISPATCH = "CAN_DISPATCH";
+
+#define CAN_STD_ID_COUNT    2048
+#define CAN_EXT_EMPTY       UINT32_MAX
+
+typedef struct {
+    can_dispatch_handler_t handler;
+    void *ctx;
+    uint8_t min_dlc;
+    uint8_t max_dlc;
+    can_dispatch_handler_stats_t stats;
+} dispatch_slot_t;
+
+typedef struct {
+    uint32_t identifier;
+    uint8_t slot;
+} ext_entry_t;
+
+// Index 0 means "no handler", so slots are 1-based in the lookup tables
+static dispatch_slot_t slots[CAN_DISPATCH_MAX_HANDLERS + 1];
+static uint8_t slot_count = 0;
+static uint8_t std_table[CAN_STD_ID_COUNT];
+static ext_entry_t ext_table[CAN_DISPATCH_EXT_SLOTS];
+static bool ext_table_ready = false;
+static can_dispatch_stats_t totals;
+
+static inline uint32_t ext_hash(uint32_t identifier)
+{
+    return (identifier * 2654435761u) & (CAN_DISPATCH_EXT_SLOTS - 1);
+}
+
+static ext_entry_t *ext_lookup(uint32_t identifier, bool insert)
+{
+    uint32_t index = ext_hash(identifier);
+    for (uint32_t probe = 0; probe < CAN_DISPATCH_EXT_SLOTS; probe++) {
+        ext_entry_t *entry = &ext_table[(index + probe) & (CAN_DISPATCH_EXT_SLOTS - 1)];
+        if (entry->identifier == identifier) {
+            return entry;
+        }
+        if (entry->identifier == CAN_EXT_EMPTY) {
+            return insert ? entry : NULL;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t can_dispatch_register(const can_dispatch_entry_t *entry)
+{
+    if (!entry || !entry->handler || entry->first_id > entry->last_id ||
+        entry->min_dlc > entry->max_dlc || entry->max_dlc > TWAI_FRAME_MAX_DLC) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (entry->extended ? (entry->first_id != entry->last_id || entry->last_id > 0x1FFFFFFF)
+                        : entry->last_id >= CAN_STD_ID_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (slot_count >= CAN_DISPATCH_MAX_HANDLERS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (!ext_table_ready) {
+        for (int i = 0; i < CAN_DISPATCH_EXT_SLOTS; i++) {
+            ext_table[i].identifier = CAN_EXT_EMPTY;
+        }
+        ext_table_ready = true;
+    }
+
+    uint8_t slot = slot_count + 1;
+    if (entry->extended) {
+        ext_entry_t *ext = ext_lookup(entry->first_id, true);
+        if (!ext) {
+            return ESP_ERR_NO_MEM;
+        }
+        if (ext->identifier != CAN_EXT_EMPTY) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        ext->identifier = entry->first_id;
+        ext->slot = slot;
+    } else {
+        for (uint32_t id = entry->first_id; id <= entry->last_id; id++) {
+            if (std_table[id] != 0) {
+                ESP_LOGE(TAG_CAN_DISPATCH, "ID 0x%03lX already handled by %s", (unsigned long)id, slots[std_table[id]].stats.name);
+                return ESP_ERR_INVALID_STATE;
+            }
+        }
+        memset(&std_table[entry->first_id], slot, entry->last_id - entry->first_id + 1);
+    }
+
+    slots[slot] = (dispatch_slot_t){
+        .handler = entry->handler,
+        .ctx = entry->ctx,
+        .min_dlc = entry->min_dlc,
+        .max_dlc = entry->max_dlc,
+        .stats = { .name = entry->name ? entry->name : "?" },
+    };
+    slot_count++;
+    return ESP_OK;
+}
+
+bool can_dispatch(const twai_message_t *message)
+{
+    uint8_t slot;
+    if (message->extd) {
+        ext_entry_t *ext = ext_table_ready ? ext_lookup(message->identifier, false) : NULL;
+        slot = ext ? ext->slot : 0;
+    } else {
+        slot = std_table[message->identifier & (CAN_STD_ID_COUNT - 1)];
+    }
+
+    if (slot == 0) {
+        totals.unknown_ids++;
+        return false;
+    }
+    if (message->rtr) {
+        totals.remote_frames++;
+        return false;
+    }
+
+    dispatch_slot_t *s = &slots[slot];
+    if (message->data_length_code < s->min_dlc || message->data_length_code > s->max_dlc) {
+        s->stats.dlc_errors++;
+        totals.dlc_errors++;
+        return false;
+    }
+
+    esp_cpu_cycle_count_t start = esp_cpu_get_cycle_count();
+    s->handler(message, s->ctx);
+    uint32_t cycles = esp_cpu_get_cycle_count() - start;
+
+    s->stats.calls++;
+    s->stats.total_cycles += cycles;
+    if (cycles > s->stats.max_cycles) {
+        s->stats.max_cycles = cycles;
+    }
+    totals.dispatched++;
+    return true;
+}
+
+void can_dispatch_get_stats(can_dispatch_stats_t *out_stats)
+{
+    if (out_stats) {
+        *out_stats = totals;
+    }
+}
+
+size_t can_dispatch_get_handler_stats(can_dispatch_handler_stats_t *out_stats, size_t max_handlers)
+{
+    size_t count = slot_count < max_handlers ? slot_count : max_handlers;
+    for (size_t i = 0; i < count; i++) {
+        out_stats[i] = slots[i + 1].stats;
+    }
+    return count;
+}
+
+void can_dispatch_log_stats(void)
+{
+    ESP_LOGI(TAG_CAN_DISPATCH, "Dispatched %lu, unknown ID %lu, bad DLC %lu, remote %lu",
+             (unsigned long)totals.dispatched, (unsigned long)totals.unknown_ids,
+             (unsigned long)totals.dlc_errors, (unsigned long)totals.remote_frames);
+    for (uint8_t i = 1; i <= slot_count; i++) {
+        const can_dispatch_handler_stats_t *st = &slots[i].stats;
+        uint32_t avg = st->calls ? (uint32_t)(st->total_cycles / st->calls) : 0;
+        ESP_LOGI(TAG_CAN_DISPATCH, "  %-16s calls=%lu dlc_err=%lu avg=%lu max=%lu cycles",
+                 st->name, (unsigned long)st->calls, (unsigned long)st->dlc_errors, (unsigned long)avg,
+                 (unsigned long)st->max_cycles);
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef CAN_DISPATCH_UTILS_H
+#define CAN_DISPATCH_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+
+/*
+ * Table-driven RX dispatch.
+ *
+ * Standard IDs index a 2048-entry table directly; extended IDs go through
+ * a small open-addressed hash. Either way a frame reaches its handler in
+ * constant time regardless of how many message types are registered.
+ * Register everything before the receive task starts; the tables are not
+ * locked against concurrent registration.
+ */
+#define CAN_DISPATCH_MAX_HANDLERS   32
+#define CAN_DISPATCH_EXT_SLOTS      64      // power of two
+#define CAN_DISPATCH_DLC_ANY_MIN    0
+#define CAN_DISPATCH_DLC_ANY_MAX    TWAI_FRAME_MAX_DLC
+
+typedef void (*can_dispatch_handler_t)(const twai_message_t *message, void *ctx);
+
+typedef struct {
+    const char *name;
+    uint32_t first_id;          // inclusive range; first == last for one ID
+    uint32_t last_id;           // extended IDs must be registered one at a time
+    bool extended;
+    uint8_t min_dlc;            // frames outside [min_dlc, max_dlc] are counted, not dispatched
+    uint8_t max_dlc;
+    can_dispatch_handler_t handler;
+    void *ctx;
+} can_dispatch_entry_t;
+
+typedef struct {
+    const char *name;
+    uint32_t calls;
+    uint32_t dlc_errors;
+    uint64_t total_cycles;
+    uint32_t max_cycles;
+} can_dispatch_handler_stats_t;
+
+typedef struct {
+    uint32_t dispatched;
+    uint32_t unknown_ids;
+    uint32_t dlc_errors;
+    uint32_t remote_frames;
+} can_dispatch_stats_t;
+
+/**
+ * @brief Register a handler for an ID or a range of standard IDs.
+ *
+ * @return ESP_ERR_INVALID_STATE if an ID is already taken,
+ *         ESP_ERR_NO_MEM if the handler or extended tables are full.
+ */
+esp_err_t can_dispatch_register(const can_dispatch_entry_t *entry);
+
+/**
+ * @brief Route a received frame to its handler.
+ *
+ * @return true if a handler ran.
+ */
+bool can_dispatch(const twai_message_t *message);
+
+void can_dispatch_get_stats(can_dispatch_stats_t *out_stats);
+
+/**
+ * @brief Per-handler counters and CPU cycles spent inside the handler.
+ *
+ * @return Number of registered handlers copied.
+ */
+size_t can_dispatch_get_handler_stats(can_dispatch_handler_stats_t *out_stats, size_t max_handlers);
+
+void can_dispatch_log_stats(void);
+
+#endif // CAN_DISPATCH_UTILS_H
@@ -1,49 +1,161 @@
 #include "can_receive_utils.h"
 #include "can_config.h" // For potential shared configs if needed in future
+#include "can_dispatch_utils.h"
+#include "can_driver_utils.h"
 #include "driver/twai.h"
 #include "esp_log.h"
-
-#include <string.h>
+#include "esp_timer.h"
 
 static const char *TAG_CAN_RX = "CAN_RECEIVE";
 
+typedef struct {
+    can_rx_batch_consumer_t consumer;
+    void *ctx;
+} rx_consumer_t;
+
+static rx_consumer_t consumers[CAN_RX_MAX_CONSUMERS];
+static size_t consumer_count = 0;
+static can_rx_stats_t rx_stats;
+
+static can_bcast_slot_t rx_ring_storage[CAN_RX_RING_SIZE];
+static can_bcast_ring_t rx_ring;
+
+esp_err_t can_receive_add_consumer(can_rx_batch_consumer_t consumer, void *ctx) {
+    if (consumer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (consumer_count >= CAN_RX_MAX_CONSUMERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    consumers[consumer_count++] = (rx_consumer_t){ .consumer = consumer, .ctx = ctx };
+    return ESP_OK;
+}
+
+esp_err_t can_receive_init(void) {
+    return can_bcast_init(&rx_ring, rx_ring_storage, CAN_RX_RING_SIZE);
+}
+
+int can_receive_add_reader(const char *name, TaskHandle_t waiter) {
+    return can_bcast_add_reader(&rx_ring, name, waiter);
+}
+
+can_bcast_ring_t *can_receive_ring(void) {
+    return &rx_ring;
+}
+
+void can_receive_get_stats(can_rx_stats_t *out_stats) {
+    if (out_stats != NULL) {
+        *out_stats = rx_stats;
+    }
+}
+
+static void dispatch_batch(const twai_message_t *messages, size_t count, void *ctx) {
+    (void)ctx;
+    for (size_t i = 0; i < count; i++) {
+        // Registered handlers decode; unknown IDs are only counted by the dispatcher
+        can_dispatch(&messages[i]);
+    }
+}
+
 void can_receive_task(void *pvParameters) {
-    ESP_LOGI(TAG_CAN_RX, "CAN Receive Task Started");
-    twai_message_t rx_message;
+    ESP_LOGI(TAG_CAN_RX, "CAN Receive Task Started (batches of up to %d)", CAN_RX_BATCH_MAX);
+    static twai_message_t batch[CAN_RX_BATCH_MAX];
+
+    if (consumer_count == 0) {
+        can_receive_add_consumer(dispatch_batch, NULL);
+    }
 
     while (1) {
-        // Wait to receive a message
-        esp_err_t ret = twai_receive(&rx_message, pdMS_TO_TICKS(portMAX_DELAY)); // Block indefinitely
-
-        if (ret == ESP_OK) {
-            ESP_LOGI(TAG_CAN_RX, "Message received: ID=0x%03lX, DLC=%d", rx_message.identifier, rx_message.data_length_code);
-            // Log data bytes
-            char data_str[3 * TWAI_FRAME_MAX_DLC + 1] = {0};
-            for (int i = 0; i < rx_message.data_length_code; i++) {
-                sprintf(data_str + i * 3, "%02X ", rx_message.data[i]);
-            }
-            ESP_LOGI(TAG_CAN_RX, "Data: %s", data_str);
+        // Sleep until the driver queue has a frame. The wait is bounded: a
+        // bus-off controller receives nothing, so a timeout is where it is
+        // noticed and brought back.
+        esp_err_t ret = can_driver_receive(&batch[0], pdMS_TO_TICKS(CAN_RX_WAIT_MS));
+        if (ret == ESP_ERR_TIMEOUT) {
+            can_driver_recover();
+            continue;
+        } else if (ret != ESP_OK) {
+            ESP_LOGE(TAG_CAN_RX, "Failed to receive message: %s", esp_err_to_name(ret));
+            vTaskDelay(pdMS_TO_TICKS(100)); // Wait before retrying
+            continue;
+        }
 
-            // Example: Check if it's a temperature message (though this task is generic)
-            if (rx_message.identifier == TEMP_CAN_ID && rx_message.data_length_code == sizeof(float)) {
-                float received_temp;
-                memcpy(&received_temp, rx_message.data, sizeof(float));
-                ESP_LOGI(TAG_CAN_RX, "Received temperature: %.2f C", received_temp);
+        // Drain whatever else is already queued without blocking. Frames that
+        // arrive while draining are picked up by the next wake-up, which
+        // returns immediately.
+        size_t count = 1;
+        twai_status_info_t status;
+        if (twai_get_status_info(&status) == ESP_OK) {
+            size_t pending = status.msgs_to_rx;
+            if (pending > CAN_RX_BATCH_MAX - count) {
+                pending = CAN_RX_BATCH_MAX - count;
+            }
+            while (pending-- > 0 && can_driver_receive(&batch[count], 0) == ESP_OK) {
+                count++;
             }
+            rx_stats.rx_missed = status.rx_missed_count;
+            rx_stats.rx_overrun = status.rx_overrun_count;
+        }
 
-        } else if (ret == ESP_ERR_TIMEOUT) {
-            // Timeout, no message received (should not happen with portMAX_DELAY unless driver is stopped)
-            // Continue loop
-        } else {
-            ESP_LOGE(TAG_CAN_RX, "Failed to receive message: %s", esp_err_to_name(ret));
-            // If bus-off or other critical error, may need to re-init or handle
-            if (ret == TWAI_ALERT_BUS_RECOVERED || ret == TWAI_ALERT_BUS_OFF) {
-                ESP_LOGW(TAG_CAN_RX, "CAN bus issue detected: %s. May need re-initialization.", esp_err_to_name(ret));
-                // Potentially signal main task or attempt recovery
-                vTaskDelay(pdMS_TO_TICKS(1000)); // Wait before retrying
+        for (size_t i = 0; i < consumer_count; i++) {
+            consumers[i].consumer(batch, count, consumers[i].ctx);
+        }
+
+        // One copy into the ring; readers take it from there by reference
+        if (atomic_load_explicit(&rx_ring.reader_count, memory_order_acquire) > 0) {
+            for (size_t i = 0; i < count; i++) {
+                can_bcast_publish(&rx_ring, &batch[i]);
             }
+            can_bcast_notify(&rx_ring);
+        }
+
+        rx_stats.frames += count;
+        rx_stats.batches++;
+        if (count > rx_stats.max_batch) {
+            rx_stats.max_batch = count;
         }
-        // Small delay to yield, though twai_receive with timeout handles blocking
-         vTaskDelay(pdMS_TO_TICKS(10));
     }
-}
\ No newline at end of file
+}
+
+#if CAN_RX_SELF_TEST
+void can_rx_self_test_task(void *pvParameters) {
+    twai_message_t message = {
+        .identifier = CAN_RX_SELF_TEST_ID,
+        .data_length_code = TWAI_FRAME_MAX_DLC,
+    };
+    message.self = 1; // receive our own frame; NO_ACK mode completes it without a peer
+
+    can_rx_stats_t before;
+    can_receive_get_stats(&before);
+    ESP_LOGI(TAG_CAN_RX, "RX self-test: sending %d frames back to back", CAN_RX_SELF_TEST_FRAMES);
+
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < CAN_RX_SELF_TEST_FRAMES; i++) {
+        message.data[0] = (uint8_t)i;
+        message.data[1] = (uint8_t)(i >> 8);
+        // Blocking keeps the TX queue full, so the bus never idles
+        if (can_driver_transmit(&message, portMAX_DELAY) != ESP_OK) {
+            ESP_LOGE(TAG_CAN_RX, "RX self-test: transmit failed after %lu frames", i);
+            break;
+        }
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    // Give the receive task time to drain the tail
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    can_rx_stats_t after;
+    can_receive_get_stats(&after);
+    uint32_t received = after.frames - before.frames;
+    uint32_t missed = (after.rx_missed - before.rx_missed) + (after.rx_overrun - before.rx_overrun);
+    uint32_t frames_per_s = elapsed_us > 0 ? (uint32_t)((int64_t)received * 1000000 / elapsed_us) : 0;
+
+    if (received == CAN_RX_SELF_TEST_FRAMES && missed == 0) {
+        ESP_LOGI(TAG_CAN_RX, "RX self-test PASSED: %lu/%d frames, %lu frames/s, max batch %lu",
+                 received, CAN_RX_SELF_TEST_FRAMES, frames_per_s, after.max_batch);
+    } else {
+        ESP_LOGE(TAG_CAN_RX, "RX self-test FAILED: %lu/%d frames, %lu dropped by driver, max batch %lu",
+                 received, CAN_RX_SELF_TEST_FRAMES, missed, after.max_batch);
+    }
+    vTaskDelete(NULL);
+}
+#endif
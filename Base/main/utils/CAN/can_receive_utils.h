@@ -1,14 +1,80 @@
 #ifndef CAN_RECEIVE_UTILS_H
 #define CAN_RECEIVE_UTILS_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+#include "can_config.h"
+#include "can_ring_utils.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#define CAN_RX_MAX_CONSUMERS 4
+
+/**
+ * @brief Called once per wake-up with every frame drained from the driver.
+ *
+ * Runs in the receive task; the batch is only valid for the duration of the call.
+ */
+typedef void (*can_rx_batch_consumer_t)(const twai_message_t *messages, size_t count, void *ctx);
+
+typedef struct {
+    uint32_t frames;            // frames handed to consumers
+    uint32_t batches;           // receive task wake-ups that produced frames
+    uint32_t max_batch;         // largest batch seen
+    uint32_t rx_missed;         // frames lost because the driver RX queue was full
+    uint32_t rx_overrun;        // frames lost in the controller's RX FIFO
+} can_rx_stats_t;
+
+/**
+ * @brief Add a batch consumer. Register before the receive task starts.
+ *
+ * With no consumers registered, frames go to the RX dispatcher.
+ */
+esp_err_t can_receive_add_consumer(can_rx_batch_consumer_t consumer, void *ctx);
+
+/**
+ * @brief Set up the RX broadcast ring. Call once, before adding readers.
+ */
+esp_err_t can_receive_init(void);
+
+/**
+ * @brief Subscribe to every received frame through the RX broadcast ring.
+ *
+ * Frames are copied into the ring once and read by reference with
+ * can_bcast_peek()/can_bcast_release() on can_receive_ring(). Register
+ * from app_main, after can_receive_init() and before any reader or the
+ * receive task starts.
+ *
+ * @param waiter Task notified after each batch, or NULL to poll.
+ * @return Reader index, or -1 if all reader slots are taken.
+ */
+int can_receive_add_reader(const char *name, TaskHandle_t waiter);
+
+can_bcast_ring_t *can_receive_ring(void);
+
+void can_receive_get_stats(can_rx_stats_t *out_stats);
+
 /**
  * @brief Task to receive and process CAN messages.
  *
+ * Blocks until the driver has a frame, then drains everything pending
+ * (msgs_to_rx) into one batch and hands it to the consumers.
+ *
  * @param pvParameters Task parameters (not used).
  */
 void can_receive_task(void *pvParameters);
 
-#endif // CAN_RECEIVE_UTILS_H
\ No newline at end of file
+#if CAN_RX_SELF_TEST
+/**
+ * @brief Flood the bus with self-received frames and verify none are dropped.
+ *
+ * Requires the driver in NO_ACK mode (see CAN_RX_SELF_TEST in can_config.h).
+ *
+ * @param pvParameters Task parameters (not used).
+ */
+void can_rx_self_test_task(void *pvParameters);
+#endif
+
+#endif // CAN_RECEIVE_UTILS_H
@@ -0,0 +1,152 @@
+#include "can_ring_utils.h"
+#include <string.h>
+
+static bool is_power_of_two(uint32_t size) {
+    return size != 0 && (size & (size - 1)) == 0;
+}
+
+esp_err_t can_spsc_init(can_spsc_ring_t *ring, twai_message_t *storage, uint32_t size) {
+    if (ring == NULL || storage == NULL || !is_power_of_two(size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ring->slots = storage;
+    ring->mask = size - 1;
+    atomic_store(&ring->head, 0);
+    atomic_store(&ring->tail, 0);
+    atomic_store(&ring->overflows, 0);
+    return ESP_OK;
+}
+
+bool can_spsc_push(can_spsc_ring_t *ring, const twai_message_t *message) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail > ring->mask) {
+        atomic_fetch_add_explicit(&ring->overflows, 1, memory_order_relaxed);
+        return false;
+    }
+    ring->slots[head & ring->mask] = *message;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+const twai_message_t *can_spsc_peek(can_spsc_ring_t *ring) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return head == tail ? NULL : &ring->slots[tail & ring->mask];
+}
+
+void can_spsc_release(can_spsc_ring_t *ring) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+esp_err_t can_bcast_init(can_bcast_ring_t *ring, can_bcast_slot_t *storage, uint32_t size) {
+    if (ring == NULL || storage == NULL || !is_power_of_two(size)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->slots = storage;
+    ring->mask = size - 1;
+    // Slot i last held position i - size, so it reads as "not yet published"
+    for (uint32_t i = 0; i < size; i++) {
+        atomic_store(&storage[i].sequence, i - size + 1);
+    }
+    return ESP_OK;
+}
+
+int can_bcast_add_reader(can_bcast_ring_t *ring, const char *name, TaskHandle_t waiter) {
+    uint32_t index = atomic_load(&ring->reader_count);
+    if (index >= CAN_RING_MAX_READERS) {
+        return -1;
+    }
+    can_bcast_reader_t *reader = &ring->readers[index];
+    reader->name = name;
+    atomic_store(&reader->waiter, waiter);
+    reader->received = 0;
+    atomic_store(&reader->overflows, 0);
+    atomic_store(&reader->cursor, atomic_load(&ring->head));
+    atomic_store(&ring->reader_count, index + 1);
+    return (int)index;
+}
+
+twai_message_t *can_bcast_claim(can_bcast_ring_t *ring, uint32_t *out_position) {
+    uint32_t reader_count = atomic_load_explicit(&ring->reader_count, memory_order_acquire);
+    uint32_t position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    while (1) {
+        // Cursors only move forward, so a stale read can only make a reader look fuller
+        bool full = false;
+        for (uint32_t i = 0; i < reader_count; i++) {
+            uint32_t cursor = atomic_load_explicit(&ring->readers[i].cursor, memory_order_acquire);
+            if (position - cursor > ring->mask) {
+                full = true;
+                atomic_fetch_add_explicit(&ring->readers[i].overflows, 1, memory_order_relaxed);
+            }
+        }
+        if (full) {
+            atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+            return NULL;
+        }
+        if (atomic_compare_exchange_weak_explicit(&ring->head, &position, position + 1,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    *out_position = position;
+    return &ring->slots[position & ring->mask].message;
+}
+
+void can_bcast_commit(can_bcast_ring_t *ring, uint32_t position) {
+    atomic_store_explicit(&ring->slots[position & ring->mask].sequence, position + 1, memory_order_release);
+}
+
+bool can_bcast_publish(can_bcast_ring_t *ring, const twai_message_t *message) {
+    uint32_t position;
+    twai_message_t *slot = can_bcast_claim(ring, &position);
+    if (slot == NULL) {
+        return false;
+    }
+    *slot = *message;
+    can_bcast_commit(ring, position);
+    return true;
+}
+
+void can_bcast_set_waiter(can_bcast_ring_t *ring, int reader, TaskHandle_t waiter) {
+    atomic_store_explicit(&ring->readers[reader].waiter, waiter, memory_order_release);
+}
+
+void can_bcast_notify(can_bcast_ring_t *ring) {
+    uint32_t reader_count = atomic_load_explicit(&ring->reader_count, memory_order_acquire);
+    for (uint32_t i = 0; i < reader_count; i++) {
+        TaskHandle_t waiter = atomic_load_explicit(&ring->readers[i].waiter, memory_order_acquire);
+        if (waiter != NULL) {
+            xTaskNotifyGive(waiter);
+        }
+    }
+}
+
+const twai_message_t *can_bcast_peek(can_bcast_ring_t *ring, int reader) {
+    uint32_t cursor = atomic_load_explicit(&ring->readers[reader].cursor, memory_order_relaxed);
+    can_bcast_slot_t *slot = &ring->slots[cursor & ring->mask];
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != cursor + 1) {
+        return NULL;
+    }
+    return &slot->message;
+}
+
+void can_bcast_release(can_bcast_ring_t *ring, int reader) {
+    can_bcast_reader_t *r = &ring->readers[reader];
+    uint32_t cursor = atomic_load_explicit(&r->cursor, memory_order_relaxed);
+    r->received++;
+    atomic_store_explicit(&r->cursor, cursor + 1, memory_order_release);
+}
+
+void can_bcast_get_reader_stats(can_bcast_ring_t *ring, int reader, can_bcast_reader_stats_t *out_stats) {
+    can_bcast_reader_t *r = &ring->readers[reader];
+    uint32_t cursor = atomic_load(&r->cursor);
+    out_stats->name = r->name;
+    out_stats->received = r->received;
+    out_stats->overflows = atomic_load(&r->overflows);
+    out_stats->pending = atomic_load(&ring->head) - cursor;
+}
@@ -0,0 +1,137 @@
+#ifndef CAN_RING_UTILS_H
+#define CAN_RING_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/*
+ * Lock-free frame rings.
+ *
+ * can_spsc_ring_t: one producer task, one consumer task. Head and tail
+ * are each written by one side only.
+ *
+ * can_bcast_ring_t: any number of producers, up to CAN_RING_MAX_READERS
+ * readers that each see every frame through their own cursor. Frames
+ * are copied into the ring once (or received straight into a claimed
+ * slot) and readers get a pointer to the slot; nothing is copied per
+ * reader. A slot is reused only after every reader has released it, so
+ * a frame that does not fit because some reader is behind is dropped
+ * for all readers and charged to each reader that was full.
+ *
+ * Ring storage is supplied by the caller; sizes must be powers of two.
+ */
+#define CAN_RING_MAX_READERS 4
+
+typedef struct {
+    twai_message_t *slots;
+    uint32_t mask;
+    atomic_uint head;           // written by the producer
+    atomic_uint tail;           // written by the consumer
+    atomic_uint overflows;      // pushes rejected because the ring was full
+} can_spsc_ring_t;
+
+typedef struct {
+    atomic_uint sequence;       // position + 1 once published
+    twai_message_t message;
+} can_bcast_slot_t;
+
+typedef struct {
+    const char *name;
+    atomic_uint cursor;         // next position to read; written by the reader
+    atomic_uint overflows;      // frames dropped while this reader was full
+    uint32_t received;
+    _Atomic(TaskHandle_t) waiter; // notified by can_bcast_notify(), may be NULL
+} can_bcast_reader_t;
+
+typedef struct {
+    can_bcast_slot_t *slots;
+    uint32_t mask;
+    atomic_uint head;           // next position to claim
+    atomic_uint dropped;        // frames no reader received
+    atomic_uint reader_count;
+    can_bcast_reader_t readers[CAN_RING_MAX_READERS];
+} can_bcast_ring_t;
+
+typedef struct {
+    const char *name;
+    uint32_t received;
+    uint32_t overflows;
+    uint32_t pending;
+} can_bcast_reader_stats_t;
+
+esp_err_t can_spsc_init(can_spsc_ring_t *ring, twai_message_t *storage, uint32_t size);
+
+/**
+ * @brief Copy a frame in. Producer side only.
+ *
+ * @return false (and an overflow is counted) if the ring is full.
+ */
+bool can_spsc_push(can_spsc_ring_t *ring, const twai_message_t *message);
+
+/**
+ * @brief Oldest unread frame, by reference, or NULL if empty. Consumer side only.
+ *
+ * The pointer stays valid until can_spsc_release().
+ */
+const twai_message_t *can_spsc_peek(can_spsc_ring_t *ring);
+void can_spsc_release(can_spsc_ring_t *ring);
+
+esp_err_t can_bcast_init(can_bcast_ring_t *ring, can_bcast_slot_t *storage, uint32_t size);
+
+/**
+ * @brief Register a reader starting at the current head.
+ *
+ * Add readers from one task, before producers start; the reader tasks
+ * get their index as a parameter rather than registering themselves.
+ *
+ * @param waiter Task to notify from can_bcast_notify(), or NULL to poll.
+ * @return Reader index, or -1 if all reader slots are taken.
+ */
+int can_bcast_add_reader(can_bcast_ring_t *ring, const char *name, TaskHandle_t waiter);
+
+/**
+ * @brief Set the task a reader wakes, typically the reader task itself once
+ *        it runs. Notifications sent before then are lost, so the reader
+ *        drains the ring before its first wait.
+ */
+void can_bcast_set_waiter(can_bcast_ring_t *ring, int reader, TaskHandle_t waiter);
+
+/**
+ * @brief Claim the next slot for writing, e.g. to twai_receive() into it.
+ *
+ * Every successful claim must be followed by can_bcast_commit(), or
+ * readers stall at that position.
+ *
+ * @return Slot to fill, or NULL if some reader is a full ring behind.
+ */
+twai_message_t *can_bcast_claim(can_bcast_ring_t *ring, uint32_t *out_position);
+void can_bcast_commit(can_bcast_ring_t *ring, uint32_t position);
+
+/**
+ * @brief Claim, copy and commit in one step.
+ */
+bool can_bcast_publish(can_bcast_ring_t *ring, const twai_message_t *message);
+
+/**
+ * @brief Wake every reader that registered a waiter task.
+ *
+ * Producers call this once per batch rather than per frame.
+ */
+void can_bcast_notify(can_bcast_ring_t *ring);
+
+/**
+ * @brief Next frame for a reader, by reference, or NULL if it is up to date.
+ *
+ * The pointer stays valid until can_bcast_release() for the same reader.
+ */
+const twai_message_t *can_bcast_peek(can_bcast_ring_t *ring, int reader);
+void can_bcast_release(can_bcast_ring_t *ring, int reader);
+
+void can_bcast_get_reader_stats(can_bcast_ring_t *ring, int reader, can_bcast_reader_stats_t *out_stats);
+
+#endif // CAN_RING_UTILS_H
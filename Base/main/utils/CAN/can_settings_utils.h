@@ -0,0 +1,93 @@
+#ifndef CAN_SETTINGS_UTILS_H
+#define CAN_SETTINGS_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+
+/*
+ * Bus settings record: bit timing, driver queue lengths and controller
+ * mode, stored in NVS so a node can move to another bitrate without a
+ * new firmware image.
+ *
+ * Timing is kept as raw BRP/TSEG1/TSEG2/SJW against the controller
+ * clock (CAN_SETTINGS_CLOCK_HZ). A bit is 1 + TSEG1 + TSEG2 time quanta
+ * of BRP clock cycles each, sampled after 1 + TSEG1 quanta. Presets for
+ * 125k-1M match the ESP-IDF TWAI_TIMING_CONFIG_*() macros.
+ */
+#define CAN_SETTINGS_CLOCK_HZ       80000000    // APB, the TWAI default clock on ESP32
+#define CAN_SETTINGS_NVS_NAMESPACE  "can"
+#define CAN_SETTINGS_NVS_KEY        "settings"
+#define CAN_SETTINGS_VERSION        1
+#define CAN_SETTINGS_MAX_QUEUE_LEN  256
+
+typedef struct {
+    uint16_t version;
+    uint16_t brp;               // clock prescaler, even, 2-128
+    uint8_t tseg_1;             // 1-16 quanta
+    uint8_t tseg_2;             // 1-8 quanta
+    uint8_t sjw;                // 1-4 quanta, at most tseg_2
+    uint8_t mode;               // twai_mode_t
+    uint16_t rx_queue_len;
+    uint16_t tx_queue_len;
+} can_settings_t;
+
+typedef struct {
+    uint32_t bitrate;
+    can_settings_t timing;      // only brp/tseg/sjw are meaningful
+} can_settings_preset_t;
+
+/**
+ * @brief Standard bitrates, slowest first. Returns the entry count.
+ */
+size_t can_settings_get_presets(const can_settings_preset_t **out_presets);
+
+/**
+ * @brief Compile-time defaults from can_config.h.
+ */
+void can_settings_default(can_settings_t *out_settings);
+
+/**
+ * @brief Set the timing fields of a preset bitrate.
+ *
+ * @return ESP_ERR_NOT_SUPPORTED if there is no preset for the bitrate.
+ */
+esp_err_t can_settings_set_bitrate(can_settings_t *settings, uint32_t bitrate);
+
+/**
+ * @brief Check ranges the controller and driver accept.
+ *
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG with a reason in *out_reason.
+ */
+esp_err_t can_settings_validate(const can_settings_t *settings, const char **out_reason);
+
+/**
+ * @brief Stored record, or the defaults if none or invalid.
+ *
+ * @return ESP_OK if a stored record was used, ESP_ERR_NOT_FOUND for defaults.
+ */
+esp_err_t can_settings_load(can_settings_t *out_settings);
+esp_err_t can_settings_save(const can_settings_t *settings);
+esp_err_t can_settings_erase(void);
+
+void can_settings_to_config(const can_settings_t *settings, twai_general_config_t *out_general,
+                            twai_timing_config_t *out_timing);
+
+uint32_t can_settings_bitrate(const can_settings_t *settings);
+
+/**
+ * @brief Sample point in 1/1000 of the bit time.
+ */
+uint32_t can_settings_sample_point_permille(const can_settings_t *settings);
+
+/**
+ * @brief Frames per second on a saturated bus for 8-byte standard frames,
+ *        with worst-case stuffing (min) and without stuff bits (max).
+ */
+void can_settings_max_frame_rate(const can_settings_t *settings, uint32_t *out_min, uint32_t *out_max);
+
+const char *can_settings_mode_name(uint8_t mode);
+
+#endif // CAN_SETTINGS_UTILS_H
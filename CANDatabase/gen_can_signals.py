@@ -0,0 +1,371 @@
+#!/usr/bin/env python3
+"""Generate include/can_signals.h from signals.json.
+
+Every message gets ID/DLC constants, a struct of raw signal values and
+inline pack/unpack functions whose shifts and masks are resolved here,
+so the C side is straight-line code with no per-signal interpretation.
+Scaled signals also get encode/decode helpers with the physical range
+clamped at compile-time constants.
+
+Usage:
+    python3 gen_can_signals.py            # regenerate the header
+    python3 gen_can_signals.py --check    # fail if the header is stale
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_INPUT = os.path.join(HERE, "signals.json")
+DEFAULT_OUTPUT = os.path.join(HERE, "include", "can_signals.h")
+
+IDENT = re.compile(r"^[A-Za-z_][A-Za-z0-9_]*$")
+
+
+class DatabaseError(Exception):
+    pass
+
+
+def c_float(value):
+    text = repr(float(value))
+    if "e" not in text and "." not in text:
+        text += ".0"
+    return text + "f"
+
+
+def raw_type(length, signed):
+    for bits in (8, 16, 32, 64):
+        if length <= bits:
+            return ("int%d_t" if signed else "uint%d_t") % bits, bits
+    raise DatabaseError("signal longer than 64 bits")
+
+
+def bit_positions(sig):
+    """Frame bit position (byte * 8 + bit) for each raw bit, LSB first."""
+    start, length = sig["start"], sig["length"]
+    if sig.get("byte_order", "little") == "little":
+        return [start + i for i in range(length)]
+
+    # Motorola / DBC big-endian: start is the MSB, walking the sawtooth
+    positions = [0] * length
+    pos = start
+    for i in reversed(range(length)):
+        positions[i] = pos
+        pos = pos + 15 if pos % 8 == 0 else pos - 1
+    return positions
+
+
+def byte_slices(sig):
+    """[(byte, raw_lsb, bit_in_byte, width)] with contiguous bits per byte."""
+    per_byte = {}
+    for raw_bit, pos in enumerate(bit_positions(sig)):
+        per_byte.setdefault(pos // 8, []).append((raw_bit, pos % 8))
+    slices = []
+    for byte in sorted(per_byte):
+        bits = per_byte[byte]
+        raw_lsb, bit_lsb = bits[0]
+        slices.append((byte, raw_lsb, bit_lsb, len(bits)))
+    return slices
+
+
+def validate(db):
+    messages = db.get("messages", [])
+    by_name = {}
+    by_id = {}
+    for msg in messages:
+        name = msg["name"]
+        if not IDENT.match(name) or name in by_name:
+            raise DatabaseError("bad or duplicate message name '%s'" % name)
+        by_name[name] = msg
+        msg["id_value"] = int(str(msg["id"]), 0)
+        extended = msg.get("extended", False)
+        if msg["id_value"] > (0x1FFFFFFF if extended else 0x7FF):
+            raise DatabaseError("%s: identifier out of range" % name)
+        if not 0 <= msg["dlc"] <= 8:
+            raise DatabaseError("%s: DLC must be 0-8" % name)
+        by_id.setdefault((msg["id_value"], extended), []).append(msg)
+        if "node_ids" in msg:
+            nodes = msg["node_ids"]
+            nodes["base_value"] = int(str(nodes["base"]), 0)
+            if nodes["count"] < 1 or nodes["base_value"] + nodes["count"] - 1 > (0x1FFFFFFF if extended else 0x7FF):
+                raise DatabaseError("%s: node ID range out of range" % name)
+
+        used = set()
+        names = set()
+        for sig in msg["signals"]:
+            if not IDENT.match(sig["name"]) or sig["name"] in names:
+                raise DatabaseError("%s: bad or duplicate signal '%s'" % (name, sig["name"]))
+            names.add(sig["name"])
+            if not 1 <= sig["length"] <= 64:
+                raise DatabaseError("%s.%s: length must be 1-64" % (name, sig["name"]))
+            positions = bit_positions(sig)
+            if min(positions) < 0 or max(positions) >= msg["dlc"] * 8:
+                raise DatabaseError("%s.%s: bits outside DLC" % (name, sig["name"]))
+            if used.intersection(positions):
+                raise DatabaseError("%s.%s: overlaps another signal" % (name, sig["name"]))
+            used.update(positions)
+
+    ranged = [m for m in messages if "node_ids" in m]
+    for msg in ranged:
+        first = msg["node_ids"]["base_value"]
+        last = first + msg["node_ids"]["count"] - 1
+        extended = msg.get("extended", False)
+        for (ident, ext) in by_id:
+            if ext == extended and first <= ident <= last:
+                raise DatabaseError("%s: node ID range contains identifier 0x%X" % (msg["name"], ident))
+        for other in ranged:
+            o_first = other["node_ids"]["base_value"]
+            o_last = o_first + other["node_ids"]["count"] - 1
+            if other is msg or other.get("extended", False) != extended:
+                continue
+            # Messages sharing an ID share its node range too (checked below)
+            if other["id_value"] == msg["id_value"] and (o_first, o_last) == (first, last):
+                continue
+            if first <= o_last and o_first <= last:
+                raise DatabaseError("%s: node ID range overlaps %s" % (msg["name"], other["name"]))
+
+    for (ident, _), group in by_id.items():
+        if len(group) == 1:
+            continue
+        owners = [m for m in group if "shares_id_with" not in m]
+        sharers = [m for m in group if "shares_id_with" in m]
+        if len(owners) != 1 or any(m["shares_id_with"] != owners[0]["name"] for m in sharers):
+            raise DatabaseError("identifier 0x%X used by several messages without shares_id_with" % ident)
+        node_range = owners[0].get("node_ids")
+        for msg in sharers:
+            other_range = msg.get("node_ids")
+            if (node_range is None) != (other_range is None) or \
+                    (node_range and (node_range["base_value"], node_range["count"]) !=
+                     (other_range["base_value"], other_range["count"])):
+                raise DatabaseError("%s: shares identifier 0x%X with %s but not its node ID range"
+                                    % (msg["name"], ident, owners[0]["name"]))
+    return messages
+
+
+def signal_raw_range(sig):
+    length, signed = sig["length"], sig.get("signed", False)
+    lo = -(1 << (length - 1)) if signed else 0
+    hi = (1 << (length - 1)) - 1 if signed else (1 << length) - 1
+    scale, offset = sig.get("scale", 1), sig.get("offset", 0)
+    if "min" in sig:
+        lo = max(lo, int(round((sig["min"] - offset) / scale)))
+    if "max" in sig:
+        hi = min(hi, int(round((sig["max"] - offset) / scale)))
+    if lo > hi:
+        raise DatabaseError("%s: empty range" % sig["name"])
+    return lo, hi
+
+
+def c_int(value, bits):
+    if value < 0:
+        # Avoid INT_MIN literal pitfalls
+        return "(%d)" % value if value > -(1 << 31) else "(-%dLL - 1)" % (-value - 1)
+    suffix = "ULL" if bits == 64 else "u" if value > 0x7FFFFFFF else ""
+    return "%d%s" % (value, suffix)
+
+
+def define(name, value):
+    return "#define %-48s %s" % (name, value)
+
+
+def emit_message(out, msg):
+    name = msg["name"]
+    lower = name.lower()
+    prefix = "CAN_MSG_" + name
+    extended = msg.get("extended", False)
+
+    out.append("/* " + "-" * 70)
+    out.append(" * %s: ID 0x%X%s, DLC %d" % (name, msg["id_value"], " (extended)" if extended else "", msg["dlc"]))
+    if msg.get("comment"):
+        out.append(" * " + msg["comment"])
+    out.append(" */")
+    if "shares_id_with" in msg:
+        out.append(define(prefix + "_ID", "CAN_MSG_%s_ID" % msg["shares_id_with"]))
+    else:
+        out.append(define(prefix + "_ID", "0x%Xu" % msg["id_value"]))
+    out.append(define(prefix + "_EXTENDED", 1 if extended else 0))
+    out.append(define(prefix + "_DLC", msg["dlc"]))
+    if "period_ms" in msg:
+        out.append(define(prefix + "_PERIOD_MS", msg["period_ms"]))
+    if "node_ids" in msg:
+        nodes = msg["node_ids"]
+        out.append("// Per-node copies of this message: ID = NODE_BASE_ID + node, node < NODE_COUNT")
+        out.append(define(prefix + "_NODE_BASE_ID", "0x%Xu" % nodes["base_value"]))
+        out.append(define(prefix + "_NODE_COUNT", nodes["count"]))
+        out.append(define(prefix + "_NODE_ID(node)", "(%s_NODE_BASE_ID + (uint32_t)(node))" % prefix))
+    out.append("")
+
+    for sig in msg["signals"]:
+        sp = "CAN_SIG_%s_%s" % (name, sig["name"].upper())
+        ctype, bits = raw_type(sig["length"], sig.get("signed", False))
+        lo, hi = signal_raw_range(sig)
+        scale, offset = sig.get("scale", 1), sig.get("offset", 0)
+        order = "LE" if sig.get("byte_order", "little") == "little" else "BE"
+        desc = "%s: start %d, %d bit%s, %s, %s" % (
+            sig["name"], sig["start"], sig["length"], "" if sig["length"] == 1 else "s",
+            "signed" if sig.get("signed", False) else "unsigned", order)
+        if scale != 1 or offset != 0:
+            desc += ", %g/bit + %g" % (scale, offset)
+        if sig.get("unit"):
+            desc += " [%s]" % sig["unit"]
+        out.append("// " + desc)
+        out.append(define(sp + "_MIN_RAW", c_int(lo, bits)))
+        out.append(define(sp + "_MAX_RAW", c_int(hi, bits)))
+        if scale != 1 or offset != 0:
+            out.append(define(sp + "_SCALE", c_float(scale)))
+            out.append(define(sp + "_OFFSET", c_float(offset)))
+    out.append("")
+
+    out.append("typedef struct {")
+    for sig in msg["signals"]:
+        ctype, _ = raw_type(sig["length"], sig.get("signed", False))
+        out.append("    %s %s;" % (ctype, sig["name"]))
+    if not msg["signals"]:
+        out.append("    uint8_t reserved;")
+    out.append("} can_%s_t;" % lower)
+    out.append("")
+
+    # Pack: one assignment per data byte, all signals OR'ed in
+    contributions = {b: [] for b in range(msg["dlc"])}
+    for sig in msg["signals"]:
+        _, bits = raw_type(sig["length"], False)
+        utype = "uint%d_t" % bits
+        for byte, raw_lsb, bit_lsb, width in byte_slices(sig):
+            expr = "(%s)msg->%s" % (utype, sig["name"])
+            if raw_lsb:
+                expr = "(%s >> %d)" % (expr, raw_lsb)
+            expr = "(%s & 0x%Xu)" % (expr, (1 << width) - 1)
+            if bit_lsb:
+                expr = "(%s << %d)" % (expr, bit_lsb)
+            contributions[byte].append(expr)
+
+    out.append("static inline void can_%s_pack(uint8_t *data, const can_%s_t *msg)" % (lower, lower))
+    out.append("{")
+    if not msg["signals"]:
+        out.append("    (void)msg;")
+    for byte in range(msg["dlc"]):
+        parts = contributions[byte]
+        if not parts:
+            rhs = "0"
+        elif len(parts) == 1:
+            rhs = "(uint8_t)" + parts[0]
+        else:
+            rhs = "(uint8_t)(%s)" % " | ".join(parts)
+        out.append("    data[%d] = %s;" % (byte, rhs))
+    out.append("}")
+    out.append("")
+
+    out.append("static inline void can_%s_unpack(can_%s_t *msg, const uint8_t *data)" % (lower, lower))
+    out.append("{")
+    if not msg["signals"]:
+        out.append("    (void)msg;")
+        out.append("    (void)data;")
+    for sig in msg["signals"]:
+        signed = sig.get("signed", False)
+        ctype, bits = raw_type(sig["length"], signed)
+        utype = "uint%d_t" % bits
+        parts = []
+        for byte, raw_lsb, bit_lsb, width in byte_slices(sig):
+            expr = "data[%d]" % byte
+            if bit_lsb:
+                expr = "(%s >> %d)" % (expr, bit_lsb)
+            if width < 8:
+                expr = "(%s & 0x%Xu)" % (expr, (1 << width) - 1)
+            if raw_lsb:
+                expr = "((%s)%s << %d)" % (utype, expr, raw_lsb)
+            elif len(byte_slices(sig)) > 1:
+                expr = "(%s)%s" % (utype, expr)
+            parts.append(expr)
+        value = " | ".join(parts)
+        if signed and sig["length"] < bits:
+            # Branch-free sign extension of a narrower field
+            sign = "0x%X%s" % (1 << (sig["length"] - 1), "ULL" if bits == 64 else "u")
+            value = "(((%s)(%s) ^ %s) - %s)" % (utype, value, sign, sign)
+        elif len(parts) > 1:
+            value = "(%s)" % value
+        out.append("    msg->%s = (%s)%s;" % (sig["name"], ctype, value))
+    out.append("}")
+    out.append("")
+
+    for sig in msg["signals"]:
+        scale, offset = sig.get("scale", 1), sig.get("offset", 0)
+        if scale == 1 and offset == 0:
+            continue
+        sp = "CAN_SIG_%s_%s" % (name, sig["name"].upper())
+        ctype, _ = raw_type(sig["length"], sig.get("signed", False))
+        fn = "can_%s_%s" % (lower, sig["name"])
+        out.append("static inline %s %s_encode(float value)" % (ctype, fn))
+        out.append("{")
+        out.append("    float raw = (value - %s_OFFSET) * %s;" % (sp, c_float(1.0 / scale)))
+        out.append("    raw = raw < (float)%s_MIN_RAW ? (float)%s_MIN_RAW : raw;" % (sp, sp))
+        out.append("    raw = raw > (float)%s_MAX_RAW ? (float)%s_MAX_RAW : raw;" % (sp, sp))
+        out.append("    return (%s)(raw + (raw >= 0.0f ? 0.5f : -0.5f));" % ctype)
+        out.append("}")
+        out.append("")
+        out.append("static inline float %s_decode(%s raw)" % (fn, ctype))
+        out.append("{")
+        out.append("    return (float)raw * %s_SCALE + %s_OFFSET;" % (sp, sp))
+        out.append("}")
+        out.append("")
+
+
+def generate(messages, source_name):
+    out = [
+        "/*",
+        " * can_signals.h - generated by CANDatabase/gen_can_signals.py from %s." % source_name,
+        " * DO NOT EDIT: change the signal database and re-run the generator.",
+        " *",
+        " * Struct fields hold raw (unscaled) values. pack() writes exactly DLC",
+        " * bytes; unpack() reads them. Scaled signals have encode()/decode()",
+        " * helpers that clamp to the declared physical range.",
+        " */",
+        "#ifndef CAN_SIGNALS_H",
+        "#define CAN_SIGNALS_H",
+        "",
+        "#include <stdint.h>",
+        "",
+    ]
+    for msg in messages:
+        emit_message(out, msg)
+    out.append("#endif // CAN_SIGNALS_H")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--input", default=DEFAULT_INPUT)
+    parser.add_argument("--output", default=DEFAULT_OUTPUT)
+    parser.add_argument("--check", action="store_true", help="verify the output is up to date")
+    args = parser.parse_args()
+
+    with open(args.input) as f:
+        db = json.load(f)
+    try:
+        messages = validate(db)
+        text = generate(messages, os.path.basename(args.input))
+    except (DatabaseError, KeyError) as err:
+        print("error: %s" % err, file=sys.stderr)
+        return 1
+
+    if args.check:
+        try:
+            with open(args.output) as f:
+                current = f.read()
+        except FileNotFoundError:
+            current = None
+        if current != text:
+            print("%s is out of date; run gen_can_signals.py" % args.output, file=sys.stderr)
+            return 1
+        return 0
+
+    os.makedirs(os.path.dirname(args.output), exist_ok=True)
+    with open(args.output, "w") as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,410 @@
+/*
+ * can_signals.h - generated by CANDatabase/gen_can_signals.py from signals.json.
+ * DO NOT EDIT: change the signal database and re-run the generator.
+ *
+ * Struct fields hold raw (unscaled) values. pack() writes exactly DLC
+ * bytes; unpack() reads them. Scaled signals have encode()/decode()
+ * helpers that clamp to the declared physical range.
+ */
+#ifndef CAN_SIGNALS_H
+#define CAN_SIGNALS_H
+
+#include <stdint.h>
+
+/* ----------------------------------------------------------------------
+ * TEMPERATURE: ID 0x515, DLC 2
+ * Single LM35 sample from TempTransmitter
+ */
+#define CAN_MSG_TEMPERATURE_ID                           0x515u
+#define CAN_MSG_TEMPERATURE_EXTENDED                     0
+#define CAN_MSG_TEMPERATURE_DLC                          2
+// Per-node copies of this message: ID = NODE_BASE_ID + node, node < NODE_COUNT
+#define CAN_MSG_TEMPERATURE_NODE_BASE_ID                 0x400u
+#define CAN_MSG_TEMPERATURE_NODE_COUNT                   256
+#define CAN_MSG_TEMPERATURE_NODE_ID(node)                (CAN_MSG_TEMPERATURE_NODE_BASE_ID + (uint32_t)(node))
+
+// temperature: start 0, 16 bits, signed, LE, 0.01/bit + 0 [degC]
+#define CAN_SIG_TEMPERATURE_TEMPERATURE_MIN_RAW          (-5500)
+#define CAN_SIG_TEMPERATURE_TEMPERATURE_MAX_RAW          15000
+#define CAN_SIG_TEMPERATURE_TEMPERATURE_SCALE            0.01f
+#define CAN_SIG_TEMPERATURE_TEMPERATURE_OFFSET           0.0f
+
+typedef struct {
+    int16_t temperature;
+} can_temperature_t;
+
+static inline void can_temperature_pack(uint8_t *data, const can_temperature_t *msg)
+{
+    data[0] = (uint8_t)((uint16_t)msg->temperature & 0xFFu);
+    data[1] = (uint8_t)(((uint16_t)msg->temperature >> 8) & 0xFFu);
+}
+
+static inline void can_temperature_unpack(can_temperature_t *msg, const uint8_t *data)
+{
+    msg->temperature = (int16_t)((uint16_t)data[0] | ((uint16_t)data[1] << 8));
+}
+
+static inline int16_t can_temperature_temperature_encode(float value)
+{
+    float raw = (value - CAN_SIG_TEMPERATURE_TEMPERATURE_OFFSET) * 100.0f;
+    raw = raw < (float)CAN_SIG_TEMPERATURE_TEMPERATURE_MIN_RAW ? (float)CAN_SIG_TEMPERATURE_TEMPERATURE_MIN_RAW : raw;
+    raw = raw > (float)CAN_SIG_TEMPERATURE_TEMPERATURE_MAX_RAW ? (float)CAN_SIG_TEMPERATURE_TEMPERATURE_MAX_RAW : raw;
+    return (int16_t)(raw + (raw >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline float can_temperature_temperature_decode(int16_t raw)
+{
+    return (float)raw * CAN_SIG_TEMPERATURE_TEMPERATURE_SCALE + CAN_SIG_TEMPERATURE_TEMPERATURE_OFFSET;
+}
+
+/* ----------------------------------------------------------------------
+ * TEMPERATURE_BATCH: ID 0x515, DLC 7
+ * Up to 3 samples per frame; DLC = 1 + 2 * count, unused samples are not sent
+ */
+#define CAN_MSG_TEMPERATURE_BATCH_ID                     CAN_MSG_TEMPERATURE_ID
+#define CAN_MSG_TEMPERATURE_BATCH_EXTENDED               0
+#define CAN_MSG_TEMPERATURE_BATCH_DLC                    7
+// Per-node copies of this message: ID = NODE_BASE_ID + node, node < NODE_COUNT
+#define CAN_MSG_TEMPERATURE_BATCH_NODE_BASE_ID           0x400u
+#define CAN_MSG_TEMPERATURE_BATCH_NODE_COUNT             256
+#define CAN_MSG_TEMPERATURE_BATCH_NODE_ID(node)          (CAN_MSG_TEMPERATURE_BATCH_NODE_BASE_ID + (uint32_t)(node))
+
+// sequence: start 0, 6 bits, unsigned, LE
+#define CAN_SIG_TEMPERATURE_BATCH_SEQUENCE_MIN_RAW       0
+#define CAN_SIG_TEMPERATURE_BATCH_SEQUENCE_MAX_RAW       63
+// count: start 6, 2 bits, unsigned, LE
+#define CAN_SIG_TEMPERATURE_BATCH_COUNT_MIN_RAW          1
+#define CAN_SIG_TEMPERATURE_BATCH_COUNT_MAX_RAW          3
+// sample0: start 8, 16 bits, signed, LE, 0.01/bit + 0 [degC]
+#define CAN_SIG_TEMPERATURE_BATCH_SAMPLE0_MIN_RAW        (-5500)
+#define CAN_SIG_TEMPERATURE_BATCH_SAMPLE0_MAX_RAW        15000
+#define CAN_SIG_TEMPERATURE_BATCH_SAMPLE0_SCALE          0.01f
+#define CAN_SIG_TEMPERATURE_BATCH_SAMPLE0_OFFSET         0.0f
+// sample1: start 24, 16 bits, signed, LE, 0.01/bit + 0 [degC]
+#define CAN_SIG_TEMPERATURE_BATCH_SAMPLE1_MIN_RAW        (-5500)
+#define CAN_SIG_TEMPERATURE_BATCH_SAMPLE1_MAX_RAW        15000
+#define CAN_SIG_TEMPERATURE_BATCH_SAMPLE1_SCALE          0.01f
+#define CAN_SIG_TEMPERATURE_BATCH_SAMPLE1_OFFSET         0.0f
+// sample2: start 40, 16 bits, signed, LE, 0.01/bit + 0 [degC]
+#define CAN_SIG_TEMPERATURE_BATCH_SAMPLE2_MIN_RAW        (-5500)
+#define CAN_SIG_TEMPERATURE_BATCH_SAMPLE2_MAX_RAW        15000
+#define CAN_SIG_TEMPERATURE_BATCH_SAMPLE2_SCALE          0.01f
+#define CAN_SIG_TEMPERATURE_BATCH_SAMPLE2_OFFSET         0.0f
+
+typedef struct {
+    uint8_t sequence;
+    uint8_t count;
+    int16_t sample0;
+    int16_t sample1;
+    int16_t sample2;
+} can_temperature_batch_t;
+
+static inline void can_temperature_batch_pack(uint8_t *data, const can_temperature_batch_t *msg)
+{
+    data[0] = (uint8_t)(((uint8_t)msg->sequence & 0x3Fu) | (((uint8_t)msg->count & 0x3u) << 6));
+    data[1] = (uint8_t)((uint16_t)msg->sample0 & 0xFFu);
+    data[2] = (uint8_t)(((uint16_t)msg->sample0 >> 8) & 0xFFu);
+    data[3] = (uint8_t)((uint16_t)msg->sample1 & 0xFFu);
+    data[4] = (uint8_t)(((uint16_t)msg->sample1 >> 8) & 0xFFu);
+    data[5] = (uint8_t)((uint16_t)msg->sample2 & 0xFFu);
+    data[6] = (uint8_t)(((uint16_t)msg->sample2 >> 8) & 0xFFu);
+}
+
+static inline void can_temperature_batch_unpack(can_temperature_batch_t *msg, const uint8_t *data)
+{
+    msg->sequence = (uint8_t)(data[0] & 0x3Fu);
+    msg->count = (uint8_t)((data[0] >> 6) & 0x3u);
+    msg->sample0 = (int16_t)((uint16_t)data[1] | ((uint16_t)data[2] << 8));
+    msg->sample1 = (int16_t)((uint16_t)data[3] | ((uint16_t)data[4] << 8));
+    msg->sample2 = (int16_t)((uint16_t)data[5] | ((uint16_t)data[6] << 8));
+}
+
+static inline int16_t can_temperature_batch_sample0_encode(float value)
+{
+    float raw = (value - CAN_SIG_TEMPERATURE_BATCH_SAMPLE0_OFFSET) * 100.0f;
+    raw = raw < (float)CAN_SIG_TEMPERATURE_BATCH_SAMPLE0_MIN_RAW ? (float)CAN_SIG_TEMPERATURE_BATCH_SAMPLE0_MIN_RAW : raw;
+    raw = raw > (float)CAN_SIG_TEMPERATURE_BATCH_SAMPLE0_MAX_RAW ? (float)CAN_SIG_TEMPERATURE_BATCH_SAMPLE0_MAX_RAW : raw;
+    return (int16_t)(raw + (raw >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline float can_temperature_batch_sample0_decode(int16_t raw)
+{
+    return (float)raw * CAN_SIG_TEMPERATURE_BATCH_SAMPLE0_SCALE + CAN_SIG_TEMPERATURE_BATCH_SAMPLE0_OFFSET;
+}
+
+static inline int16_t can_temperature_batch_sample1_encode(float value)
+{
+    float raw = (value - CAN_SIG_TEMPERATURE_BATCH_SAMPLE1_OFFSET) * 100.0f;
+    raw = raw < (float)CAN_SIG_TEMPERATURE_BATCH_SAMPLE1_MIN_RAW ? (float)CAN_SIG_TEMPERATURE_BATCH_SAMPLE1_MIN_RAW : raw;
+    raw = raw > (float)CAN_SIG_TEMPERATURE_BATCH_SAMPLE1_MAX_RAW ? (float)CAN_SIG_TEMPERATURE_BATCH_SAMPLE1_MAX_RAW : raw;
+    return (int16_t)(raw + (raw >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline float can_temperature_batch_sample1_decode(int16_t raw)
+{
+    return (float)raw * CAN_SIG_TEMPERATURE_BATCH_SAMPLE1_SCALE + CAN_SIG_TEMPERATURE_BATCH_SAMPLE1_OFFSET;
+}
+
+static inline int16_t can_temperature_batch_sample2_encode(float value)
+{
+    float raw = (value - CAN_SIG_TEMPERATURE_BATCH_SAMPLE2_OFFSET) * 100.0f;
+    raw = raw < (float)CAN_SIG_TEMPERATURE_BATCH_SAMPLE2_MIN_RAW ? (float)CAN_SIG_TEMPERATURE_BATCH_SAMPLE2_MIN_RAW : raw;
+    raw = raw > (float)CAN_SIG_TEMPERATURE_BATCH_SAMPLE2_MAX_RAW ? (float)CAN_SIG_TEMPERATURE_BATCH_SAMPLE2_MAX_RAW : raw;
+    return (int16_t)(raw + (raw >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline float can_temperature_batch_sample2_decode(int16_t raw)
+{
+    return (float)raw * CAN_SIG_TEMPERATURE_BATCH_SAMPLE2_SCALE + CAN_SIG_TEMPERATURE_BATCH_SAMPLE2_OFFSET;
+}
+
+/* ----------------------------------------------------------------------
+ * TEMP_STATS_REQUEST: ID 0x516, DLC 1
+ * Ask TempReceiver for its temperature statistics
+ */
+#define CAN_MSG_TEMP_STATS_REQUEST_ID                    0x516u
+#define CAN_MSG_TEMP_STATS_REQUEST_EXTENDED              0
+#define CAN_MSG_TEMP_STATS_REQUEST_DLC                   1
+
+// window: start 0, 8 bits, unsigned, LE
+#define CAN_SIG_TEMP_STATS_REQUEST_WINDOW_MIN_RAW        0
+#define CAN_SIG_TEMP_STATS_REQUEST_WINDOW_MAX_RAW        255
+
+typedef struct {
+    uint8_t window;
+} can_temp_stats_request_t;
+
+static inline void can_temp_stats_request_pack(uint8_t *data, const can_temp_stats_request_t *msg)
+{
+    data[0] = (uint8_t)((uint8_t)msg->window & 0xFFu);
+}
+
+static inline void can_temp_stats_request_unpack(can_temp_stats_request_t *msg, const uint8_t *data)
+{
+    msg->window = (uint8_t)data[0];
+}
+
+/* ----------------------------------------------------------------------
+ * TEMP_STATS: ID 0x517, DLC 8
+ * TempReceiver statistics since start; count saturates at 65535
+ */
+#define CAN_MSG_TEMP_STATS_ID                            0x517u
+#define CAN_MSG_TEMP_STATS_EXTENDED                      0
+#define CAN_MSG_TEMP_STATS_DLC                           8
+
+// mean: start 0, 16 bits, signed, LE, 0.01/bit + 0 [degC]
+#define CAN_SIG_TEMP_STATS_MEAN_MIN_RAW                  (-5500)
+#define CAN_SIG_TEMP_STATS_MEAN_MAX_RAW                  15000
+#define CAN_SIG_TEMP_STATS_MEAN_SCALE                    0.01f
+#define CAN_SIG_TEMP_STATS_MEAN_OFFSET                   0.0f
+// stddev: start 16, 16 bits, unsigned, LE, 0.01/bit + 0 [degC]
+#define CAN_SIG_TEMP_STATS_STDDEV_MIN_RAW                0
+#define CAN_SIG_TEMP_STATS_STDDEV_MAX_RAW                65535
+#define CAN_SIG_TEMP_STATS_STDDEV_SCALE                  0.01f
+#define CAN_SIG_TEMP_STATS_STDDEV_OFFSET                 0.0f
+// ema: start 32, 16 bits, signed, LE, 0.01/bit + 0 [degC]
+#define CAN_SIG_TEMP_STATS_EMA_MIN_RAW                   (-5500)
+#define CAN_SIG_TEMP_STATS_EMA_MAX_RAW                   15000
+#define CAN_SIG_TEMP_STATS_EMA_SCALE                     0.01f
+#define CAN_SIG_TEMP_STATS_EMA_OFFSET                    0.0f
+// count: start 48, 16 bits, unsigned, LE
+#define CAN_SIG_TEMP_STATS_COUNT_MIN_RAW                 0
+#define CAN_SIG_TEMP_STATS_COUNT_MAX_RAW                 65535
+
+typedef struct {
+    int16_t mean;
+    uint16_t stddev;
+    int16_t ema;
+    uint16_t count;
+} can_temp_stats_t;
+
+static inline void can_temp_stats_pack(uint8_t *data, const can_temp_stats_t *msg)
+{
+    data[0] = (uint8_t)((uint16_t)msg->mean & 0xFFu);
+    data[1] = (uint8_t)(((uint16_t)msg->mean >> 8) & 0xFFu);
+    data[2] = (uint8_t)((uint16_t)msg->stddev & 0xFFu);
+    data[3] = (uint8_t)(((uint16_t)msg->stddev >> 8) & 0xFFu);
+    data[4] = (uint8_t)((uint16_t)msg->ema & 0xFFu);
+    data[5] = (uint8_t)(((uint16_t)msg->ema >> 8) & 0xFFu);
+    data[6] = (uint8_t)((uint16_t)msg->count & 0xFFu);
+    data[7] = (uint8_t)(((uint16_t)msg->count >> 8) & 0xFFu);
+}
+
+static inline void can_temp_stats_unpack(can_temp_stats_t *msg, const uint8_t *data)
+{
+    msg->mean = (int16_t)((uint16_t)data[0] | ((uint16_t)data[1] << 8));
+    msg->stddev = (uint16_t)((uint16_t)data[2] | ((uint16_t)data[3] << 8));
+    msg->ema = (int16_t)((uint16_t)data[4] | ((uint16_t)data[5] << 8));
+    msg->count = (uint16_t)((uint16_t)data[6] | ((uint16_t)data[7] << 8));
+}
+
+static inline int16_t can_temp_stats_mean_encode(float value)
+{
+    float raw = (value - CAN_SIG_TEMP_STATS_MEAN_OFFSET) * 100.0f;
+    raw = raw < (float)CAN_SIG_TEMP_STATS_MEAN_MIN_RAW ? (float)CAN_SIG_TEMP_STATS_MEAN_MIN_RAW : raw;
+    raw = raw > (float)CAN_SIG_TEMP_STATS_MEAN_MAX_RAW ? (float)CAN_SIG_TEMP_STATS_MEAN_MAX_RAW : raw;
+    return (int16_t)(raw + (raw >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline float can_temp_stats_mean_decode(int16_t raw)
+{
+    return (float)raw * CAN_SIG_TEMP_STATS_MEAN_SCALE + CAN_SIG_TEMP_STATS_MEAN_OFFSET;
+}
+
+static inline uint16_t can_temp_stats_stddev_encode(float value)
+{
+    float raw = (value - CAN_SIG_TEMP_STATS_STDDEV_OFFSET) * 100.0f;
+    raw = raw < (float)CAN_SIG_TEMP_STATS_STDDEV_MIN_RAW ? (float)CAN_SIG_TEMP_STATS_STDDEV_MIN_RAW : raw;
+    raw = raw > (float)CAN_SIG_TEMP_STATS_STDDEV_MAX_RAW ? (float)CAN_SIG_TEMP_STATS_STDDEV_MAX_RAW : raw;
+    return (uint16_t)(raw + (raw >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline float can_temp_stats_stddev_decode(uint16_t raw)
+{
+    return (float)raw * CAN_SIG_TEMP_STATS_STDDEV_SCALE + CAN_SIG_TEMP_STATS_STDDEV_OFFSET;
+}
+
+static inline int16_t can_temp_stats_ema_encode(float value)
+{
+    float raw = (value - CAN_SIG_TEMP_STATS_EMA_OFFSET) * 100.0f;
+    raw = raw < (float)CAN_SIG_TEMP_STATS_EMA_MIN_RAW ? (float)CAN_SIG_TEMP_STATS_EMA_MIN_RAW : raw;
+    raw = raw > (float)CAN_SIG_TEMP_STATS_EMA_MAX_RAW ? (float)CAN_SIG_TEMP_STATS_EMA_MAX_RAW : raw;
+    return (int16_t)(raw + (raw >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline float can_temp_stats_ema_decode(int16_t raw)
+{
+    return (float)raw * CAN_SIG_TEMP_STATS_EMA_SCALE + CAN_SIG_TEMP_STATS_EMA_OFFSET;
+}
+
+/* ----------------------------------------------------------------------
+ * TEMP_STATS_WINDOW: ID 0x518, DLC 7
+ * Min/max over the requested window; window 0 is since start
+ */
+#define CAN_MSG_TEMP_STATS_WINDOW_ID                     0x518u
+#define CAN_MSG_TEMP_STATS_WINDOW_EXTENDED               0
+#define CAN_MSG_TEMP_STATS_WINDOW_DLC                    7
+
+// window: start 0, 7 bits, unsigned, LE
+#define CAN_SIG_TEMP_STATS_WINDOW_WINDOW_MIN_RAW         0
+#define CAN_SIG_TEMP_STATS_WINDOW_WINDOW_MAX_RAW         127
+// valid: start 7, 1 bit, unsigned, LE
+#define CAN_SIG_TEMP_STATS_WINDOW_VALID_MIN_RAW          0
+#define CAN_SIG_TEMP_STATS_WINDOW_VALID_MAX_RAW          1
+// window_s: start 8, 16 bits, unsigned, LE [s]
+#define CAN_SIG_TEMP_STATS_WINDOW_WINDOW_S_MIN_RAW       0
+#define CAN_SIG_TEMP_STATS_WINDOW_WINDOW_S_MAX_RAW       65535
+// min: start 24, 16 bits, signed, LE, 0.01/bit + 0 [degC]
+#define CAN_SIG_TEMP_STATS_WINDOW_MIN_MIN_RAW            (-5500)
+#define CAN_SIG_TEMP_STATS_WINDOW_MIN_MAX_RAW            15000
+#define CAN_SIG_TEMP_STATS_WINDOW_MIN_SCALE              0.01f
+#define CAN_SIG_TEMP_STATS_WINDOW_MIN_OFFSET             0.0f
+// max: start 40, 16 bits, signed, LE, 0.01/bit + 0 [degC]
+#define CAN_SIG_TEMP_STATS_WINDOW_MAX_MIN_RAW            (-5500)
+#define CAN_SIG_TEMP_STATS_WINDOW_MAX_MAX_RAW            15000
+#define CAN_SIG_TEMP_STATS_WINDOW_MAX_SCALE              0.01f
+#define CAN_SIG_TEMP_STATS_WINDOW_MAX_OFFSET             0.0f
+
+typedef struct {
+    uint8_t window;
+    uint8_t valid;
+    uint16_t window_s;
+    int16_t min;
+    int16_t max;
+} can_temp_stats_window_t;
+
+static inline void can_temp_stats_window_pack(uint8_t *data, const can_temp_stats_window_t *msg)
+{
+    data[0] = (uint8_t)(((uint8_t)msg->window & 0x7Fu) | (((uint8_t)msg->valid & 0x1u) << 7));
+    data[1] = (uint8_t)((uint16_t)msg->window_s & 0xFFu);
+    data[2] = (uint8_t)(((uint16_t)msg->window_s >> 8) & 0xFFu);
+    data[3] = (uint8_t)((uint16_t)msg->min & 0xFFu);
+    data[4] = (uint8_t)(((uint16_t)msg->min >> 8) & 0xFFu);
+    data[5] = (uint8_t)((uint16_t)msg->max & 0xFFu);
+    data[6] = (uint8_t)(((uint16_t)msg->max >> 8) & 0xFFu);
+}
+
+static inline void can_temp_stats_window_unpack(can_temp_stats_window_t *msg, const uint8_t *data)
+{
+    msg->window = (uint8_t)(data[0] & 0x7Fu);
+    msg->valid = (uint8_t)((data[0] >> 7) & 0x1u);
+    msg->window_s = (uint16_t)((uint16_t)data[1] | ((uint16_t)data[2] << 8));
+    msg->min = (int16_t)((uint16_t)data[3] | ((uint16_t)data[4] << 8));
+    msg->max = (int16_t)((uint16_t)data[5] | ((uint16_t)data[6] << 8));
+}
+
+static inline int16_t can_temp_stats_window_min_encode(float value)
+{
+    float raw = (value - CAN_SIG_TEMP_STATS_WINDOW_MIN_OFFSET) * 100.0f;
+    raw = raw < (float)CAN_SIG_TEMP_STATS_WINDOW_MIN_MIN_RAW ? (float)CAN_SIG_TEMP_STATS_WINDOW_MIN_MIN_RAW : raw;
+    raw = raw > (float)CAN_SIG_TEMP_STATS_WINDOW_MIN_MAX_RAW ? (float)CAN_SIG_TEMP_STATS_WINDOW_MIN_MAX_RAW : raw;
+    return (int16_t)(raw + (raw >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline float can_temp_stats_window_min_decode(int16_t raw)
+{
+    return (float)raw * CAN_SIG_TEMP_STATS_WINDOW_MIN_SCALE + CAN_SIG_TEMP_STATS_WINDOW_MIN_OFFSET;
+}
+
+static inline int16_t can_temp_stats_window_max_encode(float value)
+{
+    float raw = (value - CAN_SIG_TEMP_STATS_WINDOW_MAX_OFFSET) * 100.0f;
+    raw = raw < (float)CAN_SIG_TEMP_STATS_WINDOW_MAX_MIN_RAW ? (float)CAN_SIG_TEMP_STATS_WINDOW_MAX_MIN_RAW : raw;
+    raw = raw > (float)CAN_SIG_TEMP_STATS_WINDOW_MAX_MAX_RAW ? (float)CAN_SIG_TEMP_STATS_WINDOW_MAX_MAX_RAW : raw;
+    return (int16_t)(raw + (raw >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline float can_temp_stats_window_max_decode(int16_t raw)
+{
+    return (float)raw * CAN_SIG_TEMP_STATS_WINDOW_MAX_SCALE + CAN_SIG_TEMP_STATS_WINDOW_MAX_OFFSET;
+}
+
+/* ----------------------------------------------------------------------
+ * HEARTBEAT: ID 0x715, DLC 8
+ * TempTransmitter health
+ */
+#define CAN_MSG_HEARTBEAT_ID                             0x715u
+#define CAN_MSG_HEARTBEAT_EXTENDED                       0
+#define CAN_MSG_HEARTBEAT_DLC                            8
+#define CAN_MSG_HEARTBEAT_PERIOD_MS                      1000
+// Per-node copies of this message: ID = NODE_BASE_ID + node, node < NODE_COUNT
+#define CAN_MSG_HEARTBEAT_NODE_BASE_ID                   0x600u
+#define CAN_MSG_HEARTBEAT_NODE_COUNT                     256
+#define CAN_MSG_HEARTBEAT_NODE_ID(node)                  (CAN_MSG_HEARTBEAT_NODE_BASE_ID + (uint32_t)(node))
+
+// uptime: start 0, 32 bits, unsigned, LE [s]
+#define CAN_SIG_HEARTBEAT_UPTIME_MIN_RAW                 0
+#define CAN_SIG_HEARTBEAT_UPTIME_MAX_RAW                 4294967295u
+// deadline_misses: start 32, 16 bits, unsigned, LE
+#define CAN_SIG_HEARTBEAT_DEADLINE_MISSES_MIN_RAW        0
+#define CAN_SIG_HEARTBEAT_DEADLINE_MISSES_MAX_RAW        65535
+// log_dropped: start 48, 16 bits, unsigned, LE
+#define CAN_SIG_HEARTBEAT_LOG_DROPPED_MIN_RAW            0
+#define CAN_SIG_HEARTBEAT_LOG_DROPPED_MAX_RAW            65535
+
+typedef struct {
+    uint32_t uptime;
+    uint16_t deadline_misses;
+    uint16_t log_dropped;
+} can_heartbeat_t;
+
+static inline void can_heartbeat_pack(uint8_t *data, const can_heartbeat_t *msg)
+{
+    data[0] = (uint8_t)((uint32_t)msg->uptime & 0xFFu);
+    data[1] = (uint8_t)(((uint32_t)msg->uptime >> 8) & 0xFFu);
+    data[2] = (uint8_t)(((uint32_t)msg->uptime >> 16) & 0xFFu);
+    data[3] = (uint8_t)(((uint32_t)msg->uptime >> 24) & 0xFFu);
+    data[4] = (uint8_t)((uint16_t)msg->deadline_misses & 0xFFu);
+    data[5] = (uint8_t)(((uint16_t)msg->deadline_misses >> 8) & 0xFFu);
+    data[6] = (uint8_t)((uint16_t)msg->log_dropped & 0xFFu);
+    data[7] = (uint8_t)(((uint16_t)msg->log_dropped >> 8) & 0xFFu);
+}
+
+static inline void can_heartbeat_unpack(can_heartbeat_t *msg, const uint8_t *data)
+{
+    msg->uptime = (uint32_t)((uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+    msg->deadline_misses = (uint16_t)((uint16_t)data[4] | ((uint16_t)data[5] << 8));
+    msg->log_dropped = (uint16_t)((uint16_t)data[6] | ((uint16_t)data[7] << 8));
+}
+
+#endif // CAN_SIGNALS_H
@@ -5,6 +5,12 @@
 #include "esp_random.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "driver/twai.h"
+#include "can_config.h"
+#include "can_driver_utils.h"
+#include "can_isotp.h"
+#include "can_ring_utils.h"
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
@@ -28,6 +34,38 @@ static struct {
     struct arg_end *end;
 } stress_test_args;
 
+static struct {
+    struct arg_int *samples;
+    struct arg_end *end;
+} temp_benchmark_args;
+
+static struct {
+    struct arg_int *size;
+    struct arg_int *count;
+    struct arg_int *bitrate;
+    struct arg_int *block_size;
+    struct arg_int *st_min;
+    struct arg_end *end;
+} isotp_benchmark_args;
+
+static struct {
+    struct arg_int *frames;
+    struct arg_int *readers;
+    struct arg_end *end;
+} ring_benchmark_args;
+
+static struct {
+    struct arg_int *frames;
+    struct arg_int *bitrate;
+    struct arg_int *dlc;
+    struct arg_int *id;
+    struct arg_int *id_span;
+    struct arg_str *pattern;
+    struct arg_lit *extended;
+    struct arg_int *window;
+    struct arg_end *end;
+} can_benchmark_args;
+
 void register_performance_commands(void)
 {
     // Initialize argument tables
@@ -41,6 +79,30 @@ void register_performance_commands(void)
     stress_test_args.duration = arg_int0("d", "duration", "<seconds>", "Test duration in seconds (default: 10)");
     stress_test_args.end = arg_end(2);
 
+    temp_benchmark_args.samples = arg_int0("n", "samples", "<num>", "Number of samples (default: 10000)");
+    temp_benchmark_args.end = arg_end(2);
+
+    isotp_benchmark_args.size = arg_int0("s", "size", "<bytes>", "Payload size, 1-4095 (default: 4095)");
+    isotp_benchmark_args.count = arg_int0("n", "count", "<num>", "Messages per bitrate (default: 5)");
+    isotp_benchmark_args.bitrate = arg_int0("b", "bitrate", "<kbps>", "125, 250, 500 or 1000 (default: all)");
+    isotp_benchmark_args.block_size = arg_int0("B", "block-size", "<num>", "Receiver block size, 0 = unlimited (default: 0)");
+    isotp_benchmark_args.st_min = arg_int0("m", "st-min", "<byte>", "Receiver STmin, ISO-TP encoding (default: 0)");
+    isotp_benchmark_args.end = arg_end(6);
+
+    ring_benchmark_args.frames = arg_int0("n", "frames", "<num>", "Frames to pass through (default: 100000)");
+    ring_benchmark_args.readers = arg_int0("r", "readers", "<num>", "Consumers, 1-4 (default: 3)");
+    ring_benchmark_args.end = arg_end(3);
+
+    can_benchmark_args.frames = arg_int0("n", "frames", "<num>", "Frames to send (default: 10000)");
+    can_benchmark_args.bitrate = arg_int0("b", "bitrate", "<kbps>", "Preset bitrate (default: active setting)");
+    can_benchmark_args.dlc = arg_int0("l", "dlc", "<0-8>", "Data length code (default: 8)");
+    can_benchmark_args.id = arg_int0("i", "id", "<id>", "First identifier (default: 0x7A0)");
+    can_benchmark_args.id_span = arg_int0("r", "id-span", "<num>", "Identifiers used by seq/random (default: 16)");
+    can_benchmark_args.pattern = arg_str0("p", "pattern", "<fixed|seq|random>", "Identifier pattern (default: fixed)");
+    can_benchmark_args.extended = arg_lit0("e", "extended", "Use 29-bit identifiers");
+    can_benchmark_args.window = arg_int0("w", "window", "<num>", "Frames in flight, 1 = unloaded latency (default: 32)");
+    can_benchmark_args.end = arg_end(9);
+
     // Define performance commands
     const cli_command_t perf_commands[] = {
         {
@@ -70,6 +132,34 @@ void register_performance_commands(void)
             .hint = NULL,
             .func = cmd_profile_tasks,
             .argtable = NULL
+        },
+        {
+            .command = "bench-temp",
+            .help = "Compare float vs fixed-point temperature sample pipeline",
+            .hint = NULL,
+            .func = cmd_benchmark_temp,
+            .argtable = &temp_benchmark_args
+        },
+        {
+            .command = "bench-isotp",
+            .help = "Measure ISO-TP payload throughput on TWAI self-reception",
+            .hint = NULL,
+            .func = cmd_benchmark_isotp,
+            .argtable = &isotp_benchmark_args
+        },
+        {
+            .command = "bench-ring",
+            .help = "Compare frame fan-out through FreeRTOS queues and lock-free rings",
+            .hint = NULL,
+            .func = cmd_benchmark_ring,
+            .argtable = &ring_benchmark_args
+        },
+        {
+            .command = "bench-can",
+            .help = "Measure TWAI throughput and loopback latency on self-reception",
+            .hint = NULL,
+            .func = cmd_benchmark_can,
+            .argtable = &can_benchmark_args
         }
     };
 
@@ -351,3 +441,754 @@ int cmd_profile_tasks(int argc, char **argv)
     cli_printf_success("Task profiling completed\n");
     return 0;
 }
+
+// Mirrors the ADC fallback conversion used by lm35_reader_task
+static inline int bench_raw_to_mv(int raw)
+{
+    return (raw * 3100) / 4095;
+}
+
+static int64_t bench_temp_float_path(QueueHandle_t queue, int samples, volatile uint8_t *sink)
+{
+    twai_message_t message = {0};
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < samples; i++) {
+        int voltage_mv = bench_raw_to_mv(i & 0xFFF);
+        float temperature_c = (float)voltage_mv / 10.0;
+        xQueueSend(queue, &temperature_c, 0);
+
+        float received;
+        xQueueReceive(queue, &received, 0);
+        memcpy(message.data, &received, sizeof(float));
+        *sink ^= message.data[0];
+    }
+    return esp_timer_get_time() - start;
+}
+
+static int64_t bench_temp_fixed_path(QueueHandle_t queue, int samples, volatile uint8_t *sink)
+{
+    twai_message_t message = {0};
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < samples; i++) {
+        int voltage_mv = bench_raw_to_mv(i & 0xFFF);
+        int32_t centi = ((int32_t)voltage_mv * 10 * 32768 + (1 << 14)) >> 15;
+        int16_t temperature = (int16_t)centi;
+        xQueueSend(queue, &temperature, 0);
+
+        int16_t received;
+        xQueueReceive(queue, &received, 0);
+        message.data[0] = (uint16_t)received & 0xFF;
+        message.data[1] = ((uint16_t)received >> 8) & 0xFF;
+        *sink ^= message.data[0];
+    }
+    return esp_timer_get_time() - start;
+}
+
+int cmd_benchmark_temp(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &temp_benchmark_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, temp_benchmark_args.end, argv[0]);
+        return 1;
+    }
+
+    int samples = temp_benchmark_args.samples->count > 0 ?
+                  temp_benchmark_args.samples->ival[0] : 10000;
+    if (samples <= 0) {
+        cli_printf_error("Sample count must be positive\n");
+        return 1;
+    }
+
+    QueueHandle_t float_queue = xQueueCreate(1, sizeof(float));
+    QueueHandle_t fixed_queue = xQueueCreate(1, sizeof(int16_t));
+    if (!float_queue || !fixed_queue) {
+        cli_printf_error("Failed to create benchmark queues\n");
+        if (float_queue) vQueueDelete(float_queue);
+        if (fixed_queue) vQueueDelete(fixed_queue);
+        return 1;
+    }
+
+    cli_printf("Running temperature pipeline benchmark with %d samples...\n", samples);
+
+    volatile uint8_t sink = 0;
+    int64_t float_us = bench_temp_float_path(float_queue, samples, &sink);
+    int64_t fixed_us = bench_temp_fixed_path(fixed_queue, samples, &sink);
+
+    vQueueDelete(float_queue);
+    vQueueDelete(fixed_queue);
+
+    cli_printf("Temperature Pipeline Results (ADC mV -> queue -> CAN payload):\n");
+    cli_printf("  Float path: %lld µs (%.3f µs/sample, %u-byte queue items)\n",
+               float_us, (double)float_us / samples, (unsigned)sizeof(float));
+    cli_printf("  Fixed path: %lld µs (%.3f µs/sample, %u-byte queue items)\n",
+               fixed_us, (double)fixed_us / samples, (unsigned)sizeof(int16_t));
+    if (fixed_us > 0) {
+        cli_printf("  Speedup: %.2fx\n", (double)float_us / fixed_us);
+    }
+    (void)sink;
+
+    cli_printf_success("Temperature pipeline benchmark completed\n");
+    return 0;
+}
+
+// ISO-TP throughput benchmark
+// Sender and receiver sessions live on this node with swapped IDs; the
+// controller runs in no-ACK mode with self-reception so every frame comes
+// back through the RX path (needs a transceiver or TX wired to RX).
+#define BENCH_ISOTP_REQ_ID      0x7E0
+#define BENCH_ISOTP_RESP_ID     0x7E8
+#define BENCH_ISOTP_QUEUE_LEN   32
+#define BENCH_ISOTP_TIMEOUT_MS  5000
+
+// Classic CAN, 11-bit ID, 8 data bytes, no stuff bits, including 3-bit IFS
+#define BENCH_CAN_FRAME_BITS    111
+
+typedef struct {
+    uint32_t kbps;
+    twai_timing_config_t timing;
+} bench_bitrate_t;
+
+static const bench_bitrate_t bench_bitrates[] = {
+    { 125,  TWAI_TIMING_CONFIG_125KBITS() },
+    { 250,  TWAI_TIMING_CONFIG_250KBITS() },
+    { 500,  TWAI_TIMING_CONFIG_500KBITS() },
+    { 1000, TWAI_TIMING_CONFIG_1MBITS() },
+};
+
+typedef struct {
+    const uint8_t *expected;
+    size_t length;
+    volatile bool received;
+    volatile bool sent;
+    volatile esp_err_t send_status;
+    uint32_t mismatches;
+} bench_isotp_ctx_t;
+
+static esp_err_t bench_isotp_can_tx(const twai_message_t *message, void *ctx)
+{
+    twai_message_t frame = *message;
+    frame.self = 1;
+    return twai_transmit(&frame, 0);
+}
+
+static void bench_isotp_on_receive(int handle, const uint8_t *data, size_t length, void *ctx)
+{
+    bench_isotp_ctx_t *bench = (bench_isotp_ctx_t *)ctx;
+    if (length != bench->length || memcmp(data, bench->expected, length) != 0) {
+        bench->mismatches++;
+    }
+    bench->received = true;
+}
+
+static void bench_isotp_on_send_done(int handle, esp_err_t status, void *ctx)
+{
+    bench_isotp_ctx_t *bench = (bench_isotp_ctx_t *)ctx;
+    bench->send_status = status;
+    bench->sent = true;
+}
+
+// Returns elapsed microseconds for all messages, or -1 on failure
+static int64_t bench_isotp_run(int sender, bench_isotp_ctx_t *bench, const uint8_t *payload,
+                               size_t size, int count)
+{
+    int64_t start = esp_timer_get_time();
+
+    for (int m = 0; m < count; m++) {
+        bench->received = false;
+        bench->sent = false;
+        if (isotp_send(sender, payload, size) != ESP_OK) {
+            return -1;
+        }
+
+        int64_t deadline = esp_timer_get_time() + (int64_t)BENCH_ISOTP_TIMEOUT_MS * 1000;
+        while (!(bench->received && bench->sent)) {
+            twai_message_t frame;
+            if (twai_receive(&frame, 1) == ESP_OK) {
+                isotp_on_frame(&frame);
+            }
+            isotp_poll();
+
+            if ((bench->sent && bench->send_status != ESP_OK) || esp_timer_get_time() > deadline) {
+                return -1;
+            }
+        }
+    }
+
+    return esp_timer_get_time() - start;
+}
+
+int cmd_benchmark_isotp(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &isotp_benchmark_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, isotp_benchmark_args.end, argv[0]);
+        return 1;
+    }
+
+    int size = isotp_benchmark_args.size->count > 0 ? isotp_benchmark_args.size->ival[0] : ISOTP_MAX_PAYLOAD;
+    int count = isotp_benchmark_args.count->count > 0 ? isotp_benchmark_args.count->ival[0] : 5;
+    int only_kbps = isotp_benchmark_args.bitrate->count > 0 ? isotp_benchmark_args.bitrate->ival[0] : 0;
+    int block_size = isotp_benchmark_args.block_size->count > 0 ? isotp_benchmark_args.block_size->ival[0] : 0;
+    int st_min = isotp_benchmark_args.st_min->count > 0 ? isotp_benchmark_args.st_min->ival[0] : 0;
+
+    if (size <= 0 || size > ISOTP_MAX_PAYLOAD || count <= 0 ||
+        block_size < 0 || block_size > 255 || st_min < 0 || st_min > 255) {
+        cli_printf_error("Invalid arguments\n");
+        return 1;
+    }
+
+    uint8_t *payload = malloc(size);
+    uint8_t *rx_buffer = malloc(size);
+    if (!payload || !rx_buffer) {
+        cli_printf_error("Failed to allocate %d-byte buffers\n", size);
+        free(payload);
+        free(rx_buffer);
+        return 1;
+    }
+    for (int i = 0; i < size; i++) {
+        payload[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    bench_isotp_ctx_t bench = { .expected = payload, .length = size };
+    isotp_config_t sender_cfg = {
+        .tx_id = BENCH_ISOTP_REQ_ID,
+        .rx_id = BENCH_ISOTP_RESP_ID,
+        .on_send_done = bench_isotp_on_send_done,
+        .ctx = &bench,
+        .padding = true,
+    };
+    isotp_config_t receiver_cfg = {
+        .tx_id = BENCH_ISOTP_RESP_ID,
+        .rx_id = BENCH_ISOTP_REQ_ID,
+        .block_size = (uint8_t)block_size,
+        .st_min = (uint8_t)st_min,
+        .rx_buffer = rx_buffer,
+        .rx_buffer_size = size,
+        .on_receive = bench_isotp_on_receive,
+        .ctx = &bench,
+        .padding = true,
+    };
+
+    int sender = -1, receiver = -1;
+    if (isotp_open(&sender_cfg, &sender) != ESP_OK || isotp_open(&receiver_cfg, &receiver) != ESP_OK) {
+        cli_printf_error("Failed to open ISO-TP sessions\n");
+        isotp_close(sender);
+        free(payload);
+        free(rx_buffer);
+        return 1;
+    }
+    isotp_set_can_tx(bench_isotp_can_tx, NULL);
+
+    // Take the controller from the shared driver for the duration of the run
+    bool restore_driver = can_driver_is_running();
+    if (restore_driver) {
+        can_driver_deinit();
+    }
+
+    cli_printf("Running ISO-TP benchmark: %d x %d bytes, BS=%d, STmin=0x%02X...\n",
+               count, size, block_size, st_min);
+    cli_printf("ISO-TP Throughput Results:\n");
+    cli_printf("  Bitrate   Time(ms)   Payload(B/s)   Theoretical(B/s)   Efficiency\n");
+
+    int failures = 0;
+    int runs = 0;
+    for (size_t b = 0; b < sizeof(bench_bitrates) / sizeof(bench_bitrates[0]); b++) {
+        const bench_bitrate_t *rate = &bench_bitrates[b];
+        if (only_kbps != 0 && (uint32_t)only_kbps != rate->kbps) {
+            continue;
+        }
+        runs++;
+
+        twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(CAN_TX_GPIO, CAN_RX_GPIO, TWAI_MODE_NO_ACK);
+        g_config.tx_queue_len = BENCH_ISOTP_QUEUE_LEN;
+        g_config.rx_queue_len = BENCH_ISOTP_QUEUE_LEN;
+        if (can_driver_install(&g_config, &rate->timing, false) != ESP_OK) {
+            cli_printf_error("  %4lu kbps: TWAI driver install failed\n", rate->kbps);
+            failures++;
+            continue;
+        }
+
+        int64_t elapsed_us = bench_isotp_run(sender, &bench, payload, size, count);
+        can_driver_deinit();
+
+        if (elapsed_us <= 0) {
+            cli_printf_error("  %4lu kbps: transfer failed or timed out\n", rate->kbps);
+            failures++;
+            // Drop any half-finished transfer before the next bitrate
+            isotp_close(sender);
+            isotp_close(receiver);
+            isotp_open(&sender_cfg, &sender);
+            isotp_open(&receiver_cfg, &receiver);
+            continue;
+        }
+
+        // Upper bound: back-to-back consecutive frames carrying 7 bytes each
+        double theoretical = (double)rate->kbps * 1000.0 / BENCH_CAN_FRAME_BITS * 7.0;
+        double achieved = (double)size * count * 1000000.0 / elapsed_us;
+        cli_printf("  %4lu kbps %10.1f %14.0f %18.0f %11.1f%%\n",
+                   rate->kbps, elapsed_us / 1000.0, achieved, theoretical,
+                   achieved * 100.0 / theoretical);
+    }
+
+    isotp_stats_t tx_stats, rx_stats;
+    isotp_get_stats(sender, &tx_stats);
+    isotp_get_stats(receiver, &rx_stats);
+    cli_printf("  Frames sent: %lu (sender) + %lu (flow control)\n",
+               tx_stats.frames_sent, rx_stats.frames_sent);
+    cli_printf("  Timeouts: %lu, sequence errors: %lu, data mismatches: %lu\n",
+               tx_stats.timeouts + rx_stats.timeouts, rx_stats.sequence_errors, bench.mismatches);
+
+    isotp_set_can_tx(NULL, NULL);
+    isotp_close(sender);
+    isotp_close(receiver);
+    free(payload);
+    free(rx_buffer);
+    if (restore_driver && can_driver_init() != ESP_OK) {
+        cli_printf_warning("Failed to restore the CAN driver\n");
+    }
+
+    if (runs == 0) {
+        cli_printf_error("Unsupported bitrate %d kbps\n", only_kbps);
+        return 1;
+    }
+    if (failures > 0 || bench.mismatches > 0) {
+        cli_printf_error("ISO-TP benchmark completed with errors\n");
+        return 1;
+    }
+    cli_printf_success("ISO-TP benchmark completed\n");
+    return 0;
+}
+
+/*
+ * Frame fan-out benchmark. Frames go through in bursts of RING_BENCH_BURST:
+ * the producer writes a burst, then every consumer drains it and touches
+ * each frame. Running both sides in one task keeps scheduler noise out of
+ * the numbers and measures only the cost of the hand-off itself.
+ */
+#define RING_BENCH_BURST    32
+
+static int64_t bench_ring_queues(QueueHandle_t *queues, int readers, int frames, volatile uint32_t *sink)
+{
+    twai_message_t message = { .identifier = 0x123, .data_length_code = 8 };
+    twai_message_t received;
+    int64_t start = esp_timer_get_time();
+    for (int sent = 0; sent < frames; sent += RING_BENCH_BURST) {
+        for (int i = 0; i < RING_BENCH_BURST; i++) {
+            message.data[0] = (uint8_t)i;
+            // One copy in and one copy out per consumer
+            for (int r = 0; r < readers; r++) {
+                xQueueSend(queues[r], &message, 0);
+            }
+        }
+        for (int r = 0; r < readers; r++) {
+            while (xQueueReceive(queues[r], &received, 0) == pdTRUE) {
+                *sink += received.identifier + received.data[0];
+            }
+        }
+    }
+    return esp_timer_get_time() - start;
+}
+
+static int64_t bench_ring_spsc(can_spsc_ring_t *ring, int frames, volatile uint32_t *sink)
+{
+    twai_message_t message = { .identifier = 0x123, .data_length_code = 8 };
+    int64_t start = esp_timer_get_time();
+    for (int sent = 0; sent < frames; sent += RING_BENCH_BURST) {
+        for (int i = 0; i < RING_BENCH_BURST; i++) {
+            message.data[0] = (uint8_t)i;
+            can_spsc_push(ring, &message);
+        }
+        const twai_message_t *frame;
+        while ((frame = can_spsc_peek(ring)) != NULL) {
+            *sink += frame->identifier + frame->data[0];
+            can_spsc_release(ring);
+        }
+    }
+    return esp_timer_get_time() - start;
+}
+
+static int64_t bench_ring_bcast(can_bcast_ring_t *ring, int readers, int frames, volatile uint32_t *sink)
+{
+    twai_message_t message = { .identifier = 0x123, .data_length_code = 8 };
+    int64_t start = esp_timer_get_time();
+    for (int sent = 0; sent < frames; sent += RING_BENCH_BURST) {
+        for (int i = 0; i < RING_BENCH_BURST; i++) {
+            message.data[0] = (uint8_t)i;
+            can_bcast_publish(ring, &message);
+        }
+        for (int r = 0; r < readers; r++) {
+            const twai_message_t *frame;
+            while ((frame = can_bcast_peek(ring, r)) != NULL) {
+                *sink += frame->identifier + frame->data[0];
+                can_bcast_release(ring, r);
+            }
+        }
+    }
+    return esp_timer_get_time() - start;
+}
+
+static void bench_ring_run(QueueHandle_t *queues, twai_message_t *spsc_storage, can_bcast_slot_t *bcast_storage,
+                           can_bcast_ring_t *bcast, int readers, int frames)
+{
+    can_spsc_ring_t spsc;
+    can_spsc_init(&spsc, spsc_storage, RING_BENCH_BURST);
+    can_bcast_init(bcast, bcast_storage, RING_BENCH_BURST);
+    for (int r = 0; r < readers; r++) {
+        can_bcast_add_reader(bcast, "bench", NULL);
+    }
+
+    cli_printf("Passing %d frames to %d consumer(s) in bursts of %d...\n", frames, readers, RING_BENCH_BURST);
+
+    volatile uint32_t sink = 0;
+    int64_t queue_single_us = bench_ring_queues(queues, 1, frames, &sink);
+    int64_t spsc_us = bench_ring_spsc(&spsc, frames, &sink);
+    int64_t queue_fanout_us = bench_ring_queues(queues, readers, frames, &sink);
+    int64_t bcast_us = bench_ring_bcast(bcast, readers, frames, &sink);
+
+    uint32_t lost = atomic_load(&bcast->dropped) + atomic_load(&spsc.overflows);
+
+    cli_printf("Frame Hand-off Results (%u-byte frames):\n", (unsigned)sizeof(twai_message_t));
+    cli_printf("  1 consumer:  queue  %8.3f µs/frame   SPSC ring      %8.3f µs/frame   (%.2fx)\n",
+               (double)queue_single_us / frames, (double)spsc_us / frames,
+               spsc_us > 0 ? (double)queue_single_us / spsc_us : 0.0);
+    cli_printf("  %d consumers: queues %8.3f µs/frame   broadcast ring %8.3f µs/frame   (%.2fx)\n",
+               readers, (double)queue_fanout_us / frames, (double)bcast_us / frames,
+               bcast_us > 0 ? (double)queue_fanout_us / bcast_us : 0.0);
+    cli_printf("  Copies per frame: queues %d, broadcast ring 1\n", 2 * readers);
+    if (lost > 0) {
+        cli_printf_error("  %lu frames lost in the rings\n", lost);
+    }
+    (void)sink;
+
+    cli_printf_success("Ring benchmark completed\n");
+}
+
+int cmd_benchmark_ring(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &ring_benchmark_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, ring_benchmark_args.end, argv[0]);
+        return 1;
+    }
+
+    int frames = ring_benchmark_args.frames->count > 0 ? ring_benchmark_args.frames->ival[0] : 100000;
+    int readers = ring_benchmark_args.readers->count > 0 ? ring_benchmark_args.readers->ival[0] : 3;
+    if (frames <= 0 || readers < 1 || readers > CAN_RING_MAX_READERS) {
+        cli_printf_error("Frames must be positive and readers 1-%d\n", CAN_RING_MAX_READERS);
+        return 1;
+    }
+    frames = (frames + RING_BENCH_BURST - 1) / RING_BENCH_BURST * RING_BENCH_BURST;
+
+    QueueHandle_t queues[CAN_RING_MAX_READERS] = { 0 };
+    twai_message_t *spsc_storage = malloc(RING_BENCH_BURST * sizeof(twai_message_t));
+    can_bcast_slot_t *bcast_storage = malloc(RING_BENCH_BURST * sizeof(can_bcast_slot_t));
+    can_bcast_ring_t *bcast = malloc(sizeof(can_bcast_ring_t));
+    bool ok = spsc_storage && bcast_storage && bcast;
+    for (int r = 0; r < readers && ok; r++) {
+        queues[r] = xQueueCreate(RING_BENCH_BURST, sizeof(twai_message_t));
+        ok = queues[r] != NULL;
+    }
+
+    if (ok) {
+        bench_ring_run(queues, spsc_storage, bcast_storage, bcast, readers, frames);
+    } else {
+        cli_printf_error("Failed to allocate benchmark queues and rings\n");
+    }
+
+    for (int r = 0; r < readers; r++) {
+        if (queues[r]) vQueueDelete(queues[r]);
+    }
+    free(spsc_storage);
+    free(bcast_storage);
+    free(bcast);
+    return ok ? 0 : 1;
+}
+
+/*
+ * TWAI throughput and latency benchmark. The controller runs in NO_ACK
+ * mode with self-reception, so every frame comes back through the RX
+ * path (needs a transceiver or TX wired to RX). Up to --window frames
+ * are kept in flight; latency is from twai_transmit() returning to
+ * twai_receive() returning the same frame, so with a full window it
+ * includes the time spent queued behind earlier frames.
+ *
+ * Frame contents are a function of the sequence number, which lets the
+ * exact wire length, stuff bits included, be computed after the run for
+ * the line-rate figure without adding work to the timed loop.
+ */
+#define BENCH_CAN_QUEUE_LEN     64
+#define BENCH_CAN_LAT_SAMPLES   8192
+#define BENCH_CAN_RX_WAIT_MS    100
+#define BENCH_CAN_MAX_LOST_RUN  8       // consecutive losses that abort the run
+
+typedef enum {
+    BENCH_CAN_ID_FIXED,
+    BENCH_CAN_ID_SEQ,
+    BENCH_CAN_ID_RANDOM,
+} bench_can_pattern_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t id_span;
+    bench_can_pattern_t pattern;
+    bool extended;
+    uint8_t dlc;
+} bench_can_frame_cfg_t;
+
+static void bench_can_make_frame(const bench_can_frame_cfg_t *cfg, uint32_t seq, twai_message_t *message)
+{
+    memset(message, 0, sizeof(*message));
+    uint32_t offset = 0;
+    if (cfg->pattern == BENCH_CAN_ID_SEQ) {
+        offset = seq % cfg->id_span;
+    } else if (cfg->pattern == BENCH_CAN_ID_RANDOM) {
+        offset = (seq * 2654435761u >> 16) % cfg->id_span;
+    }
+    message->identifier = (cfg->id + offset) & (cfg->extended ? TWAI_EXTD_ID_MASK : TWAI_STD_ID_MASK);
+    message->extd = cfg->extended;
+    message->self = 1;
+    message->data_length_code = cfg->dlc;
+    for (int i = 0; i < cfg->dlc; i++) {
+        // Sequence number first, then a pattern that needs no stuff bits
+        message->data[i] = i < 4 ? (uint8_t)(seq >> (8 * i)) : 0x55;
+    }
+}
+
+static inline void bench_can_put_bits(uint8_t *bits, int *count, uint32_t value, int width)
+{
+    for (int i = width - 1; i >= 0; i--) {
+        bits[(*count)++] = (value >> i) & 1;
+    }
+}
+
+// Bits on the wire for one data frame: stuffed SOF..CRC, then CRC
+// delimiter, ACK slot and delimiter, EOF and the 3-bit interframe space
+static uint32_t bench_can_wire_bits(const twai_message_t *message)
+{
+    uint8_t bits[160];
+    int count = 0;
+    bench_can_put_bits(bits, &count, 0, 1);     // SOF
+    if (message->extd) {
+        bench_can_put_bits(bits, &count, message->identifier >> 18, 11);
+        bench_can_put_bits(bits, &count, 3, 2);  // SRR, IDE
+        bench_can_put_bits(bits, &count, message->identifier & 0x3FFFF, 18);
+        bench_can_put_bits(bits, &count, 0, 3);  // RTR, r1, r0
+    } else {
+        bench_can_put_bits(bits, &count, message->identifier, 11);
+        bench_can_put_bits(bits, &count, 0, 3);  // RTR, IDE, r0
+    }
+    bench_can_put_bits(bits, &count, message->data_length_code, 4);
+    for (int i = 0; i < message->data_length_code; i++) {
+        bench_can_put_bits(bits, &count, message->data[i], 8);
+    }
+
+    uint16_t crc = 0;
+    for (int i = 0; i < count; i++) {
+        bool feedback = ((crc >> 14) & 1) ^ bits[i];
+        crc = (crc << 1) & 0x7FFF;
+        if (feedback) {
+            crc ^= 0x4599;
+        }
+    }
+    bench_can_put_bits(bits, &count, crc, 15);
+
+    uint32_t stuff_bits = 0;
+    int run = 1;
+    uint8_t last = bits[0];
+    for (int i = 1; i < count; i++) {
+        if (bits[i] == last) {
+            if (++run == 5) {
+                // The stuff bit is the complement and starts the next run
+                stuff_bits++;
+                last ^= 1;
+                run = 1;
+            }
+        } else {
+            last = bits[i];
+            run = 1;
+        }
+    }
+    return (uint32_t)count + stuff_bits + 13;
+}
+
+static int bench_can_compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+int cmd_benchmark_can(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &can_benchmark_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, can_benchmark_args.end, argv[0]);
+        return 1;
+    }
+
+    int frames = can_benchmark_args.frames->count > 0 ? can_benchmark_args.frames->ival[0] : 10000;
+    int dlc = can_benchmark_args.dlc->count > 0 ? can_benchmark_args.dlc->ival[0] : 8;
+    int window = can_benchmark_args.window->count > 0 ? can_benchmark_args.window->ival[0] : 32;
+    bench_can_frame_cfg_t cfg = {
+        .id = can_benchmark_args.id->count > 0 ? (uint32_t)can_benchmark_args.id->ival[0] : 0x7A0,
+        .id_span = can_benchmark_args.id_span->count > 0 ? (uint32_t)can_benchmark_args.id_span->ival[0] : 16,
+        .pattern = BENCH_CAN_ID_FIXED,
+        .extended = can_benchmark_args.extended->count > 0,
+        .dlc = (uint8_t)dlc,
+    };
+    if (can_benchmark_args.pattern->count > 0) {
+        const char *pattern = can_benchmark_args.pattern->sval[0];
+        if (strcmp(pattern, "seq") == 0) {
+            cfg.pattern = BENCH_CAN_ID_SEQ;
+        } else if (strcmp(pattern, "random") == 0) {
+            cfg.pattern = BENCH_CAN_ID_RANDOM;
+        } else if (strcmp(pattern, "fixed") != 0) {
+            cli_printf_error("Unknown pattern: %s (use fixed, seq or random)\n", pattern);
+            return 1;
+        }
+    }
+    if (frames <= 0 || dlc < 0 || dlc > TWAI_FRAME_MAX_DLC || window < 1 || window > BENCH_CAN_QUEUE_LEN ||
+        cfg.id_span == 0 || (int)cfg.id_span < 0) {
+        cli_printf_error("Invalid arguments (window 1-%d)\n", BENCH_CAN_QUEUE_LEN);
+        return 1;
+    }
+
+    can_settings_t settings;
+    can_driver_get_settings(&settings);
+    if (can_benchmark_args.bitrate->count > 0 &&
+        can_settings_set_bitrate(&settings, (uint32_t)can_benchmark_args.bitrate->ival[0] * 1000) != ESP_OK) {
+        cli_printf_error("No preset for %d kbps (see can-config -l)\n", can_benchmark_args.bitrate->ival[0]);
+        return 1;
+    }
+    settings.mode = TWAI_MODE_NO_ACK;
+    settings.tx_queue_len = BENCH_CAN_QUEUE_LEN;
+    settings.rx_queue_len = BENCH_CAN_QUEUE_LEN;
+    uint32_t bitrate = can_settings_bitrate(&settings);
+
+    // Every stride-th latency is kept for the percentiles; max is exact
+    uint32_t stride = (frames + BENCH_CAN_LAT_SAMPLES - 1) / BENCH_CAN_LAT_SAMPLES;
+    uint32_t *latencies = malloc(BENCH_CAN_LAT_SAMPLES * sizeof(uint32_t));
+    int64_t *sent_at = malloc(BENCH_CAN_QUEUE_LEN * sizeof(int64_t));
+    if (!latencies || !sent_at) {
+        cli_printf_error("Failed to allocate benchmark buffers\n");
+        free(latencies);
+        free(sent_at);
+        return 1;
+    }
+
+    // Take the controller from the shared driver for the duration of the run
+    bool restore_driver = can_driver_is_running();
+    if (restore_driver) {
+        can_driver_deinit();
+    }
+    twai_general_config_t g_config;
+    twai_timing_config_t t_config;
+    can_settings_to_config(&settings, &g_config, &t_config);
+    if (can_driver_install(&g_config, &t_config, false) != ESP_OK) {
+        cli_printf_error("TWAI driver install failed\n");
+        free(latencies);
+        free(sent_at);
+        if (restore_driver) {
+            can_driver_init();
+        }
+        return 1;
+    }
+
+    cli_printf("Running CAN benchmark: %d frames, DLC %d, %s IDs from 0x%lX, %lu kbps, window %d...\n",
+               frames, dlc, cfg.pattern == BENCH_CAN_ID_FIXED ? "fixed" :
+               cfg.pattern == BENCH_CAN_ID_SEQ ? "sequential" : "random",
+               cfg.id, bitrate / 1000, window);
+
+    uint32_t sent = 0, received = 0, tx_failures = 0, out_of_order = 0;
+    uint32_t latency_count = 0, latency_max = 0, lost_run = 0;
+    twai_message_t message;
+    int64_t start = esp_timer_get_time();
+    int64_t last_rx = start;
+    int64_t last_progress = start;
+
+    while (received + tx_failures < (uint32_t)frames && lost_run < BENCH_CAN_MAX_LOST_RUN) {
+        // Fill the window; TX and self-RX keep sequence order, so sent_at is a FIFO
+        while (sent < (uint32_t)frames && sent - received - tx_failures < (uint32_t)window) {
+            bench_can_make_frame(&cfg, sent, &message);
+            if (twai_transmit(&message, 0) != ESP_OK) {
+                break;
+            }
+            sent_at[sent % BENCH_CAN_QUEUE_LEN] = esp_timer_get_time();
+            sent++;
+        }
+
+        uint32_t in_flight = sent - received - tx_failures;
+        TickType_t wait = in_flight >= (uint32_t)window || sent == (uint32_t)frames ? pdMS_TO_TICKS(BENCH_CAN_RX_WAIT_MS) : 0;
+        twai_message_t rx;
+        if (twai_receive(&rx, wait) == ESP_OK) {
+            int64_t now = esp_timer_get_time();
+            uint32_t seq = received + tx_failures;
+            uint32_t latency = (uint32_t)(now - sent_at[seq % BENCH_CAN_QUEUE_LEN]);
+            if (dlc >= 2 && (uint16_t)(rx.data[0] | (rx.data[1] << 8)) != (uint16_t)seq) {
+                out_of_order++;
+            }
+            if (latency > latency_max) {
+                latency_max = latency;
+            }
+            if (seq % stride == 0 && latency_count < BENCH_CAN_LAT_SAMPLES) {
+                latencies[latency_count++] = latency;
+            }
+            received++;
+            lost_run = 0;
+            last_rx = now;
+            last_progress = now;
+        } else if (in_flight > 0 && esp_timer_get_time() - last_progress > BENCH_CAN_RX_WAIT_MS * 1000) {
+            // The oldest frame in flight never came back
+            tx_failures++;
+            lost_run++;
+            last_progress = esp_timer_get_time();
+        }
+    }
+    int64_t elapsed_us = last_rx - start;
+
+    twai_status_info_t status;
+    twai_get_status_info(&status);
+    can_driver_deinit();
+    if (restore_driver && can_driver_init() != ESP_OK) {
+        cli_printf_warning("Failed to restore the CAN driver\n");
+    }
+
+    // Exact wire length of the frames that made it, outside the timed loop
+    uint64_t wire_bits = 0;
+    for (uint32_t seq = 0; seq < sent; seq++) {
+        bench_can_make_frame(&cfg, seq, &message);
+        wire_bits += bench_can_wire_bits(&message);
+    }
+    double avg_bits = sent > 0 ? (double)wire_bits / sent : 0.0;
+
+    cli_printf("CAN Benchmark Results:\n");
+    cli_printf("  Frames: %lu sent, %lu received, %lu lost, %lu out of order\n",
+               sent, received, tx_failures, out_of_order);
+    if (elapsed_us > 0 && received > 0) {
+        double frames_per_s = received * 1000000.0 / elapsed_us;
+        double line_frames_per_s = bitrate / avg_bits;
+        cli_printf("  Throughput: %.0f frames/s, %.0f payload B/s\n", frames_per_s, frames_per_s * dlc);
+        cli_printf("  Line rate: %.1f%% (%.0f frames/s at %.1f bits/frame incl. stuffing)\n",
+                   frames_per_s * 100.0 / line_frames_per_s, line_frames_per_s, avg_bits);
+    }
+    if (latency_count > 0) {
+        qsort(latencies, latency_count, sizeof(uint32_t), bench_can_compare_u32);
+        cli_printf("  Loopback latency: p50 %lu us, p99 %lu us, max %lu us (%lu samples)\n",
+                   latencies[latency_count * 50 / 100], latencies[latency_count * 99 / 100],
+                   latency_max, latency_count);
+    }
+    if (lost_run >= BENCH_CAN_MAX_LOST_RUN) {
+        cli_printf_warning("  Aborted after %d frames in a row did not come back; check the transceiver\n",
+                           BENCH_CAN_MAX_LOST_RUN);
+    }
+    cli_printf("  Controller: RX missed %lu, RX overrun %lu, bus errors %lu\n",
+               status.rx_missed_count, status.rx_overrun_count, status.bus_error_count);
+
+    free(latencies);
+    free(sent_at);
+    if (tx_failures > 0 || out_of_order > 0) {
+        cli_printf_error("CAN benchmark completed with errors\n");
+        return 1;
+    }
+    cli_printf_success("CAN benchmark completed\n");
+    return 0;
+}
@@ -20,6 +20,10 @@ int cmd_benchmark_cpu(int argc, char **argv);
 int cmd_benchmark_memory(int argc, char **argv);
 int cmd_stress_test(int argc, char **argv);
 int cmd_profile_tasks(int argc, char **argv);
+int cmd_benchmark_temp(int argc, char **argv);
+int cmd_benchmark_isotp(int argc, char **argv);
+int cmd_benchmark_ring(int argc, char **argv);
+int cmd_benchmark_can(int argc, char **argv);
 
 #ifdef __cplusplus
 }
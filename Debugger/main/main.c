@@ -3,6 +3,11 @@
 #include "nvs_flash.h"
 #include "utils/CLI/cli_interface.h"
 #include "utils/CLI/cli_commands.h"
+#include "utils/CAN/can_config.h"
+#include "utils/CAN/can_driver_utils.h"
+#include "utils/CAN/can_receive_utils.h"
+#include "utils/CAN/can_stats_utils.h"
+#include "utils/CAN/can_isotp.h"
 
 static const char *TAG = "MAIN";
 
@@ -10,13 +15,28 @@ void app_main(void)
 {
     ESP_LOGI(TAG, "Starting ESP32 Duke Project Debugger");
     
-    // Initialize NVS (required for CLI history storage)
+    // Initialize NVS (required for CLI history storage and CAN settings)
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
         ESP_ERROR_CHECK(nvs_flash_erase());
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
+
+    // Bring up CAN with statistics; the CLI still runs without a bus.
+    // Bus settings come from NVS (can-config -s) or can_config.h.
+    can_settings_t can_settings;
+    can_driver_get_settings(&can_settings);
+    can_stats_init(can_settings_bitrate(&can_settings));
+    if (can_driver_init() != ESP_OK) {
+        ESP_LOGW(TAG, "CAN driver unavailable, CAN commands will report it as stopped");
+    }
+    can_stats_start();
+    can_receive_values_init();
+    if (isotp_init() != ESP_OK) {
+        ESP_LOGW(TAG, "ISO-TP unavailable, no memory for its lock");
+    }
+    xTaskCreate(can_receive_task, "can_receive_task", 4096, NULL, 5, NULL);
     
     // Initialize CLI interface
     cli_config_t cli_config = cli_get_default_config();
@@ -0,0 +1,154 @@
+#include "can_autobaud_utils.h"
+#include "can_config.h"
+#include "can_driver_utils.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include <string.h>
+
+static const char *TAG_CAN_AUTOBAUD = "CAN_AUTOBAUD";
+
+#define AUTOBAUD_QUEUE_LEN      16
+#define AUTOBAUD_FRAME_WEIGHT   4       // one valid frame outweighs this many bus errors
+
+static const uint32_t default_order[] = CAN_AUTOBAUD_ORDER;
+
+void can_autobaud_default_config(can_autobaud_config_t *out_config)
+{
+    memset(out_config, 0, sizeof(*out_config));
+    size_t count = sizeof(default_order) / sizeof(default_order[0]);
+    if (count > CAN_AUTOBAUD_MAX_CANDIDATES) {
+        count = CAN_AUTOBAUD_MAX_CANDIDATES;
+    }
+    memcpy(out_config->bitrates, default_order, count * sizeof(default_order[0]));
+    out_config->bitrate_count = count;
+    out_config->dwell_ms = CAN_AUTOBAUD_DWELL_MS;
+    out_config->dwell_max_ms = CAN_AUTOBAUD_DWELL_MAX_MS;
+    out_config->timeout_ms = CAN_AUTOBAUD_TIMEOUT_MS;
+    out_config->lock_frames = CAN_AUTOBAUD_LOCK_FRAMES;
+}
+
+static int32_t can_autobaud_score(const can_autobaud_candidate_t *candidate)
+{
+    return (int32_t)(candidate->frames * AUTOBAUD_FRAME_WEIGHT) - (int32_t)candidate->bus_errors;
+}
+
+// Listen at one candidate for up to dwell_ms. Returns true on an early lock.
+static bool can_autobaud_listen(const can_settings_t *timing, can_autobaud_candidate_t *candidate,
+                                uint32_t dwell_ms, uint32_t lock_frames)
+{
+    can_settings_t settings = *timing;
+    settings.mode = TWAI_MODE_LISTEN_ONLY;
+    settings.rx_queue_len = AUTOBAUD_QUEUE_LEN;
+    settings.tx_queue_len = 0;
+
+    twai_general_config_t g_config;
+    twai_timing_config_t t_config;
+    can_settings_to_config(&settings, &g_config, &t_config);
+    if (can_driver_install(&g_config, &t_config, false) != ESP_OK) {
+        return false;
+    }
+
+    uint32_t frames = 0;
+    uint32_t bus_errors = 0;
+    int64_t start = esp_timer_get_time();
+    int64_t deadline = start + (int64_t)dwell_ms * 1000;
+    bool locked = false;
+
+    for (int64_t now = start; now < deadline; now = esp_timer_get_time()) {
+        TickType_t wait = pdMS_TO_TICKS((deadline - now + 999) / 1000);
+        twai_message_t message;
+        if (twai_receive(&message, wait > 0 ? wait : 1) == ESP_OK) {
+            frames++;
+        }
+
+        twai_status_info_t status;
+        if (twai_get_status_info(&status) == ESP_OK) {
+            bus_errors = status.bus_error_count;
+        }
+        if (bus_errors == 0 && candidate->bus_errors == 0 && candidate->frames + frames >= lock_frames) {
+            locked = true;
+            break;
+        }
+    }
+
+    candidate->frames += frames;
+    candidate->bus_errors += bus_errors;
+    candidate->listen_ms += (uint32_t)((esp_timer_get_time() - start) / 1000);
+    candidate->score = can_autobaud_score(candidate);
+    can_driver_deinit();
+    return locked;
+}
+
+esp_err_t can_autobaud_run(const can_autobaud_config_t *config, can_autobaud_result_t *out_result)
+{
+    memset(out_result, 0, sizeof(*out_result));
+    if (config->bitrate_count == 0 || config->bitrate_count > CAN_AUTOBAUD_MAX_CANDIDATES ||
+        config->dwell_ms == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    can_settings_t timings[CAN_AUTOBAUD_MAX_CANDIDATES];
+    for (size_t i = 0; i < config->bitrate_count; i++) {
+        can_settings_default(&timings[i]);
+        if (can_settings_set_bitrate(&timings[i], config->bitrates[i]) != ESP_OK) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        out_result->candidates[i].bitrate = config->bitrates[i];
+    }
+    out_result->candidate_count = config->bitrate_count;
+
+    if (can_driver_is_running()) {
+        can_driver_deinit();
+    }
+
+    int64_t start = esp_timer_get_time();
+    int64_t deadline = start + (int64_t)config->timeout_ms * 1000;
+    uint32_t dwell_ms = config->dwell_ms;
+    uint32_t dwell_max_ms = config->dwell_max_ms > dwell_ms ? config->dwell_max_ms : dwell_ms;
+    int best = -1;
+
+    while (best < 0 && deadline - esp_timer_get_time() >= 1000) {
+        out_result->passes++;
+        for (size_t i = 0; i < config->bitrate_count; i++) {
+            int64_t remaining_ms = (deadline - esp_timer_get_time()) / 1000;
+            if (remaining_ms <= 0) {
+                break;
+            }
+            uint32_t listen_ms = remaining_ms < dwell_ms ? (uint32_t)remaining_ms : dwell_ms;
+            if (can_autobaud_listen(&timings[i], &out_result->candidates[i], listen_ms, config->lock_frames)) {
+                best = (int)i;
+                break;
+            }
+        }
+
+        if (best < 0) {
+            int32_t best_score = 0;
+            for (size_t i = 0; i < config->bitrate_count; i++) {
+                const can_autobaud_candidate_t *candidate = &out_result->candidates[i];
+                if (candidate->frames > 0 && candidate->score > best_score) {
+                    best_score = candidate->score;
+                    best = (int)i;
+                }
+            }
+        }
+        if (best < 0 && dwell_ms < dwell_max_ms) {
+            dwell_ms = dwell_ms * 2 < dwell_max_ms ? dwell_ms * 2 : dwell_max_ms;
+        }
+    }
+
+    out_result->elapsed_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    if (best < 0) {
+        ESP_LOGW(TAG_CAN_AUTOBAUD, "No bitrate detected after %lu ms", (unsigned long)out_result->elapsed_ms);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    out_result->locked = true;
+    out_result->bitrate = config->bitrates[best];
+    out_result->timing = timings[best];
+    ESP_LOGI(TAG_CAN_AUTOBAUD, "Locked at %lu bit/s after %lu ms (%lu frames, %lu bus errors)",
+             (unsigned long)out_result->bitrate, (unsigned long)out_result->elapsed_ms,
+             (unsigned long)out_result->candidates[best].frames,
+             (unsigned long)out_result->candidates[best].bus_errors);
+    return ESP_OK;
+}
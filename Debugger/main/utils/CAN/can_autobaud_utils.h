@@ -0,0 +1,73 @@
+#ifndef CAN_AUTOBAUD_UTILS_H
+#define CAN_AUTOBAUD_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "can_settings_utils.h"
+
+/*
+ * Bitrate detection on an unknown bus.
+ *
+ * The controller is installed in TWAI_MODE_LISTEN_ONLY at each candidate
+ * bitrate in turn, so it never sends an ACK or error frame and cannot
+ * disturb the bus. During a dwell the frames that pass CRC and the bus
+ * errors the controller flags are counted; at a wrong bitrate nearly
+ * every frame ends in a stuff or form error, at the right one there are
+ * valid frames and no errors.
+ *
+ * A candidate that collects lock_frames valid frames without a single
+ * error locks at once, so a busy bus at the first candidate in the scan
+ * order is found within a few frame times. Otherwise each full pass
+ * scores the candidates on everything seen so far (valid frames weigh
+ * more than errors) and locks onto the best with at least one frame;
+ * a pass without any frame doubles the dwell, up to dwell_max_ms, to
+ * catch sparse traffic. Detection gives up after timeout_ms.
+ */
+#define CAN_AUTOBAUD_MAX_CANDIDATES 8
+
+typedef struct {
+    uint32_t bitrates[CAN_AUTOBAUD_MAX_CANDIDATES];    // scan order, presets only
+    size_t bitrate_count;
+    uint32_t dwell_ms;          // first pass
+    uint32_t dwell_max_ms;
+    uint32_t timeout_ms;
+    uint32_t lock_frames;
+} can_autobaud_config_t;
+
+typedef struct {
+    uint32_t bitrate;
+    uint32_t frames;            // valid frames, all passes
+    uint32_t bus_errors;
+    uint32_t listen_ms;         // total dwell
+    int32_t score;
+} can_autobaud_candidate_t;
+
+typedef struct {
+    bool locked;
+    uint32_t bitrate;           // 0 if not locked
+    can_settings_t timing;      // preset timing of the locked bitrate
+    uint32_t elapsed_ms;
+    uint32_t passes;
+    size_t candidate_count;
+    can_autobaud_candidate_t candidates[CAN_AUTOBAUD_MAX_CANDIDATES];
+} can_autobaud_result_t;
+
+/**
+ * @brief Defaults from can_config.h (CAN_AUTOBAUD_*).
+ */
+void can_autobaud_default_config(can_autobaud_config_t *out_config);
+
+/**
+ * @brief Run detection. Blocks for up to timeout_ms.
+ *
+ * Takes the controller from the shared driver for the duration and
+ * leaves it uninstalled; the caller restores or reapplies it.
+ *
+ * @return ESP_OK when locked, ESP_ERR_TIMEOUT if no candidate qualified,
+ *         ESP_ERR_INVALID_ARG for an empty or unsupported scan order.
+ */
+esp_err_t can_autobaud_run(const can_autobaud_config_t *config, can_autobaud_result_t *out_result);
+
+#endif // CAN_AUTOBAUD_UTILS_H
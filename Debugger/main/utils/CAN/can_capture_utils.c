@@ -0,0 +1,336 @@
+#include "can_capture_utils.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_vfs_fat.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char *TAG_CAN_CAPTURE = "CAN_CAPTURE";
+
+typedef enum {
+    BLOCK_FREE,
+    BLOCK_FILLING,
+    BLOCK_FULL,
+} block_state_t;
+
+static portMUX_TYPE capture_lock = portMUX_INITIALIZER_UNLOCKED;
+static can_capture_block_t *blocks[2];
+static volatile block_state_t block_state[2];
+static int filling = -1;            // block taking frames, -1 while both are full
+static int next_write = 0;          // oldest full block
+static volatile bool capturing = false;
+static can_capture_status_t capture_status;
+
+static TaskHandle_t writer_task = NULL;
+static SemaphoreHandle_t writer_done = NULL;
+static FILE *capture_file = NULL;
+static uint32_t file_index = 0;     // number of the file being written
+static uint32_t oldest_index = 1;   // lowest-numbered file still on flash
+
+static bool mounted = false;
+static wl_handle_t wl_handle = WL_INVALID_HANDLE;
+
+esp_err_t can_capture_mount(void) {
+    if (mounted) {
+        return ESP_OK;
+    }
+    const esp_vfs_fat_mount_config_t mount_config = {
+        .format_if_mount_failed = true,
+        .max_files = 2,
+        .allocation_unit_size = CONFIG_WL_SECTOR_SIZE,
+    };
+    esp_err_t ret = esp_vfs_fat_spiflash_mount_rw_wl(CAN_CAPTURE_MOUNT_POINT, CAN_CAPTURE_PARTITION,
+                                                     &mount_config, &wl_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_CAN_CAPTURE, "Failed to mount %s partition: %s", CAN_CAPTURE_PARTITION, esp_err_to_name(ret));
+        return ret;
+    }
+    mounted = true;
+    return ESP_OK;
+}
+
+// Find the existing CANnnnnn.BIN range so numbering and pruning continue across runs
+static void scan_existing_files(void) {
+    uint32_t lowest = UINT32_MAX, highest = 0;
+    DIR *dir = opendir(CAN_CAPTURE_MOUNT_POINT);
+    if (dir != NULL) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            unsigned long number;
+            if (sscanf(entry->d_name, "CAN%5lu.BIN", &number) == 1) {
+                lowest = number < lowest ? number : lowest;
+                highest = number > highest ? number : highest;
+            }
+        }
+        closedir(dir);
+    }
+    file_index = highest;
+    oldest_index = lowest == UINT32_MAX ? highest + 1 : lowest;
+}
+
+static bool open_next_file(void) {
+    if (capture_file != NULL) {
+        fclose(capture_file);
+    }
+    file_index++;
+    char path[sizeof(capture_status.path)];
+    snprintf(path, sizeof(path), "%s/CAN%05lu.BIN", CAN_CAPTURE_MOUNT_POINT, file_index);
+    capture_file = fopen(path, "wb");
+    if (capture_file == NULL) {
+        ESP_LOGE(TAG_CAN_CAPTURE, "Failed to create %s", path);
+        return false;
+    }
+    // Blocks are already sector-sized; stdio buffering would only add a copy
+    setvbuf(capture_file, NULL, _IONBF, 0);
+    taskENTER_CRITICAL(&capture_lock);
+    memcpy(capture_status.path, path, sizeof(path));
+    capture_status.file_bytes = 0;
+    capture_status.files_opened++;
+    taskEXIT_CRITICAL(&capture_lock);
+
+    while (file_index - oldest_index + 1 > capture_status.max_files) {
+        char old_path[32];
+        snprintf(old_path, sizeof(old_path), "%s/CAN%05lu.BIN", CAN_CAPTURE_MOUNT_POINT, oldest_index);
+        unlink(old_path);
+        oldest_index++;
+    }
+    return true;
+}
+
+// The writer task is the only one changing the file fields, so it reads
+// them without the lock; updates take it so can_capture_get_status() sees
+// a consistent snapshot
+static void write_block(const can_capture_block_t *block) {
+    if (capture_file == NULL || capture_status.file_bytes + CAN_CAPTURE_BLOCK_SIZE > capture_status.file_max_bytes) {
+        if (!open_next_file()) {
+            taskENTER_CRITICAL(&capture_lock);
+            capture_status.write_errors++;
+            taskEXIT_CRITICAL(&capture_lock);
+            return;
+        }
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    size_t written = fwrite(block, 1, CAN_CAPTURE_BLOCK_SIZE, capture_file);
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    taskENTER_CRITICAL(&capture_lock);
+    if (written != CAN_CAPTURE_BLOCK_SIZE) {
+        capture_status.write_errors++;
+    } else {
+        capture_status.blocks_written++;
+        capture_status.file_bytes += CAN_CAPTURE_BLOCK_SIZE;
+        if (elapsed_us > capture_status.max_write_us) {
+            capture_status.max_write_us = elapsed_us;
+        }
+    }
+    taskEXIT_CRITICAL(&capture_lock);
+}
+
+// Caller holds capture_lock
+static void seal_filling_block(void) {
+    block_state[filling] = BLOCK_FULL;
+    int other = filling ^ 1;
+    if (block_state[other] == BLOCK_FREE) {
+        block_state[other] = BLOCK_FILLING;
+        filling = other;
+    } else {
+        filling = -1;
+    }
+}
+
+void can_capture_record(const twai_message_t *message, int64_t timestamp_us) {
+    if (!capturing) {
+        return;
+    }
+
+    bool notify = false;
+    taskENTER_CRITICAL(&capture_lock);
+    if (capturing) {
+        // A block spans at most 2^24 us; quiet buses start a fresh block
+        if (filling >= 0 && blocks[filling]->header.record_count > 0 &&
+            (uint64_t)(timestamp_us - (int64_t)blocks[filling]->header.base_time_us) > CAN_CAPTURE_INFO_TIME_MASK) {
+            seal_filling_block();
+            notify = true;
+        }
+
+        if (filling < 0) {
+            capture_status.dropped++;
+        } else {
+            can_capture_block_t *block = blocks[filling];
+            if (block->header.record_count == 0) {
+                block->header.base_time_us = (uint64_t)timestamp_us;
+            }
+            can_capture_record_t *record = &block->records[block->header.record_count++];
+            record->info = ((uint32_t)(timestamp_us - (int64_t)block->header.base_time_us) & CAN_CAPTURE_INFO_TIME_MASK) |
+                           ((uint32_t)(message->data_length_code & CAN_CAPTURE_INFO_DLC_MASK) << CAN_CAPTURE_INFO_DLC_SHIFT) |
+                           (message->rtr ? CAN_CAPTURE_INFO_RTR : 0) |
+                           (message->extd ? CAN_CAPTURE_INFO_EXTD : 0);
+            record->identifier = message->identifier;
+            memcpy(record->data, message->data, TWAI_FRAME_MAX_DLC);
+            capture_status.frames++;
+
+            if (block->header.record_count == CAN_CAPTURE_RECORDS_PER_BLOCK) {
+                seal_filling_block();
+                notify = true;
+            }
+        }
+    }
+    taskEXIT_CRITICAL(&capture_lock);
+
+    if (notify) {
+        xTaskNotifyGive(writer_task);
+    }
+}
+
+static void capture_writer_task(void *pvParameters) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CAN_CAPTURE_FLUSH_MS / 4));
+        bool stopping = !capturing;
+        bool flushed_partial = false;
+
+        // Push out a partial block once it is old enough, or everything on stop
+        taskENTER_CRITICAL(&capture_lock);
+        if (filling >= 0 && blocks[filling]->header.record_count > 0 &&
+            (stopping || esp_timer_get_time() - (int64_t)blocks[filling]->header.base_time_us >= CAN_CAPTURE_FLUSH_MS * 1000LL)) {
+            seal_filling_block();
+            flushed_partial = true;
+        }
+        taskEXIT_CRITICAL(&capture_lock);
+
+        while (block_state[next_write] == BLOCK_FULL) {
+            can_capture_block_t *block = blocks[next_write];
+            write_block(block);
+            memset(block, 0, sizeof(*block));
+            block->header.magic = CAN_CAPTURE_MAGIC;
+            block->header.version = CAN_CAPTURE_VERSION;
+
+            taskENTER_CRITICAL(&capture_lock);
+            block_state[next_write] = BLOCK_FREE;
+            if (filling < 0) {
+                block_state[next_write] = BLOCK_FILLING;
+                filling = next_write;
+            }
+            taskEXIT_CRITICAL(&capture_lock);
+            next_write ^= 1;
+        }
+
+        // Partial blocks mean the bus is quiet; make them visible in the directory entry
+        if (flushed_partial && capture_file != NULL) {
+            fsync(fileno(capture_file));
+        }
+        if (stopping) {
+            break;
+        }
+    }
+
+    if (capture_file != NULL) {
+        fclose(capture_file);
+        capture_file = NULL;
+    }
+    xSemaphoreGive(writer_done);
+    vTaskDelete(NULL);
+}
+
+esp_err_t can_capture_start(uint32_t file_kb, uint32_t max_files) {
+    if (capturing || writer_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = can_capture_mount();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (writer_done == NULL && (writer_done = xSemaphoreCreateBinary()) == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        blocks[i] = calloc(1, sizeof(can_capture_block_t));
+        if (blocks[i] == NULL) {
+            free(blocks[0]);
+            blocks[0] = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+        blocks[i]->header.magic = CAN_CAPTURE_MAGIC;
+        blocks[i]->header.version = CAN_CAPTURE_VERSION;
+        block_state[i] = BLOCK_FREE;
+    }
+
+    uint32_t file_max_bytes = (file_kb ? file_kb : CAN_CAPTURE_DEFAULT_FILE_KB) * 1024;
+    taskENTER_CRITICAL(&capture_lock);
+    memset(&capture_status, 0, sizeof(capture_status));
+    capture_status.file_max_bytes = file_max_bytes < CAN_CAPTURE_BLOCK_SIZE ? CAN_CAPTURE_BLOCK_SIZE : file_max_bytes;
+    capture_status.max_files = max_files ? max_files : CAN_CAPTURE_DEFAULT_MAX_FILES;
+    taskEXIT_CRITICAL(&capture_lock);
+    scan_existing_files();
+
+    block_state[0] = BLOCK_FILLING;
+    filling = 0;
+    next_write = 0;
+
+    if (xTaskCreate(capture_writer_task, "can_capture", CAN_CAPTURE_WRITER_STACK_SIZE, NULL,
+                    CAN_CAPTURE_WRITER_PRIORITY, &writer_task) != pdPASS) {
+        writer_task = NULL;
+        free(blocks[0]);
+        free(blocks[1]);
+        blocks[0] = blocks[1] = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    taskENTER_CRITICAL(&capture_lock);
+    capturing = true;
+    capture_status.running = true;
+    taskEXIT_CRITICAL(&capture_lock);
+    ESP_LOGI(TAG_CAN_CAPTURE, "Capture started: %lu KiB files, keeping %lu",
+             capture_status.file_max_bytes / 1024, capture_status.max_files);
+    return ESP_OK;
+}
+
+esp_err_t can_capture_stop(void) {
+    if (writer_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    taskENTER_CRITICAL(&capture_lock);
+    capturing = false;
+    taskEXIT_CRITICAL(&capture_lock);
+
+    xTaskNotifyGive(writer_task);
+    xSemaphoreTake(writer_done, portMAX_DELAY);
+    writer_task = NULL;
+
+    free(blocks[0]);
+    free(blocks[1]);
+    blocks[0] = blocks[1] = NULL;
+    taskENTER_CRITICAL(&capture_lock);
+    filling = -1;
+    capture_status.running = false;
+    taskEXIT_CRITICAL(&capture_lock);
+
+    ESP_LOGI(TAG_CAN_CAPTURE, "Capture stopped: %lu frames, %lu dropped, %lu blocks",
+             capture_status.frames, capture_status.dropped, capture_status.blocks_written);
+    return ESP_OK;
+}
+
+void can_capture_get_status(can_capture_status_t *out_status) {
+    taskENTER_CRITICAL(&capture_lock);
+    *out_status = capture_status;
+    taskEXIT_CRITICAL(&capture_lock);
+}
+
+void can_capture_decode(const can_capture_block_header_t *header, const can_capture_record_t *record,
+                        twai_message_t *out_message, int64_t *out_timestamp_us) {
+    memset(out_message, 0, sizeof(*out_message));
+    out_message->identifier = record->identifier;
+    out_message->data_length_code = (record->info >> CAN_CAPTURE_INFO_DLC_SHIFT) & CAN_CAPTURE_INFO_DLC_MASK;
+    out_message->rtr = (record->info & CAN_CAPTURE_INFO_RTR) != 0;
+    out_message->extd = (record->info & CAN_CAPTURE_INFO_EXTD) != 0;
+    memcpy(out_message->data, record->data, TWAI_FRAME_MAX_DLC);
+    *out_timestamp_us = (int64_t)header->base_time_us + (record->info & CAN_CAPTURE_INFO_TIME_MASK);
+}
@@ -0,0 +1,126 @@
+#ifndef CAN_CAPTURE_UTILS_H
+#define CAN_CAPTURE_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+
+/*
+ * Binary CAN capture to the FAT "storage" partition.
+ *
+ * The receive task appends frames to one of two RAM blocks; a full
+ * block is handed to a writer task and the other block takes over, so
+ * flash latency only matters if a whole block fills while the previous
+ * one is still being written. Frames that arrive then are counted as
+ * dropped, never waited for.
+ *
+ * File format (.BIN, little-endian): a sequence of 4096-byte blocks,
+ * each written with a single sector-aligned write.
+ *
+ *   block header, 16 bytes:
+ *     u32 magic          CAN_CAPTURE_MAGIC ("CCAP")
+ *     u16 version        CAN_CAPTURE_VERSION
+ *     u16 record_count   1..CAN_CAPTURE_RECORDS_PER_BLOCK
+ *     u64 base_time_us   esp_timer time of the first record
+ *   records, 16 bytes each (unused ones are zero):
+ *     u32 info           bits 0-23  time since base_time_us [us]
+ *                        bits 24-27 DLC
+ *                        bit  28    RTR
+ *                        bit  29    extended ID
+ *     u32 identifier
+ *     u8  data[8]        bytes past DLC are zero
+ *
+ * Blocks are self-contained, so a file cut short by a reset is readable
+ * up to its last complete block. Files rotate at a size cap and the
+ * oldest file is deleted once more than max_files exist.
+ */
+#define CAN_CAPTURE_MOUNT_POINT         "/capture"
+#define CAN_CAPTURE_PARTITION           "storage"
+#define CAN_CAPTURE_BLOCK_SIZE          4096    // one wear-levelling sector
+#define CAN_CAPTURE_FLUSH_MS            5000    // partial blocks reach flash at least this often
+#define CAN_CAPTURE_DEFAULT_FILE_KB     512
+#define CAN_CAPTURE_DEFAULT_MAX_FILES   8
+#define CAN_CAPTURE_WRITER_STACK_SIZE   4096
+#define CAN_CAPTURE_WRITER_PRIORITY     3       // below the receive task
+
+#define CAN_CAPTURE_MAGIC               0x50414343u
+#define CAN_CAPTURE_VERSION             1
+#define CAN_CAPTURE_RECORDS_PER_BLOCK   255
+
+#define CAN_CAPTURE_INFO_TIME_MASK      0x00FFFFFFu
+#define CAN_CAPTURE_INFO_DLC_SHIFT      24
+#define CAN_CAPTURE_INFO_DLC_MASK       0xFu
+#define CAN_CAPTURE_INFO_RTR            (1u << 28)
+#define CAN_CAPTURE_INFO_EXTD           (1u << 29)
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_count;
+    uint64_t base_time_us;
+} can_capture_block_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t info;
+    uint32_t identifier;
+    uint8_t data[TWAI_FRAME_MAX_DLC];
+} can_capture_record_t;
+
+typedef struct {
+    can_capture_block_header_t header;
+    can_capture_record_t records[CAN_CAPTURE_RECORDS_PER_BLOCK];
+} can_capture_block_t;
+
+_Static_assert(sizeof(can_capture_block_t) == CAN_CAPTURE_BLOCK_SIZE, "capture block must fill one sector");
+
+typedef struct {
+    bool running;
+    char path[32];              // file currently being written
+    uint32_t frames;            // frames accepted into blocks
+    uint32_t dropped;           // frames lost because both blocks were full
+    uint32_t blocks_written;
+    uint32_t write_errors;
+    uint32_t files_opened;
+    uint32_t file_bytes;        // size of the current file
+    uint32_t file_max_bytes;
+    uint32_t max_files;
+    uint32_t max_write_us;      // slowest block write
+} can_capture_status_t;
+
+/**
+ * @brief Mount the FAT capture partition at CAN_CAPTURE_MOUNT_POINT.
+ *
+ * Formats it on first use. Safe to call repeatedly.
+ */
+esp_err_t can_capture_mount(void);
+
+/**
+ * @brief Mount the capture partition (once) and start recording.
+ *
+ * Numbering continues after the newest existing capture file.
+ *
+ * @param file_kb   Rotate to a new file at this size; 0 = default.
+ * @param max_files Keep at most this many files; 0 = default.
+ */
+esp_err_t can_capture_start(uint32_t file_kb, uint32_t max_files);
+
+/**
+ * @brief Flush the partial block, close the file and stop the writer.
+ */
+esp_err_t can_capture_stop(void);
+
+/**
+ * @brief Append one frame. Called from the receive path; never blocks.
+ */
+void can_capture_record(const twai_message_t *message, int64_t timestamp_us);
+
+void can_capture_get_status(can_capture_status_t *out_status);
+
+/**
+ * @brief Decode a record back into a frame and its absolute timestamp.
+ */
+void can_capture_decode(const can_capture_block_header_t *header, const can_capture_record_t *record,
+                        twai_message_t *out_message, int64_t *out_timestamp_us);
+
+#endif // CAN_CAPTURE_UTILS_H
@@ -4,13 +4,41 @@
 #include "driver/twai.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "can_signals.h"    // generated from CANDatabase/signals.json
+#include "can_driver_config.h" // GPIOs, bitrate, queues and alerts from sdkconfig.defaults
 
-// Define CAN GPIOs - ESP32 default: TX GPIO21, RX GPIO22. Adjust if needed.
-#define CAN_TX_GPIO         GPIO_NUM_21
-#define CAN_RX_GPIO         GPIO_NUM_22
+#define CAN_TX_GPIO         CAN_DRIVER_TX_GPIO
+#define CAN_RX_GPIO         CAN_DRIVER_RX_GPIO
 
-// Define a CAN ID for temperature messages
-#define TEMP_CAN_ID         0x1A0 // Example CAN ID
+// CAN ID for temperature messages, shared by all nodes through the signal database
+#define TEMP_CAN_ID         CAN_MSG_TEMPERATURE_ID
+
+// Bus settings used by can_driver_init() until a record is saved with can-config
+#define CAN_DEFAULT_BITRATE         CAN_DRIVER_BITRATE
+#define CAN_DEFAULT_MODE            CAN_DRIVER_MODE
+#define CAN_DEFAULT_RX_QUEUE_LEN    CAN_DRIVER_RX_QUEUE_LEN
+#define CAN_DEFAULT_TX_QUEUE_LEN    CAN_DRIVER_TX_QUEUE_LEN
+
+// Auto-baud: candidates in scan order (most likely first), dwell per
+// candidate on the first pass (doubled each pass up to the max), overall
+// bound, and the error-free frame count that locks without finishing a pass
+#define CAN_AUTOBAUD_ORDER          { 500000, 250000, 125000, 1000000, 800000 }
+#define CAN_AUTOBAUD_DWELL_MS       50
+#define CAN_AUTOBAUD_DWELL_MAX_MS   1600
+#define CAN_AUTOBAUD_TIMEOUT_MS     5000
+#define CAN_AUTOBAUD_LOCK_FRAMES    3
+
+// Alerts raised by the shared driver, consumed by the statistics task:
+// CAN_DRIVER_ALERTS from CONFIG_CAN_DRIVER_ALERTS_TX, _RX and _ERROR_STATE
+// (bus-off and bus-recovered drive can_driver_recover())
+
+// Statistics query: request data[0] = page, answered on the response ID
+#define CAN_STATS_REQUEST_ID    0x7F0
+#define CAN_STATS_RESPONSE_ID   0x7F1
+
+// Age after which a cached value reads as stale
+#define CAN_VALUE_TEMPERATURE_MAX_AGE_MS    5000
+#define CAN_VALUE_HEARTBEAT_MAX_AGE_MS      (3 * CAN_MSG_HEARTBEAT_PERIOD_MS)
 
 extern QueueHandle_t temperature_queue;
 
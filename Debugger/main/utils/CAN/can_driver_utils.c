@@ -1,25 +1,76 @@
 #include "can_driver_utils.h"
 #include "can_config.h"
 #include "esp_log.h"
+#include "freertos/task.h"
 #include "driver/gpio.h" // Required for TWAI_GENERAL_CONFIG_DEFAULT
 
 static const char *TAG_CAN_DRIVER = "CAN_DRIVER";
 
+// Gate between driver (un)installation and tasks blocked inside the driver
+static portMUX_TYPE driver_gate_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool driver_shared = false;
+static uint32_t driver_users = 0;
+
+// Settings of the shared driver, loaded on first init
+static can_settings_t active_settings;
+static bool settings_loaded = false;
+
+static esp_err_t can_driver_install_settings(const can_settings_t *settings) {
+    twai_general_config_t g_config;
+    twai_timing_config_t t_config;
+    can_settings_to_config(settings, &g_config, &t_config);
+    g_config.alerts_enabled = CAN_DRIVER_ALERTS;
+
+    ESP_LOGI(TAG_CAN_DRIVER, "%lu bit/s (BRP %u, TSEG1 %u, TSEG2 %u, SJW %u), %s, queues RX %u TX %u",
+             (unsigned long)can_settings_bitrate(settings), settings->brp, settings->tseg_1, settings->tseg_2,
+             settings->sjw, can_settings_mode_name(settings->mode), settings->rx_queue_len, settings->tx_queue_len);
+    return can_driver_install(&g_config, &t_config, true);
+}
+
 esp_err_t can_driver_init(void) {
-    // Initialize TWAI general configuration
-    twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(CAN_TX_GPIO, CAN_RX_GPIO, TWAI_MODE_NORMAL);
-    g_config.tx_queue_len = 5; // Number of messages TX queue can hold
-    g_config.rx_queue_len = 5; // Number of messages RX queue can hold
+    if (!settings_loaded) {
+        if (can_settings_load(&active_settings) == ESP_OK) {
+            ESP_LOGI(TAG_CAN_DRIVER, "Using stored CAN settings");
+        }
+        settings_loaded = true;
+    }
+    return can_driver_install_settings(&active_settings);
+}
+
+void can_driver_get_settings(can_settings_t *out_settings) {
+    if (!settings_loaded) {
+        can_settings_load(&active_settings);
+        settings_loaded = true;
+    }
+    *out_settings = active_settings;
+}
+
+esp_err_t can_driver_apply(const can_settings_t *settings) {
+    if (can_settings_validate(settings, NULL) != ESP_OK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (driver_shared) {
+        can_driver_deinit();
+    }
+
+    esp_err_t ret = can_driver_install_settings(settings);
+    if (ret == ESP_OK) {
+        active_settings = *settings;
+        settings_loaded = true;
+        return ESP_OK;
+    }
 
-    // Initialize TWAI timing configuration
-    // Common speeds: TWAI_TIMING_CONFIG_125KBITS(), TWAI_TIMING_CONFIG_250KBITS(), TWAI_TIMING_CONFIG_500KBITS(), TWAI_TIMING_CONFIG_1MBITS()
-    twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
+    ESP_LOGW(TAG_CAN_DRIVER, "Restoring previous CAN settings");
+    can_driver_init();
+    return ret;
+}
 
+esp_err_t can_driver_install(const twai_general_config_t *g_config, const twai_timing_config_t *t_config, bool shared) {
     // Initialize TWAI filter configuration (accept all messages)
     twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
 
     // Install TWAI driver
-    esp_err_t ret = twai_driver_install(&g_config, &t_config, &f_config);
+    esp_err_t ret = twai_driver_install(g_config, t_config, &f_config);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG_CAN_DRIVER, "Failed to install TWAI driver: %s", esp_err_to_name(ret));
         return ret;
@@ -34,10 +85,60 @@ esp_err_t can_driver_init(void) {
         return ret;
     }
     ESP_LOGI(TAG_CAN_DRIVER, "TWAI driver started");
+
+    taskENTER_CRITICAL(&driver_gate_lock);
+    driver_shared = shared;
+    taskEXIT_CRITICAL(&driver_gate_lock);
     return ESP_OK;
 }
 
+bool can_driver_acquire(void) {
+    taskENTER_CRITICAL(&driver_gate_lock);
+    bool running = driver_shared;
+    if (running) {
+        driver_users++;
+    }
+    taskEXIT_CRITICAL(&driver_gate_lock);
+    return running;
+}
+
+void can_driver_release(void) {
+    taskENTER_CRITICAL(&driver_gate_lock);
+    driver_users--;
+    taskEXIT_CRITICAL(&driver_gate_lock);
+}
+
+void can_driver_recover(void) {
+    // The gate is held: the shared driver is installed and only recovery stops it
+    twai_status_info_t status;
+    if (twai_get_status_info(&status) != ESP_OK) {
+        return;
+    }
+    if (status.state == TWAI_STATE_BUS_OFF) {
+        if (twai_initiate_recovery() == ESP_OK) {
+            ESP_LOGW(TAG_CAN_DRIVER, "Bus-off (TEC=%lu, REC=%lu), recovery started",
+                     (unsigned long)status.tx_error_counter, (unsigned long)status.rx_error_counter);
+        }
+    } else if (status.state == TWAI_STATE_STOPPED) {
+        if (twai_start() == ESP_OK) {
+            ESP_LOGI(TAG_CAN_DRIVER, "Bus recovered, TWAI driver restarted");
+        }
+    }
+}
+
+bool can_driver_is_running(void) {
+    return driver_shared;
+}
+
 void can_driver_deinit(void) {
+    // Close the gate, then wait for background tasks to leave the driver
+    taskENTER_CRITICAL(&driver_gate_lock);
+    driver_shared = false;
+    taskEXIT_CRITICAL(&driver_gate_lock);
+    while (driver_users > 0) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
     esp_err_t ret = twai_stop();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG_CAN_DRIVER, "Failed to stop TWAI driver: %s", esp_err_to_name(ret));
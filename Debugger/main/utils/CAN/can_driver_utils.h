@@ -1,9 +1,61 @@
 #ifndef CAN_DRIVER_UTILS_H
 #define CAN_DRIVER_UTILS_H
 
+#include <stdbool.h>
 #include "esp_err.h"
+#include "driver/twai.h"
+#include "can_settings_utils.h"
 
+/**
+ * @brief Install the shared driver with the active settings. The first
+ *        call loads them from NVS (or the can_config.h defaults).
+ */
 esp_err_t can_driver_init(void);
+
+/**
+ * @brief Settings the shared driver was last installed with.
+ */
+void can_driver_get_settings(can_settings_t *out_settings);
+
+/**
+ * @brief Reinstall the shared driver with new settings.
+ *
+ * Background tasks are drained through the gate first. If the driver
+ * rejects the settings the previous ones are reinstalled.
+ */
+esp_err_t can_driver_apply(const can_settings_t *settings);
+
+/**
+ * @brief Install and start the TWAI driver with caller supplied configs
+ *        (accept-all filter).
+ *
+ * @param shared true to open the driver to background tasks (RX task,
+ *        statistics). Benchmarks that need the controller to themselves,
+ *        in another mode or bitrate, pass false.
+ */
+esp_err_t can_driver_install(const twai_general_config_t *g_config, const twai_timing_config_t *t_config, bool shared);
+
+/**
+ * @brief Enter a section that calls into the shared driver.
+ *
+ * Background tasks wrap each blocking driver call (with a bounded
+ * timeout) in acquire/release so can_driver_deinit() can wait for them
+ * to leave the driver before it is uninstalled.
+ *
+ * @return true if the shared driver is running; release() must follow.
+ */
+bool can_driver_acquire(void);
+void can_driver_release(void);
+
+/**
+ * @brief Bring the shared driver back from bus-off without reinstalling.
+ *
+ * Call between can_driver_acquire() and can_driver_release(), so a CLI
+ * reinstall cannot run meanwhile. Bus-off starts recovery, and the stopped
+ * state a finished recovery leaves behind restarts the controller.
+ */
+void can_driver_recover(void);
+bool can_driver_is_running(void);
 void can_driver_deinit(void);
 
 #endif 
\ No newline at end of file
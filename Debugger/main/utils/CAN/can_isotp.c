@@ -0,0 +1,549 @@
+#include "can_isotp.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char *TAG_ISOTP = "CAN_ISOTP";
+
+// Protocol control information (upper nibble of byte 0)
+#define ISOTP_PCI_SF    0x0
+#define ISOTP_PCI_FF    0x1
+#define ISOTP_PCI_CF    0x2
+#define ISOTP_PCI_FC    0x3
+
+// Flow status
+#define ISOTP_FS_CTS    0x0
+#define ISOTP_FS_WAIT   0x1
+#define ISOTP_FS_OVFLW  0x2
+
+#define ISOTP_SF_MAX_DATA   7
+#define ISOTP_FF_DATA       6
+#define ISOTP_CF_DATA       7
+#define ISOTP_PAD_BYTE      0xCC
+
+typedef enum {
+    ISOTP_TX_IDLE,
+    ISOTP_TX_SEND_FIRST,    // SF/FF not yet accepted by the driver
+    ISOTP_TX_WAIT_FC,
+    ISOTP_TX_SENDING,
+} isotp_tx_state_t;
+
+typedef enum {
+    ISOTP_RX_IDLE,
+    ISOTP_RX_RECEIVING,
+} isotp_rx_state_t;
+
+typedef struct {
+    bool in_use;
+    isotp_config_t config;
+    isotp_stats_t stats;
+
+    // Sender side; tx_data is the caller's buffer (zero-copy)
+    isotp_tx_state_t tx_state;
+    const uint8_t *tx_data;
+    size_t tx_length;
+    size_t tx_offset;
+    uint8_t tx_sn;
+    uint8_t tx_block_size;
+    uint8_t tx_block_remaining;
+    uint8_t tx_wait_count;
+    uint32_t tx_st_min_us;
+    int64_t tx_next_us;
+    int64_t tx_deadline_us;
+
+    // Receiver side
+    isotp_rx_state_t rx_state;
+    size_t rx_length;
+    size_t rx_offset;
+    uint8_t rx_sn;
+    uint8_t rx_block_count;
+    bool rx_fc_pending;         // FC could not be queued, retry in poll
+    uint8_t rx_fc_status;
+    int64_t rx_deadline_us;
+} isotp_session_t;
+
+static isotp_session_t sessions[ISOTP_MAX_SESSIONS];
+// Recursive so callbacks may start a new transfer from inside the layer
+static SemaphoreHandle_t isotp_mutex = NULL;
+
+static esp_err_t isotp_default_can_tx(const twai_message_t *message, void *ctx)
+{
+    return twai_transmit(message, 0);
+}
+
+static isotp_can_tx_t isotp_can_tx = isotp_default_can_tx;
+static void *isotp_can_tx_ctx = NULL;
+
+static inline void isotp_lock(void)
+{
+    xSemaphoreTakeRecursive(isotp_mutex, portMAX_DELAY);
+}
+
+static inline void isotp_unlock(void)
+{
+    xSemaphoreGiveRecursive(isotp_mutex);
+}
+
+static bool isotp_valid_handle(int handle)
+{
+    return handle >= 0 && handle < ISOTP_MAX_SESSIONS && sessions[handle].in_use;
+}
+
+uint32_t isotp_st_min_to_us(uint8_t st_min)
+{
+    if (st_min <= 0x7F) {
+        return (uint32_t)st_min * 1000;
+    }
+    if (st_min >= 0xF1 && st_min <= 0xF9) {
+        return (uint32_t)(st_min - 0xF0) * 100;
+    }
+    // Reserved values are treated as the longest valid separation
+    return 127000;
+}
+
+static esp_err_t isotp_emit(isotp_session_t *s, twai_message_t *msg, uint8_t used)
+{
+    msg->identifier = s->config.tx_id;
+    msg->extd = s->config.extended ? 1 : 0;
+    if (s->config.padding) {
+        memset(&msg->data[used], ISOTP_PAD_BYTE, 8 - used);
+        msg->data_length_code = 8;
+    } else {
+        msg->data_length_code = used;
+    }
+
+    esp_err_t ret = isotp_can_tx(msg, isotp_can_tx_ctx);
+    if (ret == ESP_OK) {
+        s->stats.frames_sent++;
+    }
+    return ret;
+}
+
+static esp_err_t isotp_send_fc(isotp_session_t *s, uint8_t status)
+{
+    twai_message_t msg = {0};
+    msg.data[0] = (ISOTP_PCI_FC << 4) | status;
+    msg.data[1] = s->config.block_size;
+    msg.data[2] = s->config.st_min;
+
+    esp_err_t ret = isotp_emit(s, &msg, 3);
+    s->rx_fc_pending = (ret == ESP_ERR_TIMEOUT);
+    s->rx_fc_status = status;
+    return ret;
+}
+
+static void isotp_finish_tx(int handle, esp_err_t status)
+{
+    isotp_session_t *s = &sessions[handle];
+    s->tx_state = ISOTP_TX_IDLE;
+    s->tx_data = NULL;
+    if (status == ESP_OK) {
+        s->stats.messages_sent++;
+    } else {
+        ESP_LOGW(TAG_ISOTP, "Session %d send aborted: %s", handle, esp_err_to_name(status));
+    }
+    if (s->config.on_send_done) {
+        s->config.on_send_done(handle, status, s->config.ctx);
+    }
+}
+
+static void isotp_deliver(int handle, const uint8_t *data, size_t length)
+{
+    isotp_session_t *s = &sessions[handle];
+    s->rx_state = ISOTP_RX_IDLE;
+    s->stats.messages_received++;
+    if (s->config.on_receive) {
+        s->config.on_receive(handle, data, length, s->config.ctx);
+    }
+}
+
+// Try to queue the SF or FF for a freshly started transfer
+static void isotp_send_first(int handle, int64_t now_us)
+{
+    isotp_session_t *s = &sessions[handle];
+    twai_message_t msg = {0};
+    esp_err_t ret;
+
+    if (s->tx_length <= ISOTP_SF_MAX_DATA) {
+        msg.data[0] = (ISOTP_PCI_SF << 4) | (uint8_t)s->tx_length;
+        memcpy(&msg.data[1], s->tx_data, s->tx_length);
+        ret = isotp_emit(s, &msg, 1 + s->tx_length);
+        if (ret == ESP_OK) {
+            isotp_finish_tx(handle, ESP_OK);
+        }
+    } else {
+        msg.data[0] = (ISOTP_PCI_FF << 4) | (uint8_t)((s->tx_length >> 8) & 0x0F);
+        msg.data[1] = (uint8_t)(s->tx_length & 0xFF);
+        memcpy(&msg.data[2], s->tx_data, ISOTP_FF_DATA);
+        ret = isotp_emit(s, &msg, 8);
+        if (ret == ESP_OK) {
+            s->tx_offset = ISOTP_FF_DATA;
+            s->tx_sn = 1;
+            s->tx_wait_count = 0;
+            s->tx_state = ISOTP_TX_WAIT_FC;
+            s->tx_deadline_us = now_us + (int64_t)ISOTP_TIMEOUT_MS * 1000;
+        }
+    }
+
+    if (ret != ESP_OK && ret != ESP_ERR_TIMEOUT) {
+        isotp_finish_tx(handle, ret);
+    }
+}
+
+static void isotp_send_consecutive(int handle, int64_t now_us)
+{
+    isotp_session_t *s = &sessions[handle];
+
+    while (s->tx_state == ISOTP_TX_SENDING && now_us >= s->tx_next_us) {
+        size_t chunk = s->tx_length - s->tx_offset;
+        if (chunk > ISOTP_CF_DATA) {
+            chunk = ISOTP_CF_DATA;
+        }
+
+        twai_message_t msg = {0};
+        msg.data[0] = (ISOTP_PCI_CF << 4) | s->tx_sn;
+        memcpy(&msg.data[1], s->tx_data + s->tx_offset, chunk);
+
+        esp_err_t ret = isotp_emit(s, &msg, 1 + chunk);
+        if (ret == ESP_ERR_TIMEOUT) {
+            return; // driver queue full, resume on next poll
+        }
+        if (ret != ESP_OK) {
+            isotp_finish_tx(handle, ret);
+            return;
+        }
+
+        s->tx_offset += chunk;
+        s->tx_sn = (s->tx_sn + 1) & 0x0F;
+        if (s->tx_offset >= s->tx_length) {
+            isotp_finish_tx(handle, ESP_OK);
+            return;
+        }
+
+        if (s->tx_block_size != 0 && --s->tx_block_remaining == 0) {
+            s->tx_state = ISOTP_TX_WAIT_FC;
+            s->tx_deadline_us = now_us + (int64_t)ISOTP_TIMEOUT_MS * 1000;
+            return;
+        }
+        s->tx_next_us = now_us + s->tx_st_min_us;
+    }
+}
+
+void isotp_set_can_tx(isotp_can_tx_t can_tx, void *ctx)
+{
+    isotp_can_tx = can_tx ? can_tx : isotp_default_can_tx;
+    isotp_can_tx_ctx = can_tx ? ctx : NULL;
+}
+
+esp_err_t isotp_init(void)
+{
+    if (!isotp_mutex) {
+        isotp_mutex = xSemaphoreCreateRecursiveMutex();
+        if (!isotp_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t isotp_open(const isotp_config_t *config, int *out_handle)
+{
+    if (!config || !out_handle || config->tx_id == config->rx_id) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!isotp_mutex) {
+        return ESP_ERR_INVALID_STATE;   // isotp_init() not called
+    }
+
+    isotp_lock();
+    for (int i = 0; i < ISOTP_MAX_SESSIONS; i++) {
+        if (sessions[i].in_use) {
+            if (sessions[i].config.rx_id == config->rx_id &&
+                sessions[i].config.extended == config->extended) {
+                isotp_unlock();
+                ESP_LOGE(TAG_ISOTP, "RX ID 0x%lX already bound to session %d", config->rx_id, i);
+                return ESP_ERR_INVALID_STATE;
+            }
+            continue;
+        }
+        memset(&sessions[i], 0, sizeof(sessions[i]));
+        sessions[i].config = *config;
+        sessions[i].in_use = true;
+        *out_handle = i;
+        isotp_unlock();
+        return ESP_OK;
+    }
+    isotp_unlock();
+
+    ESP_LOGE(TAG_ISOTP, "No free session (max %d)", ISOTP_MAX_SESSIONS);
+    return ESP_ERR_NO_MEM;
+}
+
+void isotp_close(int handle)
+{
+    if (!isotp_mutex) {
+        return;
+    }
+    isotp_lock();
+    if (isotp_valid_handle(handle)) {
+        sessions[handle].in_use = false;
+    }
+    isotp_unlock();
+}
+
+esp_err_t isotp_send(int handle, const uint8_t *data, size_t length)
+{
+    if (!data || length == 0 || length > ISOTP_MAX_PAYLOAD) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!isotp_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    isotp_lock();
+    if (!isotp_valid_handle(handle)) {
+        isotp_unlock();
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    isotp_session_t *s = &sessions[handle];
+    if (s->tx_state != ISOTP_TX_IDLE) {
+        isotp_unlock();
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s->tx_data = data;
+    s->tx_length = length;
+    s->tx_offset = 0;
+    s->tx_state = ISOTP_TX_SEND_FIRST;
+    isotp_send_first(handle, esp_timer_get_time());
+    isotp_unlock();
+    return ESP_OK;
+}
+
+static void isotp_handle_fc(int handle, const twai_message_t *msg, int64_t now_us)
+{
+    isotp_session_t *s = &sessions[handle];
+    if (s->tx_state != ISOTP_TX_WAIT_FC || msg->data_length_code < 3) {
+        return;
+    }
+
+    switch (msg->data[0] & 0x0F) {
+        case ISOTP_FS_CTS:
+            s->tx_block_size = msg->data[1];
+            s->tx_block_remaining = msg->data[1];
+            s->tx_st_min_us = isotp_st_min_to_us(msg->data[2]);
+            s->tx_wait_count = 0;
+            s->tx_next_us = now_us;
+            s->tx_state = ISOTP_TX_SENDING;
+            isotp_send_consecutive(handle, now_us);
+            break;
+        case ISOTP_FS_WAIT:
+            if (++s->tx_wait_count > ISOTP_MAX_WAIT_FRAMES) {
+                isotp_finish_tx(handle, ESP_ERR_TIMEOUT);
+            } else {
+                s->tx_deadline_us = now_us + (int64_t)ISOTP_TIMEOUT_MS * 1000;
+            }
+            break;
+        case ISOTP_FS_OVFLW:
+            s->stats.overflows++;
+            isotp_finish_tx(handle, ESP_ERR_INVALID_SIZE);
+            break;
+        default:
+            isotp_finish_tx(handle, ESP_ERR_INVALID_RESPONSE);
+            break;
+    }
+}
+
+static void isotp_handle_ff(int handle, const twai_message_t *msg, int64_t now_us)
+{
+    isotp_session_t *s = &sessions[handle];
+    size_t length = ((size_t)(msg->data[0] & 0x0F) << 8) | msg->data[1];
+
+    if (msg->data_length_code != 8 || length <= ISOTP_SF_MAX_DATA) {
+        return;
+    }
+    if (!s->config.rx_buffer || length > s->config.rx_buffer_size) {
+        s->stats.overflows++;
+        s->rx_state = ISOTP_RX_IDLE;
+        isotp_send_fc(s, ISOTP_FS_OVFLW);
+        return;
+    }
+
+    // A new FF aborts any reception in progress
+    memcpy(s->config.rx_buffer, &msg->data[2], ISOTP_FF_DATA);
+    s->rx_length = length;
+    s->rx_offset = ISOTP_FF_DATA;
+    s->rx_sn = 1;
+    s->rx_block_count = 0;
+    s->rx_state = ISOTP_RX_RECEIVING;
+    s->rx_deadline_us = now_us + (int64_t)ISOTP_TIMEOUT_MS * 1000;
+    isotp_send_fc(s, ISOTP_FS_CTS);
+}
+
+static void isotp_handle_cf(int handle, const twai_message_t *msg, int64_t now_us)
+{
+    isotp_session_t *s = &sessions[handle];
+    if (s->rx_state != ISOTP_RX_RECEIVING) {
+        return;
+    }
+
+    if ((msg->data[0] & 0x0F) != s->rx_sn) {
+        s->stats.sequence_errors++;
+        s->rx_state = ISOTP_RX_IDLE;
+        ESP_LOGW(TAG_ISOTP, "Session %d sequence error (got %u, expected %u)",
+                 handle, msg->data[0] & 0x0F, s->rx_sn);
+        return;
+    }
+
+    size_t chunk = s->rx_length - s->rx_offset;
+    if (chunk > ISOTP_CF_DATA) {
+        chunk = ISOTP_CF_DATA;
+    }
+    if (msg->data_length_code < 1 + chunk) {
+        return;
+    }
+
+    memcpy(s->config.rx_buffer + s->rx_offset, &msg->data[1], chunk);
+    s->rx_offset += chunk;
+    s->rx_sn = (s->rx_sn + 1) & 0x0F;
+    s->rx_deadline_us = now_us + (int64_t)ISOTP_TIMEOUT_MS * 1000;
+
+    if (s->rx_offset >= s->rx_length) {
+        isotp_deliver(handle, s->config.rx_buffer, s->rx_length);
+        return;
+    }
+
+    if (s->config.block_size != 0 && ++s->rx_block_count >= s->config.block_size) {
+        s->rx_block_count = 0;
+        isotp_send_fc(s, ISOTP_FS_CTS);
+    }
+}
+
+bool isotp_on_frame(const twai_message_t *message)
+{
+    if (!message || !isotp_mutex || message->rtr || message->data_length_code == 0) {
+        return false;
+    }
+
+    isotp_lock();
+    int handle = -1;
+    for (int i = 0; i < ISOTP_MAX_SESSIONS; i++) {
+        if (sessions[i].in_use &&
+            sessions[i].config.rx_id == message->identifier &&
+            sessions[i].config.extended == (bool)message->extd) {
+            handle = i;
+            break;
+        }
+    }
+    if (handle < 0) {
+        isotp_unlock();
+        return false;
+    }
+
+    isotp_session_t *s = &sessions[handle];
+    int64_t now_us = esp_timer_get_time();
+    s->stats.frames_received++;
+
+    switch (message->data[0] >> 4) {
+        case ISOTP_PCI_SF: {
+            uint8_t length = message->data[0] & 0x0F;
+            if (length >= 1 && length <= ISOTP_SF_MAX_DATA &&
+                message->data_length_code >= 1 + length) {
+                // Single frames are delivered straight from the CAN frame
+                isotp_deliver(handle, &message->data[1], length);
+            }
+            break;
+        }
+        case ISOTP_PCI_FF:
+            isotp_handle_ff(handle, message, now_us);
+            break;
+        case ISOTP_PCI_CF:
+            isotp_handle_cf(handle, message, now_us);
+            break;
+        case ISOTP_PCI_FC:
+            isotp_handle_fc(handle, message, now_us);
+            break;
+        default:
+            break;
+    }
+    isotp_unlock();
+    return true;
+}
+
+void isotp_poll(void)
+{
+    if (!isotp_mutex) {
+        return;
+    }
+
+    isotp_lock();
+    int64_t now_us = esp_timer_get_time();
+    for (int i = 0; i < ISOTP_MAX_SESSIONS; i++) {
+        isotp_session_t *s = &sessions[i];
+        if (!s->in_use) {
+            continue;
+        }
+
+        if (s->rx_fc_pending) {
+            isotp_send_fc(s, s->rx_fc_status);
+        }
+        if (s->rx_state == ISOTP_RX_RECEIVING && now_us > s->rx_deadline_us) {
+            s->stats.timeouts++;
+            s->rx_state = ISOTP_RX_IDLE;
+            ESP_LOGW(TAG_ISOTP, "Session %d receive timed out (N_Cr)", i);
+        }
+
+        switch (s->tx_state) {
+            case ISOTP_TX_SEND_FIRST:
+                isotp_send_first(i, now_us);
+                break;
+            case ISOTP_TX_WAIT_FC:
+                if (now_us > s->tx_deadline_us) {
+                    s->stats.timeouts++;
+                    isotp_finish_tx(i, ESP_ERR_TIMEOUT);
+                }
+                break;
+            case ISOTP_TX_SENDING:
+                isotp_send_consecutive(i, now_us);
+                break;
+            default:
+                break;
+        }
+    }
+    isotp_unlock();
+}
+
+bool isotp_busy(void)
+{
+    if (!isotp_mutex) {
+        return false;
+    }
+
+    bool busy = false;
+    isotp_lock();
+    for (int i = 0; i < ISOTP_MAX_SESSIONS && !busy; i++) {
+        busy = sessions[i].in_use &&
+               (sessions[i].tx_state != ISOTP_TX_IDLE ||
+                sessions[i].rx_state != ISOTP_RX_IDLE ||
+                sessions[i].rx_fc_pending);
+    }
+    isotp_unlock();
+    return busy;
+}
+
+void isotp_get_stats(int handle, isotp_stats_t *out_stats)
+{
+    if (!out_stats || !isotp_mutex) {
+        return;
+    }
+    isotp_lock();
+    if (isotp_valid_handle(handle)) {
+        *out_stats = sessions[handle].stats;
+    } else {
+        memset(out_stats, 0, sizeof(*out_stats));
+    }
+    isotp_unlock();
+}
@@ -0,0 +1,107 @@
+#ifndef CAN_ISOTP_H
+#define CAN_ISOTP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+
+/*
+ * ISO 15765-2 (ISO-TP) transport over classic CAN.
+ *
+ * Frames: single (SF), first (FF), consecutive (CF) and flow control
+ * (FC) with normal addressing, 12-bit lengths (up to 4095 bytes).
+ * Several sessions can be active at once; each is bound to a TX and an
+ * RX identifier. The layer is not tied to a task: feed received frames
+ * to isotp_on_frame() and call isotp_poll() regularly (or after every
+ * received frame) to send pending consecutive frames and run timeouts.
+ */
+#define ISOTP_MAX_SESSIONS      4
+#define ISOTP_MAX_PAYLOAD       4095
+#define ISOTP_TIMEOUT_MS        1000    // N_Bs / N_Cr
+#define ISOTP_MAX_WAIT_FRAMES   10      // FC.WAIT frames tolerated before aborting
+
+typedef void (*isotp_rx_cb_t)(int handle, const uint8_t *data, size_t length, void *ctx);
+typedef void (*isotp_tx_cb_t)(int handle, esp_err_t status, void *ctx);
+
+/**
+ * @brief Frame output used by the layer. Must not block; return
+ *        ESP_ERR_TIMEOUT when the driver queue is full and the frame
+ *        will be retried on the next isotp_poll().
+ */
+typedef esp_err_t (*isotp_can_tx_t)(const twai_message_t *message, void *ctx);
+
+typedef struct {
+    uint32_t tx_id;
+    uint32_t rx_id;
+    bool extended;
+    uint8_t block_size;         // advertised in our FC, 0 = no limit
+    uint8_t st_min;             // advertised in our FC, ISO-TP encoding
+    uint8_t *rx_buffer;         // reassembly buffer owned by the caller
+    size_t rx_buffer_size;
+    isotp_rx_cb_t on_receive;
+    isotp_tx_cb_t on_send_done;
+    void *ctx;
+    bool padding;               // pad frames to 8 bytes
+} isotp_config_t;
+
+typedef struct {
+    uint32_t frames_sent;
+    uint32_t frames_received;
+    uint32_t messages_sent;
+    uint32_t messages_received;
+    uint32_t timeouts;
+    uint32_t sequence_errors;
+    uint32_t overflows;
+} isotp_stats_t;
+
+/**
+ * @brief Set the frame output. Defaults to twai_transmit() with no timeout.
+ */
+void isotp_set_can_tx(isotp_can_tx_t can_tx, void *ctx);
+
+/**
+ * @brief Create the session lock. Call once from app_main, before any
+ *        task uses the layer; the other calls fail or do nothing until then.
+ */
+esp_err_t isotp_init(void);
+
+esp_err_t isotp_open(const isotp_config_t *config, int *out_handle);
+void isotp_close(int handle);
+
+/**
+ * @brief Start sending a message.
+ *
+ * Zero-copy: frames are built straight from data, which must stay valid
+ * and unchanged until on_send_done is called.
+ *
+ * @return ESP_OK if started, ESP_ERR_INVALID_STATE if the session is busy.
+ */
+esp_err_t isotp_send(int handle, const uint8_t *data, size_t length);
+
+/**
+ * @brief Offer a received frame to the sessions.
+ *
+ * @return true if a session consumed the frame.
+ */
+bool isotp_on_frame(const twai_message_t *message);
+
+/**
+ * @brief Send due consecutive/flow-control frames and run timeouts.
+ */
+void isotp_poll(void);
+
+/**
+ * @brief True while any session is sending or receiving.
+ */
+bool isotp_busy(void);
+
+void isotp_get_stats(int handle, isotp_stats_t *out_stats);
+
+/**
+ * @brief Convert an ISO-TP STmin byte to microseconds.
+ */
+uint32_t isotp_st_min_to_us(uint8_t st_min);
+
+#endif // CAN_ISOTP_H
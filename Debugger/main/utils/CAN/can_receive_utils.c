@@ -1,49 +1,131 @@
 #include "can_receive_utils.h"
 #include "can_config.h" // For potential shared configs if needed in future
+#include "can_driver_utils.h"
+#include "can_stats_utils.h"
+#include "can_capture_utils.h"
+#include "can_value_utils.h"
+#include "esp_timer.h"
 #include "driver/twai.h"
 #include "esp_log.h"
 
+#include <stdio.h>
 #include <string.h>
 
 static const char *TAG_CAN_RX = "CAN_RECEIVE";
 
+static can_value_handle_t temperature_value = -1;
+static can_value_handle_t uptime_value = -1;
+static can_value_handle_t deadline_misses_value = -1;
+static can_value_handle_t log_dropped_value = -1;
+
+void can_receive_values_init(void) {
+    const can_value_def_t temperature = {
+        .name = "temperature", .unit = "C",
+        .identifier = CAN_MSG_TEMPERATURE_ID, .extended = CAN_MSG_TEMPERATURE_EXTENDED,
+        .signal = CAN_VALUE_SIG_TEMPERATURE, .max_age_ms = CAN_VALUE_TEMPERATURE_MAX_AGE_MS,
+    };
+    const can_value_def_t uptime = {
+        .name = "tx_uptime", .unit = "s",
+        .identifier = CAN_MSG_HEARTBEAT_ID, .extended = CAN_MSG_HEARTBEAT_EXTENDED,
+        .signal = CAN_VALUE_SIG_UPTIME, .max_age_ms = CAN_VALUE_HEARTBEAT_MAX_AGE_MS,
+    };
+    const can_value_def_t deadline_misses = {
+        .name = "tx_deadline_misses", .unit = "",
+        .identifier = CAN_MSG_HEARTBEAT_ID, .extended = CAN_MSG_HEARTBEAT_EXTENDED,
+        .signal = CAN_VALUE_SIG_DEADLINE_MISSES, .max_age_ms = CAN_VALUE_HEARTBEAT_MAX_AGE_MS,
+    };
+    const can_value_def_t log_dropped = {
+        .name = "tx_log_dropped", .unit = "",
+        .identifier = CAN_MSG_HEARTBEAT_ID, .extended = CAN_MSG_HEARTBEAT_EXTENDED,
+        .signal = CAN_VALUE_SIG_LOG_DROPPED, .max_age_ms = CAN_VALUE_HEARTBEAT_MAX_AGE_MS,
+    };
+    temperature_value = can_value_register(&temperature);
+    uptime_value = can_value_register(&uptime);
+    deadline_misses_value = can_value_register(&deadline_misses);
+    log_dropped_value = can_value_register(&log_dropped);
+}
+
+// Decode known messages into the last-value cache
+static void update_values(const twai_message_t *message, int64_t timestamp_us) {
+    if (message->rtr || message->extd) {
+        return;
+    }
+    if (message->identifier == CAN_MSG_TEMPERATURE_ID) {
+        // TEMPERATURE shares its ID with TEMPERATURE_BATCH; DLC 4 is the legacy raw float
+        if (message->data_length_code == CAN_MSG_TEMPERATURE_DLC) {
+            can_temperature_t msg;
+            can_temperature_unpack(&msg, message->data);
+            can_value_update(temperature_value, can_temperature_temperature_decode(msg.temperature), timestamp_us);
+        } else if (message->data_length_code == sizeof(float)) {
+            float temperature_c;
+            memcpy(&temperature_c, message->data, sizeof(float));
+            can_value_update(temperature_value, temperature_c, timestamp_us);
+        } else {
+            can_temperature_batch_t batch;
+            can_temperature_batch_unpack(&batch, message->data);
+            // Samples are in acquisition order, so the newest is the last one sent
+            if (batch.count >= CAN_SIG_TEMPERATURE_BATCH_COUNT_MIN_RAW &&
+                message->data_length_code == 1 + 2 * batch.count) {
+                const int16_t samples[] = { batch.sample0, batch.sample1, batch.sample2 };
+                can_value_update(temperature_value, can_temperature_batch_sample0_decode(samples[batch.count - 1]),
+                                 timestamp_us);
+            }
+        }
+    } else if (message->identifier == CAN_MSG_HEARTBEAT_ID && message->data_length_code == CAN_MSG_HEARTBEAT_DLC) {
+        can_heartbeat_t heartbeat;
+        can_heartbeat_unpack(&heartbeat, message->data);
+        can_value_update(uptime_value, (float)heartbeat.uptime, timestamp_us);
+        can_value_update(deadline_misses_value, heartbeat.deadline_misses, timestamp_us);
+        can_value_update(log_dropped_value, heartbeat.log_dropped, timestamp_us);
+    }
+}
+
 void can_receive_task(void *pvParameters) {
     ESP_LOGI(TAG_CAN_RX, "CAN Receive Task Started");
     twai_message_t rx_message;
 
     while (1) {
-        // Wait to receive a message
-        esp_err_t ret = twai_receive(&rx_message, pdMS_TO_TICKS(portMAX_DELAY)); // Block indefinitely
+        // Bounded wait inside the driver gate so the CLI can reinstall the driver
+        if (!can_driver_acquire()) {
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+        esp_err_t ret = twai_receive(&rx_message, pdMS_TO_TICKS(100));
+        // Stamp before anything else: an idle task wakes here as soon as the RX interrupt queues the frame
+        int64_t rx_time_us = esp_timer_get_time();
+        twai_status_info_t status;
+        bool have_status = twai_get_status_info(&status) == ESP_OK;
+        can_driver_release();
 
         if (ret == ESP_OK) {
-            ESP_LOGI(TAG_CAN_RX, "Message received: ID=0x%03lX, DLC=%d", rx_message.identifier, rx_message.data_length_code);
-            // Log data bytes
-            char data_str[3 * TWAI_FRAME_MAX_DLC + 1] = {0};
-            for (int i = 0; i < rx_message.data_length_code; i++) {
-                sprintf(data_str + i * 3, "%02X ", rx_message.data[i]);
+            can_stats_record_rx(&rx_message, have_status ? status.msgs_to_rx : 0, rx_time_us);
+            can_capture_record(&rx_message, rx_time_us);
+            if (can_stats_handle_request(&rx_message)) {
+                continue;
             }
-            ESP_LOGI(TAG_CAN_RX, "Data: %s", data_str);
 
-            // Example: Check if it's a temperature message (though this task is generic)
-            if (rx_message.identifier == TEMP_CAN_ID && rx_message.data_length_code == sizeof(float)) {
-                float received_temp;
-                memcpy(&received_temp, rx_message.data, sizeof(float));
-                ESP_LOGI(TAG_CAN_RX, "Received temperature: %.2f C", received_temp);
+            // Per-frame output is debug only: the CLI shares this console
+            ESP_LOGD(TAG_CAN_RX, "Message received: ID=0x%03lX, DLC=%d", rx_message.identifier, rx_message.data_length_code);
+            // ESP_LOG_DEBUG is an enum, so this is a C test, not #if; the
+            // compile-time half folds away in builds below debug level
+            if (LOG_LOCAL_LEVEL >= ESP_LOG_DEBUG && esp_log_level_get(TAG_CAN_RX) >= ESP_LOG_DEBUG) {
+                char data_str[3 * TWAI_FRAME_MAX_DLC + 1] = {0};
+                for (int i = 0; i < rx_message.data_length_code; i++) {
+                    sprintf(data_str + i * 3, "%02X ", rx_message.data[i]);
+                }
+                ESP_LOGD(TAG_CAN_RX, "Data: %s", data_str);
             }
 
+            update_values(&rx_message, rx_time_us);
+
         } else if (ret == ESP_ERR_TIMEOUT) {
-            // Timeout, no message received (should not happen with portMAX_DELAY unless driver is stopped)
+            // No traffic within the bounded wait
             // Continue loop
         } else {
+            // Bus-off is not an error here (the receive just times out); the
+            // statistics task recovers on TWAI_ALERT_BUS_OFF
             ESP_LOGE(TAG_CAN_RX, "Failed to receive message: %s", esp_err_to_name(ret));
-            // If bus-off or other critical error, may need to re-init or handle
-            if (ret == TWAI_ALERT_BUS_RECOVERED || ret == TWAI_ALERT_BUS_OFF) {
-                ESP_LOGW(TAG_CAN_RX, "CAN bus issue detected: %s. May need re-initialization.", esp_err_to_name(ret));
-                // Potentially signal main task or attempt recovery
-                vTaskDelay(pdMS_TO_TICKS(1000)); // Wait before retrying
-            }
+            vTaskDelay(pdMS_TO_TICKS(100)); // Wait before retrying
         }
-        // Small delay to yield, though twai_receive with timeout handles blocking
-         vTaskDelay(pdMS_TO_TICKS(10));
     }
-}
\ No newline at end of file
+}
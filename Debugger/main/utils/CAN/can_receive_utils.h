@@ -4,6 +4,19 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+// Signal indices in the last-value cache, per message
+#define CAN_VALUE_SIG_TEMPERATURE       0
+#define CAN_VALUE_SIG_UPTIME            0
+#define CAN_VALUE_SIG_DEADLINE_MISSES   1
+#define CAN_VALUE_SIG_LOG_DROPPED       2
+
+/**
+ * @brief Register the decoded signals in the last-value cache.
+ *
+ * Call once before starting can_receive_task.
+ */
+void can_receive_values_init(void);
+
 /**
  * @brief Task to receive and process CAN messages.
  *
@@ -0,0 +1,193 @@
+#include "can_replay_utils.h"
+#include "can_capture_utils.h"
+#include "can_stats_utils.h"
+#include "driver/gptimer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG_CAN_REPLAY = "CAN_REPLAY";
+
+// Waits shorter than this spin on the counter; an interrupt round trip costs about as much
+#define CAN_REPLAY_SPIN_US  50
+
+static bool IRAM_ATTR replay_alarm_cb(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t high_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)user_ctx, &high_task_woken);
+    return high_task_woken == pdTRUE;
+}
+
+static uint64_t timer_now(gptimer_handle_t timer)
+{
+    uint64_t count = 0;
+    gptimer_get_raw_count(timer, &count);
+    return count;
+}
+
+static void wait_until(gptimer_handle_t timer, uint64_t target)
+{
+    uint64_t now = timer_now(timer);
+    while (now + CAN_REPLAY_SPIN_US < target) {
+        ulTaskNotifyTake(pdTRUE, 0);
+        gptimer_alarm_config_t alarm = { .alarm_count = target - CAN_REPLAY_SPIN_US };
+        gptimer_set_alarm_action(timer, &alarm);
+        // The tick timeout only guards against an alarm that was already in the past when set
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((target - now) / 1000) + 2);
+        now = timer_now(timer);
+    }
+    while (now < target) {
+        now = timer_now(timer);
+    }
+}
+
+static void record_error(can_replay_report_t *report, uint32_t error_us)
+{
+    int bucket;
+    if (error_us < CAN_REPLAY_ERROR_LINEAR_US) {
+        bucket = error_us;
+    } else {
+        // 256-511 -> first log bucket, 512-1023 -> second, ...
+        bucket = CAN_REPLAY_ERROR_LINEAR_US + (31 - __builtin_clz(error_us)) - 8;
+        if (bucket >= CAN_REPLAY_ERROR_BUCKETS) {
+            bucket = CAN_REPLAY_ERROR_BUCKETS - 1;
+        }
+    }
+    report->error_hist[bucket]++;
+    if (error_us > report->error_max_us) {
+        report->error_max_us = error_us;
+    }
+}
+
+uint32_t can_replay_error_percentile(const can_replay_report_t *report, uint32_t percentile)
+{
+    uint64_t samples = 0;
+    for (int bucket = 0; bucket < CAN_REPLAY_ERROR_BUCKETS; bucket++) {
+        samples += report->error_hist[bucket];
+    }
+    if (samples == 0) {
+        return 0;
+    }
+
+    uint64_t target = (samples * percentile + 99) / 100;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < CAN_REPLAY_ERROR_BUCKETS; bucket++) {
+        seen += report->error_hist[bucket];
+        if (seen >= target) {
+            if (bucket < CAN_REPLAY_ERROR_LINEAR_US) {
+                return bucket;
+            }
+            uint32_t upper = 1u << (bucket - CAN_REPLAY_ERROR_LINEAR_US + 9);
+            return upper < report->error_max_us ? upper : report->error_max_us;
+        }
+    }
+    return report->error_max_us;
+}
+
+static esp_err_t replay_once(FILE *file, can_capture_block_t *block, gptimer_handle_t timer,
+                             float speed, can_replay_report_t *report)
+{
+    bool first = true;
+    int64_t first_ts = 0, last_ts = 0;
+    uint64_t loop_start = 0;
+
+    rewind(file);
+    while (fread(block, 1, CAN_CAPTURE_BLOCK_SIZE, file) == CAN_CAPTURE_BLOCK_SIZE) {
+        if (block->header.magic != CAN_CAPTURE_MAGIC || block->header.version != CAN_CAPTURE_VERSION ||
+            block->header.record_count > CAN_CAPTURE_RECORDS_PER_BLOCK) {
+            report->bad_blocks++;
+            continue;
+        }
+
+        for (uint16_t i = 0; i < block->header.record_count; i++) {
+            twai_message_t message;
+            int64_t timestamp_us;
+            can_capture_decode(&block->header, &block->records[i], &message, &timestamp_us);
+
+            if (timer != NULL) {
+                if (first) {
+                    first_ts = timestamp_us;
+                    loop_start = timer_now(timer);
+                }
+                uint64_t due = loop_start + (uint64_t)((double)(timestamp_us - first_ts) / speed);
+                wait_until(timer, due);
+                uint64_t now = timer_now(timer);
+                record_error(report, now > due ? (uint32_t)(now - due) : 0);
+            } else if (first) {
+                first_ts = timestamp_us;
+            }
+            first = false;
+            last_ts = timestamp_us;
+
+            if (can_stats_transmit(&message, pdMS_TO_TICKS(CAN_REPLAY_TX_TIMEOUT_MS)) == ESP_OK) {
+                report->frames_sent++;
+            } else {
+                report->tx_failures++;
+            }
+        }
+    }
+
+    report->capture_span_us = last_ts - first_ts;
+    return ferror(file) ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t can_replay_file(const char *path, const can_replay_config_t *config, can_replay_report_t *out_report)
+{
+    memset(out_report, 0, sizeof(*out_report));
+
+    esp_err_t ret = can_capture_mount();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    can_capture_block_t *block = malloc(sizeof(can_capture_block_t));
+    if (block == NULL) {
+        fclose(file);
+        return ESP_ERR_NO_MEM;
+    }
+
+    gptimer_handle_t timer = NULL;
+    if (config->speed > 0.0f) {
+        const gptimer_config_t timer_config = {
+            .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+            .direction = GPTIMER_COUNT_UP,
+            .resolution_hz = CAN_REPLAY_TIMER_HZ,
+        };
+        const gptimer_event_callbacks_t callbacks = { .on_alarm = replay_alarm_cb };
+        ret = gptimer_new_timer(&timer_config, &timer);
+        if (ret == ESP_OK) {
+            gptimer_register_event_callbacks(timer, &callbacks, xTaskGetCurrentTaskHandle());
+            gptimer_enable(timer);
+            gptimer_start(timer);
+        } else {
+            ESP_LOGE(TAG_CAN_REPLAY, "Failed to create replay timer: %s", esp_err_to_name(ret));
+            free(block);
+            fclose(file);
+            return ret;
+        }
+    }
+
+    uint32_t loops = config->loops ? config->loops : 1;
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t loop = 0; loop < loops && ret == ESP_OK; loop++) {
+        ret = replay_once(file, block, timer, config->speed, out_report);
+    }
+    out_report->elapsed_us = esp_timer_get_time() - start_us;
+
+    if (timer != NULL) {
+        gptimer_stop(timer);
+        gptimer_disable(timer);
+        gptimer_del_timer(timer);
+    }
+    free(block);
+    fclose(file);
+    return ret;
+}
@@ -0,0 +1,52 @@
+#ifndef CAN_REPLAY_UTILS_H
+#define CAN_REPLAY_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/*
+ * Replay of can-capture files.
+ *
+ * Each frame is due at its captured offset from the first frame divided
+ * by the speed factor. A 1 MHz GPTimer alarm wakes the replaying task at
+ * that time, so pacing is not limited to the RTOS tick. Timing error is
+ * the delay between a frame's due time and the moment it was handed to
+ * the driver.
+ */
+#define CAN_REPLAY_TIMER_HZ         1000000
+#define CAN_REPLAY_TX_TIMEOUT_MS    10      // per frame, before counting a TX failure
+#define CAN_REPLAY_ERROR_LINEAR_US  256     // 1 us resolution below this
+#define CAN_REPLAY_ERROR_BUCKETS    (CAN_REPLAY_ERROR_LINEAR_US + 24)
+
+typedef struct {
+    float speed;                // time compression, e.g. 10 = ten times faster; 0 = as fast as possible
+    uint32_t loops;             // play the file this many times; 0 counts as 1
+} can_replay_config_t;
+
+typedef struct {
+    uint32_t frames_sent;
+    uint32_t tx_failures;
+    uint32_t bad_blocks;        // blocks skipped for a wrong magic or version
+    int64_t elapsed_us;         // wall time of the replay
+    int64_t capture_span_us;    // first to last frame in the file, per loop
+    uint32_t error_max_us;
+    uint32_t error_hist[CAN_REPLAY_ERROR_BUCKETS];
+} can_replay_report_t;
+
+/**
+ * @brief Replay a capture file on the shared driver. Blocks until done.
+ *
+ * @return ESP_ERR_NOT_FOUND if the file cannot be opened, ESP_FAIL on a
+ *         read error, ESP_OK otherwise (TX failures are in the report).
+ */
+esp_err_t can_replay_file(const char *path, const can_replay_config_t *config, can_replay_report_t *out_report);
+
+/**
+ * @brief Timing error at a percentile (0-100), in microseconds.
+ *
+ * Exact below CAN_REPLAY_ERROR_LINEAR_US, an upper bound above.
+ */
+uint32_t can_replay_error_percentile(const can_replay_report_t *report, uint32_t percentile);
+
+#endif // CAN_REPLAY_UTILS_H
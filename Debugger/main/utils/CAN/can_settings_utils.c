@@ -0,0 +1,176 @@
+#include "can_settings_utils.h"
+#include "can_config.h"
+#include "nvs.h"
+#include "driver/gpio.h"
+#include <string.h>
+
+// 8-byte standard data frame including the 3-bit interframe space
+#define FRAME_BITS_NO_STUFFING      111
+#define FRAME_BITS_WORST_STUFFING   (111 + (34 + 64 - 1) / 4)
+
+static const can_settings_preset_t presets[] = {
+    { 125000,  { .brp = 32, .tseg_1 = 15, .tseg_2 = 4, .sjw = 3 } },
+    { 250000,  { .brp = 16, .tseg_1 = 15, .tseg_2 = 4, .sjw = 3 } },
+    { 500000,  { .brp = 8,  .tseg_1 = 15, .tseg_2 = 4, .sjw = 3 } },
+    { 800000,  { .brp = 4,  .tseg_1 = 16, .tseg_2 = 8, .sjw = 3 } },
+    { 1000000, { .brp = 4,  .tseg_1 = 15, .tseg_2 = 4, .sjw = 3 } },
+};
+
+size_t can_settings_get_presets(const can_settings_preset_t **out_presets)
+{
+    *out_presets = presets;
+    return sizeof(presets) / sizeof(presets[0]);
+}
+
+esp_err_t can_settings_set_bitrate(can_settings_t *settings, uint32_t bitrate)
+{
+    for (size_t i = 0; i < sizeof(presets) / sizeof(presets[0]); i++) {
+        if (presets[i].bitrate == bitrate) {
+            settings->brp = presets[i].timing.brp;
+            settings->tseg_1 = presets[i].timing.tseg_1;
+            settings->tseg_2 = presets[i].timing.tseg_2;
+            settings->sjw = presets[i].timing.sjw;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void can_settings_default(can_settings_t *out_settings)
+{
+    memset(out_settings, 0, sizeof(*out_settings));
+    out_settings->version = CAN_SETTINGS_VERSION;
+    out_settings->mode = CAN_DEFAULT_MODE;
+    out_settings->rx_queue_len = CAN_DEFAULT_RX_QUEUE_LEN;
+    out_settings->tx_queue_len = CAN_DEFAULT_TX_QUEUE_LEN;
+    can_settings_set_bitrate(out_settings, CAN_DEFAULT_BITRATE);
+}
+
+esp_err_t can_settings_validate(const can_settings_t *settings, const char **out_reason)
+{
+    const char *reason = NULL;
+    if (settings->version != CAN_SETTINGS_VERSION) {
+        reason = "unknown record version";
+    } else if (settings->brp < 2 || settings->brp > 128 || (settings->brp & 1)) {
+        reason = "BRP must be even, 2-128";
+    } else if (settings->tseg_1 < 1 || settings->tseg_1 > 16) {
+        reason = "TSEG1 must be 1-16";
+    } else if (settings->tseg_2 < 1 || settings->tseg_2 > 8) {
+        reason = "TSEG2 must be 1-8";
+    } else if (settings->sjw < 1 || settings->sjw > 4 || settings->sjw > settings->tseg_2) {
+        reason = "SJW must be 1-4 and at most TSEG2";
+    } else if (can_settings_bitrate(settings) > 1000000) {
+        reason = "bitrate above 1 Mbit/s";
+    } else if (settings->mode > TWAI_MODE_LISTEN_ONLY) {
+        reason = "unknown mode";
+    } else if (settings->rx_queue_len < 1 || settings->rx_queue_len > CAN_SETTINGS_MAX_QUEUE_LEN ||
+               settings->tx_queue_len > CAN_SETTINGS_MAX_QUEUE_LEN) {
+        reason = "queue length out of range";
+    }
+    if (out_reason != NULL) {
+        *out_reason = reason;
+    }
+    return reason == NULL ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t can_settings_load(can_settings_t *out_settings)
+{
+    nvs_handle_t handle;
+    can_settings_t stored;
+    size_t length = sizeof(stored);
+
+    esp_err_t ret = nvs_open(CAN_SETTINGS_NVS_NAMESPACE, NVS_READONLY, &handle);
+    if (ret == ESP_OK) {
+        ret = nvs_get_blob(handle, CAN_SETTINGS_NVS_KEY, &stored, &length);
+        nvs_close(handle);
+    }
+    if (ret == ESP_OK && length == sizeof(stored) && can_settings_validate(&stored, NULL) == ESP_OK) {
+        *out_settings = stored;
+        return ESP_OK;
+    }
+    can_settings_default(out_settings);
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t can_settings_save(const can_settings_t *settings)
+{
+    if (can_settings_validate(settings, NULL) != ESP_OK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(CAN_SETTINGS_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_set_blob(handle, CAN_SETTINGS_NVS_KEY, settings, sizeof(*settings));
+    if (ret == ESP_OK) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+esp_err_t can_settings_erase(void)
+{
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(CAN_SETTINGS_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = nvs_erase_key(handle, CAN_SETTINGS_NVS_KEY);
+    if (ret == ESP_OK || ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = nvs_commit(handle);
+    }
+    nvs_close(handle);
+    return ret;
+}
+
+void can_settings_to_config(const can_settings_t *settings, twai_general_config_t *out_general,
+                            twai_timing_config_t *out_timing)
+{
+    twai_general_config_t general = TWAI_GENERAL_CONFIG_DEFAULT(CAN_TX_GPIO, CAN_RX_GPIO, (twai_mode_t)settings->mode);
+    general.rx_queue_len = settings->rx_queue_len;
+    general.tx_queue_len = settings->tx_queue_len;
+    *out_general = general;
+
+    // quanta_resolution_hz = 0 makes the driver take brp as given
+    const twai_timing_config_t timing = {
+        .clk_src = TWAI_CLK_SRC_DEFAULT,
+        .quanta_resolution_hz = 0,
+        .brp = settings->brp,
+        .tseg_1 = settings->tseg_1,
+        .tseg_2 = settings->tseg_2,
+        .sjw = settings->sjw,
+        .triple_sampling = false,
+    };
+    *out_timing = timing;
+}
+
+uint32_t can_settings_bitrate(const can_settings_t *settings)
+{
+    uint32_t quanta = 1 + settings->tseg_1 + settings->tseg_2;
+    return CAN_SETTINGS_CLOCK_HZ / settings->brp / quanta;
+}
+
+uint32_t can_settings_sample_point_permille(const can_settings_t *settings)
+{
+    uint32_t quanta = 1 + settings->tseg_1 + settings->tseg_2;
+    return (1 + settings->tseg_1) * 1000 / quanta;
+}
+
+void can_settings_max_frame_rate(const can_settings_t *settings, uint32_t *out_min, uint32_t *out_max)
+{
+    uint32_t bitrate = can_settings_bitrate(settings);
+    *out_min = bitrate / FRAME_BITS_WORST_STUFFING;
+    *out_max = bitrate / FRAME_BITS_NO_STUFFING;
+}
+
+const char *can_settings_mode_name(uint8_t mode)
+{
+    switch (mode) {
+        case TWAI_MODE_NORMAL:      return "normal";
+        case TWAI_MODE_NO_ACK:      return "no-ack";
+        case TWAI_MODE_LISTEN_ONLY: return "listen-only";
+        default:                    return "unknown";
+    }
+}
@@ -0,0 +1,552 @@
+#include "can_stats_utils.h"
+#include "can_config.h"
+#include "can_driver_utils.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <math.h>
+
+static const char *TAG_CAN_STATS = "CAN_STATS";
+
+#define CAN_STATS_EMPTY_SLOT    UINT32_MAX
+#define CAN_STATS_HASH_BITS     5
+
+_Static_assert((1u << CAN_STATS_HASH_BITS) == CAN_STATS_MAX_IDS,
+               "CAN_STATS_HASH_BITS must index exactly CAN_STATS_MAX_IDS slots");
+
+typedef struct {
+    uint32_t key;               // identifier | extended flag, EMPTY_SLOT if unused
+    uint32_t tx_count;
+    uint32_t rx_count;
+    uint32_t tx_window_base;
+    uint32_t rx_window_base;
+    uint32_t tx_per_sec;
+    uint32_t rx_per_sec;
+    int64_t last_rx_us;
+    uint32_t period_ref_us;     // first period; deviations from it are summed
+    uint32_t period_mean_us;    // refreshed every few samples for gap detection
+    uint32_t period_count;
+    int64_t period_sum;
+    uint64_t period_sum_sq;
+    uint32_t period_min_us;
+    uint32_t period_max_us;
+    uint32_t missed_periods;
+    uint32_t step_ref_us;       // first period of a run outside the mean's range
+    uint32_t step_count;        // consecutive similar periods in that run
+    uint32_t step_missed;       // missed_periods counted during the run
+} can_stats_slot_t;
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static can_stats_slot_t slots[CAN_STATS_MAX_IDS];
+static can_stats_summary_t totals;
+static uint64_t window_bits = 0;
+static uint32_t tx_window_base = 0;
+static uint32_t rx_window_base = 0;
+static uint32_t last_rx_pending = 0;
+static uint64_t rx_timing_cycles = 0;
+
+// Enqueue timestamps of frames still in the driver, oldest first.
+// Guarded by tx_mutex together with the twai_transmit() call so the
+// alert side never sees a frame in the driver without its timestamp.
+static SemaphoreHandle_t tx_mutex = NULL;
+static int64_t tx_pending[CAN_STATS_TX_PENDING_MAX];
+static uint32_t tx_pending_head = 0;
+static uint32_t tx_pending_count = 0;
+
+static TaskHandle_t stats_task_handle = NULL;
+
+static inline uint32_t can_stats_key(const twai_message_t *message)
+{
+    return message->identifier | (message->extd ? 0x80000000u : 0);
+}
+
+// Open addressing; returns NULL once the table is full
+static can_stats_slot_t *can_stats_lookup(uint32_t key)
+{
+    uint32_t index = (key * 2654435761u) >> (32 - CAN_STATS_HASH_BITS);
+    for (uint32_t probe = 0; probe < CAN_STATS_MAX_IDS; probe++) {
+        can_stats_slot_t *slot = &slots[(index + probe) % CAN_STATS_MAX_IDS];
+        if (slot->key == key) {
+            return slot;
+        }
+        if (slot->key == CAN_STATS_EMPTY_SLOT) {
+            slot->key = key;
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+static void can_stats_clear_locked(void)
+{
+    uint32_t bitrate = totals.bitrate;
+    memset(slots, 0, sizeof(slots));
+    for (int i = 0; i < CAN_STATS_MAX_IDS; i++) {
+        slots[i].key = CAN_STATS_EMPTY_SLOT;
+    }
+    memset(&totals, 0, sizeof(totals));
+    totals.bitrate = bitrate;
+    window_bits = 0;
+    tx_window_base = 0;
+    rx_window_base = 0;
+    rx_timing_cycles = 0;
+}
+
+void can_stats_init(uint32_t bitrate)
+{
+    if (!tx_mutex) {
+        tx_mutex = xSemaphoreCreateMutex();
+    }
+    taskENTER_CRITICAL(&stats_lock);
+    totals.bitrate = bitrate;
+    can_stats_clear_locked();
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+void can_stats_set_bitrate(uint32_t bitrate)
+{
+    taskENTER_CRITICAL(&stats_lock);
+    totals.bitrate = bitrate;
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+void can_stats_reset(void)
+{
+    taskENTER_CRITICAL(&stats_lock);
+    can_stats_clear_locked();
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+// Counts periods outside [mean / 2, 1.5 mean] that agree with each other
+// within 25%; returns true once there are CAN_STATS_PERIOD_REBASE of them
+static inline bool can_stats_track_step(can_stats_slot_t *slot, uint32_t period, bool in_range)
+{
+    if (in_range) {
+        slot->step_count = 0;
+        slot->step_missed = 0;
+        return false;
+    }
+    uint32_t ref = slot->step_ref_us;
+    if (slot->step_count == 0 || period > ref + ref / 4 || period < ref - ref / 4) {
+        slot->step_ref_us = period;
+        slot->step_count = 0;
+        slot->step_missed = 0;
+    }
+    return ++slot->step_count >= CAN_STATS_PERIOD_REBASE;
+}
+
+static inline void can_stats_track_period(can_stats_slot_t *slot, int64_t timestamp_us)
+{
+    if (slot->rx_count > 1) {
+        uint32_t period = (uint32_t)(timestamp_us - slot->last_rx_us);
+        uint32_t mean = slot->period_mean_us;
+        bool judged = slot->period_count >= CAN_STATS_PERIOD_WARMUP && mean > 0;
+        bool long_gap = judged && period > mean + mean / 2;
+        if (judged && can_stats_track_step(slot, period, !long_gap && period >= mean / 2)) {
+            // The transmitter changed its period: the gaps of this run were
+            // not lost frames, and the old statistics no longer apply
+            slot->missed_periods -= slot->step_missed;
+            slot->period_count = 0;
+            slot->period_sum = 0;
+            slot->period_sum_sq = 0;
+            slot->step_count = 0;
+            slot->step_missed = 0;
+            long_gap = false;
+        }
+        if (long_gap) {
+            uint32_t missed = (period + mean / 2) / mean - 1;
+            slot->missed_periods += missed;
+            slot->step_missed += missed;
+        } else {
+            if (slot->period_count == 0) {
+                slot->period_ref_us = period;
+                slot->period_min_us = period;
+                slot->period_max_us = period;
+            }
+            int32_t deviation = (int32_t)(period - slot->period_ref_us);
+            slot->period_sum += deviation;
+            slot->period_sum_sq += (uint64_t)((int64_t)deviation * deviation);
+            slot->period_count++;
+            if (period < slot->period_min_us) {
+                slot->period_min_us = period;
+            }
+            if (period > slot->period_max_us) {
+                slot->period_max_us = period;
+            }
+            // The 64-bit divide is the expensive part; the mean only guides gap detection
+            if (slot->period_count <= CAN_STATS_PERIOD_WARMUP || (slot->period_count & 15) == 0) {
+                slot->period_mean_us = slot->period_ref_us + (int32_t)(slot->period_sum / (int32_t)slot->period_count);
+            }
+        }
+    }
+    slot->last_rx_us = timestamp_us;
+}
+
+void can_stats_record_rx(const twai_message_t *message, uint32_t rx_pending, int64_t timestamp_us)
+{
+    uint32_t bits = can_stats_frame_bits(message);
+    uint32_t key = can_stats_key(message);
+
+    taskENTER_CRITICAL(&stats_lock);
+    totals.rx_frames++;
+    window_bits += bits;
+    can_stats_slot_t *slot = can_stats_lookup(key);
+    if (slot) {
+        slot->rx_count++;
+        uint32_t start = esp_cpu_get_cycle_count();
+        can_stats_track_period(slot, timestamp_us);
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        rx_timing_cycles += cycles;
+        if (cycles > totals.rx_timing_cycles_max) {
+            totals.rx_timing_cycles_max = cycles;
+        }
+    } else {
+        totals.rx_other++;
+    }
+    // A frame that was queued behind others is stamped when it is dequeued, not when it arrived
+    if (last_rx_pending > 0) {
+        totals.rx_backlog_stamps++;
+    }
+    last_rx_pending = rx_pending;
+    // The frame just read was still queued a moment ago
+    if (rx_pending + 1 > totals.rx_queue_hwm) {
+        totals.rx_queue_hwm = rx_pending + 1;
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+esp_err_t can_stats_transmit(const twai_message_t *message, TickType_t ticks_to_wait)
+{
+    if (!tx_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(tx_mutex, portMAX_DELAY);
+    int64_t enqueue_us = esp_timer_get_time();
+    esp_err_t ret = twai_transmit(message, ticks_to_wait);
+
+    twai_status_info_t status;
+    bool have_status = (ret == ESP_OK) && twai_get_status_info(&status) == ESP_OK;
+    if (ret == ESP_OK && tx_pending_count < CAN_STATS_TX_PENDING_MAX) {
+        tx_pending[(tx_pending_head + tx_pending_count) % CAN_STATS_TX_PENDING_MAX] = enqueue_us;
+        tx_pending_count++;
+    }
+    xSemaphoreGive(tx_mutex);
+
+    uint32_t bits = can_stats_frame_bits(message);
+    uint32_t key = can_stats_key(message);
+
+    taskENTER_CRITICAL(&stats_lock);
+    if (ret == ESP_OK) {
+        totals.tx_frames++;
+        window_bits += bits;
+        can_stats_slot_t *slot = can_stats_lookup(key);
+        if (slot) {
+            slot->tx_count++;
+        } else {
+            totals.tx_other++;
+        }
+        if (have_status && status.msgs_to_tx > totals.tx_queue_hwm) {
+            totals.tx_queue_hwm = status.msgs_to_tx;
+        }
+    } else {
+        totals.tx_enqueue_failures++;
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+
+    return ret;
+}
+
+static inline uint32_t can_stats_latency_bucket(uint32_t latency_us)
+{
+    uint32_t bucket = 0;
+    while (latency_us > 1 && bucket < CAN_STATS_LATENCY_BUCKETS - 1) {
+        latency_us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+// Frames that left the driver since the last alert are the oldest pending
+// ones; a failed frame is not ACKed and only drops its timestamp.
+static void can_stats_complete_tx(bool failed)
+{
+    twai_status_info_t status;
+    int64_t now_us = esp_timer_get_time();
+
+    xSemaphoreTake(tx_mutex, portMAX_DELAY);
+    if (twai_get_status_info(&status) != ESP_OK) {
+        xSemaphoreGive(tx_mutex);
+        return;
+    }
+
+    uint32_t completed = tx_pending_count > status.msgs_to_tx ? tx_pending_count - status.msgs_to_tx : 0;
+    for (uint32_t i = 0; i < completed; i++) {
+        uint32_t latency_us = (uint32_t)(now_us - tx_pending[tx_pending_head]);
+        tx_pending_head = (tx_pending_head + 1) % CAN_STATS_TX_PENDING_MAX;
+        tx_pending_count--;
+
+        if (failed && i == completed - 1) {
+            continue;
+        }
+        taskENTER_CRITICAL(&stats_lock);
+        totals.latency_hist[can_stats_latency_bucket(latency_us)]++;
+        totals.latency_samples++;
+        if (latency_us > totals.latency_max_us) {
+            totals.latency_max_us = latency_us;
+        }
+        taskEXIT_CRITICAL(&stats_lock);
+    }
+    xSemaphoreGive(tx_mutex);
+}
+
+static void can_stats_roll_window(int64_t elapsed_us)
+{
+    taskENTER_CRITICAL(&stats_lock);
+    uint64_t window_us = elapsed_us > 0 ? (uint64_t)elapsed_us : 1;
+    for (int i = 0; i < CAN_STATS_MAX_IDS; i++) {
+        can_stats_slot_t *slot = &slots[i];
+        if (slot->key == CAN_STATS_EMPTY_SLOT) {
+            continue;
+        }
+        slot->tx_per_sec = (uint32_t)((uint64_t)(slot->tx_count - slot->tx_window_base) * 1000000 / window_us);
+        slot->rx_per_sec = (uint32_t)((uint64_t)(slot->rx_count - slot->rx_window_base) * 1000000 / window_us);
+        slot->tx_window_base = slot->tx_count;
+        slot->rx_window_base = slot->rx_count;
+    }
+    totals.tx_per_sec = (uint32_t)((uint64_t)(totals.tx_frames - tx_window_base) * 1000000 / window_us);
+    totals.rx_per_sec = (uint32_t)((uint64_t)(totals.rx_frames - rx_window_base) * 1000000 / window_us);
+    tx_window_base = totals.tx_frames;
+    rx_window_base = totals.rx_frames;
+    if (totals.bitrate > 0) {
+        // bits * 1000 / (bitrate * seconds)
+        totals.bus_load_permille = (uint32_t)(window_bits * 1000 * 1000000 / ((uint64_t)totals.bitrate * window_us));
+    }
+    window_bits = 0;
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+static void can_stats_task(void *pvParameters)
+{
+    int64_t window_start = esp_timer_get_time();
+
+    while (1) {
+        if (can_driver_acquire()) {
+            uint32_t alerts = 0;
+            if (twai_read_alerts(&alerts, pdMS_TO_TICKS(100)) == ESP_OK) {
+                if (alerts & (TWAI_ALERT_TX_SUCCESS | TWAI_ALERT_TX_FAILED)) {
+                    can_stats_complete_tx(alerts & TWAI_ALERT_TX_FAILED);
+                }
+                if (alerts & TWAI_ALERT_RX_QUEUE_FULL) {
+                    taskENTER_CRITICAL(&stats_lock);
+                    totals.rx_queue_full_alerts++;
+                    taskEXIT_CRITICAL(&stats_lock);
+                }
+                if (alerts & (TWAI_ALERT_BUS_OFF | TWAI_ALERT_BUS_RECOVERED)) {
+                    // Still inside the gate, so a CLI reinstall cannot interleave
+                    can_driver_recover();
+                }
+            }
+            can_driver_release();
+        } else {
+            // Driver down or owned by a benchmark: forget in-flight frames
+            xSemaphoreTake(tx_mutex, portMAX_DELAY);
+            tx_pending_count = 0;
+            xSemaphoreGive(tx_mutex);
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+
+        int64_t now = esp_timer_get_time();
+        if (now - window_start >= (int64_t)CAN_STATS_WINDOW_MS * 1000) {
+            can_stats_roll_window(now - window_start);
+            window_start = now;
+        }
+    }
+}
+
+esp_err_t can_stats_start(void)
+{
+    if (stats_task_handle) {
+        return ESP_OK;
+    }
+    if (!tx_mutex) {
+        return ESP_ERR_INVALID_STATE;   // can_stats_init() not called
+    }
+    if (xTaskCreate(can_stats_task, "can_stats_task", CAN_STATS_TASK_STACK_SIZE, NULL,
+                    CAN_STATS_TASK_PRIORITY, &stats_task_handle) != pdPASS) {
+        ESP_LOGE(TAG_CAN_STATS, "Failed to create statistics task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void can_stats_get_summary(can_stats_summary_t *out_summary)
+{
+    if (!out_summary) {
+        return;
+    }
+    taskENTER_CRITICAL(&stats_lock);
+    *out_summary = totals;
+    uint32_t timed_frames = totals.rx_frames - totals.rx_other;
+    out_summary->rx_timing_cycles_avg = timed_frames ? (uint32_t)(rx_timing_cycles / timed_frames) : 0;
+    taskEXIT_CRITICAL(&stats_lock);
+
+    out_summary->driver_running = false;
+    if (can_driver_acquire()) {
+        out_summary->driver_running = twai_get_status_info(&out_summary->status) == ESP_OK;
+        can_driver_release();
+    }
+}
+
+size_t can_stats_get_ids(can_stats_id_t *out_ids, size_t max_ids)
+{
+    size_t count = 0;
+    // On the caller's stack (640 bytes) so the CLI and the CAN request path can both call in
+    int64_t period_sums[CAN_STATS_MAX_IDS];
+    uint64_t period_sum_sqs[CAN_STATS_MAX_IDS];
+    uint32_t period_refs[CAN_STATS_MAX_IDS];
+
+    taskENTER_CRITICAL(&stats_lock);
+    for (int i = 0; i < CAN_STATS_MAX_IDS && count < max_ids; i++) {
+        if (slots[i].key == CAN_STATS_EMPTY_SLOT) {
+            continue;
+        }
+        out_ids[count].identifier = slots[i].key & 0x1FFFFFFF;
+        out_ids[count].extended = (slots[i].key & 0x80000000u) != 0;
+        out_ids[count].tx_count = slots[i].tx_count;
+        out_ids[count].rx_count = slots[i].rx_count;
+        out_ids[count].tx_per_sec = slots[i].tx_per_sec;
+        out_ids[count].rx_per_sec = slots[i].rx_per_sec;
+        out_ids[count].period_samples = slots[i].period_count;
+        out_ids[count].period_min_us = slots[i].period_min_us;
+        out_ids[count].period_max_us = slots[i].period_max_us;
+        out_ids[count].missed_periods = slots[i].missed_periods;
+        // Raw sums are turned into mean and deviation outside the critical section
+        period_sums[count] = slots[i].period_sum;
+        period_sum_sqs[count] = slots[i].period_sum_sq;
+        period_refs[count] = slots[i].period_ref_us;
+        count++;
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t n = out_ids[i].period_samples;
+        if (n == 0) {
+            out_ids[i].period_mean_us = 0;
+            out_ids[i].period_stddev_us = 0;
+            continue;
+        }
+        double mean_deviation = (double)period_sums[i] / n;
+        double variance = (double)period_sum_sqs[i] / n - mean_deviation * mean_deviation;
+        out_ids[i].period_mean_us = (uint32_t)(period_refs[i] + mean_deviation + 0.5);
+        out_ids[i].period_stddev_us = variance > 0 ? (uint32_t)(sqrt(variance) + 0.5) : 0;
+    }
+
+    // Busiest first; the table is small so insertion sort is fine
+    for (size_t i = 1; i < count; i++) {
+        can_stats_id_t entry = out_ids[i];
+        uint32_t total = entry.tx_count + entry.rx_count;
+        size_t j = i;
+        while (j > 0 && out_ids[j - 1].tx_count + out_ids[j - 1].rx_count < total) {
+            out_ids[j] = out_ids[j - 1];
+            j--;
+        }
+        out_ids[j] = entry;
+    }
+    return count;
+}
+
+uint32_t can_stats_latency_percentile(const can_stats_summary_t *summary, uint32_t percentile)
+{
+    if (!summary || summary->latency_samples == 0) {
+        return 0;
+    }
+
+    uint64_t target = ((uint64_t)summary->latency_samples * percentile + 99) / 100;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < CAN_STATS_LATENCY_BUCKETS; bucket++) {
+        seen += summary->latency_hist[bucket];
+        if (seen >= target) {
+            uint32_t upper = 1u << (bucket + 1);
+            return upper < summary->latency_max_us ? upper : summary->latency_max_us;
+        }
+    }
+    return summary->latency_max_us;
+}
+
+static inline void put_u16(uint8_t *dst, uint32_t value)
+{
+    if (value > UINT16_MAX) {
+        value = UINT16_MAX;
+    }
+    dst[0] = value & 0xFF;
+    dst[1] = (value >> 8) & 0xFF;
+}
+
+static inline void put_u32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = value & 0xFF;
+    dst[1] = (value >> 8) & 0xFF;
+    dst[2] = (value >> 16) & 0xFF;
+    dst[3] = (value >> 24) & 0xFF;
+}
+
+static inline uint8_t sat_u8(uint32_t value)
+{
+    return value > UINT8_MAX ? UINT8_MAX : (uint8_t)value;
+}
+
+bool can_stats_handle_request(const twai_message_t *message)
+{
+    if (message->identifier != CAN_STATS_REQUEST_ID || message->extd ||
+        message->rtr || message->data_length_code < 1) {
+        return false;
+    }
+
+    can_stats_summary_t summary;
+    can_stats_get_summary(&summary);
+
+    twai_message_t response = {0};
+    response.identifier = CAN_STATS_RESPONSE_ID;
+    response.data_length_code = 8;
+    response.data[0] = message->data[0];
+    uint8_t *p = &response.data[1];
+
+    switch (message->data[0]) {
+        case 0:
+            put_u32(p, summary.tx_frames);
+            put_u16(p + 4, summary.tx_enqueue_failures);
+            break;
+        case 1:
+            put_u32(p, summary.rx_frames);
+            put_u16(p + 4, summary.rx_other);
+            break;
+        case 2:
+            put_u16(p, summary.bus_load_permille);
+            p[2] = sat_u8(summary.tx_queue_hwm);
+            p[3] = sat_u8(summary.rx_queue_hwm);
+            p[4] = sat_u8(summary.status.tx_error_counter);
+            p[5] = sat_u8(summary.status.rx_error_counter);
+            break;
+        case 3:
+            put_u16(p, can_stats_latency_percentile(&summary, 50));
+            put_u16(p + 2, can_stats_latency_percentile(&summary, 99));
+            put_u16(p + 4, summary.latency_max_us);
+            break;
+        case 4:
+            put_u16(p, summary.status.rx_missed_count);
+            put_u16(p + 2, summary.status.rx_overrun_count);
+            put_u16(p + 4, summary.status.bus_error_count);
+            break;
+        default:
+            return true;    // unknown page: consumed, no answer
+    }
+
+    if (can_stats_transmit(&response, 0) != ESP_OK) {
+        ESP_LOGW(TAG_CAN_STATS, "Failed to queue statistics response (page %u)", message->data[0]);
+    }
+    return true;
+}
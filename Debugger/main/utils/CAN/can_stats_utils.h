@@ -0,0 +1,143 @@
+#ifndef CAN_STATS_UTILS_H
+#define CAN_STATS_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+#include "freertos/FreeRTOS.h"
+
+/*
+ * Always-on CAN instrumentation.
+ *
+ * Hot-path cost is a short critical section per frame: a hashed per-ID
+ * counter update and a frame-length add. Rates and bus load are computed
+ * once per CAN_STATS_WINDOW_MS by the statistics task, which also turns
+ * TX_SUCCESS/TX_FAILED alerts into enqueue-to-ACK latency samples.
+ *
+ * Received frames also carry a microsecond timestamp taken when the
+ * receive task wakes from twai_receive(). Per ID the inter-arrival
+ * period is tracked incrementally with integer arithmetic: mean, min,
+ * max and standard deviation (sums of deviations from the first period,
+ * so nothing overflows or cancels). Once CAN_STATS_PERIOD_WARMUP periods
+ * are known, a gap longer than 1.5 mean periods counts as missed frames
+ * instead of a period sample. CAN_STATS_PERIOD_REBASE similar periods in a
+ * row outside half to 1.5 times the mean are taken as a new period: the
+ * statistics restart from it and the gaps of that run are not counted
+ * as missed.
+ */
+#define CAN_STATS_MAX_IDS           32      // further IDs are counted as "other"
+#define CAN_STATS_LATENCY_BUCKETS   16      // log2 buckets, bucket n < 2^(n+1) µs
+#define CAN_STATS_TX_PENDING_MAX    32      // enqueue timestamps awaiting ACK
+#define CAN_STATS_WINDOW_MS         1000
+#define CAN_STATS_TASK_STACK_SIZE   3072
+#define CAN_STATS_TASK_PRIORITY     4
+#define CAN_STATS_PERIOD_WARMUP     4       // periods averaged before gaps are judged
+#define CAN_STATS_PERIOD_REBASE     8       // similar off-mean periods that start a new baseline
+
+typedef struct {
+    uint32_t identifier;
+    bool extended;
+    uint32_t tx_count;
+    uint32_t rx_count;
+    uint32_t tx_per_sec;        // last complete window
+    uint32_t rx_per_sec;
+    uint32_t period_samples;    // inter-arrival periods measured
+    uint32_t period_mean_us;
+    uint32_t period_min_us;
+    uint32_t period_max_us;
+    uint32_t period_stddev_us;
+    uint32_t missed_periods;    // frames presumed lost from gaps in a periodic ID
+} can_stats_id_t;
+
+typedef struct {
+    bool driver_running;
+    uint32_t bitrate;
+    uint32_t tx_frames;
+    uint32_t rx_frames;
+    uint32_t tx_enqueue_failures;
+    uint32_t tx_other;          // frames whose ID did not fit the per-ID table
+    uint32_t rx_other;
+    uint32_t tx_per_sec;
+    uint32_t rx_per_sec;
+    uint32_t bus_load_permille; // worst-case bit stuffing, last window
+    uint32_t tx_queue_hwm;
+    uint32_t rx_queue_hwm;
+    uint32_t rx_queue_full_alerts;
+    uint32_t rx_backlog_stamps;     // timestamps taken after the frame had waited behind others
+    uint32_t rx_timing_cycles_avg;  // CPU cycles per frame for period tracking
+    uint32_t rx_timing_cycles_max;
+    uint32_t latency_samples;
+    uint32_t latency_max_us;
+    uint32_t latency_hist[CAN_STATS_LATENCY_BUCKETS];
+    twai_status_info_t status;  // valid when driver_running
+} can_stats_summary_t;
+
+/**
+ * @brief Reset all counters and set the bitrate used for bus load.
+ */
+void can_stats_init(uint32_t bitrate);
+void can_stats_set_bitrate(uint32_t bitrate);
+void can_stats_reset(void);
+
+/**
+ * @brief Start the task that consumes TX alerts and rolls the rate window.
+ */
+esp_err_t can_stats_start(void);
+
+/**
+ * @brief Account a received frame.
+ *
+ * @param rx_pending   msgs_to_rx after the read
+ * @param timestamp_us esp_timer time at which twai_receive() returned it
+ */
+void can_stats_record_rx(const twai_message_t *message, uint32_t rx_pending, int64_t timestamp_us);
+
+/**
+ * @brief twai_transmit() with TX accounting and latency tracking.
+ */
+esp_err_t can_stats_transmit(const twai_message_t *message, TickType_t ticks_to_wait);
+
+/**
+ * @brief Answer a statistics request frame on CAN_STATS_RESPONSE_ID.
+ *
+ * Request: CAN_STATS_REQUEST_ID, data[0] = page. Response data[0] echoes
+ * the page, followed by little-endian fields:
+ *   0: tx_frames u32, tx_enqueue_failures u16
+ *   1: rx_frames u32, rx_other u16
+ *   2: bus_load_permille u16, tx_queue_hwm u8, rx_queue_hwm u8, TEC u8, REC u8
+ *   3: latency p50 u16, p99 u16, max u16 (µs, saturated)
+ *   4: rx_missed u16, rx_overrun u16, bus_errors u16
+ *
+ * @return true if the frame was a statistics request.
+ */
+bool can_stats_handle_request(const twai_message_t *message);
+
+void can_stats_get_summary(can_stats_summary_t *out_summary);
+
+/**
+ * @brief Copy the per-ID table, busiest first.
+ * @return Number of entries written.
+ */
+size_t can_stats_get_ids(can_stats_id_t *out_ids, size_t max_ids);
+
+/**
+ * @brief Upper bound in µs of the bucket holding the given percentile.
+ */
+uint32_t can_stats_latency_percentile(const can_stats_summary_t *summary, uint32_t percentile);
+
+/**
+ * @brief Bits on the wire for a frame, including worst-case stuff bits
+ *        and the 3-bit interframe space.
+ */
+static inline uint32_t can_stats_frame_bits(const twai_message_t *message)
+{
+    uint32_t payload = message->rtr ? 0 : 8u * message->data_length_code;
+    if (message->extd) {
+        return 67 + payload + (54 + payload - 1) / 4;
+    }
+    return 47 + payload + (34 + payload - 1) / 4;
+}
+
+#endif // CAN_STATS_UTILS_H
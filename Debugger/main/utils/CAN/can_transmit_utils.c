@@ -1,5 +1,6 @@
 #include "can_transmit_utils.h"
 #include "can_config.h" // For temperature_queue and TEMP_CAN_ID
+#include "can_driver_utils.h"
 #include "driver/twai.h"
 #include "esp_log.h"
 #include <string.h> // For memcpy
@@ -26,19 +27,20 @@ void can_transmit_task(void *pvParameters) {
                 message.data[i] = 0;
             }
 
-            // Transmit CAN message
+            // Transmit CAN message inside the driver gate, like the background tasks
+            if (!can_driver_acquire()) {
+                ESP_LOGW(TAG_CAN_TX, "CAN driver not running, sample dropped");
+                continue;
+            }
             esp_err_t ret = twai_transmit(&message, pdMS_TO_TICKS(1000)); // Wait 1 second max for TX
             if (ret == ESP_OK) {
-                ESP_LOGI(TAG_CAN_TX, "Message transmitted: ID=0x%03lX, Temp=%.2f C", message.identifier, temperature_c);
+                ESP_LOGI(TAG_CAN_TX, "Message transmitted: ID=0x%03lX, Temp=%.2f C", (unsigned long)message.identifier, temperature_c);
             } else {
                 ESP_LOGE(TAG_CAN_TX, "Failed to transmit message: %s", esp_err_to_name(ret));
-                // Handle specific errors like TWAI_ERR_TX_QUEUE_FULL or TWAI_ERR_BUS_OFF
-                if (ret == TWAI_ALERT_BUS_OFF) {
-                    ESP_LOGW(TAG_CAN_TX, "CAN Bus is off, attempting recovery...");
-                    // Attempt to recover bus-off state (optional, requires careful implementation)
-                    // For simplicity, we just log here. Recovery might involve twai_initiate_recovery().
-                }
+                // A bus-off controller rejects or times out frames; the state says which
+                can_driver_recover();
             }
+            can_driver_release();
         }
         // Small delay to allow other tasks to run, especially if queue is empty for a while (though portMAX_DELAY handles blocking)
         vTaskDelay(pdMS_TO_TICKS(10)); 
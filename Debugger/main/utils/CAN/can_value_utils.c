@@ -0,0 +1,127 @@
+#include "can_value_utils.h"
+#include "esp_timer.h"
+#include <stdatomic.h>
+
+_Static_assert((CAN_VALUE_HASH_SLOTS & (CAN_VALUE_HASH_SLOTS - 1)) == 0, "CAN_VALUE_HASH_SLOTS must be a power of two");
+_Static_assert(CAN_VALUE_HASH_SLOTS > CAN_VALUE_MAX_ENTRIES, "hash table needs free slots");
+
+typedef struct {
+    atomic_uint sequence;       // odd while the writer is mid-update
+    float value;
+    int64_t timestamp_us;
+} can_value_entry_t;
+
+static can_value_def_t defs[CAN_VALUE_MAX_ENTRIES];
+static can_value_entry_t entries[CAN_VALUE_MAX_ENTRIES];
+static size_t entry_count = 0;
+
+// Index + 1 into defs/entries, 0 = empty
+static uint8_t hash_table[CAN_VALUE_HASH_SLOTS];
+
+static inline uint32_t can_value_key(uint32_t identifier, bool extended, uint8_t signal)
+{
+    return (identifier | (extended ? 0x80000000u : 0)) * 2654435761u + signal * 40503u;
+}
+
+static uint8_t *can_value_slot(uint32_t identifier, bool extended, uint8_t signal, bool *found)
+{
+    uint32_t index = can_value_key(identifier, extended, signal) & (CAN_VALUE_HASH_SLOTS - 1);
+    for (uint32_t probe = 0; probe < CAN_VALUE_HASH_SLOTS; probe++) {
+        uint8_t *slot = &hash_table[(index + probe) & (CAN_VALUE_HASH_SLOTS - 1)];
+        if (*slot == 0) {
+            *found = false;
+            return slot;
+        }
+        const can_value_def_t *def = &defs[*slot - 1];
+        if (def->identifier == identifier && def->extended == extended && def->signal == signal) {
+            *found = true;
+            return slot;
+        }
+    }
+    *found = false;
+    return NULL;
+}
+
+can_value_handle_t can_value_register(const can_value_def_t *def)
+{
+    if (def == NULL || entry_count >= CAN_VALUE_MAX_ENTRIES) {
+        return -1;
+    }
+    bool found;
+    uint8_t *slot = can_value_slot(def->identifier, def->extended, def->signal, &found);
+    if (slot == NULL || found) {
+        return -1;
+    }
+
+    can_value_handle_t handle = (can_value_handle_t)entry_count;
+    defs[handle] = *def;
+    atomic_store(&entries[handle].sequence, 0);
+    entries[handle].value = 0.0f;
+    entries[handle].timestamp_us = 0;
+    entry_count++;
+    *slot = (uint8_t)(handle + 1);
+    return handle;
+}
+
+can_value_handle_t can_value_find(uint32_t identifier, bool extended, uint8_t signal)
+{
+    bool found;
+    uint8_t *slot = can_value_slot(identifier, extended, signal, &found);
+    return found ? *slot - 1 : -1;
+}
+
+void can_value_update(can_value_handle_t handle, float value, int64_t timestamp_us)
+{
+    if (handle < 0 || (size_t)handle >= entry_count) {
+        return;
+    }
+    can_value_entry_t *entry = &entries[handle];
+    uint32_t sequence = atomic_load_explicit(&entry->sequence, memory_order_relaxed);
+
+    atomic_store_explicit(&entry->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    entry->value = value;
+    entry->timestamp_us = timestamp_us;
+    atomic_store_explicit(&entry->sequence, sequence + 2, memory_order_release);
+}
+
+bool can_value_read(can_value_handle_t handle, can_value_t *out_value)
+{
+    if (handle < 0 || (size_t)handle >= entry_count || out_value == NULL) {
+        return false;
+    }
+    const can_value_entry_t *entry = &entries[handle];
+    uint32_t before, after;
+    float value;
+    int64_t timestamp_us;
+
+    do {
+        before = atomic_load_explicit(&entry->sequence, memory_order_acquire);
+        value = entry->value;
+        timestamp_us = entry->timestamp_us;
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&entry->sequence, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    out_value->value = value;
+    out_value->timestamp_us = timestamp_us;
+    out_value->sequence = before / 2;
+
+    uint32_t max_age_ms = defs[handle].max_age_ms;
+    out_value->stale = out_value->sequence == 0 ||
+                       (max_age_ms > 0 && esp_timer_get_time() - timestamp_us > (int64_t)max_age_ms * 1000);
+    return true;
+}
+
+const can_value_def_t *can_value_get_def(can_value_handle_t handle)
+{
+    if (handle < 0 || (size_t)handle >= entry_count) {
+        return NULL;
+    }
+    return &defs[handle];
+}
+
+size_t can_value_count(void)
+{
+    return entry_count;
+}
@@ -0,0 +1,74 @@
+#ifndef CAN_VALUE_UTILS_H
+#define CAN_VALUE_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Last-value cache for decoded CAN signals.
+ *
+ * Each entry holds the latest physical value of one signal with its
+ * receive timestamp and update count. The RX path writes entries; any
+ * task reads them in O(1) without locks through a per-entry seqlock:
+ * the writer makes the sequence odd, updates the fields and makes it
+ * even again, and a reader retries if the sequence was odd or changed
+ * while it copied. Readers never block the writer.
+ *
+ * Each entry must have a single writer (the receive task). Register all
+ * signals at start-up, before the receive task runs.
+ */
+#define CAN_VALUE_MAX_ENTRIES   32
+#define CAN_VALUE_HASH_SLOTS    64      // power of two, > CAN_VALUE_MAX_ENTRIES
+
+typedef int can_value_handle_t;         // index, -1 if invalid
+
+typedef struct {
+    const char *name;
+    const char *unit;
+    uint32_t identifier;
+    bool extended;
+    uint8_t signal;             // signal index within the message
+    uint32_t max_age_ms;        // older values read as stale; 0 = never
+} can_value_def_t;
+
+typedef struct {
+    float value;
+    int64_t timestamp_us;       // esp_timer time of the frame that carried it
+    uint32_t sequence;          // number of updates so far, 0 = never written
+    bool stale;                 // older than max_age_ms, or never written
+} can_value_t;
+
+/**
+ * @brief Add a signal to the cache.
+ *
+ * @return Handle for update/read, or -1 if the cache is full or the
+ *         ID/signal pair is already registered.
+ */
+can_value_handle_t can_value_register(const can_value_def_t *def);
+
+/**
+ * @brief Look up a handle by ID and signal index (O(1) hash).
+ */
+can_value_handle_t can_value_find(uint32_t identifier, bool extended, uint8_t signal);
+
+/**
+ * @brief Store a new value. Single writer per entry.
+ */
+void can_value_update(can_value_handle_t handle, float value, int64_t timestamp_us);
+
+/**
+ * @brief Lock-free consistent read of an entry.
+ *
+ * @return false for an invalid handle.
+ */
+bool can_value_read(can_value_handle_t handle, can_value_t *out_value);
+
+/**
+ * @brief Registered definition for a handle, or NULL.
+ */
+const can_value_def_t *can_value_get_def(can_value_handle_t handle);
+
+size_t can_value_count(void);
+
+#endif // CAN_VALUE_UTILS_H
@@ -1,5 +1,6 @@
 #include "cli_commands.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "driver/i2c.h"
 #include <string.h>
@@ -7,7 +8,14 @@
 
 // Include your utility headers
 #include "../ADC/adc_utils.h"
+#include "../CAN/can_config.h"
 #include "../CAN/can_driver_utils.h"
+#include "../CAN/can_stats_utils.h"
+#include "../CAN/can_capture_utils.h"
+#include "../CAN/can_replay_utils.h"
+#include "../CAN/can_value_utils.h"
+#include "../CAN/can_receive_utils.h"
+#include "../CAN/can_autobaud_utils.h"
 #include "../TempSensor/temp_sensor.h"
 #include "../AD5693/ad5693_utils.h"
 
@@ -25,6 +33,53 @@ static struct {
     struct arg_end *end;
 } can_send_args;
 
+static struct {
+    struct arg_lit *ids;
+    struct arg_lit *timing;
+    struct arg_lit *reset;
+    struct arg_end *end;
+} can_status_args;
+
+static struct {
+    struct arg_int *bitrate;
+    struct arg_int *brp;
+    struct arg_int *tseg_1;
+    struct arg_int *tseg_2;
+    struct arg_int *sjw;
+    struct arg_int *rx_queue;
+    struct arg_int *tx_queue;
+    struct arg_str *mode;
+    struct arg_lit *save;
+    struct arg_lit *defaults;
+    struct arg_lit *list;
+    struct arg_end *end;
+} can_config_args;
+
+static struct {
+    struct arg_str *order;
+    struct arg_int *dwell;
+    struct arg_int *dwell_max;
+    struct arg_int *timeout;
+    struct arg_int *lock_frames;
+    struct arg_lit *apply;
+    struct arg_end *end;
+} can_autobaud_args;
+
+static struct {
+    struct arg_str *action;
+    struct arg_int *file_kb;
+    struct arg_int *max_files;
+    struct arg_end *end;
+} can_capture_args;
+
+static struct {
+    struct arg_str *file;
+    struct arg_dbl *speed;
+    struct arg_lit *fast;
+    struct arg_int *loops;
+    struct arg_end *end;
+} can_replay_args;
+
 static struct {
     struct arg_int *value;
     struct arg_end *end;
@@ -51,6 +106,43 @@ void cli_register_utility_commands(void)
     can_send_args.data = arg_str1("d", "data", "<hex>", "Data in hex format (e.g., 01020304)");
     can_send_args.end = arg_end(3);
 
+    can_status_args.ids = arg_lit0("i", "ids", "Show per-ID counters");
+    can_status_args.timing = arg_lit0("t", "timing", "Show per-ID RX period and jitter");
+    can_status_args.reset = arg_lit0("r", "reset", "Reset counters after printing");
+    can_status_args.end = arg_end(4);
+
+    can_config_args.bitrate = arg_int0("b", "bitrate", "<kbps>", "Preset bitrate: 125, 250, 500, 800 or 1000");
+    can_config_args.brp = arg_int0(NULL, "brp", "<2-128>", "Custom timing: prescaler (even)");
+    can_config_args.tseg_1 = arg_int0(NULL, "tseg1", "<1-16>", "Custom timing: time segment 1 in quanta");
+    can_config_args.tseg_2 = arg_int0(NULL, "tseg2", "<1-8>", "Custom timing: time segment 2 in quanta");
+    can_config_args.sjw = arg_int0(NULL, "sjw", "<1-4>", "Custom timing: synchronization jump width");
+    can_config_args.rx_queue = arg_int0(NULL, "rxq", "<len>", "Driver RX queue length");
+    can_config_args.tx_queue = arg_int0(NULL, "txq", "<len>", "Driver TX queue length");
+    can_config_args.mode = arg_str0("m", "mode", "<normal|noack|listen>", "Controller mode");
+    can_config_args.save = arg_lit0("s", "save", "Store the resulting settings in NVS");
+    can_config_args.defaults = arg_lit0("d", "defaults", "Erase stored settings and apply the built-in defaults");
+    can_config_args.list = arg_lit0("l", "list", "List preset bitrates");
+    can_config_args.end = arg_end(12);
+
+    can_autobaud_args.order = arg_str0("o", "order", "<kbps,...>", "Scan order (default: 500,250,125,1000,800)");
+    can_autobaud_args.dwell = arg_int0("w", "dwell", "<ms>", "Listen time per bitrate on the first pass");
+    can_autobaud_args.dwell_max = arg_int0(NULL, "dwell-max", "<ms>", "Upper bound as the dwell doubles on a quiet bus");
+    can_autobaud_args.timeout = arg_int0("t", "timeout", "<ms>", "Give up after this long");
+    can_autobaud_args.lock_frames = arg_int0("n", "lock-frames", "<num>", "Error-free frames that lock at once");
+    can_autobaud_args.apply = arg_lit0("a", "apply", "Reinstall the driver at the detected bitrate");
+    can_autobaud_args.end = arg_end(7);
+
+    can_capture_args.action = arg_str1(NULL, NULL, "<start|stop|status>", "Capture action");
+    can_capture_args.file_kb = arg_int0("s", "file-size", "<KiB>", "Rotate files at this size (default: 512)");
+    can_capture_args.max_files = arg_int0("n", "max-files", "<num>", "Keep at most this many files (default: 8)");
+    can_capture_args.end = arg_end(4);
+
+    can_replay_args.file = arg_str1("f", "file", "<path>", "Capture file, e.g. /capture/CAN00001.BIN");
+    can_replay_args.speed = arg_dbl0("x", "speed", "<factor>", "Time compression, 10 = ten times faster (default: 1)");
+    can_replay_args.fast = arg_lit0("a", "asap", "Send as fast as possible, ignoring timestamps");
+    can_replay_args.loops = arg_int0("l", "loops", "<num>", "Play the file this many times (default: 1)");
+    can_replay_args.end = arg_end(5);
+
     dac_set_args.value = arg_int1("v", "value", "<0-4095>", "DAC value (12-bit)");
     dac_set_args.end = arg_end(2);
 
@@ -89,7 +181,7 @@ void cli_register_utility_commands(void)
         },
         {
             .command = "can-recv",
-            .help = "Receive CAN messages",
+            .help = "Show latest decoded CAN values",
             .hint = NULL,
             .func = cmd_can_receive,
             .argtable = NULL
@@ -99,13 +191,41 @@ void cli_register_utility_commands(void)
             .help = "Show CAN bus status",
             .hint = NULL,
             .func = cmd_can_status,
-            .argtable = NULL
+            .argtable = &can_status_args
+        },
+        {
+            .command = "can-config",
+            .help = "Show or change CAN bitrate, timing, queues and mode",
+            .hint = NULL,
+            .func = cmd_can_config,
+            .argtable = &can_config_args
+        },
+        {
+            .command = "can-autobaud",
+            .help = "Detect the bus bitrate in listen-only mode",
+            .hint = NULL,
+            .func = cmd_can_autobaud,
+            .argtable = &can_autobaud_args
+        },
+        {
+            .command = "can-capture",
+            .help = "Record received CAN frames to flash",
+            .hint = NULL,
+            .func = cmd_can_capture,
+            .argtable = &can_capture_args
+        },
+        {
+            .command = "can-replay",
+            .help = "Retransmit a can-capture file with its original timing",
+            .hint = NULL,
+            .func = cmd_can_replay,
+            .argtable = &can_replay_args
         },
         
         // Temperature Sensor Commands
         {
             .command = "temp-read",
-            .help = "Read temperature sensor",
+            .help = "Show latest temperature received on CAN",
             .hint = NULL,
             .func = cmd_temp_read,
             .argtable = NULL
@@ -204,9 +324,33 @@ int cmd_can_send(int argc, char **argv)
 
     uint32_t can_id = can_send_args.id->ival[0];
     const char *hex_data = can_send_args.data->sval[0];
-    
+    size_t hex_len = strlen(hex_data);
+
+    if (can_id > 0x1FFFFFFF || hex_len % 2 != 0 || hex_len / 2 > TWAI_FRAME_MAX_DLC) {
+        cli_printf_error("Invalid ID or data (up to 8 bytes as hex pairs)\n");
+        return 1;
+    }
+
+    twai_message_t message = {0};
+    message.identifier = can_id;
+    message.extd = can_id > 0x7FF;
+    message.data_length_code = hex_len / 2;
+    for (size_t i = 0; i < message.data_length_code; i++) {
+        char byte_str[3] = { hex_data[2 * i], hex_data[2 * i + 1], '\0' };
+        char *end;
+        message.data[i] = (uint8_t)strtoul(byte_str, &end, 16);
+        if (*end != '\0') {
+            cli_printf_error("Invalid hex data: %s\n", hex_data);
+            return 1;
+        }
+    }
+
     cli_printf("Sending CAN message ID: 0x%X, Data: %s\n", can_id, hex_data);
-    // Implement CAN transmission using your can_transmit_utils
+    esp_err_t ret = can_stats_transmit(&message, pdMS_TO_TICKS(100));
+    if (ret != ESP_OK) {
+        cli_printf_error("CAN transmit failed: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
     cli_printf_success("CAN message sent successfully\n");
     
     return 0;
@@ -214,30 +358,484 @@ int cmd_can_send(int argc, char **argv)
 
 int cmd_can_receive(int argc, char **argv)
 {
-    cli_printf("Listening for CAN messages (Press Ctrl+C to stop)...\n");
-    // Implement CAN reception using your can_receive_utils
-    cli_printf("Received CAN ID: 0x123, Data: [01 02 03 04]\n"); // Placeholder
+    size_t count = can_value_count();
+    if (count == 0) {
+        cli_printf("No CAN signals registered\n");
+        return 0;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    cli_printf("%-20s %-6s %12s %-4s %10s %8s\n", "Signal", "ID", "Value", "Unit", "Age ms", "Updates");
+    for (can_value_handle_t handle = 0; handle < (can_value_handle_t)count; handle++) {
+        const can_value_def_t *def = can_value_get_def(handle);
+        can_value_t value;
+        can_value_read(handle, &value);
+        if (value.sequence == 0) {
+            cli_printf("%-20s 0x%03lX %12s %-4s %10s %8s\n", def->name, def->identifier, "-", def->unit, "-", "0");
+            continue;
+        }
+        cli_printf("%-20s 0x%03lX %12.2f %-4s %10lld %8lu%s\n", def->name, def->identifier, value.value, def->unit,
+                   (now_us - value.timestamp_us) / 1000, value.sequence, value.stale ? " stale" : "");
+    }
     return 0;
 }
 
+static const char *can_state_to_name(twai_state_t state)
+{
+    switch (state) {
+        case TWAI_STATE_STOPPED:    return "Stopped";
+        case TWAI_STATE_RUNNING:    return "Active";
+        case TWAI_STATE_BUS_OFF:    return "Bus-off";
+        case TWAI_STATE_RECOVERING: return "Recovering";
+        default:                    return "Unknown";
+    }
+}
+
 int cmd_can_status(int argc, char **argv)
 {
+    int nerrors = arg_parse(argc, argv, (void **) &can_status_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, can_status_args.end, argv[0]);
+        return 1;
+    }
+
+    can_stats_summary_t stats;
+    can_stats_get_summary(&stats);
+
     cli_printf("CAN Bus Status:\n");
-    cli_printf("- State: Active\n");
-    cli_printf("- Bitrate: 500 kbps\n");
-    cli_printf("- TX Count: 123\n");
-    cli_printf("- RX Count: 456\n");
-    cli_printf("- Error Count: 0\n");
+    if (stats.driver_running) {
+        const twai_status_info_t *st = &stats.status;
+        const char *passive = (st->tx_error_counter >= 128 || st->rx_error_counter >= 128) ? " (error passive)" : "";
+        cli_printf("- State: %s%s\n", can_state_to_name(st->state), passive);
+    } else {
+        cli_printf("- State: Driver not running\n");
+    }
+    cli_printf("- Bitrate: %lu kbps\n", stats.bitrate / 1000);
+    cli_printf("- Bus load: %lu.%lu%% (worst-case stuffing)\n",
+               stats.bus_load_permille / 10, stats.bus_load_permille % 10);
+    cli_printf("- TX Count: %lu (%lu/s), enqueue failures: %lu\n",
+               stats.tx_frames, stats.tx_per_sec, stats.tx_enqueue_failures);
+    cli_printf("- RX Count: %lu (%lu/s)\n", stats.rx_frames, stats.rx_per_sec);
+    if (stats.driver_running) {
+        const twai_status_info_t *st = &stats.status;
+        cli_printf("- TX queue: %lu now, %lu peak\n", st->msgs_to_tx, stats.tx_queue_hwm);
+        cli_printf("- RX queue: %lu now, %lu peak, %lu queue-full alerts\n",
+                   st->msgs_to_rx, stats.rx_queue_hwm, stats.rx_queue_full_alerts);
+        cli_printf("- Error Count: TEC=%lu REC=%lu\n", st->tx_error_counter, st->rx_error_counter);
+        cli_printf("- TX failed: %lu, arbitration lost: %lu, bus errors: %lu\n",
+                   st->tx_failed_count, st->arb_lost_count, st->bus_error_count);
+        cli_printf("- RX missed: %lu, RX overrun: %lu\n", st->rx_missed_count, st->rx_overrun_count);
+    }
+    if (stats.latency_samples > 0) {
+        cli_printf("- TX latency (enqueue->ACK): p50 <= %lu us, p99 <= %lu us, max %lu us (%lu samples)\n",
+                   can_stats_latency_percentile(&stats, 50), can_stats_latency_percentile(&stats, 99),
+                   stats.latency_max_us, stats.latency_samples);
+    }
+
+    if (can_status_args.ids->count > 0) {
+        static can_stats_id_t ids[CAN_STATS_MAX_IDS];
+        size_t count = can_stats_get_ids(ids, CAN_STATS_MAX_IDS);
+        cli_printf("\n  %-10s%8s %8s %8s %8s\n", "ID", "TX", "RX", "TX/s", "RX/s");
+        for (size_t i = 0; i < count; i++) {
+            char id_str[12];
+            snprintf(id_str, sizeof(id_str), ids[i].extended ? "0x%08lX" : "0x%03lX", ids[i].identifier);
+            cli_printf("  %-10s%8lu %8lu %8lu %8lu\n", id_str, ids[i].tx_count, ids[i].rx_count,
+                       ids[i].tx_per_sec, ids[i].rx_per_sec);
+        }
+        if (stats.tx_other || stats.rx_other) {
+            cli_printf("  %-10s%8lu %8lu\n", "other", stats.tx_other, stats.rx_other);
+        }
+    }
+
+    if (can_status_args.timing->count > 0) {
+        static can_stats_id_t ids[CAN_STATS_MAX_IDS];
+        size_t count = can_stats_get_ids(ids, CAN_STATS_MAX_IDS);
+        cli_printf("\n  %-10s%8s %10s %8s %8s %8s %7s\n", "ID", "Periods", "Mean(us)", "Min", "Max", "StdDev", "Missed");
+        for (size_t i = 0; i < count; i++) {
+            if (ids[i].period_samples == 0) {
+                continue;
+            }
+            char id_str[12];
+            snprintf(id_str, sizeof(id_str), ids[i].extended ? "0x%08lX" : "0x%03lX", ids[i].identifier);
+            cli_printf("  %-10s%8lu %10lu %8lu %8lu %8lu %7lu\n", id_str, ids[i].period_samples,
+                       ids[i].period_mean_us, ids[i].period_min_us, ids[i].period_max_us,
+                       ids[i].period_stddev_us, ids[i].missed_periods);
+        }
+        cli_printf("  Stamped behind a backlog: %lu of %lu frames; tracking cost avg %lu / max %lu cycles\n",
+                   stats.rx_backlog_stamps, stats.rx_frames, stats.rx_timing_cycles_avg, stats.rx_timing_cycles_max);
+    }
+
+    if (can_status_args.reset->count > 0) {
+        can_stats_reset();
+        cli_printf("Counters reset\n");
+    }
     return 0;
 }
 
+static void print_can_settings(const char *title, const can_settings_t *settings)
+{
+    uint32_t sample_point = can_settings_sample_point_permille(settings);
+    uint32_t rate_min, rate_max;
+    can_settings_max_frame_rate(settings, &rate_min, &rate_max);
+
+    cli_printf("%s:\n", title);
+    cli_printf("- Bitrate: %lu bit/s (BRP %u, TSEG1 %u, TSEG2 %u, SJW %u)\n",
+               can_settings_bitrate(settings), settings->brp, settings->tseg_1, settings->tseg_2, settings->sjw);
+    cli_printf("- Sample point: %lu.%lu%%\n", sample_point / 10, sample_point % 10);
+    cli_printf("- Max frame rate (8-byte std): %lu-%lu frames/s\n", rate_min, rate_max);
+    cli_printf("- Mode: %s\n", can_settings_mode_name(settings->mode));
+    cli_printf("- Queues: RX %u, TX %u\n", settings->rx_queue_len, settings->tx_queue_len);
+}
+
+int cmd_can_config(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &can_config_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, can_config_args.end, argv[0]);
+        return 1;
+    }
+
+    if (can_config_args.list->count > 0) {
+        const can_settings_preset_t *presets;
+        size_t count = can_settings_get_presets(&presets);
+        cli_printf("  %-8s%5s %6s %6s %4s %8s %16s\n", "kbps", "BRP", "TSEG1", "TSEG2", "SJW", "SP", "frames/s");
+        for (size_t i = 0; i < count; i++) {
+            const can_settings_t *timing = &presets[i].timing;
+            uint32_t sample_point = can_settings_sample_point_permille(timing);
+            uint32_t rate_min, rate_max;
+            can_settings_max_frame_rate(timing, &rate_min, &rate_max);
+            cli_printf("  %-8lu%5u %6u %6u %4u %6lu.%lu%% %7lu-%-8lu\n", presets[i].bitrate / 1000,
+                       timing->brp, timing->tseg_1, timing->tseg_2, timing->sjw,
+                       sample_point / 10, sample_point % 10, rate_min, rate_max);
+        }
+        return 0;
+    }
+
+    can_settings_t settings;
+    bool changed = false;
+    if (can_config_args.defaults->count > 0) {
+        esp_err_t ret = can_settings_erase();
+        if (ret != ESP_OK) {
+            cli_printf_error("Failed to erase stored settings: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        can_settings_default(&settings);
+        changed = true;
+    } else {
+        can_driver_get_settings(&settings);
+    }
+
+    if (can_config_args.bitrate->count > 0) {
+        uint32_t bitrate = (uint32_t)can_config_args.bitrate->ival[0] * 1000;
+        if (can_settings_set_bitrate(&settings, bitrate) != ESP_OK) {
+            cli_printf_error("No preset for %d kbps (see can-config -l)\n", can_config_args.bitrate->ival[0]);
+            return 1;
+        }
+        changed = true;
+    }
+    struct { struct arg_int *arg; int min; int max; } fields[] = {
+        { can_config_args.brp, 0, 0xFFFF }, { can_config_args.tseg_1, 0, 0xFF },
+        { can_config_args.tseg_2, 0, 0xFF }, { can_config_args.sjw, 0, 0xFF },
+        { can_config_args.rx_queue, 0, 0xFFFF }, { can_config_args.tx_queue, 0, 0xFFFF },
+    };
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        if (fields[i].arg->count > 0 &&
+            (fields[i].arg->ival[0] < fields[i].min || fields[i].arg->ival[0] > fields[i].max)) {
+            cli_printf_error("Value out of range: %d\n", fields[i].arg->ival[0]);
+            return 1;
+        }
+    }
+    if (can_config_args.brp->count > 0) {
+        settings.brp = (uint16_t)can_config_args.brp->ival[0];
+        changed = true;
+    }
+    if (can_config_args.tseg_1->count > 0) {
+        settings.tseg_1 = (uint8_t)can_config_args.tseg_1->ival[0];
+        changed = true;
+    }
+    if (can_config_args.tseg_2->count > 0) {
+        settings.tseg_2 = (uint8_t)can_config_args.tseg_2->ival[0];
+        changed = true;
+    }
+    if (can_config_args.sjw->count > 0) {
+        settings.sjw = (uint8_t)can_config_args.sjw->ival[0];
+        changed = true;
+    }
+    if (can_config_args.rx_queue->count > 0) {
+        settings.rx_queue_len = (uint16_t)can_config_args.rx_queue->ival[0];
+        changed = true;
+    }
+    if (can_config_args.tx_queue->count > 0) {
+        settings.tx_queue_len = (uint16_t)can_config_args.tx_queue->ival[0];
+        changed = true;
+    }
+    if (can_config_args.mode->count > 0) {
+        const char *mode = can_config_args.mode->sval[0];
+        if (strcmp(mode, "normal") == 0) {
+            settings.mode = TWAI_MODE_NORMAL;
+        } else if (strcmp(mode, "noack") == 0) {
+            settings.mode = TWAI_MODE_NO_ACK;
+        } else if (strcmp(mode, "listen") == 0) {
+            settings.mode = TWAI_MODE_LISTEN_ONLY;
+        } else {
+            cli_printf_error("Unknown mode: %s (use normal, noack or listen)\n", mode);
+            return 1;
+        }
+        changed = true;
+    }
+
+    const char *reason;
+    if (can_settings_validate(&settings, &reason) != ESP_OK) {
+        cli_printf_error("Invalid settings: %s\n", reason);
+        return 1;
+    }
+
+    if (changed) {
+        esp_err_t ret = can_driver_apply(&settings);
+        if (ret != ESP_OK) {
+            cli_printf_error("Driver rejected the settings: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        can_stats_set_bitrate(can_settings_bitrate(&settings));
+        cli_printf_success("CAN driver reinstalled\n");
+    }
+
+    if (can_config_args.save->count > 0) {
+        esp_err_t ret = can_settings_save(&settings);
+        if (ret != ESP_OK) {
+            cli_printf_error("Failed to store settings: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        cli_printf_success("Settings stored, used from next boot\n");
+    }
+
+    print_can_settings("Active CAN Settings", &settings);
+    can_settings_t stored;
+    if (can_settings_load(&stored) != ESP_OK) {
+        cli_printf("Stored: none (built-in defaults at boot)\n");
+    } else if (memcmp(&stored, &settings, sizeof(stored)) != 0) {
+        print_can_settings("Stored CAN Settings (applied at boot)", &stored);
+    } else {
+        cli_printf("Stored: same as active\n");
+    }
+    return 0;
+}
+
+int cmd_can_autobaud(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &can_autobaud_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, can_autobaud_args.end, argv[0]);
+        return 1;
+    }
+
+    can_autobaud_config_t config;
+    can_autobaud_default_config(&config);
+    if (can_autobaud_args.order->count > 0) {
+        const char *p = can_autobaud_args.order->sval[0];
+        config.bitrate_count = 0;
+        while (*p != '\0') {
+            char *end;
+            long kbps = strtol(p, &end, 10);
+            can_settings_t probe;
+            if (end == p || kbps <= 0 || config.bitrate_count >= CAN_AUTOBAUD_MAX_CANDIDATES ||
+                can_settings_set_bitrate(&probe, (uint32_t)kbps * 1000) != ESP_OK) {
+                cli_printf_error("Bad scan order: %s (presets only, at most %d, see can-config -l)\n",
+                                 can_autobaud_args.order->sval[0], CAN_AUTOBAUD_MAX_CANDIDATES);
+                return 1;
+            }
+            config.bitrates[config.bitrate_count++] = (uint32_t)kbps * 1000;
+            p = (*end == ',') ? end + 1 : end;
+        }
+    }
+    if (can_autobaud_args.dwell->count > 0) {
+        config.dwell_ms = can_autobaud_args.dwell->ival[0];
+    }
+    if (can_autobaud_args.dwell_max->count > 0) {
+        config.dwell_max_ms = can_autobaud_args.dwell_max->ival[0];
+    }
+    if (can_autobaud_args.timeout->count > 0) {
+        config.timeout_ms = can_autobaud_args.timeout->ival[0];
+    }
+    if (can_autobaud_args.lock_frames->count > 0) {
+        config.lock_frames = can_autobaud_args.lock_frames->ival[0];
+    }
+    if ((int32_t)config.dwell_ms <= 0 || (int32_t)config.dwell_max_ms < 0 ||
+        (int32_t)config.timeout_ms <= 0 || (int32_t)config.lock_frames <= 0) {
+        cli_printf_error("Dwell, timeout and lock frames must be positive\n");
+        return 1;
+    }
+
+    bool restore_driver = can_driver_is_running();
+    cli_printf("Listening at %u bitrate(s), %lu ms dwell, up to %lu ms...\n",
+               (unsigned)config.bitrate_count, config.dwell_ms, config.timeout_ms);
+    can_autobaud_result_t result;
+    esp_err_t ret = can_autobaud_run(&config, &result);
+
+    cli_printf("  %-8s%8s %8s %10s %8s\n", "kbps", "Frames", "Errors", "Listen(ms)", "Score");
+    for (size_t i = 0; i < result.candidate_count; i++) {
+        const can_autobaud_candidate_t *candidate = &result.candidates[i];
+        cli_printf("  %-8lu%8lu %8lu %10lu %8ld%s\n", candidate->bitrate / 1000, candidate->frames,
+                   candidate->bus_errors, candidate->listen_ms, (long)candidate->score,
+                   result.locked && candidate->bitrate == result.bitrate ? "  <-" : "");
+    }
+
+    int status = 0;
+    if (ret == ESP_OK) {
+        cli_printf_success("Detected %lu kbps in %lu ms (%lu pass(es))\n",
+                           result.bitrate / 1000, result.elapsed_ms, result.passes);
+    } else if (ret == ESP_ERR_TIMEOUT) {
+        cli_printf_warning("No bitrate detected in %lu ms; is there traffic on the bus?\n", result.elapsed_ms);
+        status = 1;
+    } else {
+        cli_printf_error("Auto-baud failed: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+
+    if (ret == ESP_OK && can_autobaud_args.apply->count > 0) {
+        can_settings_t settings;
+        can_driver_get_settings(&settings);
+        settings.brp = result.timing.brp;
+        settings.tseg_1 = result.timing.tseg_1;
+        settings.tseg_2 = result.timing.tseg_2;
+        settings.sjw = result.timing.sjw;
+        if (can_driver_apply(&settings) != ESP_OK) {
+            cli_printf_error("Failed to install the driver at %lu kbps\n", result.bitrate / 1000);
+            return 1;
+        }
+        can_stats_set_bitrate(result.bitrate);
+        cli_printf_success("CAN driver running at %lu kbps (can-config -s to keep it)\n", result.bitrate / 1000);
+    } else if (restore_driver && can_driver_init() != ESP_OK) {
+        cli_printf_warning("Failed to restore the CAN driver\n");
+    }
+    return status;
+}
+
+static void print_capture_status(void)
+{
+    can_capture_status_t status;
+    can_capture_get_status(&status);
+
+    cli_printf("CAN Capture Status:\n");
+    cli_printf("- State: %s\n", status.running ? "Recording" : "Stopped");
+    if (status.files_opened > 0) {
+        cli_printf("- File: %s (%lu / %lu KiB)\n", status.path, status.file_bytes / 1024, status.file_max_bytes / 1024);
+    }
+    cli_printf("- Frames: %lu captured, %lu dropped\n", status.frames, status.dropped);
+    cli_printf("- Blocks written: %lu, write errors: %lu, slowest write: %lu us\n",
+               status.blocks_written, status.write_errors, status.max_write_us);
+    cli_printf("- Files: %lu opened, keeping %lu\n", status.files_opened, status.max_files);
+}
+
+int cmd_can_capture(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &can_capture_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, can_capture_args.end, argv[0]);
+        return 1;
+    }
+
+    const char *action = can_capture_args.action->sval[0];
+    if (strcmp(action, "start") == 0) {
+        int file_kb = can_capture_args.file_kb->count > 0 ? can_capture_args.file_kb->ival[0] : 0;
+        int max_files = can_capture_args.max_files->count > 0 ? can_capture_args.max_files->ival[0] : 0;
+        if (file_kb < 0 || max_files < 0) {
+            cli_printf_error("File size and file count must be positive\n");
+            return 1;
+        }
+        esp_err_t ret = can_capture_start(file_kb, max_files);
+        if (ret != ESP_OK) {
+            cli_printf_error("Failed to start capture: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+        cli_printf_success("Capture started\n");
+    } else if (strcmp(action, "stop") == 0) {
+        if (can_capture_stop() != ESP_OK) {
+            cli_printf_error("Capture is not running\n");
+            return 1;
+        }
+        print_capture_status();
+    } else if (strcmp(action, "status") == 0) {
+        print_capture_status();
+    } else {
+        cli_printf_error("Unknown action: %s (use start, stop or status)\n", action);
+        return 1;
+    }
+    return 0;
+}
+
+int cmd_can_replay(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &can_replay_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, can_replay_args.end, argv[0]);
+        return 1;
+    }
+
+    can_replay_config_t config = {
+        .speed = can_replay_args.speed->count > 0 ? (float)can_replay_args.speed->dval[0] : 1.0f,
+        .loops = can_replay_args.loops->count > 0 ? can_replay_args.loops->ival[0] : 1,
+    };
+    if (can_replay_args.fast->count > 0) {
+        config.speed = 0.0f;
+    } else if (config.speed <= 0.0f) {
+        cli_printf_error("Speed must be positive (use -a for as fast as possible)\n");
+        return 1;
+    }
+    if (can_replay_args.loops->count > 0 && can_replay_args.loops->ival[0] <= 0) {
+        cli_printf_error("Loop count must be positive\n");
+        return 1;
+    }
+
+    const char *path = can_replay_args.file->sval[0];
+    if (config.speed > 0.0f) {
+        cli_printf("Replaying %s at %.2fx, %lu loop(s)...\n", path, config.speed, config.loops);
+    } else {
+        cli_printf("Replaying %s as fast as possible, %lu loop(s)...\n", path, config.loops);
+    }
+
+    can_replay_report_t report;
+    esp_err_t ret = can_replay_file(path, &config, &report);
+    if (ret != ESP_OK) {
+        cli_printf_error("Replay failed: %s\n", esp_err_to_name(ret));
+        if (report.frames_sent == 0) {
+            return 1;
+        }
+    }
+
+    uint32_t frames = report.frames_sent + report.tx_failures;
+    cli_printf("CAN Replay Results:\n");
+    cli_printf("- Frames sent: %lu, TX failures: %lu, bad blocks: %lu\n",
+               report.frames_sent, report.tx_failures, report.bad_blocks);
+    cli_printf("- Elapsed: %lld ms (capture span %lld ms per loop)\n",
+               report.elapsed_us / 1000, report.capture_span_us / 1000);
+    if (report.elapsed_us > 0) {
+        cli_printf("- Achieved rate: %.1f frames/s\n", (double)report.frames_sent * 1000000.0 / report.elapsed_us);
+    }
+    if (config.speed > 0.0f && frames > 0) {
+        cli_printf("- Timing error: p50 %lu us, p90 %lu us, p99 %lu us, max %lu us\n",
+                   can_replay_error_percentile(&report, 50), can_replay_error_percentile(&report, 90),
+                   can_replay_error_percentile(&report, 99), report.error_max_us);
+    }
+    return report.tx_failures > 0 ? 1 : 0;
+}
+
 // Temperature Sensor Command Implementation
 int cmd_temp_read(int argc, char **argv)
 {
-    cli_printf("Reading temperature sensor...\n");
-    // Implement temperature reading using your temp_sensor utils
-    float temperature = 25.5; // Placeholder
-    cli_printf_success("Temperature: %.2f°C\n", temperature);
+    can_value_t value;
+    if (!can_value_read(can_value_find(CAN_MSG_TEMPERATURE_ID, CAN_MSG_TEMPERATURE_EXTENDED, CAN_VALUE_SIG_TEMPERATURE),
+                        &value) || value.sequence == 0) {
+        cli_printf_warning("No temperature received on CAN yet\n");
+        return 1;
+    }
+
+    int64_t age_ms = (esp_timer_get_time() - value.timestamp_us) / 1000;
+    if (value.stale) {
+        cli_printf_warning("Temperature: %.2f°C (stale, %lld ms old)\n", value.value, age_ms);
+        return 1;
+    }
+    cli_printf_success("Temperature: %.2f°C (%lld ms old, update #%lu)\n", value.value, age_ms, value.sequence);
     return 0;
 }
 
@@ -25,6 +25,10 @@ int cmd_adc_calibrate(int argc, char **argv);
 int cmd_can_send(int argc, char **argv);
 int cmd_can_receive(int argc, char **argv);
 int cmd_can_status(int argc, char **argv);
+int cmd_can_config(int argc, char **argv);
+int cmd_can_autobaud(int argc, char **argv);
+int cmd_can_capture(int argc, char **argv);
+int cmd_can_replay(int argc, char **argv);
 
 /**
  * @brief Temperature sensor commands
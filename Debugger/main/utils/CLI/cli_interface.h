@@ -27,7 +27,7 @@ extern "C" {
 // CLI Configuration
 #define CLI_PROMPT_STR "ESP32-CLI> "
 #define CLI_MAX_CMDLINE_LENGTH 256
-#define CLI_TASK_STACK_SIZE 4096
+#define CLI_TASK_STACK_SIZE 5120   // can_stats_get_ids() keeps 640 bytes of scratch on it
 #define CLI_TASK_PRIORITY 5
 #define CLI_HISTORY_SIZE 30
 
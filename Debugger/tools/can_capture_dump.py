@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+"""Convert Debugger can-capture files (CANnnnnn.BIN) to candump log format.
+
+The binary layout is documented in main/utils/CAN/can_capture_utils.h.
+Timestamps are seconds since the Debugger booted, so files from one run
+can be concatenated and fed to canplayer or any candump -l reader:
+
+    python3 can_capture_dump.py CAN00001.BIN CAN00002.BIN > capture.log
+"""
+
+import argparse
+import struct
+import sys
+
+BLOCK_SIZE = 4096
+MAGIC = 0x50414343
+VERSION = 1
+HEADER = struct.Struct("<IHHQ")
+RECORD = struct.Struct("<II8s")
+
+TIME_MASK = 0x00FFFFFF
+DLC_SHIFT = 24
+RTR = 1 << 28
+EXTD = 1 << 29
+
+
+def frames(path):
+    with open(path, "rb") as f:
+        index = 0
+        while True:
+            block = f.read(BLOCK_SIZE)
+            if len(block) < BLOCK_SIZE:
+                return
+            magic, version, count, base_us = HEADER.unpack_from(block)
+            if magic != MAGIC or version != VERSION:
+                print(f"{path}: block {index} is not a capture block, skipped", file=sys.stderr)
+            else:
+                for i in range(count):
+                    info, identifier, data = RECORD.unpack_from(block, HEADER.size + i * RECORD.size)
+                    dlc = (info >> DLC_SHIFT) & 0xF
+                    yield base_us + (info & TIME_MASK), identifier, bool(info & EXTD), bool(info & RTR), data[:dlc]
+            index += 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("files", nargs="+", help="capture files, oldest first")
+    parser.add_argument("--interface", default="can0", help="interface name written to the log")
+    args = parser.parse_args()
+
+    for path in args.files:
+        for time_us, identifier, extended, rtr, data in frames(path):
+            can_id = f"{identifier:08X}" if extended else f"{identifier:03X}"
+            payload = "R" if rtr else data.hex().upper()
+            print(f"({time_us // 1000000}.{time_us % 1000000:06d}) {args.interface} {can_id}#{payload}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,876 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include "vcan_protocol.h"
+#include "vcan_frame.h"
+
+/*
+ * Virtual CAN bus for host nodes.
+ *
+ * Nodes connect over a UNIX-domain SOCK_SEQPACKET socket (see
+ * vcan_protocol.h). The bus runs one frame at a time: when it goes idle,
+ * the head frames of all nodes arbitrate, the lowest key wins and the
+ * losers are told. The frame then occupies the bus for its exact wire
+ * length, stuff bits included, at the bus bitrate before it is delivered
+ * to every other node and acknowledged. Bus time is kept virtually:
+ * frames start when the previous one ended or when they were queued,
+ * whichever is later, so late wake-ups of this process delay delivery
+ * but do not change the timing of the traffic.
+ *
+ * Errors follow the CAN fault confinement rules closely enough to drive
+ * the firmware's error handling: a frame nobody acknowledges (NORMAL
+ * mode, no other node in NORMAL or NO_ACK mode) and injected errors end
+ * in an error frame, TEC/REC move by 8/1, a node above TEC 255 goes bus
+ * off and recovers after 128 x 11 recessive bits. A node configured for
+ * another bitrate destroys every frame it sends and sees only errors.
+ *
+ * Optionally the bus is bridged to a SocketCAN interface (e.g. vcan0):
+ * its frames take part in arbitration like a node's, and every frame on
+ * the virtual bus is written to it, so candump/cansend work alongside.
+ */
+#define MAX_NODES           32
+#define NODE_FIFO_LEN       256
+#define MAX_IDS             64
+#define LATENCY_BUCKET_US   10
+#define LATENCY_BUCKETS     10000   // up to 100 ms, then the overflow bucket
+
+typedef struct {
+    vcan_frame_t frame;
+    uint8_t flags;              // VCAN_FLAG_*
+    int64_t queued_ns;
+} pending_frame_t;
+
+typedef enum {
+    NODE_ACTIVE,
+    NODE_BUS_OFF,
+    NODE_RECOVERING,
+    NODE_STOPPED,               // recovered, waits for the node to restart
+} node_state_t;
+
+typedef struct {
+    bool connected;
+    bool departed;              // disconnected, kept for the report
+    bool socketcan;
+    int fd;
+    char name[VCAN_NAME_LEN];
+    bool hello;
+    uint32_t bitrate;
+    uint8_t mode;
+    node_state_t state;
+    int64_t recover_at_ns;
+    uint16_t tec;
+    uint16_t rec;
+    pending_frame_t fifo[NODE_FIFO_LEN];
+    uint32_t fifo_head;
+    uint32_t fifo_count;
+    uint32_t tx_frames;
+    uint32_t rx_frames;
+    uint32_t arb_lost;
+    uint32_t errors;
+    uint32_t fifo_overflows;
+    uint32_t send_drops;        // events lost because the node did not read
+} node_t;
+
+typedef enum {
+    XFER_OK,
+    XFER_ACK_ERROR,
+    XFER_INJECTED_ERROR,
+    XFER_BITRATE_ERROR,
+} xfer_outcome_t;
+
+typedef struct {
+    bool busy;
+    int winner;                 // node index, -1 for bitrate errors
+    uint32_t offenders;         // bitmask of wrong-bitrate transmitters
+    uint32_t contenders;        // bitmask of all transmitters at SOF
+    xfer_outcome_t outcome;
+    int64_t start_ns;
+    int64_t end_ns;
+    uint32_t bits;
+} transfer_t;
+
+typedef struct {
+    uint32_t identifier;
+    bool extended;
+    uint32_t frames;
+} id_stats_t;
+
+static struct {
+    const char *socket_path;
+    uint32_t bitrate;
+    uint32_t error_ppm;
+    int64_t error_id;           // -1 = any
+    int duration_s;
+    bool verbose;
+    const char *socketcan_if;
+} options = {
+    .socket_path = VCAN_DEFAULT_SOCKET,
+    .bitrate = 500000,
+    .error_id = -1,
+};
+
+static node_t nodes[MAX_NODES];
+static transfer_t xfer;
+static int64_t bus_free_ns;             // end of the last frame or error frame
+static int64_t start_ns;
+static uint64_t busy_ns;
+static uint64_t frames_ok;
+static uint64_t frames_error;
+static uint64_t frames_injected;
+static uint64_t arbitration_losses;
+static uint32_t latency_hist[LATENCY_BUCKETS + 1];
+static uint64_t latency_count;
+static uint64_t latency_max_ns;
+static id_stats_t id_stats[MAX_IDS];
+static size_t id_count;
+static uint32_t id_other;
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+static volatile sig_atomic_t stop_requested;
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static uint32_t rng_next(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32);
+}
+
+static int64_t bits_to_ns(uint32_t bits)
+{
+    return (int64_t)bits * 1000000000LL / options.bitrate;
+}
+
+static const char *node_state_name(node_state_t state)
+{
+    switch (state) {
+        case NODE_ACTIVE:       return "active";
+        case NODE_BUS_OFF:      return "bus-off";
+        case NODE_RECOVERING:   return "recovering";
+        case NODE_STOPPED:      return "stopped";
+        default:                return "?";
+    }
+}
+
+// ---- Node I/O -------------------------------------------------------------
+
+static void node_send(node_t *node, uint8_t type, uint8_t flags, const pending_frame_t *frame, int64_t timestamp_ns)
+{
+    if (node->socketcan) {
+        if (type == VCAN_MSG_RX) {
+            struct can_frame out = { 0 };
+            out.can_id = frame->frame.identifier;
+            if (frame->frame.extended) {
+                out.can_id |= CAN_EFF_FLAG;
+            }
+            if (frame->frame.rtr) {
+                out.can_id |= CAN_RTR_FLAG;
+            }
+            out.can_dlc = frame->frame.dlc > 8 ? 8 : frame->frame.dlc;
+            memcpy(out.data, frame->frame.data, sizeof(out.data));
+            if (write(node->fd, &out, sizeof(out)) != sizeof(out)) {
+                node->send_drops++;
+            }
+        }
+        return;
+    }
+
+    vcan_packet_t packet = {
+        .type = type,
+        .flags = flags,
+        .tec = node->tec,
+        .rec = node->rec,
+        .timestamp_ns = timestamp_ns,
+    };
+    if (frame != NULL) {
+        packet.identifier = frame->frame.identifier;
+        packet.dlc = frame->frame.dlc;
+        memcpy(packet.data, frame->frame.data, sizeof(packet.data));
+        if (type == VCAN_MSG_RX) {
+            packet.flags = (frame->frame.extended ? VCAN_FLAG_EXTD : 0) | (frame->frame.rtr ? VCAN_FLAG_RTR : 0);
+        }
+    }
+    if (send(node->fd, &packet, sizeof(packet), MSG_DONTWAIT) != sizeof(packet)) {
+        node->send_drops++;
+    }
+}
+
+static bool node_on_bus(const node_t *node)
+{
+    return node->connected && node->hello && node->state == NODE_ACTIVE;
+}
+
+static void node_fifo_push(node_t *node, const pending_frame_t *frame)
+{
+    if (node->fifo_count == NODE_FIFO_LEN) {
+        node->fifo_overflows++;
+        return;
+    }
+    node->fifo[(node->fifo_head + node->fifo_count) % NODE_FIFO_LEN] = *frame;
+    node->fifo_count++;
+}
+
+static void node_fifo_pop(node_t *node)
+{
+    node->fifo_head = (node->fifo_head + 1) % NODE_FIFO_LEN;
+    node->fifo_count--;
+}
+
+static pending_frame_t *node_fifo_head(node_t *node)
+{
+    return node->fifo_count > 0 ? &node->fifo[node->fifo_head] : NULL;
+}
+
+static void node_close(int index)
+{
+    node_t *node = &nodes[index];
+    if (xfer.busy) {
+        xfer.contenders &= ~(1u << index);
+        xfer.offenders &= ~(1u << index);
+        if (xfer.winner == index) {
+            // The frame still completes on the wire, nobody is told
+            xfer.winner = -1;
+        }
+    }
+    if (node->hello) {
+        printf("[bus] %s left (tx %u, rx %u, errors %u)\n", node->name, node->tx_frames, node->rx_frames,
+               node->errors);
+    }
+    close(node->fd);
+    node->fd = -1;
+    node->connected = false;
+    node->departed = node->hello;
+    node->fifo_count = 0;
+}
+
+static void node_handle_packet(int index, const vcan_packet_t *packet)
+{
+    node_t *node = &nodes[index];
+    switch (packet->type) {
+        case VCAN_MSG_HELLO:
+            memcpy(node->name, packet->name, VCAN_NAME_LEN);
+            node->name[VCAN_NAME_LEN - 1] = '\0';
+            node->bitrate = packet->bitrate;
+            node->mode = packet->mode;
+            node->hello = true;
+            // A node restarting its driver (e.g. after bus-off) keeps its totals
+            for (int i = 0; i < MAX_NODES; i++) {
+                node_t *old = &nodes[i];
+                if (i != index && old->departed && strcmp(old->name, node->name) == 0) {
+                    node->tx_frames = old->tx_frames;
+                    node->rx_frames = old->rx_frames;
+                    node->arb_lost = old->arb_lost;
+                    node->errors = old->errors;
+                    node->fifo_overflows = old->fifo_overflows;
+                    node->send_drops = old->send_drops;
+                    old->departed = false;
+                    break;
+                }
+            }
+            printf("[bus] %s joined at %u bit/s, %s%s\n", node->name, node->bitrate,
+                   node->mode == VCAN_MODE_NORMAL ? "normal" :
+                   node->mode == VCAN_MODE_NO_ACK ? "no-ack" : "listen-only",
+                   node->bitrate != options.bitrate ? " (bitrate mismatch)" : "");
+            break;
+        case VCAN_MSG_TX: {
+            if (node->state != NODE_ACTIVE || node->mode == VCAN_MODE_LISTEN_ONLY) {
+                node_send(node, VCAN_MSG_TX_FAILED, 0, NULL, now_ns());
+                break;
+            }
+            pending_frame_t frame = {
+                .frame = {
+                    .identifier = packet->identifier,
+                    .extended = (packet->flags & VCAN_FLAG_EXTD) != 0,
+                    .rtr = (packet->flags & VCAN_FLAG_RTR) != 0,
+                    .dlc = packet->dlc,
+                },
+                .flags = packet->flags,
+                .queued_ns = now_ns(),
+            };
+            memcpy(frame.frame.data, packet->data, sizeof(frame.frame.data));
+            node_fifo_push(node, &frame);
+            break;
+        }
+        case VCAN_MSG_RECOVER:
+            if (node->state == NODE_BUS_OFF) {
+                node->state = NODE_RECOVERING;
+                node->recover_at_ns = now_ns() + bits_to_ns(VCAN_RECOVERY_BITS);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void socketcan_read(int index)
+{
+    node_t *node = &nodes[index];
+    struct can_frame in;
+    if (read(node->fd, &in, sizeof(in)) != sizeof(in)) {
+        return;
+    }
+    pending_frame_t frame = {
+        .frame = {
+            .identifier = in.can_id & ((in.can_id & CAN_EFF_FLAG) ? CAN_EFF_MASK : CAN_SFF_MASK),
+            .extended = (in.can_id & CAN_EFF_FLAG) != 0,
+            .rtr = (in.can_id & CAN_RTR_FLAG) != 0,
+            .dlc = in.can_dlc,
+        },
+        .queued_ns = now_ns(),
+    };
+    memcpy(frame.frame.data, in.data, sizeof(frame.frame.data));
+    node_fifo_push(node, &frame);
+}
+
+static int socketcan_open(const char *ifname)
+{
+    int fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (fd < 0) {
+        return -1;
+    }
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+    struct sockaddr_can addr = { .can_family = AF_CAN };
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+        close(fd);
+        return -1;
+    }
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// ---- Error counters ---------------------------------------------------------
+
+static bool counts_errors(const node_t *node)
+{
+    // Listen-only controllers never change their error counters
+    return node->mode != VCAN_MODE_LISTEN_ONLY && !node->socketcan;
+}
+
+static void tx_error(int index, uint8_t flags, bool ack_error)
+{
+    node_t *node = &nodes[index];
+    node->errors++;
+    // An error-passive transmitter does not count ACK errors
+    if (counts_errors(node) && !(ack_error && node->tec >= 128)) {
+        node->tec += 8;
+    }
+    node_send(node, VCAN_MSG_BUS_ERROR, flags | VCAN_ERR_TX, NULL, xfer.end_ns);
+
+    pending_frame_t *head = node_fifo_head(node);
+    if (node->tec > 255) {
+        node->state = NODE_BUS_OFF;
+        node->fifo_count = 0;
+        node_send(node, VCAN_MSG_BUS_OFF, 0, NULL, xfer.end_ns);
+        printf("[bus] %s is bus-off\n", node->name);
+    } else if (head != NULL && (head->flags & VCAN_FLAG_SS)) {
+        node_fifo_pop(node);
+        node_send(node, VCAN_MSG_TX_FAILED, 0, NULL, xfer.end_ns);
+    }
+}
+
+static void rx_error(int index, uint8_t flags)
+{
+    node_t *node = &nodes[index];
+    node->errors++;
+    if (counts_errors(node) && node->rec < 255) {
+        node->rec++;
+    }
+    node_send(node, VCAN_MSG_BUS_ERROR, flags, NULL, xfer.end_ns);
+}
+
+static void rx_success(node_t *node)
+{
+    if (!counts_errors(node)) {
+        return;
+    }
+    if (node->rec > 127) {
+        node->rec = 120;
+    } else if (node->rec > 0) {
+        node->rec--;
+    }
+}
+
+// ---- Bus ----------------------------------------------------------------------
+
+static void record_id(const vcan_frame_t *frame)
+{
+    for (size_t i = 0; i < id_count; i++) {
+        if (id_stats[i].identifier == frame->identifier && id_stats[i].extended == frame->extended) {
+            id_stats[i].frames++;
+            return;
+        }
+    }
+    if (id_count < MAX_IDS) {
+        id_stats[id_count++] = (id_stats_t){ frame->identifier, frame->extended, 1 };
+    } else {
+        id_other++;
+    }
+}
+
+static void print_frame(const pending_frame_t *frame, const char *sender, const char *note)
+{
+    char data[3 * 8 + 1] = "";
+    for (int i = 0; i < frame->frame.dlc && i < 8 && !frame->frame.rtr; i++) {
+        sprintf(data + strlen(data), "%02X", frame->frame.data[i]);
+    }
+    printf("(%.6f) vbus %0*X#%s%s  %s%s\n", (xfer.end_ns - start_ns) / 1e9, frame->frame.extended ? 8 : 3,
+           frame->frame.identifier, frame->frame.rtr ? "R" : "", data, sender, note);
+}
+
+// Start the next transfer at bus time `at` if any node has a frame ready by then
+static bool start_transfer(int64_t at)
+{
+    uint64_t best_key = UINT64_MAX;
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.winner = -1;
+
+    for (int i = 0; i < MAX_NODES; i++) {
+        pending_frame_t *head = node_on_bus(&nodes[i]) ? node_fifo_head(&nodes[i]) : NULL;
+        if (head == NULL || head->queued_ns > at) {
+            continue;
+        }
+        xfer.contenders |= 1u << i;
+        if (!nodes[i].socketcan && nodes[i].bitrate != options.bitrate) {
+            xfer.offenders |= 1u << i;
+        }
+        uint64_t key = vcan_frame_arbitration_key(&head->frame);
+        if (key < best_key) {
+            best_key = key;
+            xfer.winner = i;
+        }
+    }
+    if (xfer.contenders == 0) {
+        return false;
+    }
+
+    xfer.busy = true;
+    xfer.start_ns = at;
+    if (xfer.offenders != 0) {
+        // Bits at the wrong rate break the first stuff rule or bit check
+        xfer.outcome = XFER_BITRATE_ERROR;
+        xfer.bits = 6 + VCAN_ERROR_FRAME_BITS;
+        xfer.end_ns = at + bits_to_ns(xfer.bits);
+        return true;
+    }
+
+    node_t *winner = &nodes[xfer.winner];
+    pending_frame_t *frame = node_fifo_head(winner);
+    uint32_t bits = vcan_frame_wire_bits(&frame->frame);
+    for (int i = 0; i < MAX_NODES; i++) {
+        if ((xfer.contenders & (1u << i)) && i != xfer.winner) {
+            nodes[i].arb_lost++;
+            arbitration_losses++;
+            node_send(&nodes[i], VCAN_MSG_ARB_LOST, 0, NULL, at);
+        }
+    }
+
+    bool acknowledged = winner->mode == VCAN_MODE_NO_ACK;
+    for (int i = 0; i < MAX_NODES && !acknowledged; i++) {
+        acknowledged = i != xfer.winner && node_on_bus(&nodes[i]) && nodes[i].mode != VCAN_MODE_LISTEN_ONLY &&
+                       (nodes[i].socketcan || nodes[i].bitrate == options.bitrate);
+    }
+    bool inject = options.error_ppm > 0 &&
+                  (options.error_id < 0 || (uint32_t)options.error_id == frame->frame.identifier) &&
+                  rng_next() % 1000000 < options.error_ppm;
+
+    if (inject) {
+        // Error flag starts at a random bit before the CRC delimiter
+        xfer.outcome = XFER_INJECTED_ERROR;
+        xfer.bits = 1 + rng_next() % (bits - VCAN_TRAILER_BITS) + VCAN_ERROR_FRAME_BITS;
+    } else if (!acknowledged) {
+        // Flagged in the bit after the ACK slot
+        xfer.outcome = XFER_ACK_ERROR;
+        xfer.bits = bits - VCAN_TRAILER_BITS + 2 + VCAN_ERROR_FRAME_BITS;
+    } else {
+        xfer.outcome = XFER_OK;
+        xfer.bits = bits;
+    }
+    xfer.end_ns = at + bits_to_ns(xfer.bits);
+    return true;
+}
+
+static void finish_transfer(void)
+{
+    busy_ns += (uint64_t)(xfer.end_ns - xfer.start_ns);
+    bus_free_ns = xfer.end_ns;
+    xfer.busy = false;
+
+    if (xfer.outcome == XFER_BITRATE_ERROR) {
+        frames_error++;
+        for (int i = 0; i < MAX_NODES; i++) {
+            if (!node_on_bus(&nodes[i])) {
+                continue;
+            }
+            if (xfer.contenders & (1u << i)) {
+                tx_error(i, (xfer.offenders & (1u << i)) ? VCAN_ERR_BITRATE : 0, false);
+            } else {
+                rx_error(i, nodes[i].bitrate != options.bitrate ? VCAN_ERR_BITRATE : 0);
+            }
+        }
+        if (options.verbose) {
+            printf("(%.6f) vbus error frame (bitrate mismatch)\n", (xfer.end_ns - start_ns) / 1e9);
+        }
+        return;
+    }
+
+    if (xfer.winner < 0) {
+        return;     // transmitter disconnected mid-frame
+    }
+    node_t *winner = &nodes[xfer.winner];
+    pending_frame_t frame = *node_fifo_head(winner);
+
+    if (xfer.outcome != XFER_OK) {
+        bool ack_error = xfer.outcome == XFER_ACK_ERROR;
+        uint8_t flags = ack_error ? VCAN_ERR_ACK : VCAN_ERR_INJECTED;
+        frames_error++;
+        if (!ack_error) {
+            frames_injected++;
+        }
+        tx_error(xfer.winner, flags, ack_error);
+        for (int i = 0; i < MAX_NODES; i++) {
+            if (i != xfer.winner && node_on_bus(&nodes[i])) {
+                rx_error(i, (nodes[i].bitrate != options.bitrate ? VCAN_ERR_BITRATE : 0) | flags);
+            }
+        }
+        if (options.verbose) {
+            print_frame(&frame, winner->name, ack_error ? "  ACK error" : "  injected error");
+        }
+        return;
+    }
+
+    frames_ok++;
+    node_fifo_pop(winner);
+    winner->tx_frames++;
+    if (winner->tec > 0) {
+        winner->tec--;
+    }
+    record_id(&frame.frame);
+
+    uint64_t latency_ns = (uint64_t)(xfer.end_ns - frame.queued_ns);
+    uint64_t bucket = latency_ns / 1000 / LATENCY_BUCKET_US;
+    latency_hist[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS]++;
+    latency_count++;
+    if (latency_ns > latency_max_ns) {
+        latency_max_ns = latency_ns;
+    }
+
+    for (int i = 0; i < MAX_NODES; i++) {
+        node_t *node = &nodes[i];
+        if (!node_on_bus(node) || i == xfer.winner) {
+            continue;
+        }
+        if (!node->socketcan && node->bitrate != options.bitrate) {
+            rx_error(i, VCAN_ERR_BITRATE);
+            continue;
+        }
+        rx_success(node);
+        node->rx_frames++;
+        node_send(node, VCAN_MSG_RX, 0, &frame, xfer.end_ns);
+    }
+    node_send(winner, VCAN_MSG_TX_DONE, 0, NULL, xfer.end_ns);
+    if (frame.flags & VCAN_FLAG_SELF) {
+        winner->rx_frames++;
+        node_send(winner, VCAN_MSG_RX, 0, &frame, xfer.end_ns);
+    }
+    if (options.verbose) {
+        print_frame(&frame, winner->name, "");
+    }
+}
+
+static void process_recoveries(int64_t now)
+{
+    for (int i = 0; i < MAX_NODES; i++) {
+        node_t *node = &nodes[i];
+        if (node->connected && node->state == NODE_RECOVERING && now >= node->recover_at_ns) {
+            node->state = NODE_STOPPED;
+            node->tec = 0;
+            node->rec = 0;
+            node_send(node, VCAN_MSG_RECOVERED, 0, NULL, now);
+            printf("[bus] %s recovered from bus-off\n", node->name);
+        }
+    }
+}
+
+// Run the bus up to `now`: finish due transfers and start the next ones in bus time
+static void run_bus(int64_t now)
+{
+    while (1) {
+        if (xfer.busy) {
+            if (xfer.end_ns > now) {
+                return;
+            }
+            finish_transfer();
+        }
+        // Back to back if frames were waiting, else from the earliest arrival
+        int64_t at = bus_free_ns;
+        int64_t earliest = INT64_MAX;
+        for (int i = 0; i < MAX_NODES; i++) {
+            pending_frame_t *head = node_on_bus(&nodes[i]) ? node_fifo_head(&nodes[i]) : NULL;
+            if (head != NULL && head->queued_ns < earliest) {
+                earliest = head->queued_ns;
+            }
+        }
+        if (earliest == INT64_MAX || earliest > now) {
+            return;
+        }
+        if (earliest > at) {
+            at = earliest;
+        }
+        if (!start_transfer(at)) {
+            return;
+        }
+    }
+}
+
+// ---- Report -------------------------------------------------------------------
+
+static uint32_t latency_percentile_us(uint32_t percentile)
+{
+    if (latency_count == 0) {
+        return 0;
+    }
+    uint64_t target = (latency_count * percentile + 99) / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i <= LATENCY_BUCKETS; i++) {
+        seen += latency_hist[i];
+        if (seen >= target) {
+            return (uint32_t)(i + 1) * LATENCY_BUCKET_US;
+        }
+    }
+    return (uint32_t)(latency_max_ns / 1000);
+}
+
+static int compare_ids(const void *a, const void *b)
+{
+    const id_stats_t *x = a, *y = b;
+    return (x->frames < y->frames) - (x->frames > y->frames);
+}
+
+static void print_report(void)
+{
+    double elapsed_s = (now_ns() - start_ns) / 1e9;
+    uint32_t load_permille = elapsed_s > 0 ? (uint32_t)(busy_ns / (elapsed_s * 1e6)) : 0;
+    uint32_t p50 = latency_percentile_us(50), p99 = latency_percentile_us(99);
+    uint32_t max_us = (uint32_t)(latency_max_ns / 1000);
+
+    printf("\nVirtual bus: %u bit/s for %.1f s\n", options.bitrate, elapsed_s);
+    printf("- Frames: %" PRIu64 " (%.1f/s), bus load %u.%u%%\n", frames_ok, frames_ok / elapsed_s,
+           load_permille / 10, load_permille % 10);
+    printf("- Error frames: %" PRIu64 " (%" PRIu64 " injected), arbitration losses: %" PRIu64 "\n",
+           frames_error, frames_injected, arbitration_losses);
+    printf("- Latency (queued -> end of frame): p50 <= %u us, p99 <= %u us, max %u us\n", p50, p99, max_us);
+
+    printf("\n  %-16s%8s %8s %8s %7s %5s %5s %s\n", "Node", "TX", "RX", "ArbLost", "Errors", "TEC", "REC", "State");
+    for (int i = 0; i < MAX_NODES; i++) {
+        node_t *node = &nodes[i];
+        if ((node->connected || node->departed) && node->hello) {
+            printf("  %-16s%8u %8u %8u %7u %5u %5u %s%s\n", node->name, node->tx_frames, node->rx_frames,
+                   node->arb_lost, node->errors, node->tec, node->rec,
+                   node->connected ? node_state_name(node->state) : "left",
+                   node->fifo_overflows || node->send_drops ? " (events dropped)" : "");
+        }
+    }
+
+    qsort(id_stats, id_count, sizeof(id_stats[0]), compare_ids);
+    printf("\n  %-10s%8s %8s\n", "ID", "Frames", "Per s");
+    for (size_t i = 0; i < id_count; i++) {
+        printf("  0x%0*X%*s%8u %8.1f\n", id_stats[i].extended ? 8 : 3, id_stats[i].identifier,
+               id_stats[i].extended ? 0 : 5, "", id_stats[i].frames, id_stats[i].frames / elapsed_s);
+    }
+    if (id_other > 0) {
+        printf("  %-10s%8u\n", "other", id_other);
+    }
+
+    // One line for scripts comparing runs
+    printf("\nsummary frames=%" PRIu64 " frames_per_s=%.1f load_permille=%u errors=%" PRIu64
+           " arb_lost=%" PRIu64 " p50_us=%u p99_us=%u max_us=%u\n",
+           frames_ok, frames_ok / elapsed_s, load_permille, frames_error, arbitration_losses, p50, p99, max_us);
+    fflush(stdout);
+}
+
+// ---- Main ---------------------------------------------------------------------
+
+static void on_signal(int signal_number)
+{
+    (void)signal_number;
+    stop_requested = 1;
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [-s socket] [-b bitrate] [-e ppm] [-x id] [-t seconds] [-c ifname] [-r seed] [-v]\n"
+            "  -s  listening socket (default: $VCAN_SOCKET or %s)\n"
+            "  -b  bus bitrate in bit/s (default: 500000)\n"
+            "  -e  injected error rate, per million frames (default: 0)\n"
+            "  -x  inject errors only into frames with this identifier\n"
+            "  -t  stop after this many seconds and print the report (default: on Ctrl-C)\n"
+            "  -c  bridge to a SocketCAN interface, e.g. vcan0\n"
+            "  -r  random seed for error injection\n"
+            "  -v  print every frame, candump style\n",
+            program, VCAN_DEFAULT_SOCKET);
+}
+
+int main(int argc, char **argv)
+{
+    if (getenv("VCAN_SOCKET") != NULL) {
+        options.socket_path = getenv("VCAN_SOCKET");
+    }
+    int opt;
+    while ((opt = getopt(argc, argv, "s:b:e:x:t:c:r:vh")) != -1) {
+        switch (opt) {
+            case 's': options.socket_path = optarg; break;
+            case 'b': options.bitrate = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'e': options.error_ppm = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'x': options.error_id = (int64_t)strtoul(optarg, NULL, 0); break;
+            case 't': options.duration_s = atoi(optarg); break;
+            case 'c': options.socketcan_if = optarg; break;
+            case 'r': rng_state = strtoull(optarg, NULL, 0) | 1; break;
+            case 'v': options.verbose = true; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (options.bitrate == 0 || options.bitrate > 1000000) {
+        fprintf(stderr, "bitrate must be 1-1000000\n");
+        return 2;
+    }
+
+    int listen_fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strncpy(addr.sun_path, options.socket_path, sizeof(addr.sun_path) - 1);
+    unlink(options.socket_path);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(listen_fd, MAX_NODES) < 0) {
+        perror("virtual bus socket");
+        return 1;
+    }
+
+    if (options.socketcan_if != NULL) {
+        int fd = socketcan_open(options.socketcan_if);
+        if (fd < 0) {
+            perror(options.socketcan_if);
+            return 1;
+        }
+        nodes[0] = (node_t){ .connected = true, .socketcan = true, .fd = fd, .hello = true,
+                             .bitrate = options.bitrate, .mode = VCAN_MODE_NORMAL };
+        snprintf(nodes[0].name, VCAN_NAME_LEN, "%s", options.socketcan_if);
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    start_ns = now_ns();
+    bus_free_ns = start_ns;
+    int64_t stop_at = options.duration_s > 0 ? start_ns + options.duration_s * 1000000000LL : INT64_MAX;
+    printf("[bus] listening on %s at %u bit/s\n", options.socket_path, options.bitrate);
+
+    while (!stop_requested && now_ns() < stop_at) {
+        struct pollfd fds[MAX_NODES + 1];
+        int owners[MAX_NODES + 1];
+        nfds_t count = 0;
+        fds[count] = (struct pollfd){ .fd = listen_fd, .events = POLLIN };
+        owners[count++] = -1;
+        for (int i = 0; i < MAX_NODES; i++) {
+            if (nodes[i].connected) {
+                fds[count] = (struct pollfd){ .fd = nodes[i].fd, .events = POLLIN };
+                owners[count++] = i;
+            }
+        }
+
+        // Sleep until the current frame ends, a recovery is due or the run is over
+        int64_t wake = stop_at;
+        if (xfer.busy && xfer.end_ns < wake) {
+            wake = xfer.end_ns;
+        }
+        for (int i = 0; i < MAX_NODES; i++) {
+            if (nodes[i].connected && nodes[i].state == NODE_RECOVERING && nodes[i].recover_at_ns < wake) {
+                wake = nodes[i].recover_at_ns;
+            }
+        }
+        struct timespec timeout, *timeout_ptr = NULL;
+        if (wake != INT64_MAX) {
+            int64_t wait = wake - now_ns();
+            if (wait < 0) {
+                wait = 0;
+            }
+            timeout = (struct timespec){ .tv_sec = wait / 1000000000LL, .tv_nsec = wait % 1000000000LL };
+            timeout_ptr = &timeout;
+        }
+        if (ppoll(fds, count, timeout_ptr, NULL) < 0 && errno != EINTR) {
+            perror("ppoll");
+            break;
+        }
+
+        for (nfds_t f = 0; f < count; f++) {
+            if (fds[f].revents == 0) {
+                continue;
+            }
+            if (owners[f] < 0) {
+                int fd = accept(listen_fd, NULL, NULL);
+                // Free slots first, then those of nodes that left
+                int slot = -1;
+                for (int pass = 0; pass < 2 && slot < 0; pass++) {
+                    for (int i = 0; i < MAX_NODES && slot < 0; i++) {
+                        slot = nodes[i].connected || (pass == 0 && nodes[i].departed) ? -1 : i;
+                    }
+                }
+                if (fd >= 0 && slot >= 0) {
+                    nodes[slot] = (node_t){ .connected = true, .fd = fd };
+                } else if (fd >= 0) {
+                    close(fd);
+                }
+                continue;
+            }
+            int index = owners[f];
+            if (nodes[index].socketcan) {
+                socketcan_read(index);
+                continue;
+            }
+            vcan_packet_t packet;
+            ssize_t length = recv(nodes[index].fd, &packet, sizeof(packet), MSG_DONTWAIT);
+            if (length == sizeof(packet)) {
+                node_handle_packet(index, &packet);
+            } else if (length == 0 || (length < 0 && errno != EAGAIN && errno != EINTR)) {
+                node_close(index);
+            }
+        }
+
+        int64_t now = now_ns();
+        process_recoveries(now);
+        run_bus(now);
+    }
+
+    print_report();
+    unlink(options.socket_path);
+    return 0;
+}
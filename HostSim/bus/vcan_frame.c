@@ -0,0 +1,73 @@
+#include "vcan_frame.h"
+
+uint64_t vcan_frame_arbitration_key(const vcan_frame_t *frame)
+{
+    if (frame->extended) {
+        // Base ID, SRR (recessive), IDE (recessive), extended ID, RTR
+        return ((uint64_t)(frame->identifier >> 18) << 21) | (1u << 20) | (1u << 19) |
+               ((uint64_t)(frame->identifier & 0x3FFFF) << 1) | frame->rtr;
+    }
+    // Base ID, RTR, IDE (dominant)
+    return ((uint64_t)(frame->identifier & 0x7FF) << 21) | ((uint64_t)frame->rtr << 20);
+}
+
+static inline void put_bits(uint8_t *bits, int *count, uint32_t value, int width)
+{
+    for (int i = width - 1; i >= 0; i--) {
+        bits[(*count)++] = (value >> i) & 1;
+    }
+}
+
+uint32_t vcan_frame_wire_bits(const vcan_frame_t *frame)
+{
+    uint8_t bits[160];
+    int count = 0;
+    uint8_t dlc = frame->dlc > 8 ? 8 : frame->dlc;
+
+    put_bits(bits, &count, 0, 1);   // SOF
+    if (frame->extended) {
+        put_bits(bits, &count, frame->identifier >> 18, 11);
+        put_bits(bits, &count, 3, 2);   // SRR, IDE
+        put_bits(bits, &count, frame->identifier & 0x3FFFF, 18);
+        put_bits(bits, &count, frame->rtr, 1);
+        put_bits(bits, &count, 0, 2);   // r1, r0
+    } else {
+        put_bits(bits, &count, frame->identifier, 11);
+        put_bits(bits, &count, frame->rtr, 1);
+        put_bits(bits, &count, 0, 2);   // IDE, r0
+    }
+    put_bits(bits, &count, frame->dlc, 4);
+    if (!frame->rtr) {
+        for (int i = 0; i < dlc; i++) {
+            put_bits(bits, &count, frame->data[i], 8);
+        }
+    }
+
+    uint16_t crc = 0;
+    for (int i = 0; i < count; i++) {
+        int feedback = ((crc >> 14) & 1) ^ bits[i];
+        crc = (crc << 1) & 0x7FFF;
+        if (feedback) {
+            crc ^= 0x4599;
+        }
+    }
+    put_bits(bits, &count, crc, 15);
+
+    // After five equal bits a complement is inserted, which starts the next run
+    uint32_t stuff_bits = 0;
+    int run = 1;
+    uint8_t last = bits[0];
+    for (int i = 1; i < count; i++) {
+        if (bits[i] == last) {
+            if (++run == 5) {
+                stuff_bits++;
+                last ^= 1;
+                run = 1;
+            }
+        } else {
+            last = bits[i];
+            run = 1;
+        }
+    }
+    return (uint32_t)count + stuff_bits + VCAN_TRAILER_BITS;
+}
@@ -0,0 +1,36 @@
+#ifndef VCAN_FRAME_H
+#define VCAN_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Classic CAN frame properties the virtual bus needs: the arbitration
+ * order and the exact length on the wire.
+ */
+#define VCAN_TRAILER_BITS       13      // CRC delimiter, ACK slot + delimiter, EOF, IFS
+#define VCAN_ERROR_FRAME_BITS   17      // error flag, delimiter and IFS
+#define VCAN_RECOVERY_BITS      (128 * 11)
+
+typedef struct {
+    uint32_t identifier;
+    bool extended;
+    bool rtr;
+    uint8_t dlc;
+    uint8_t data[8];
+} vcan_frame_t;
+
+/**
+ * @brief Arbitration key; the lower key wins. Follows the bit order on
+ *        the wire, so a standard frame beats an extended frame with the
+ *        same base ID and a data frame beats a remote frame.
+ */
+uint64_t vcan_frame_arbitration_key(const vcan_frame_t *frame);
+
+/**
+ * @brief Bits from SOF to the end of the interframe space, with the stuff
+ *        bits this frame's contents and CRC actually need.
+ */
+uint32_t vcan_frame_wire_bits(const vcan_frame_t *frame);
+
+#endif // VCAN_FRAME_H
@@ -0,0 +1,64 @@
+#ifndef VCAN_PROTOCOL_H
+#define VCAN_PROTOCOL_H
+
+#include <stdint.h>
+
+/*
+ * Messages between host nodes (port/twai_host.c) and the virtual bus
+ * (bus/vcan_broker.c), one vcan_packet_t per SOCK_SEQPACKET datagram on
+ * a UNIX-domain socket.
+ *
+ * A node sends HELLO once after connecting, then TX for each frame it
+ * queues. The bus keeps a FIFO per node and models a controller with
+ * one TX buffer: only the head frame of each node takes part in
+ * arbitration and it is retried automatically after an error unless it
+ * is single-shot. Every event carries the node's error counters as the
+ * bus computed them.
+ */
+#define VCAN_DEFAULT_SOCKET     "/tmp/vcan0.sock"
+#define VCAN_NAME_LEN           16
+
+enum {
+    VCAN_MSG_HELLO = 1,         // node -> bus: name, bitrate, mode
+    VCAN_MSG_TX,                // node -> bus: queue a frame
+    VCAN_MSG_RECOVER,           // node -> bus: start bus-off recovery
+    VCAN_MSG_RX,                // bus -> node: frame received
+    VCAN_MSG_TX_DONE,           // bus -> node: head frame sent and acknowledged
+    VCAN_MSG_TX_FAILED,         // bus -> node: single-shot head frame dropped after an error
+    VCAN_MSG_ARB_LOST,          // bus -> node: head frame lost arbitration, still queued
+    VCAN_MSG_BUS_ERROR,         // bus -> node: error frame on the bus (flags: VCAN_ERR_*)
+    VCAN_MSG_BUS_OFF,           // bus -> node: TEC passed 255, queued frames dropped
+    VCAN_MSG_RECOVERED,         // bus -> node: recovery complete, node is stopped
+};
+
+#define VCAN_FLAG_EXTD          0x01    // same bits as TWAI_MSG_FLAG_*
+#define VCAN_FLAG_RTR           0x02
+#define VCAN_FLAG_SS            0x04
+#define VCAN_FLAG_SELF          0x08
+
+#define VCAN_ERR_TX             0x01    // this node was the transmitter
+#define VCAN_ERR_ACK            0x02    // nobody acknowledged
+#define VCAN_ERR_BITRATE        0x04    // node and bus bitrates differ
+#define VCAN_ERR_INJECTED       0x08    // error injected by the bus
+
+enum {
+    VCAN_MODE_NORMAL,           // same order as twai_mode_t
+    VCAN_MODE_NO_ACK,
+    VCAN_MODE_LISTEN_ONLY,
+};
+
+typedef struct {
+    uint8_t type;
+    uint8_t mode;               // HELLO
+    uint8_t dlc;
+    uint8_t flags;              // VCAN_FLAG_* for frames, VCAN_ERR_* for BUS_ERROR
+    uint16_t tec;
+    uint16_t rec;
+    uint32_t bitrate;           // HELLO
+    uint32_t identifier;
+    uint8_t data[8];
+    int64_t timestamp_ns;       // CLOCK_MONOTONIC end of frame on the bus
+    char name[VCAN_NAME_LEN];   // HELLO
+} vcan_packet_t;
+
+#endif // VCAN_PROTOCOL_H
@@ -0,0 +1,14 @@
+#ifndef HOST_ESP_CPU_H
+#define HOST_ESP_CPU_H
+
+#include <stdint.h>
+
+/*
+ * Host build: one "cycle" is one nanosecond of CLOCK_MONOTONIC, so cycle
+ * counts printed by the firmware read as nanoseconds on the host.
+ */
+typedef uint32_t esp_cpu_cycle_count_t;
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+#endif // HOST_ESP_CPU_H
@@ -0,0 +1,48 @@
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#include <stdint.h>
+
+/*
+ * Host build: logs go to stdout as "<level> (<ms>) <node> <tag>: ...".
+ *
+ * Formats are checked as printf formats. uint32_t is unsigned long on the
+ * ESP32 but unsigned int here, so firmware passes %lu/%lx arguments
+ * through (unsigned long) casts, which print the same on both.
+ */
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+void esp_log_level_set(const char *tag, esp_log_level_t level);
+uint32_t esp_log_timestamp(void);
+
+// Prefixed line for ESP_LOGx; the plain esp_log_write() prints as is
+void esp_log_line(esp_log_level_t level, const char *tag, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+// As in the IDF, a file may define LOG_LOCAL_LEVEL first to compile out lower levels
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
+#endif
+
+#define ESP_LOG_LEVEL(level, tag, format, ...)  esp_log_line(level, tag, format, ##__VA_ARGS__)
+#define ESP_LOG_LEVEL_LOCAL(level, tag, format, ...) do {                          \
+        if (LOG_LOCAL_LEVEL >= (level)) {                                           \
+            esp_log_line(level, tag, format, ##__VA_ARGS__);                        \
+        }                                                                           \
+    } while (0)
+#define ESP_LOGE(tag, format, ...)  ESP_LOG_LEVEL_LOCAL(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...)  ESP_LOG_LEVEL_LOCAL(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)  ESP_LOG_LEVEL_LOCAL(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...)  ESP_LOG_LEVEL_LOCAL(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...)  ESP_LOG_LEVEL_LOCAL(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+
+#endif // HOST_ESP_LOG_H
@@ -0,0 +1,56 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/*
+ * Host build: the FreeRTOS subset used by the firmware, on POSIX threads
+ * (port/freertos_host.c). Tasks are threads, priorities and stack sizes
+ * are accepted and ignored, the tick is 1 ms. A portMUX_TYPE is a
+ * recursive mutex, so critical sections exclude each other but, unlike
+ * on the ESP32, do not stop other tasks from running.
+ */
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define configTICK_RATE_HZ      1000
+#define configMAX_PRIORITIES    25
+#define portTICK_PERIOD_MS      (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFF)
+#define portNUM_PROCESSORS      2
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define pdTICKS_TO_MS(ticks)    ((uint32_t)(((uint64_t)(ticks) * 1000) / configTICK_RATE_HZ))
+
+#define pdFALSE                 0
+#define pdTRUE                  1
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+#define errQUEUE_FULL           0
+#define errQUEUE_EMPTY          0
+#define tskIDLE_PRIORITY        0
+#define tskNO_AFFINITY          0x7FFFFFFF
+
+typedef struct {
+    pthread_mutex_t mutex;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP }
+
+void vPortEnterCritical(portMUX_TYPE *mux);
+void vPortExitCritical(portMUX_TYPE *mux);
+BaseType_t xPortGetCoreID(void);
+
+#define portENTER_CRITICAL(mux)         vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)          vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux)     vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)      vPortExitCritical(mux)
+#define taskENTER_CRITICAL(mux)         vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL(mux)          vPortExitCritical(mux)
+#define taskENTER_CRITICAL_ISR(mux)     vPortEnterCritical(mux)
+#define taskEXIT_CRITICAL_ISR(mux)      vPortExitCritical(mux)
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,22 @@
+#ifndef HOST_FREERTOS_SEMPHR_H
+#define HOST_FREERTOS_SEMPHR_H
+
+#include "queue.h"
+
+/*
+ * Semaphores are zero-size queues, as in FreeRTOS: giving posts an item,
+ * taking removes one. A mutex starts with its one item available.
+ */
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+
+#define xSemaphoreTake(sem, ticks)              xQueueReceive(sem, NULL, ticks)
+#define xSemaphoreGive(sem)                     xQueueSend(sem, NULL, 0)
+#define xSemaphoreGiveFromISR(sem, woken)       xQueueSend(sem, NULL, 0)
+#define vSemaphoreDelete(sem)                   vQueueDelete(sem)
+#define uxSemaphoreGetCount(sem)                uxQueueMessagesWaiting(sem)
+
+#endif // HOST_FREERTOS_SEMPHR_H
@@ -0,0 +1,14 @@
+#include "receiver_cli.h"
+#include "esp_log.h"
+
+/*
+ * Host stand-in for the receiver console: there is no UART, so the
+ * commands are not registered. Statistics still appear in the log.
+ */
+static const char *TAG_CLI = "RECEIVER_CLI";
+
+esp_err_t receiver_cli_start(void)
+{
+    ESP_LOGI(TAG_CLI, "No console in the host build");
+    return ESP_OK;
+}
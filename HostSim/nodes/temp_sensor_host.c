@@ -0,0 +1,46 @@
+#include "temp_sensor.h"
+#include <math.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "deferred_log.h"
+#include "utils/CAN/can_config.h"
+
+/*
+ * Host stand-in for the LM35 reader: a slow sine around 25 C instead of
+ * the ADC, pushed into temperature_queue in the same sample format.
+ * HOSTSIM_TEMP_PERIOD_MS overrides the 2 s sample period to load the bus.
+ */
+static const char *TAG_LM35 = "LM35_TASK";
+
+void lm35_reader_task(void *pvParameters) {
+    const char *period_env = getenv("HOSTSIM_TEMP_PERIOD_MS");
+    uint32_t period_ms = period_env != NULL && *period_env != '\0' ? (uint32_t)strtoul(period_env, NULL, 0) : 2000;
+    if (period_ms == 0) {
+        period_ms = 1;
+    }
+    ESP_LOGI(TAG_LM35, "LM35 Reader Task Started. Simulated sensor, one sample every %lu ms", (unsigned long)period_ms);
+
+    uint32_t sample_index = 0;
+    while (1) {
+        float temperature_c = 25.0f + 5.0f * sinf((float)sample_index++ * 0.05f);
+        // Log the sample as queued, not the unrounded reading
+#if TEMP_SAMPLE_USE_FLOAT
+        temp_sample_t temperature = temperature_c;
+        DLOGI(TAG_LM35, "Simulated temperature: %.2f C", temperature);
+#else
+        temp_sample_t temperature = (temp_sample_t)lrintf(temperature_c * 100.0f);
+        DLOGI(TAG_LM35, "Simulated temperature: %d centi-C", (int)temperature);
+#endif
+
+        if (temperature_queue != NULL) {
+            if (xQueueSend(temperature_queue, &temperature, pdMS_TO_TICKS(100)) != pdPASS) {
+                ESP_LOGE(TAG_LM35, "Failed to send temperature to queue");
+            }
+        } else {
+            ESP_LOGE(TAG_LM35, "Temperature queue not initialized!");
+        }
+        vTaskDelay(pdMS_TO_TICKS(period_ms));
+    }
+}
@@ -0,0 +1,389 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "freertos/task.h"
+#include "host_time.h"
+#include "host_main.h"
+
+// ---- Boot time ------------------------------------------------------------
+
+static int64_t boot_ns;
+
+__attribute__((constructor)) static void host_record_boot(void)
+{
+    boot_ns = host_now_ns();
+}
+
+int64_t host_boot_ns(void)
+{
+    return boot_ns;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return (host_now_ns() - boot_ns) / 1000;
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void)
+{
+    return (esp_cpu_cycle_count_t)host_now_ns();
+}
+
+// ---- Errors ---------------------------------------------------------------
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK:                        return "ESP_OK";
+        case ESP_FAIL:                      return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:                return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:           return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:         return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:          return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:             return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:         return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:               return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_NVS_NOT_FOUND:         return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_NO_FREE_PAGES:     return "ESP_ERR_NVS_NO_FREE_PAGES";
+        case ESP_ERR_NVS_NEW_VERSION_FOUND: return "ESP_ERR_NVS_NEW_VERSION_FOUND";
+        default:                            return "UNKNOWN ERROR";
+    }
+}
+
+// ---- Logging --------------------------------------------------------------
+
+static esp_log_level_t log_level = ESP_LOG_INFO;
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    // Per-tag levels are not kept on the host; "*" and any tag set the global level
+    (void)tag;
+    log_level = level;
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static void host_log_vwrite(const char *format, va_list args)
+{
+    pthread_mutex_lock(&log_lock);
+    vprintf(format, args);
+    fflush(stdout);
+    pthread_mutex_unlock(&log_lock);
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    (void)tag;
+    if (level > log_level) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    host_log_vwrite(format, args);
+    va_end(args);
+}
+
+void esp_log_line(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    static const char level_chars[] = { 'N', 'E', 'W', 'I', 'D', 'V' };
+    if (level > log_level) {
+        return;
+    }
+    char line[512];
+    snprintf(line, sizeof(line), "%c (%u) %s %s: %s\n", level_chars[level], esp_log_timestamp(),
+             host_node_name(), tag, format);
+    va_list args;
+    va_start(args, format);
+    host_log_vwrite(line, args);
+    va_end(args);
+}
+
+// ---- esp_timer --------------------------------------------------------------
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    int64_t due_ns;
+    int64_t period_ns;          // 0 = one-shot
+    bool armed;
+    struct esp_timer *next;     // armed list, earliest first
+};
+
+static pthread_mutex_t timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timer_changed;
+static struct esp_timer *armed_timers;
+static bool timer_thread_started;
+
+static void timer_unlink(struct esp_timer *timer)
+{
+    for (struct esp_timer **p = &armed_timers; *p != NULL; p = &(*p)->next) {
+        if (*p == timer) {
+            *p = timer->next;
+            break;
+        }
+    }
+    timer->armed = false;
+}
+
+static void timer_insert(struct esp_timer *timer)
+{
+    struct esp_timer **p = &armed_timers;
+    while (*p != NULL && (*p)->due_ns <= timer->due_ns) {
+        p = &(*p)->next;
+    }
+    timer->next = *p;
+    *p = timer;
+    timer->armed = true;
+    pthread_cond_signal(&timer_changed);
+}
+
+static void *timer_thread(void *arg)
+{
+    (void)arg;
+    pthread_setname_np(pthread_self(), "esp_timer");
+    pthread_mutex_lock(&timer_lock);
+    while (1) {
+        if (armed_timers == NULL) {
+            pthread_cond_wait(&timer_changed, &timer_lock);
+            continue;
+        }
+        struct esp_timer *timer = armed_timers;
+        if (host_now_ns() < timer->due_ns) {
+            host_cond_wait_until(&timer_changed, &timer_lock, timer->due_ns);
+            continue;
+        }
+        timer_unlink(timer);
+        if (timer->period_ns > 0) {
+            timer->due_ns += timer->period_ns;
+            timer_insert(timer);
+        }
+        esp_timer_cb_t callback = timer->callback;
+        void *callback_arg = timer->arg;
+        pthread_mutex_unlock(&timer_lock);
+        callback(callback_arg);
+        pthread_mutex_lock(&timer_lock);
+    }
+    return NULL;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    if (create_args == NULL || create_args->callback == NULL || out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct esp_timer *timer = calloc(1, sizeof(*timer));
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->callback = create_args->callback;
+    timer->arg = create_args->arg;
+
+    pthread_mutex_lock(&timer_lock);
+    if (!timer_thread_started) {
+        host_cond_init(&timer_changed);
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, timer_thread, NULL) != 0) {
+            pthread_mutex_unlock(&timer_lock);
+            free(timer);
+            return ESP_FAIL;
+        }
+        pthread_detach(thread);
+        timer_thread_started = true;
+    }
+    pthread_mutex_unlock(&timer_lock);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t timer, uint64_t timeout_us, bool periodic)
+{
+    pthread_mutex_lock(&timer_lock);
+    if (timer->armed) {
+        pthread_mutex_unlock(&timer_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->due_ns = host_now_ns() + (int64_t)timeout_us * 1000;
+    timer->period_ns = periodic ? (int64_t)timeout_us * 1000 : 0;
+    timer_insert(timer);
+    pthread_mutex_unlock(&timer_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return timer_start(timer, timeout_us, false);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    return timer_start(timer, period, true);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&timer_lock);
+    bool armed = timer->armed;
+    if (armed) {
+        timer_unlink(timer);
+    }
+    pthread_mutex_unlock(&timer_lock);
+    return armed ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&timer_lock);
+    bool armed = timer->armed;
+    pthread_mutex_unlock(&timer_lock);
+    if (armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    free(timer);
+    return ESP_OK;
+}
+
+// ---- NVS (in memory) --------------------------------------------------------
+
+#define HOST_NVS_MAX_ENTRIES    16
+#define HOST_NVS_NAME_LEN       16
+
+typedef struct {
+    char namespace_name[HOST_NVS_NAME_LEN];
+    char key[HOST_NVS_NAME_LEN];
+    void *value;
+    size_t length;
+} host_nvs_entry_t;
+
+static host_nvs_entry_t nvs_entries[HOST_NVS_MAX_ENTRIES];
+static char nvs_namespaces[HOST_NVS_MAX_ENTRIES][HOST_NVS_NAME_LEN];
+static pthread_mutex_t nvs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+esp_err_t nvs_flash_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    pthread_mutex_lock(&nvs_lock);
+    for (int i = 0; i < HOST_NVS_MAX_ENTRIES; i++) {
+        free(nvs_entries[i].value);
+    }
+    memset(nvs_entries, 0, sizeof(nvs_entries));
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    (void)open_mode;
+    pthread_mutex_lock(&nvs_lock);
+    for (int i = 0; i < HOST_NVS_MAX_ENTRIES; i++) {
+        if (nvs_namespaces[i][0] == '\0') {
+            strncpy(nvs_namespaces[i], namespace_name, HOST_NVS_NAME_LEN - 1);
+        }
+        if (strncmp(nvs_namespaces[i], namespace_name, HOST_NVS_NAME_LEN - 1) == 0) {
+            pthread_mutex_unlock(&nvs_lock);
+            *out_handle = (nvs_handle_t)i + 1;
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_ERR_NO_MEM;
+}
+
+static host_nvs_entry_t *nvs_find(nvs_handle_t handle, const char *key)
+{
+    const char *namespace_name = nvs_namespaces[handle - 1];
+    for (int i = 0; i < HOST_NVS_MAX_ENTRIES; i++) {
+        if (nvs_entries[i].value != NULL && strcmp(nvs_entries[i].namespace_name, namespace_name) == 0 &&
+            strncmp(nvs_entries[i].key, key, HOST_NVS_NAME_LEN - 1) == 0) {
+            return &nvs_entries[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    pthread_mutex_lock(&nvs_lock);
+    host_nvs_entry_t *entry = nvs_find(handle, key);
+    esp_err_t ret = ESP_ERR_NVS_NOT_FOUND;
+    if (entry != NULL) {
+        if (out_value == NULL) {
+            ret = ESP_OK;
+        } else if (*length < entry->length) {
+            ret = ESP_ERR_INVALID_SIZE;
+        } else {
+            memcpy(out_value, entry->value, entry->length);
+            ret = ESP_OK;
+        }
+        *length = entry->length;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return ret;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    void *copy = malloc(length ? length : 1);
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, value, length);
+
+    pthread_mutex_lock(&nvs_lock);
+    host_nvs_entry_t *entry = nvs_find(handle, key);
+    for (int i = 0; entry == NULL && i < HOST_NVS_MAX_ENTRIES; i++) {
+        if (nvs_entries[i].value == NULL) {
+            entry = &nvs_entries[i];
+            strncpy(entry->namespace_name, nvs_namespaces[handle - 1], HOST_NVS_NAME_LEN - 1);
+            strncpy(entry->key, key, HOST_NVS_NAME_LEN - 1);
+        }
+    }
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    if (entry != NULL) {
+        free(entry->value);
+        entry->value = copy;
+        entry->length = length;
+        ret = ESP_OK;
+    } else {
+        free(copy);
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return ret;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    pthread_mutex_lock(&nvs_lock);
+    host_nvs_entry_t *entry = nvs_find(handle, key);
+    if (entry != NULL) {
+        free(entry->value);
+        memset(entry, 0, sizeof(*entry));
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return entry != NULL ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    (void)handle;
+}
@@ -0,0 +1,356 @@
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "host_time.h"
+
+#define HOST_TASK_NAME_LEN 16
+
+struct host_task {
+    pthread_t thread;
+    char name[HOST_TASK_NAME_LEN];
+    TaskFunction_t code;
+    void *parameters;
+    pthread_mutex_t lock;
+    pthread_cond_t notified;
+    uint32_t notify_count;
+};
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    uint32_t length;
+    uint32_t item_size;
+    uint32_t head;
+    uint32_t count;
+    uint8_t *storage;           // NULL for semaphores
+};
+
+static __thread struct host_task *current_task;
+
+// ---- Critical sections ----------------------------------------------------
+
+void vPortEnterCritical(portMUX_TYPE *mux)
+{
+    pthread_mutex_lock(&mux->mutex);
+}
+
+void vPortExitCritical(portMUX_TYPE *mux)
+{
+    pthread_mutex_unlock(&mux->mutex);
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+    int cpu = sched_getcpu();
+    return cpu < 0 ? 0 : cpu % portNUM_PROCESSORS;
+}
+
+// ---- Tasks ----------------------------------------------------------------
+
+static struct host_task *host_task_new(const char *name)
+{
+    struct host_task *task = calloc(1, sizeof(*task));
+    if (task == NULL) {
+        return NULL;
+    }
+    strncpy(task->name, name ? name : "", HOST_TASK_NAME_LEN - 1);
+    pthread_mutex_init(&task->lock, NULL);
+    host_cond_init(&task->notified);
+    return task;
+}
+
+static void *host_task_entry(void *arg)
+{
+    struct host_task *task = arg;
+    current_task = task;
+    pthread_setname_np(pthread_self(), task->name);
+    task->code(task->parameters);
+    // Returning from a task function is an error in FreeRTOS; end the thread quietly
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task_code, const char *name, uint32_t stack_depth,
+                                   void *parameters, UBaseType_t priority, TaskHandle_t *created_task,
+                                   BaseType_t core_id)
+{
+    (void)stack_depth;
+    (void)priority;
+    (void)core_id;
+    struct host_task *task = host_task_new(name);
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    task->code = task_code;
+    task->parameters = parameters;
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int ret = pthread_create(&task->thread, &attr, host_task_entry, task);
+    pthread_attr_destroy(&attr);
+    if (ret != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    if (created_task != NULL) {
+        *created_task = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task_code, const char *name, uint32_t stack_depth,
+                       void *parameters, UBaseType_t priority, TaskHandle_t *created_task)
+{
+    return xTaskCreatePinnedToCore(task_code, name, stack_depth, parameters, priority, created_task,
+                                   tskNO_AFFINITY);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    // Threads not started by xTaskCreate (main, timer, driver) get a handle on first use
+    if (current_task == NULL) {
+        char name[HOST_TASK_NAME_LEN] = "";
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        current_task = host_task_new(name);
+        if (current_task != NULL) {
+            current_task->thread = pthread_self();
+        }
+    }
+    return current_task;
+}
+
+const char *pcTaskGetName(TaskHandle_t task)
+{
+    if (task == NULL) {
+        task = xTaskGetCurrentTaskHandle();
+    }
+    return task ? task->name : "";
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL || task == current_task) {
+        pthread_exit(NULL);
+    }
+    pthread_cancel(task->thread);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = host_ns_to_timespec(host_now_ns() + (int64_t)pdTICKS_TO_MS(ticks) * 1000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)((host_now_ns() - host_boot_ns()) / (1000000000LL / configTICK_RATE_HZ));
+}
+
+void vTaskDelayUntil(TickType_t *previous_wake_time, TickType_t increment)
+{
+    *previous_wake_time += increment;
+    TickType_t now = xTaskGetTickCount();
+    int32_t remaining = (int32_t)(*previous_wake_time - now);
+    if (remaining > 0) {
+        vTaskDelay((TickType_t)remaining);
+    }
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify_count++;
+    pthread_cond_signal(&task->notified);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_task_woken)
+{
+    xTaskNotifyGive(task);
+    if (higher_priority_task_woken != NULL) {
+        *higher_priority_task_woken = pdFALSE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    struct host_task *task = xTaskGetCurrentTaskHandle();
+    int64_t deadline = host_deadline_ns(ticks_to_wait);
+
+    pthread_mutex_lock(&task->lock);
+    while (task->notify_count == 0 && ticks_to_wait > 0) {
+        if (!host_cond_wait_until(&task->notified, &task->lock, deadline) && host_now_ns() >= deadline) {
+            break;
+        }
+    }
+    uint32_t value = task->notify_count;
+    if (value > 0) {
+        task->notify_count = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+// ---- Queues and semaphores ------------------------------------------------
+
+static struct host_queue *host_queue_new(UBaseType_t length, UBaseType_t item_size)
+{
+    struct host_queue *queue = calloc(1, sizeof(*queue));
+    if (queue == NULL || length == 0) {
+        free(queue);
+        return NULL;
+    }
+    if (item_size > 0) {
+        queue->storage = malloc((size_t)length * item_size);
+        if (queue->storage == NULL) {
+            free(queue);
+            return NULL;
+        }
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    pthread_mutex_init(&queue->lock, NULL);
+    host_cond_init(&queue->not_empty);
+    host_cond_init(&queue->not_full);
+    return queue;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    return host_queue_new(length, item_size);
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    if (queue == NULL) {
+        return;
+    }
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_cond_destroy(&queue->not_full);
+    free(queue->storage);
+    free(queue);
+}
+
+static BaseType_t host_queue_put(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait, bool front)
+{
+    int64_t deadline = host_deadline_ns(ticks_to_wait);
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->length) {
+        if (ticks_to_wait == 0 ||
+            (!host_cond_wait_until(&queue->not_full, &queue->lock, deadline) && host_now_ns() >= deadline)) {
+            pthread_mutex_unlock(&queue->lock);
+            return errQUEUE_FULL;
+        }
+    }
+    uint32_t index;
+    if (front) {
+        queue->head = (queue->head + queue->length - 1) % queue->length;
+        index = queue->head;
+    } else {
+        index = (queue->head + queue->count) % queue->length;
+    }
+    if (queue->storage != NULL) {
+        memcpy(queue->storage + (size_t)index * queue->item_size, item, queue->item_size);
+    }
+    queue->count++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+static BaseType_t host_queue_get(QueueHandle_t queue, void *buffer, TickType_t ticks_to_wait, bool remove)
+{
+    int64_t deadline = host_deadline_ns(ticks_to_wait);
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0) {
+        if (ticks_to_wait == 0 ||
+            (!host_cond_wait_until(&queue->not_empty, &queue->lock, deadline) && host_now_ns() >= deadline)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    if (queue->storage != NULL && buffer != NULL) {
+        memcpy(buffer, queue->storage + (size_t)queue->head * queue->item_size, queue->item_size);
+    }
+    if (remove) {
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+        pthread_cond_signal(&queue->not_full);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait)
+{
+    return host_queue_put(queue, item, ticks_to_wait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait)
+{
+    return host_queue_put(queue, item, ticks_to_wait, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks_to_wait)
+{
+    return host_queue_get(queue, buffer, ticks_to_wait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *buffer, TickType_t ticks_to_wait)
+{
+    return host_queue_get(queue, buffer, ticks_to_wait, false);
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    queue->head = 0;
+    queue->count = 0;
+    pthread_cond_broadcast(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&queue->lock);
+    UBaseType_t spaces = queue->length - queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return spaces;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return host_queue_new(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    struct host_queue *queue = host_queue_new(max_count, 0);
+    if (queue != NULL) {
+        queue->count = initial_count > max_count ? max_count : initial_count;
+    }
+    return queue;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
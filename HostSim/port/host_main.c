@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <getopt.h>
+#include "host_main.h"
+#include "vcan_protocol.h"
+
+/*
+ * Entry point of a firmware image built for the host: parse the node
+ * options, run app_main() like the ESP-IDF main task does, then keep the
+ * process alive for the tasks it started.
+ */
+void app_main(void);
+
+static const char *node_name = "node";
+static const char *bus_path = NULL;
+
+const char *host_node_name(void)
+{
+    return node_name;
+}
+
+const char *host_bus_path(void)
+{
+    return bus_path;
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [-n name] [-b socket] [-t seconds]\n"
+            "  -n  node name used in logs and by the bus (default: node)\n"
+            "  -b  virtual bus socket (default: $VCAN_SOCKET or %s)\n"
+            "  -t  exit after this many seconds (default: run until killed)\n",
+            program, VCAN_DEFAULT_SOCKET);
+}
+
+int main(int argc, char **argv)
+{
+    int duration_s = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:b:t:h")) != -1) {
+        switch (opt) {
+            case 'n': node_name = optarg; break;
+            case 'b': bus_path = optarg; break;
+            case 't': duration_s = atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+    if (bus_path == NULL) {
+        bus_path = getenv("VCAN_SOCKET") ? getenv("VCAN_SOCKET") : VCAN_DEFAULT_SOCKET;
+    }
+    // A node that loses the bus must not die on a write to the closed socket
+    signal(SIGPIPE, SIG_IGN);
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    app_main();
+
+    if (duration_s > 0) {
+        sleep((unsigned)duration_s);
+        return 0;
+    }
+    while (1) {
+        pause();
+    }
+}
@@ -0,0 +1,10 @@
+#ifndef HOST_MAIN_H
+#define HOST_MAIN_H
+
+/*
+ * Process-level settings of a host node, from its command line.
+ */
+const char *host_node_name(void);
+const char *host_bus_path(void);
+
+#endif // HOST_MAIN_H
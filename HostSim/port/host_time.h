@@ -0,0 +1,56 @@
+#ifndef HOST_TIME_H
+#define HOST_TIME_H
+
+#include <stdint.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+
+/*
+ * Clock helpers shared by the host port. All waits use CLOCK_MONOTONIC
+ * absolute deadlines so they are immune to wall-clock changes.
+ */
+static inline int64_t host_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static inline struct timespec host_ns_to_timespec(int64_t ns)
+{
+    struct timespec ts = { .tv_sec = ns / 1000000000LL, .tv_nsec = ns % 1000000000LL };
+    return ts;
+}
+
+// Absolute deadline for a FreeRTOS timeout; portMAX_DELAY gives INT64_MAX
+static inline int64_t host_deadline_ns(TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY) {
+        return INT64_MAX;
+    }
+    return host_now_ns() + (int64_t)pdTICKS_TO_MS(ticks) * 1000000LL;
+}
+
+// Wait on a condition variable created with host_cond_init(); false on timeout
+static inline bool host_cond_wait_until(pthread_cond_t *cond, pthread_mutex_t *mutex, int64_t deadline_ns)
+{
+    if (deadline_ns == INT64_MAX) {
+        pthread_cond_wait(cond, mutex);
+        return true;
+    }
+    struct timespec ts = host_ns_to_timespec(deadline_ns);
+    return pthread_cond_timedwait(cond, mutex, &ts) == 0;
+}
+
+static inline void host_cond_init(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+int64_t host_boot_ns(void);
+
+#endif // HOST_TIME_H
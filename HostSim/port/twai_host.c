@@ -0,0 +1,551 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "driver/twai.h"
+#include "esp_log.h"
+#include "host_time.h"
+#include "host_main.h"
+#include "vcan_protocol.h"
+
+/*
+ * TWAI driver on the virtual bus. twai_start() connects to the broker and
+ * twai_stop() disconnects; in between a receive thread turns bus events
+ * into RX queue entries, alerts and status counters the way the ESP32
+ * controller and IDF driver report them. Arbitration, timing and error
+ * counters are the broker's; this side only applies the acceptance
+ * filter, the queue lengths and the alert mask.
+ */
+static const char *TAG = "twai_host";
+
+#define TWAI_APB_CLK_HZ         80000000
+#define TWAI_ERR_WARN_LIMIT     96          // ESP32 default error warning limit
+#define TWAI_ERR_PASSIVE_LIMIT  128
+
+static struct {
+    bool installed;
+    twai_general_config_t general;
+    twai_filter_config_t filter;
+    uint32_t bitrate;
+    twai_state_t state;
+    int fd;
+    pthread_t rx_thread;
+    bool rx_thread_running;
+
+    twai_message_t *rx_queue;       // ring of general.rx_queue_len frames
+    uint32_t rx_head;
+    uint32_t rx_count;
+    uint32_t tx_outstanding;        // sent to the bus, not yet done or failed
+    uint32_t tx_capacity;           // TX queue plus the controller's TX buffer
+
+    uint32_t alerts;                // raised and enabled, not yet read
+    uint16_t tec;
+    uint16_t rec;
+    uint32_t tx_failed_count;
+    uint32_t rx_missed_count;
+    uint32_t arb_lost_count;
+    uint32_t bus_error_count;
+} twai = { .fd = -1 };
+
+static pthread_mutex_t twai_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t twai_changed;
+static pthread_once_t twai_once = PTHREAD_ONCE_INIT;
+
+static void twai_init_cond(void)
+{
+    host_cond_init(&twai_changed);
+}
+
+static void raise_alerts(uint32_t alerts)
+{
+    twai.alerts |= alerts & twai.general.alerts_enabled;
+    pthread_cond_broadcast(&twai_changed);
+}
+
+static uint32_t timing_bitrate(const twai_timing_config_t *t_config)
+{
+    uint32_t quanta = 1 + t_config->tseg_1 + t_config->tseg_2;
+    if (t_config->quanta_resolution_hz != 0) {
+        return t_config->quanta_resolution_hz / quanta;
+    }
+    return t_config->brp != 0 ? TWAI_APB_CLK_HZ / t_config->brp / quanta : 0;
+}
+
+// ---- Acceptance filter ------------------------------------------------------
+// Same layout as the ESP32 (SJA1000) filter: code/mask bits line up with the
+// ID, RTR and leading data bits, a set mask bit means "don't care".
+
+static bool filter_match(uint32_t value, uint32_t code, uint32_t mask, uint32_t bits)
+{
+    return ((value ^ code) & ~mask & bits) == 0;
+}
+
+static bool filter_accepts(const twai_message_t *message)
+{
+    const twai_filter_config_t *f = &twai.filter;
+    uint32_t rtr = message->rtr ? 1 : 0;
+    uint8_t data0 = message->data_length_code > 0 && !message->rtr ? message->data[0] : 0;
+    uint8_t data1 = message->data_length_code > 1 && !message->rtr ? message->data[1] : 0;
+
+    if (f->single_filter) {
+        uint32_t value = message->extd ? (message->identifier << 3) | (rtr << 2)
+                                       : (message->identifier << 21) | (rtr << 20) | (data0 << 8) | data1;
+        uint32_t bits = message->extd ? 0xFFFFFFFC : 0xFFF0FFFF;
+        return filter_match(value, f->acceptance_code, f->acceptance_mask, bits);
+    }
+
+    if (message->extd) {
+        // Both filters see ID bits 28..13
+        uint32_t id_high = (message->identifier >> 13) & 0xFFFF;
+        return filter_match(id_high << 16, f->acceptance_code, f->acceptance_mask, 0xFFFF0000) ||
+               filter_match(id_high, f->acceptance_code, f->acceptance_mask, 0x0000FFFF);
+    }
+    // Filter 1: ID, RTR and the first data byte (split around filter 2)
+    uint32_t id_rtr = (message->identifier << 5) | (rtr << 4);
+    uint32_t value1 = ((id_rtr | (data0 >> 4)) << 16) | (data0 & 0x0F);
+    return filter_match(value1, f->acceptance_code, f->acceptance_mask, 0xFFFF000F) ||
+           filter_match(id_rtr, f->acceptance_code, f->acceptance_mask, 0x0000FFF0);
+}
+
+// ---- Bus events ---------------------------------------------------------------
+
+static void update_error_counters(uint16_t tec, uint16_t rec)
+{
+    bool was_warn = twai.tec >= TWAI_ERR_WARN_LIMIT || twai.rec >= TWAI_ERR_WARN_LIMIT;
+    bool was_passive = twai.tec >= TWAI_ERR_PASSIVE_LIMIT || twai.rec >= TWAI_ERR_PASSIVE_LIMIT;
+    twai.tec = tec;
+    twai.rec = rec;
+    bool warn = tec >= TWAI_ERR_WARN_LIMIT || rec >= TWAI_ERR_WARN_LIMIT;
+    bool passive = tec >= TWAI_ERR_PASSIVE_LIMIT || rec >= TWAI_ERR_PASSIVE_LIMIT;
+
+    if (warn && !was_warn) {
+        raise_alerts(TWAI_ALERT_ABOVE_ERR_WARN);
+    } else if (!warn && was_warn) {
+        raise_alerts(TWAI_ALERT_BELOW_ERR_WARN);
+    }
+    if (passive && !was_passive) {
+        raise_alerts(TWAI_ALERT_ERR_PASS);
+    } else if (!passive && was_passive && twai.state == TWAI_STATE_RUNNING) {
+        raise_alerts(TWAI_ALERT_ERR_ACTIVE);
+    }
+}
+
+static void tx_finished(void)
+{
+    if (twai.tx_outstanding > 0) {
+        twai.tx_outstanding--;
+    }
+    if (twai.tx_outstanding == 0) {
+        raise_alerts(TWAI_ALERT_TX_IDLE);
+    }
+}
+
+static void handle_event(const vcan_packet_t *packet)
+{
+    switch (packet->type) {
+        case VCAN_MSG_RX: {
+            twai_message_t message = {
+                .identifier = packet->identifier,
+                .data_length_code = packet->dlc,
+            };
+            message.extd = (packet->flags & VCAN_FLAG_EXTD) != 0;
+            message.rtr = (packet->flags & VCAN_FLAG_RTR) != 0;
+            memcpy(message.data, packet->data, sizeof(message.data));
+            if (!filter_accepts(&message)) {
+                break;
+            }
+            if (twai.rx_count == twai.general.rx_queue_len) {
+                twai.rx_missed_count++;
+                raise_alerts(TWAI_ALERT_RX_QUEUE_FULL);
+                break;
+            }
+            twai.rx_queue[(twai.rx_head + twai.rx_count) % twai.general.rx_queue_len] = message;
+            twai.rx_count++;
+            raise_alerts(TWAI_ALERT_RX_DATA);
+            break;
+        }
+        case VCAN_MSG_TX_DONE:
+            raise_alerts(TWAI_ALERT_TX_SUCCESS);
+            tx_finished();
+            break;
+        case VCAN_MSG_TX_FAILED:
+            twai.tx_failed_count++;
+            raise_alerts(TWAI_ALERT_TX_FAILED);
+            tx_finished();
+            break;
+        case VCAN_MSG_ARB_LOST:
+            twai.arb_lost_count++;
+            raise_alerts(TWAI_ALERT_ARB_LOST);
+            break;
+        case VCAN_MSG_BUS_ERROR:
+            twai.bus_error_count++;
+            raise_alerts(TWAI_ALERT_BUS_ERROR);
+            if (packet->flags & VCAN_ERR_TX) {
+                raise_alerts(TWAI_ALERT_TX_RETRIED);
+            }
+            break;
+        case VCAN_MSG_BUS_OFF:
+            // The controller drops everything queued for transmission
+            twai.state = TWAI_STATE_BUS_OFF;
+            twai.tx_outstanding = 0;
+            raise_alerts(TWAI_ALERT_BUS_OFF);
+            break;
+        case VCAN_MSG_RECOVERED:
+            twai.state = TWAI_STATE_STOPPED;
+            raise_alerts(TWAI_ALERT_BUS_RECOVERED);
+            break;
+        default:
+            break;
+    }
+    update_error_counters(packet->tec, packet->rec);
+}
+
+static void *rx_thread(void *arg)
+{
+    int fd = (int)(intptr_t)arg;
+    pthread_setname_np(pthread_self(), "twai_rx");
+    while (1) {
+        vcan_packet_t packet;
+        ssize_t length = recv(fd, &packet, sizeof(packet), 0);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length != sizeof(packet)) {
+            break;
+        }
+        pthread_mutex_lock(&twai_lock);
+        handle_event(&packet);
+        pthread_mutex_unlock(&twai_lock);
+    }
+    return NULL;
+}
+
+// Called with twai_lock held; the lock is dropped while the thread exits
+static void bus_disconnect(void)
+{
+    if (twai.fd < 0) {
+        return;
+    }
+    shutdown(twai.fd, SHUT_RDWR);
+    if (twai.rx_thread_running) {
+        pthread_mutex_unlock(&twai_lock);
+        pthread_join(twai.rx_thread, NULL);
+        pthread_mutex_lock(&twai_lock);
+        twai.rx_thread_running = false;
+    }
+    close(twai.fd);
+    twai.fd = -1;
+}
+
+static esp_err_t bus_connect(void)
+{
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strncpy(addr.sun_path, host_bus_path(), sizeof(addr.sun_path) - 1);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        ESP_LOGE(TAG, "Cannot reach the virtual bus at %s: %s", host_bus_path(), strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        return ESP_FAIL;
+    }
+
+    vcan_packet_t hello = {
+        .type = VCAN_MSG_HELLO,
+        .mode = (uint8_t)twai.general.mode,
+        .bitrate = twai.bitrate,
+    };
+    strncpy(hello.name, host_node_name(), VCAN_NAME_LEN - 1);
+    if (send(fd, &hello, sizeof(hello), 0) != sizeof(hello) ||
+        pthread_create(&twai.rx_thread, NULL, rx_thread, (void *)(intptr_t)fd) != 0) {
+        close(fd);
+        return ESP_FAIL;
+    }
+    twai.fd = fd;
+    twai.rx_thread_running = true;
+    return ESP_OK;
+}
+
+// ---- Driver API -----------------------------------------------------------------
+
+esp_err_t twai_driver_install(const twai_general_config_t *g_config, const twai_timing_config_t *t_config,
+                              const twai_filter_config_t *f_config)
+{
+    if (g_config == NULL || t_config == NULL || f_config == NULL || g_config->rx_queue_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t bitrate = timing_bitrate(t_config);
+    if (bitrate == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_once(&twai_once, twai_init_cond);
+
+    pthread_mutex_lock(&twai_lock);
+    if (twai.installed) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    twai.rx_queue = calloc(g_config->rx_queue_len, sizeof(twai_message_t));
+    if (twai.rx_queue == NULL) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    twai.general = *g_config;
+    twai.general.alerts_enabled &= TWAI_ALERT_ALL;
+    twai.filter = *f_config;
+    twai.bitrate = bitrate;
+    twai.state = TWAI_STATE_STOPPED;
+    twai.rx_head = twai.rx_count = 0;
+    twai.tx_outstanding = 0;
+    twai.tx_capacity = g_config->tx_queue_len + 1;
+    twai.alerts = 0;
+    twai.tec = twai.rec = 0;
+    twai.tx_failed_count = twai.rx_missed_count = twai.arb_lost_count = twai.bus_error_count = 0;
+    twai.installed = true;
+    pthread_mutex_unlock(&twai_lock);
+    return ESP_OK;
+}
+
+esp_err_t twai_driver_uninstall(void)
+{
+    pthread_mutex_lock(&twai_lock);
+    if (!twai.installed || twai.state == TWAI_STATE_RUNNING || twai.state == TWAI_STATE_RECOVERING) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    bus_disconnect();
+    free(twai.rx_queue);
+    twai.rx_queue = NULL;
+    twai.installed = false;
+    pthread_cond_broadcast(&twai_changed);
+    pthread_mutex_unlock(&twai_lock);
+    return ESP_OK;
+}
+
+esp_err_t twai_start(void)
+{
+    pthread_mutex_lock(&twai_lock);
+    if (!twai.installed || twai.state != TWAI_STATE_STOPPED) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    // After a bus-off recovery the old connection is still open
+    bus_disconnect();
+    twai.rx_head = twai.rx_count = 0;
+    twai.tx_outstanding = 0;
+    twai.tec = twai.rec = 0;
+    esp_err_t ret = bus_connect();
+    if (ret == ESP_OK) {
+        twai.state = TWAI_STATE_RUNNING;
+    }
+    pthread_mutex_unlock(&twai_lock);
+    return ret;
+}
+
+esp_err_t twai_stop(void)
+{
+    pthread_mutex_lock(&twai_lock);
+    if (!twai.installed || twai.state != TWAI_STATE_RUNNING) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    bus_disconnect();
+    twai.state = TWAI_STATE_STOPPED;
+    twai.tx_outstanding = 0;
+    pthread_cond_broadcast(&twai_changed);
+    pthread_mutex_unlock(&twai_lock);
+    return ESP_OK;
+}
+
+esp_err_t twai_transmit(const twai_message_t *message, TickType_t ticks_to_wait)
+{
+    if (message == NULL || (message->data_length_code > TWAI_FRAME_MAX_DLC && !message->dlc_non_comp)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int64_t deadline = host_deadline_ns(ticks_to_wait);
+
+    pthread_mutex_lock(&twai_lock);
+    if (!twai.installed || twai.state != TWAI_STATE_RUNNING) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (twai.general.mode == TWAI_MODE_LISTEN_ONLY) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    while (twai.tx_outstanding >= twai.tx_capacity) {
+        bool signalled = host_cond_wait_until(&twai_changed, &twai_lock, deadline);
+        if (twai.state != TWAI_STATE_RUNNING) {
+            pthread_mutex_unlock(&twai_lock);
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (!signalled && twai.tx_outstanding >= twai.tx_capacity) {
+            pthread_mutex_unlock(&twai_lock);
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+    twai.tx_outstanding++;
+    int fd = twai.fd;
+    pthread_mutex_unlock(&twai_lock);
+
+    vcan_packet_t packet = {
+        .type = VCAN_MSG_TX,
+        .dlc = message->data_length_code > TWAI_FRAME_MAX_DLC ? TWAI_FRAME_MAX_DLC : message->data_length_code,
+        .flags = (uint8_t)(message->flags & (VCAN_FLAG_EXTD | VCAN_FLAG_RTR | VCAN_FLAG_SS | VCAN_FLAG_SELF)),
+        .identifier = message->identifier & (message->extd ? TWAI_EXTD_ID_MASK : TWAI_STD_ID_MASK),
+    };
+    memcpy(packet.data, message->data, sizeof(packet.data));
+    if (send(fd, &packet, sizeof(packet), 0) != sizeof(packet)) {
+        pthread_mutex_lock(&twai_lock);
+        tx_finished();
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t twai_receive(twai_message_t *message, TickType_t ticks_to_wait)
+{
+    if (message == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int64_t deadline = host_deadline_ns(ticks_to_wait);
+
+    pthread_mutex_lock(&twai_lock);
+    if (!twai.installed) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    while (twai.rx_count == 0) {
+        if (!host_cond_wait_until(&twai_changed, &twai_lock, deadline) && twai.rx_count == 0) {
+            pthread_mutex_unlock(&twai_lock);
+            return ESP_ERR_TIMEOUT;
+        }
+        if (!twai.installed) {
+            pthread_mutex_unlock(&twai_lock);
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    *message = twai.rx_queue[twai.rx_head];
+    twai.rx_head = (twai.rx_head + 1) % twai.general.rx_queue_len;
+    twai.rx_count--;
+    pthread_mutex_unlock(&twai_lock);
+    return ESP_OK;
+}
+
+esp_err_t twai_read_alerts(uint32_t *alerts, TickType_t ticks_to_wait)
+{
+    if (alerts == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int64_t deadline = host_deadline_ns(ticks_to_wait);
+
+    pthread_mutex_lock(&twai_lock);
+    if (!twai.installed) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    while (twai.alerts == 0) {
+        if (!host_cond_wait_until(&twai_changed, &twai_lock, deadline) && twai.alerts == 0) {
+            *alerts = 0;
+            pthread_mutex_unlock(&twai_lock);
+            return ESP_ERR_TIMEOUT;
+        }
+        if (!twai.installed) {
+            pthread_mutex_unlock(&twai_lock);
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    *alerts = twai.alerts;
+    twai.alerts = 0;
+    pthread_mutex_unlock(&twai_lock);
+    return ESP_OK;
+}
+
+esp_err_t twai_reconfigure_alerts(uint32_t alerts_enabled, uint32_t *current_alerts)
+{
+    pthread_mutex_lock(&twai_lock);
+    if (!twai.installed) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (current_alerts != NULL) {
+        *current_alerts = twai.alerts;
+    }
+    twai.alerts = 0;
+    twai.general.alerts_enabled = alerts_enabled & TWAI_ALERT_ALL;
+    pthread_mutex_unlock(&twai_lock);
+    return ESP_OK;
+}
+
+esp_err_t twai_initiate_recovery(void)
+{
+    pthread_mutex_lock(&twai_lock);
+    if (!twai.installed || twai.state != TWAI_STATE_BUS_OFF) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    vcan_packet_t packet = { .type = VCAN_MSG_RECOVER };
+    if (send(twai.fd, &packet, sizeof(packet), 0) != sizeof(packet)) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_FAIL;
+    }
+    twai.state = TWAI_STATE_RECOVERING;
+    raise_alerts(TWAI_ALERT_RECOVERY_IN_PROGRESS);
+    pthread_mutex_unlock(&twai_lock);
+    return ESP_OK;
+}
+
+esp_err_t twai_get_status_info(twai_status_info_t *status_info)
+{
+    if (status_info == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&twai_lock);
+    if (!twai.installed) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    *status_info = (twai_status_info_t){
+        .state = twai.state,
+        .msgs_to_tx = twai.tx_outstanding,
+        .msgs_to_rx = twai.rx_count,
+        .tx_error_counter = twai.tec,
+        .rx_error_counter = twai.rec,
+        .tx_failed_count = twai.tx_failed_count,
+        .rx_missed_count = twai.rx_missed_count,
+        .arb_lost_count = twai.arb_lost_count,
+        .bus_error_count = twai.bus_error_count,
+    };
+    pthread_mutex_unlock(&twai_lock);
+    return ESP_OK;
+}
+
+esp_err_t twai_clear_transmit_queue(void)
+{
+    // Frames already handed to the bus cannot be recalled; only the
+    // accounting is reset so twai_transmit() does not block on them
+    pthread_mutex_lock(&twai_lock);
+    if (!twai.installed) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    twai.tx_outstanding = 0;
+    pthread_cond_broadcast(&twai_changed);
+    pthread_mutex_unlock(&twai_lock);
+    return ESP_OK;
+}
+
+esp_err_t twai_clear_receive_queue(void)
+{
+    pthread_mutex_lock(&twai_lock);
+    if (!twai.installed) {
+        pthread_mutex_unlock(&twai_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    twai.rx_head = twai.rx_count = 0;
+    pthread_mutex_unlock(&twai_lock);
+    return ESP_OK;
+}
@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+# Run TempTransmitter, TempReceiver and Base on one virtual bus and print the
+# bus report. Arguments after -- go to the broker, e.g. -- -e 1000 -v.
+#
+#   ./run_bus.sh [-d build dir] [-s seconds] [-p sample period ms] [-- broker args...]
+#
+# Node logs are left in <build dir>/logs. The last line of the output is the
+# broker's "summary ..." line, for scripts comparing runs.
+set -euo pipefail
+
+BUILD_DIR="$(dirname "$0")/build"
+SECONDS_TO_RUN=10
+PERIOD_MS=""
+while getopts "d:s:p:" opt; do
+    case "$opt" in
+        d) BUILD_DIR="$OPTARG" ;;
+        s) SECONDS_TO_RUN="$OPTARG" ;;
+        p) PERIOD_MS="$OPTARG" ;;
+        *) exit 2 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+SOCKET="$(mktemp -u /tmp/vcan.XXXXXX.sock)"
+LOG_DIR="$BUILD_DIR/logs"
+mkdir -p "$LOG_DIR"
+
+"$BUILD_DIR/vcan_broker" -s "$SOCKET" -t $((SECONDS_TO_RUN + 1)) "$@" > "$LOG_DIR/broker.log" &
+BROKER=$!
+for _ in $(seq 50); do
+    [ -S "$SOCKET" ] && break
+    sleep 0.02
+done
+
+# Base first so its readers are subscribed before the first frame
+"$BUILD_DIR/base_host" -n base -b "$SOCKET" -t "$SECONDS_TO_RUN" > "$LOG_DIR/base.log" 2>&1 &
+"$BUILD_DIR/temp_receiver_host" -n receiver -b "$SOCKET" -t "$SECONDS_TO_RUN" > "$LOG_DIR/receiver.log" 2>&1 &
+HOSTSIM_TEMP_PERIOD_MS="$PERIOD_MS" \
+    "$BUILD_DIR/temp_transmitter_host" -n transmitter -b "$SOCKET" -t "$SECONDS_TO_RUN" \
+    > "$LOG_DIR/transmitter.log" 2>&1 &
+
+wait "$BROKER"
+wait
+cat "$LOG_DIR/broker.log"
@@ -4,8 +4,11 @@
 #include "esp_log.h"
 
 #include "utils/CAN/can_config.h"
-#include "utils/CAN/can_driver_utils.h"
+#include "can_driver_utils.h"
 #include "utils/CAN/can_receive_utils.h"
+#include "utils/CAN/can_queue_utils.h"
+#include "utils/Log/deferred_log.h"
+#include "utils/CLI/receiver_cli.h"
 
 static const char *TAG_MAIN = "APP_MAIN";
 
@@ -13,16 +16,26 @@ void app_main(void)
 {
     ESP_LOGI(TAG_MAIN, "ESP32 CAN Bus Receiver - Main App");
 
+    if (dlog_init() != ESP_OK) {
+        ESP_LOGW(TAG_MAIN, "Deferred logger unavailable, hot-path logs will be lost");
+    }
+
     // Initialize CAN bus driver
     if (can_driver_init() != ESP_OK) {
         ESP_LOGE(TAG_MAIN, "Failed to initialize CAN driver. Halting.");
         return;
     }
     ESP_LOGI(TAG_MAIN, "CAN driver initialized.");
+    can_queue_init();
 
+    ESP_ERROR_CHECK(can_receive_stats_init());
 
     xTaskCreate(can_receive_task, "can_receive_task", 4096, NULL, 5, NULL); 
     ESP_LOGI(TAG_MAIN, "CAN receive task created.");
 
+    if (receiver_cli_start() != ESP_OK) {
+        ESP_LOGW(TAG_MAIN, "Console unavailable, statistics remain readable over CAN");
+    }
+
     ESP_LOGI(TAG_MAIN, "All tasks created. Application running.");
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef CAN_BATCH_UTILS_H
+#define CAN_BATCH_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/twai.h"
+#include "can_signals.h"
+
+/*
+ * Batched temperature frame layout (TEMPERATURE_BATCH in
+ * CANDatabase/signals.json, sent on TEMP_CAN_ID):
+ *
+ *   byte 0      : [7:6] sample count (1..3), [5:0] sequence number
+ *   byte 1..2   : sample 0, int16 little-endian, centi-degrees C
+ *   byte 3..4   : sample 1 (if count >= 2)
+ *   byte 5..6   : sample 2 (if count == 3)
+ *
+ * DLC is 1 + 2 * count (3, 5 or 7), so a batched frame can never be
+ * mistaken for the legacy 4-byte float frame.
+ */
+#define CAN_BATCH_MAX_SAMPLES   CAN_SIG_TEMPERATURE_BATCH_COUNT_MAX_RAW
+#define CAN_BATCH_SEQ_MASK      CAN_SIG_TEMPERATURE_BATCH_SEQUENCE_MAX_RAW
+
+typedef struct {
+    uint8_t sequence;
+    uint8_t count;
+    int16_t samples[CAN_BATCH_MAX_SAMPLES]; // centi-degrees C
+} can_temp_batch_t;
+
+/**
+ * @brief Pack up to CAN_BATCH_MAX_SAMPLES samples into one frame.
+ *
+ * @param samples Samples in centi-degrees C.
+ * @param count Number of samples (1..CAN_BATCH_MAX_SAMPLES).
+ * @param sequence Sequence number, only the low 6 bits are sent.
+ * @param identifier CAN identifier of the frame.
+ * @param out_message Frame to fill.
+ * @return true on success, false if count is out of range.
+ */
+bool can_batch_pack(const int16_t *samples, uint8_t count, uint8_t sequence,
+                    uint32_t identifier, twai_message_t *out_message);
+
+/**
+ * @brief Unpack a batched temperature frame.
+ *
+ * @param message Received frame.
+ * @param out_batch Decoded batch.
+ * @return true if the frame is a well-formed batch, false otherwise.
+ */
+bool can_batch_unpack(const twai_message_t *message, can_temp_batch_t *out_batch);
+
+/**
+ * @brief Check whether a frame uses the batched layout.
+ */
+bool can_batch_is_batched(const twai_message_t *message);
+
+#endif // CAN_BATCH_UTILS_H
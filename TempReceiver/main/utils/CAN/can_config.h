@@ -4,18 +4,41 @@
 #include "driver/twai.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "can_signals.h"    // generated from CANDatabase/signals.json
+#include "can_driver_config.h" // GPIOs, bitrate and queues from sdkconfig.defaults
 
+#define TEMP_CAN_ID         CAN_MSG_TEMPERATURE_ID
 
-#define CAN_TX_GPIO         GPIO_NUM_21
-#define CAN_RX_GPIO         GPIO_NUM_22
+// IDs this node consumes. can_driver_init() programs the tightest hardware
+// acceptance filter for them (can_driver_app_filter() in can_receive_utils.c);
+// set CAN_RX_FILTER_ENABLED to 0 to accept all.
+#define CAN_RX_FILTER_ENABLED   1
+#define CAN_RX_FILTER_EXTENDED  false
+#define CAN_RX_SUBSCRIPTIONS    { { TEMP_CAN_ID, TEMP_CAN_ID }, \
+                                  { CAN_MSG_TEMP_STATS_REQUEST_ID, CAN_MSG_TEMP_STATS_REQUEST_ID }, \
+                                  { CAN_MSG_TEMPERATURE_NODE_ID(0), CAN_MSG_TEMPERATURE_NODE_ID(CAN_NODE_COUNT - 1) } }
 
-#define TEMP_CAN_ID         0x515
+// Addressed transmitters: nodes 0..CAN_NODE_COUNT-1 (multiple of 32, up to
+// CAN_MSG_TEMPERATURE_NODE_COUNT). A node is absent after CAN_NODE_TIMEOUT_MS
+// without a frame; transmitters sample every 2 s, so this allows two losses.
+#define CAN_NODE_COUNT          64
+#define CAN_NODE_TIMEOUT_MS     7000
+#define CAN_NODE_SWEEP_MS       250
 
-#define CAN_TX_QUEUE_LENGTH  5
-#define CAN_RX_QUEUE_LENGTH  5
+// Temperature statistics served on TEMP_STATS_REQUEST and by the temp-stats command
+#define TEMP_STATS_EMA_ALPHA    0.1f
+#define TEMP_STATS_WINDOWS_MS   { 1000, 60000, 3600000 }
+#define TEMP_STATS_TX_TIMEOUT_MS 10
 
-// #define CAN_TIMIMG          TWAI_TIMING_CONFIG_125KBITS()
-// #define CAN_TIMIMG          TWAI_TIMING_CONFIG_250KBITS()
-#define CAN_TIMIMG          TWAI_TIMING_CONFIG_500KBITS()
-// #define CAN_TIMIMG          TWAI_TIMING_CONFIG_1MBITS()
+// Driver queue lengths at boot; CAN_QUEUE_AUTOSIZE grows them from measured bursts
+#define CAN_TX_QUEUE_LENGTH  CAN_DRIVER_TX_QUEUE_LEN
+#define CAN_RX_QUEUE_LENGTH  CAN_DRIVER_RX_QUEUE_LEN
+
+// Queue sizing: recommend peak burst * 3/2, between the boot lengths and
+// CAN_QUEUE_MAX_LENGTH. With CAN_QUEUE_AUTOSIZE the receive task reinstalls
+// the driver with the recommendation once the bus has been quiet for
+// CAN_QUEUE_IDLE_WINDOW_MS (frames sent meanwhile are lost).
+#define CAN_QUEUE_AUTOSIZE          1
+#define CAN_QUEUE_MAX_LENGTH        64
+#define CAN_QUEUE_IDLE_WINDOW_MS    200
 #endif
\ No newline at end of file
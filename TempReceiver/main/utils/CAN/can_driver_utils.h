@@ -1,9 +0,0 @@
-#ifndef CAN_DRIVER_UTILS_H
-#define CAN_DRIVER_UTILS_H
-
-#include "esp_err.h"
-
-esp_err_t can_driver_init(void);
-void can_driver_deinit(void);
-
-#endif 
\ No newline at end of file
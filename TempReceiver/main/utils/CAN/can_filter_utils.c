@@ -0,0 +1,274 @@
+#include "can_filter_utils.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG_CAN_FILTER = "CAN_FILTER";
+
+#define CAN_STD_ID_MASK     0x7FFu
+#define CAN_EXT_ID_MASK     0x1FFFFFFFu
+#define CAN_EXT_DUAL_LOW    0x1FFFu     // ID bits dual mode cannot compare
+#define CAN_FILTER_MAX_BLOCKS 64
+
+// Set of IDs matching code under mask (mask bit 1 = don't care)
+typedef struct {
+    uint32_t code;
+    uint32_t mask;
+} filter_cube_t;
+
+static filter_cube_t cube_merge(filter_cube_t a, filter_cube_t b)
+{
+    uint32_t mask = a.mask | b.mask | (a.code ^ b.code);
+    return (filter_cube_t){ a.code & ~mask, mask };
+}
+
+static uint64_t cube_size(filter_cube_t c, uint32_t id_mask)
+{
+    return 1ULL << __builtin_popcount(c.mask & id_mask);
+}
+
+static uint64_t cube_overlap(filter_cube_t a, filter_cube_t b, uint32_t id_mask)
+{
+    if ((a.code ^ b.code) & ~a.mask & ~b.mask & id_mask) {
+        return 0;
+    }
+    return 1ULL << __builtin_popcount(a.mask & b.mask & id_mask);
+}
+
+// Smallest cube holding a range: every bit up to the highest one that differs
+static filter_cube_t cube_of_range(const can_id_range_t *range)
+{
+    uint32_t diff = range->first ^ range->last;
+    uint32_t mask = 0;
+    while (diff) {
+        mask = (mask << 1) | 1;
+        diff >>= 1;
+    }
+    return (filter_cube_t){ range->first & ~mask, mask };
+}
+
+// Split a range into aligned power-of-two blocks, each an exact cube
+static size_t range_to_blocks(const can_id_range_t *range, uint32_t forced,
+                              filter_cube_t *blocks, size_t max_blocks)
+{
+    size_t count = 0;
+    uint64_t id = range->first;
+    while (id <= range->last) {
+        uint32_t size = 1;
+        while ((id & ((uint64_t)size * 2 - 1)) == 0 && id + (uint64_t)size * 2 - 1 <= range->last) {
+            size *= 2;
+        }
+        if (count == max_blocks) {
+            return 0;
+        }
+        uint32_t mask = (size - 1) | forced;
+        blocks[count++] = (filter_cube_t){ (uint32_t)id & ~mask, mask };
+        id += size;
+    }
+    return count;
+}
+
+// Best two-cube cover over contiguous splits of the sorted blocks
+static uint64_t plan_dual(const filter_cube_t *blocks, size_t count, uint32_t id_mask,
+                          filter_cube_t *out_a, filter_cube_t *out_b)
+{
+    uint64_t best = UINT64_MAX;
+    filter_cube_t prefix = blocks[0];
+
+    for (size_t split = 1; split < count; split++) {
+        filter_cube_t suffix = blocks[split];
+        for (size_t i = split + 1; i < count; i++) {
+            suffix = cube_merge(suffix, blocks[i]);
+        }
+        uint64_t total = cube_size(prefix, id_mask) + cube_size(suffix, id_mask) -
+                         cube_overlap(prefix, suffix, id_mask);
+        if (total < best) {
+            best = total;
+            *out_a = prefix;
+            *out_b = suffix;
+        }
+        prefix = cube_merge(prefix, blocks[split]);
+    }
+
+    if (count == 1) {
+        *out_a = blocks[0];
+        *out_b = blocks[0];
+        best = cube_size(blocks[0], id_mask);
+    }
+    return best;
+}
+
+static size_t normalize_ranges(const can_id_range_t *ranges, size_t count, can_id_range_t *out)
+{
+    memcpy(out, ranges, count * sizeof(*ranges));
+    for (size_t i = 1; i < count; i++) {
+        can_id_range_t key = out[i];
+        size_t j = i;
+        while (j > 0 && out[j - 1].first > key.first) {
+            out[j] = out[j - 1];
+            j--;
+        }
+        out[j] = key;
+    }
+
+    size_t merged = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (merged > 0 && (uint64_t)out[i].first <= (uint64_t)out[merged - 1].last + 1) {
+            if (out[i].last > out[merged - 1].last) {
+                out[merged - 1].last = out[i].last;
+            }
+        } else {
+            out[merged++] = out[i];
+        }
+    }
+    return merged;
+}
+
+void can_filter_plan_accept_all(can_filter_plan_t *out_plan)
+{
+    memset(out_plan, 0, sizeof(*out_plan));
+    out_plan->config = (twai_filter_config_t)TWAI_FILTER_CONFIG_ACCEPT_ALL();
+    out_plan->accept_all = true;
+}
+
+esp_err_t can_filter_plan(const can_id_range_t *ranges, size_t count, bool extended,
+                          can_filter_plan_t *out_plan)
+{
+    uint32_t id_mask = extended ? CAN_EXT_ID_MASK : CAN_STD_ID_MASK;
+    if (!ranges || !out_plan || count == 0 || count > CAN_FILTER_MAX_RANGES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (ranges[i].first > ranges[i].last || ranges[i].last > id_mask) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    memset(out_plan, 0, sizeof(*out_plan));
+    out_plan->extended = extended;
+    out_plan->range_count = normalize_ranges(ranges, count, out_plan->ranges);
+    for (size_t i = 0; i < out_plan->range_count; i++) {
+        out_plan->subscribed_ids += (uint64_t)out_plan->ranges[i].last - out_plan->ranges[i].first + 1;
+        if (!extended) {
+            for (uint32_t id = out_plan->ranges[i].first; id <= out_plan->ranges[i].last; id++) {
+                out_plan->std_bitmap[id >> 3] |= 1u << (id & 7);
+            }
+        }
+    }
+
+    // Single filter: one cube around every subscribed ID
+    filter_cube_t single = cube_of_range(&out_plan->ranges[0]);
+    for (size_t i = 1; i < out_plan->range_count; i++) {
+        single = cube_merge(single, cube_of_range(&out_plan->ranges[i]));
+    }
+    uint64_t single_accepted = cube_size(single, id_mask);
+
+    // Dual filter: two cubes over exact power-of-two blocks
+    uint32_t forced = extended ? CAN_EXT_DUAL_LOW : 0;
+    filter_cube_t blocks[CAN_FILTER_MAX_BLOCKS];
+    size_t block_count = 0;
+    for (size_t i = 0; i < out_plan->range_count; i++) {
+        size_t added = range_to_blocks(&out_plan->ranges[i], forced, &blocks[block_count],
+                                       CAN_FILTER_MAX_BLOCKS - block_count);
+        if (added == 0) {
+            block_count = 0;    // too fragmented to split, single filter only
+            break;
+        }
+        block_count += added;
+    }
+
+    filter_cube_t dual_a = single, dual_b = single;
+    uint64_t dual_accepted = UINT64_MAX;
+    if (block_count > 0) {
+        dual_accepted = plan_dual(blocks, block_count, id_mask, &dual_a, &dual_b);
+    }
+
+    twai_filter_config_t *cfg = &out_plan->config;
+    if (dual_accepted < single_accepted) {
+        out_plan->dual = true;
+        out_plan->accepted_ids = dual_accepted;
+        out_plan->code[0] = dual_a.code;
+        out_plan->mask[0] = dual_a.mask & id_mask;
+        out_plan->code[1] = dual_b.code;
+        out_plan->mask[1] = dual_b.mask & id_mask;
+        cfg->single_filter = false;
+        if (extended) {
+            // Each filter holds ID[28:13] only; remote frames pass and are
+            // dropped by can_filter_accept()
+            cfg->acceptance_code = ((dual_a.code >> 13) << 16) | (dual_b.code >> 13);
+            cfg->acceptance_mask = (((dual_a.mask & id_mask) >> 13) << 16) | ((dual_b.mask & id_mask) >> 13);
+        } else {
+            // Filter 1: ID[31:21], RTR[20], data byte 1 [19:16]+[3:0]; filter 2: ID[15:5], RTR[4].
+            // RTR stays compared against 0 (data frames only), the data nibbles are don't care
+            cfg->acceptance_code = (dual_a.code << 21) | (dual_b.code << 5);
+            cfg->acceptance_mask = ((dual_a.mask & id_mask) << 21) | ((dual_b.mask & id_mask) << 5) | 0x000F000F;
+        }
+    } else {
+        out_plan->accepted_ids = single_accepted;
+        out_plan->code[0] = out_plan->code[1] = single.code;
+        out_plan->mask[0] = out_plan->mask[1] = single.mask & id_mask;
+        cfg->single_filter = true;
+        if (extended) {
+            // ID[31:3], RTR[2] compared against 0, bits 1:0 unused
+            cfg->acceptance_code = single.code << 3;
+            cfg->acceptance_mask = ((single.mask & id_mask) << 3) | 0x3;
+        } else {
+            // ID[31:21], RTR[20] compared against 0, bits 19:16 unused, data bytes 1-2 [15:0]
+            cfg->acceptance_code = single.code << 21;
+            cfg->acceptance_mask = ((single.mask & id_mask) << 21) | 0x000FFFFF;
+        }
+    }
+    return ESP_OK;
+}
+
+bool can_filter_accept(can_filter_plan_t *plan, const twai_message_t *message)
+{
+    if (plan->accept_all) {
+        return true;
+    }
+
+    bool wanted = false;
+    if ((bool)message->extd == plan->extended && !message->rtr) {
+        if (!plan->extended) {
+            uint32_t id = message->identifier & CAN_STD_ID_MASK;
+            wanted = (plan->std_bitmap[id >> 3] >> (id & 7)) & 1;
+        } else {
+            for (size_t i = 0; i < plan->range_count && !wanted; i++) {
+                wanted = message->identifier >= plan->ranges[i].first &&
+                         message->identifier <= plan->ranges[i].last;
+            }
+        }
+    }
+
+    if (!wanted) {
+        plan->software_rejects++;
+    }
+    return wanted;
+}
+
+uint32_t can_filter_false_accept_permille(const can_filter_plan_t *plan)
+{
+    if (plan->accept_all || plan->accepted_ids == 0) {
+        return 0;
+    }
+    return (uint32_t)((plan->accepted_ids - plan->subscribed_ids) * 1000 / plan->accepted_ids);
+}
+
+void can_filter_log_plan(const can_filter_plan_t *plan)
+{
+    if (plan->accept_all) {
+        ESP_LOGI(TAG_CAN_FILTER, "RX filter: accept all");
+        return;
+    }
+
+    uint32_t false_accept = can_filter_false_accept_permille(plan);
+    ESP_LOGI(TAG_CAN_FILTER, "RX filter: %s %s, code=0x%08lX mask=0x%08lX",
+             plan->dual ? "dual" : "single", plan->extended ? "extended" : "standard",
+             (unsigned long)plan->config.acceptance_code, (unsigned long)plan->config.acceptance_mask);
+    for (int i = 0; i < (plan->dual ? 2 : 1); i++) {
+        ESP_LOGI(TAG_CAN_FILTER, "  filter %d: ID 0x%lX / don't-care 0x%lX", i + 1,
+                 (unsigned long)plan->code[i], (unsigned long)plan->mask[i]);
+    }
+    ESP_LOGI(TAG_CAN_FILTER, "  %llu subscribed ID(s), %llu pass hardware, %lu.%lu%% false accepts",
+             (unsigned long long)plan->subscribed_ids, (unsigned long long)plan->accepted_ids,
+             (unsigned long)(false_accept / 10), (unsigned long)(false_accept % 10));
+}
@@ -0,0 +1,77 @@
+#ifndef CAN_FILTER_UTILS_H
+#define CAN_FILTER_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+
+/*
+ * Acceptance filter planner.
+ *
+ * Turns the set of subscribed ID ranges into the tightest single- or
+ * dual-filter code/mask the TWAI controller supports, so foreign frames
+ * are dropped in hardware before they cost an interrupt and an RX queue
+ * slot. Whatever the mask cannot exclude is rejected in software by
+ * can_filter_accept().
+ *
+ * Dual filter mode only compares the upper 16 bits of extended IDs, and
+ * a plan covers either standard or extended IDs, not both.
+ *
+ * Subscriptions are to data frames: every layout compares the RTR bit
+ * against 0, except dual-filter extended, which has no RTR bit; there
+ * can_filter_accept() drops remote frames instead. The accept-all plan
+ * passes both.
+ */
+#define CAN_FILTER_MAX_RANGES   16
+
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+} can_id_range_t;
+
+typedef struct {
+    twai_filter_config_t config;
+    bool accept_all;            // no plan, everything passes
+    bool extended;
+    bool dual;
+    uint32_t code[2];           // per filter, in ID bit positions
+    uint32_t mask[2];           // 1 = don't care
+    uint64_t subscribed_ids;
+    uint64_t accepted_ids;      // IDs the hardware filter lets through
+    can_id_range_t ranges[CAN_FILTER_MAX_RANGES];   // sorted, merged
+    size_t range_count;
+    uint8_t std_bitmap[2048 / 8];   // standard IDs: O(1) residual check
+    uint32_t software_rejects;  // frames passed by hardware, dropped by can_filter_accept()
+} can_filter_plan_t;
+
+/**
+ * @brief Compute the best filter configuration for the subscriptions.
+ *
+ * @param ranges Subscribed ID ranges (inclusive), any order, may overlap.
+ * @param count Number of ranges (1..CAN_FILTER_MAX_RANGES).
+ * @param extended true for 29-bit IDs, false for 11-bit.
+ * @param out_plan Result; out_plan->config is ready for twai_driver_install().
+ */
+esp_err_t can_filter_plan(const can_id_range_t *ranges, size_t count, bool extended,
+                          can_filter_plan_t *out_plan);
+
+/**
+ * @brief Plan that accepts every frame (filtering disabled).
+ */
+void can_filter_plan_accept_all(can_filter_plan_t *out_plan);
+
+/**
+ * @brief Residual software check for frames the hardware filter let through.
+ */
+bool can_filter_accept(can_filter_plan_t *plan, const twai_message_t *message);
+
+/**
+ * @brief Fraction of hardware-accepted IDs that are not subscribed, in 1/1000.
+ */
+uint32_t can_filter_false_accept_permille(const can_filter_plan_t *plan);
+
+void can_filter_log_plan(const can_filter_plan_t *plan);
+
+#endif // CAN_FILTER_UTILS_H
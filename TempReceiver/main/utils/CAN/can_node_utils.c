@@ -0,0 +1,90 @@
+#include "can_node_utils.h"
+#include <string.h>
+
+void can_node_table_init(can_node_table_t *table)
+{
+    memset(table, 0, sizeof(*table));
+    memset(table->expected_sequence, -1, sizeof(table->expected_sequence));
+}
+
+bool can_node_decode(const twai_message_t *message, can_temp_batch_t *out_samples, bool *out_sequenced)
+{
+    *out_sequenced = false;
+    if (can_batch_unpack(message, out_samples)) {
+        *out_sequenced = true;
+        return true;
+    }
+
+    out_samples->sequence = 0;
+    out_samples->count = 1;
+    if (message->data_length_code == sizeof(int16_t)) {
+        // Single fixed-point sample, centi-degrees C
+        can_temperature_t frame;
+        can_temperature_unpack(&frame, message->data);
+        out_samples->samples[0] = frame.temperature;
+        return true;
+    }
+    if (message->data_length_code == sizeof(float)) {
+        float temperature_c;
+        memcpy(&temperature_c, message->data, sizeof(float));
+        out_samples->samples[0] = can_temperature_temperature_encode(temperature_c);
+        return true;
+    }
+    return false;
+}
+
+uint32_t can_node_record(can_node_table_t *table, int node, const can_temp_batch_t *samples,
+                         bool sequenced, uint32_t now_ms)
+{
+    uint32_t word = (uint32_t)node / 32;
+    uint32_t bit = 1u << ((uint32_t)node % 32);
+    uint32_t lost = 0;
+
+    if (sequenced) {
+        lost = can_node_sequence_gap(&table->expected_sequence[node], samples->sequence);
+        uint32_t total = table->lost_frames[node] + lost;
+        table->lost_frames[node] = total > UINT16_MAX ? UINT16_MAX : total;
+    }
+    table->last_centi[node] = samples->samples[samples->count - 1];
+    table->last_seen_ms[node] = now_ms;
+    table->frames[node]++;
+
+    if (!(table->present[word] & bit)) {
+        table->present[word] |= bit;
+        table->seen[word] |= bit;
+        table->present_count++;
+    }
+    return lost;
+}
+
+uint32_t can_node_expire(can_node_table_t *table, uint32_t now_ms)
+{
+    uint32_t expired = 0;
+    for (uint32_t word = 0; word < CAN_NODE_WORDS; word++) {
+        uint32_t pending = table->present[word];
+        while (pending != 0) {
+            uint32_t index = __builtin_ctz(pending);
+            pending &= pending - 1;
+            uint32_t node = word * 32 + index;
+            if (now_ms - table->last_seen_ms[node] >= CAN_NODE_TIMEOUT_MS) {
+                table->present[word] &= ~(1u << index);
+                expired++;
+            }
+        }
+    }
+    table->present_count -= expired;
+    table->timeouts += expired;
+    return expired;
+}
+
+void can_node_get(const can_node_table_t *table, int node, can_node_info_t *out_info)
+{
+    uint32_t word = (uint32_t)node / 32;
+    uint32_t bit = 1u << ((uint32_t)node % 32);
+    out_info->present = (table->present[word] & bit) != 0;
+    out_info->seen = (table->seen[word] & bit) != 0;
+    out_info->last_centi = table->last_centi[node];
+    out_info->last_seen_ms = table->last_seen_ms[node];
+    out_info->frames = table->frames[node];
+    out_info->lost_frames = table->lost_frames[node];
+}
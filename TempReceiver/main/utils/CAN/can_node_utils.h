@@ -0,0 +1,104 @@
+#ifndef CAN_NODE_UTILS_H
+#define CAN_NODE_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "driver/twai.h"
+#include "can_batch_utils.h"
+#include "can_config.h"
+
+/*
+ * Per-node state for temperature transmitters addressed by ID
+ * (CAN_MSG_TEMPERATURE_NODE_ID(node), see CANDatabase/signals.json).
+ *
+ * The table is a struct of arrays indexed by node number: the frame path
+ * touches one element of a few arrays, and the timeout sweep walks only
+ * the presence bitmap and the last-seen array. Node lookup is a range
+ * check and a subtraction, so the cost per frame does not depend on how
+ * many nodes are on the bus.
+ *
+ * Not thread-safe: the receive task owns the table, readers take a copy
+ * under the owner's lock.
+ */
+#define CAN_NODE_WORDS  (CAN_NODE_COUNT / 32)
+
+_Static_assert(CAN_NODE_COUNT % 32 == 0, "CAN_NODE_COUNT must be a multiple of 32");
+_Static_assert(CAN_NODE_COUNT <= CAN_MSG_TEMPERATURE_NODE_COUNT, "more nodes than the database assigns IDs");
+
+typedef struct {
+    int16_t last_centi[CAN_NODE_COUNT];         // latest sample, centi-degrees C
+    uint32_t last_seen_ms[CAN_NODE_COUNT];
+    uint32_t frames[CAN_NODE_COUNT];
+    uint16_t lost_frames[CAN_NODE_COUNT];       // from batch sequence gaps
+    int8_t expected_sequence[CAN_NODE_COUNT];   // -1 until the first batch
+    uint32_t present[CAN_NODE_WORDS];           // heard within CAN_NODE_TIMEOUT_MS
+    uint32_t seen[CAN_NODE_WORDS];              // heard at least once
+    uint32_t present_count;
+    uint32_t timeouts;                          // present -> absent transitions
+} can_node_table_t;
+
+typedef struct {
+    bool present;
+    bool seen;
+    int16_t last_centi;
+    uint32_t last_seen_ms;
+    uint32_t frames;
+    uint16_t lost_frames;
+} can_node_info_t;
+
+void can_node_table_init(can_node_table_t *table);
+
+/**
+ * @brief Node number for a frame identifier, or -1 if outside the node range.
+ */
+static inline int can_node_from_id(const twai_message_t *message)
+{
+    uint32_t offset = message->identifier - CAN_MSG_TEMPERATURE_NODE_BASE_ID;
+    if (message->extd || message->rtr || offset >= CAN_NODE_COUNT) {
+        return -1;
+    }
+    return (int)offset;
+}
+
+/**
+ * @brief Decode any temperature layout into samples.
+ *
+ * Batched frames keep their sequence; single int16 (DLC 2) and legacy
+ * float (DLC 4) frames become a one-sample batch.
+ *
+ * @param out_sequenced true if the frame carried a batch sequence number
+ * @return false for an unknown layout
+ */
+bool can_node_decode(const twai_message_t *message, can_temp_batch_t *out_samples, bool *out_sequenced);
+
+/**
+ * @brief Frames lost before a batch with this sequence number; updates *expected.
+ */
+static inline uint32_t can_node_sequence_gap(int8_t *expected, uint8_t sequence)
+{
+    uint32_t lost = *expected >= 0 ? (uint32_t)((sequence - *expected) & CAN_BATCH_SEQ_MASK) : 0;
+    *expected = (int8_t)((sequence + 1) & CAN_BATCH_SEQ_MASK);
+    return lost;
+}
+
+/**
+ * @brief Account decoded samples from a node.
+ *
+ * @return Frames lost since the node's previous batch.
+ */
+uint32_t can_node_record(can_node_table_t *table, int node, const can_temp_batch_t *samples,
+                         bool sequenced, uint32_t now_ms);
+
+/**
+ * @brief Clear the presence bit of nodes silent for CAN_NODE_TIMEOUT_MS.
+ *
+ * Cost is proportional to the number of present nodes.
+ *
+ * @return Number of nodes that timed out in this sweep.
+ */
+uint32_t can_node_expire(can_node_table_t *table, uint32_t now_ms);
+
+void can_node_get(const can_node_table_t *table, int node, can_node_info_t *out_info);
+
+#endif // CAN_NODE_UTILS_H
@@ -0,0 +1,131 @@
+#include "can_queue_utils.h"
+#include "can_config.h"
+#include "can_driver_utils.h"
+#include "deferred_log.h"
+#include "driver/twai.h"
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG_CAN_QUEUE = "CAN_QUEUE";
+
+static can_queue_stats_t stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Driver counters at the last poll; they restart at zero on reinstall
+static uint32_t last_missed;
+static uint32_t last_overrun;
+
+static uint32_t recommend(uint32_t peak, uint32_t boot_len)
+{
+    uint32_t len = peak + (peak + 1) / 2;
+    len = len < boot_len ? boot_len : len;
+    return len > CAN_QUEUE_MAX_LENGTH ? CAN_QUEUE_MAX_LENGTH : len;
+}
+
+void can_queue_init(void)
+{
+    taskENTER_CRITICAL(&stats_lock);
+    stats = (can_queue_stats_t){ 0 };
+    can_driver_get_queue_lengths(&stats.rx_queue_len, &stats.tx_queue_len);
+    stats.recommended_rx_len = stats.rx_queue_len;
+    stats.recommended_tx_len = stats.tx_queue_len;
+    taskEXIT_CRITICAL(&stats_lock);
+    last_missed = 0;
+    last_overrun = 0;
+}
+
+void can_queue_note_receive(void)
+{
+    twai_status_info_t status;
+    if (twai_get_status_info(&status) != ESP_OK) {
+        return;
+    }
+    taskENTER_CRITICAL(&stats_lock);
+    if (status.msgs_to_rx + 1 > stats.rx_peak) {
+        stats.rx_peak = status.msgs_to_rx + 1;
+    }
+    if (status.msgs_to_tx > stats.tx_peak) {
+        stats.tx_peak = status.msgs_to_tx;
+    }
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+static void resize(uint32_t rx_len, uint32_t tx_len)
+{
+    esp_err_t ret = can_driver_reinstall(rx_len, tx_len);
+    last_missed = 0;
+    last_overrun = 0;
+
+    taskENTER_CRITICAL(&stats_lock);
+    stats.resize_requested = false;
+    if (ret == ESP_OK) {
+        stats.resizes++;
+    } else {
+        stats.resize_failures++;
+    }
+    can_driver_get_queue_lengths(&stats.rx_queue_len, &stats.tx_queue_len);
+    taskEXIT_CRITICAL(&stats_lock);
+
+    if (ret == ESP_OK) {
+        DLOGI(TAG_CAN_QUEUE, "Driver queues resized: RX %u, TX %u", rx_len, tx_len);
+    } else {
+        DLOGW(TAG_CAN_QUEUE, "Queue resize to RX %u, TX %u failed: %s", rx_len, tx_len,
+              DLOG_STR(esp_err_to_name(ret)));
+    }
+}
+
+void can_queue_poll(uint32_t idle_ms)
+{
+    twai_status_info_t status;
+    if (twai_get_status_info(&status) != ESP_OK) {
+        return;
+    }
+    uint32_t missed = status.rx_missed_count - last_missed;
+    uint32_t overrun = status.rx_overrun_count - last_overrun;
+    last_missed = status.rx_missed_count;
+    last_overrun = status.rx_overrun_count;
+
+    taskENTER_CRITICAL(&stats_lock);
+    stats.rx_missed += missed;
+    stats.rx_overrun += overrun;
+    if (missed > 0 || overrun > 0) {
+        stats.loss_events++;
+    }
+    // A full queue that still missed frames held a burst longer than itself
+    if (missed > 0 && stats.rx_queue_len + missed > stats.rx_peak) {
+        stats.rx_peak = stats.rx_queue_len + missed;
+    }
+    stats.recommended_rx_len = recommend(stats.rx_peak, CAN_RX_QUEUE_LENGTH);
+    stats.recommended_tx_len = recommend(stats.tx_peak, CAN_TX_QUEUE_LENGTH);
+    // Only ever grow: a quiet hour says nothing about the next burst
+    uint32_t rx_len = stats.recommended_rx_len > stats.rx_queue_len ? stats.recommended_rx_len : stats.rx_queue_len;
+    uint32_t tx_len = stats.recommended_tx_len > stats.tx_queue_len ? stats.recommended_tx_len : stats.tx_queue_len;
+    bool grow = rx_len != stats.rx_queue_len || tx_len != stats.tx_queue_len;
+    bool requested = stats.resize_requested;
+    if (requested && !grow) {
+        stats.resize_requested = false;
+    }
+    uint32_t peak = stats.rx_peak, queue_len = stats.rx_queue_len;
+    taskEXIT_CRITICAL(&stats_lock);
+
+    if (missed > 0 || overrun > 0) {
+        DLOGW(TAG_CAN_QUEUE, "RX lost frames: %u missed (queue full), %u overrun; peak burst %u, RX queue %u",
+              missed, overrun, peak, queue_len);
+    }
+    if (grow && (requested || (CAN_QUEUE_AUTOSIZE && idle_ms >= CAN_QUEUE_IDLE_WINDOW_MS))) {
+        resize(rx_len, tx_len);
+    }
+}
+
+void can_queue_request_resize(void)
+{
+    taskENTER_CRITICAL(&stats_lock);
+    stats.resize_requested = true;
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+void can_queue_get_stats(can_queue_stats_t *out_stats)
+{
+    taskENTER_CRITICAL(&stats_lock);
+    *out_stats = stats;
+    taskEXIT_CRITICAL(&stats_lock);
+}
@@ -0,0 +1,66 @@
+#ifndef CAN_QUEUE_UTILS_H
+#define CAN_QUEUE_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/*
+ * Driver queue monitoring and sizing.
+ *
+ * The receive task samples the driver after every frame: the RX backlog
+ * left behind it, plus that frame, is the burst the queue had to absorb.
+ * A periodic poll turns the driver's rx_missed_count (frames dropped on
+ * a full RX queue) and rx_overrun_count (hardware FIFO overruns) into
+ * running totals, which survive driver reinstalls, and warns when
+ * either grows. A sample interval with misses counts as a burst of at
+ * least the queue length plus the frames missed.
+ *
+ * From the largest burst the monitor recommends queue lengths. Larger
+ * queues mean reinstalling the driver, which loses frames, so it only
+ * happens in a maintenance window: an idle bus with CAN_QUEUE_AUTOSIZE,
+ * or when requested through can_queue_request_resize().
+ *
+ * All functions except the getters and can_queue_request_resize() must
+ * be called from the task that owns the driver.
+ */
+typedef struct {
+    uint32_t rx_queue_len;          // installed
+    uint32_t tx_queue_len;
+    uint32_t rx_peak;               // largest burst since boot, frames
+    uint32_t tx_peak;               // largest TX backlog since boot
+    uint32_t rx_missed;             // totals since boot
+    uint32_t rx_overrun;
+    uint32_t loss_events;           // polls that saw new misses or overruns
+    uint32_t recommended_rx_len;
+    uint32_t recommended_tx_len;
+    uint32_t resizes;               // reinstalls done
+    uint32_t resize_failures;
+    bool resize_requested;
+} can_queue_stats_t;
+
+/**
+ * @brief Reset counters; call after can_driver_init().
+ */
+void can_queue_init(void);
+
+/**
+ * @brief Account the driver backlog right after a frame was received.
+ */
+void can_queue_note_receive(void);
+
+/**
+ * @brief Fold in the driver's loss counters, warn and resize if due.
+ *
+ * @param idle_ms Time since the last received frame.
+ */
+void can_queue_poll(uint32_t idle_ms);
+
+/**
+ * @brief Apply the recommendation at the next poll, bus idle or not.
+ */
+void can_queue_request_resize(void);
+
+void can_queue_get_stats(can_queue_stats_t *out_stats);
+
+#endif // CAN_QUEUE_UTILS_H
@@ -0,0 +1,213 @@
+#include "can_receive_utils.h"
+#include "can_batch_utils.h"
+#include "can_node_utils.h"
+#include "can_queue_utils.h"
+#include "can_config.h"
+#include "can_driver_utils.h"
+#include "can_filter_utils.h"
+#include "driver/twai.h"
+#include "esp_log.h"
+#include "deferred_log.h"
+#include "esp_timer.h"
+
+#include <string.h>
+
+static const char *TAG_CAN_RX = "CAN_RECEIVE";
+
+// Updated by the receive task, read by the CLI
+static rolling_stats_t temperature_stats;
+static portMUX_TYPE temperature_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+// Addressed transmitters, also guarded by temperature_stats_lock
+static can_node_table_t nodes;
+// Filter handed to the driver, for the residual software check in the receive path
+static can_filter_plan_t rx_filter_plan;
+
+esp_err_t can_driver_app_filter(twai_filter_config_t *out_config) {
+#if CAN_RX_FILTER_ENABLED
+    static const can_id_range_t subscriptions[] = CAN_RX_SUBSCRIPTIONS;
+    if (can_filter_plan(subscriptions, sizeof(subscriptions) / sizeof(subscriptions[0]),
+                        CAN_RX_FILTER_EXTENDED, &rx_filter_plan) != ESP_OK) {
+        ESP_LOGW(TAG_CAN_RX, "Invalid RX subscriptions, accepting all frames");
+        can_filter_plan_accept_all(&rx_filter_plan);
+    }
+#else
+    can_filter_plan_accept_all(&rx_filter_plan);
+#endif
+    can_filter_log_plan(&rx_filter_plan);
+
+    *out_config = rx_filter_plan.config;
+    return ESP_OK;
+}
+
+esp_err_t can_receive_stats_init(void) {
+    const uint32_t windows_ms[] = TEMP_STATS_WINDOWS_MS;
+    can_node_table_init(&nodes);
+    return rolling_stats_init(&temperature_stats, TEMP_STATS_EMA_ALPHA, windows_ms,
+                              sizeof(windows_ms) / sizeof(windows_ms[0]));
+}
+
+void can_receive_get_temperature_stats(rolling_stats_summary_t *out_summary) {
+    int64_t now_us = esp_timer_get_time();
+    taskENTER_CRITICAL(&temperature_stats_lock);
+    rolling_stats_get_summary(&temperature_stats, now_us, out_summary);
+    taskEXIT_CRITICAL(&temperature_stats_lock);
+}
+
+void can_receive_reset_temperature_stats(void) {
+    taskENTER_CRITICAL(&temperature_stats_lock);
+    rolling_stats_reset(&temperature_stats);
+    taskEXIT_CRITICAL(&temperature_stats_lock);
+}
+
+static void record_temperature(float temperature_c, int64_t timestamp_us) {
+    taskENTER_CRITICAL(&temperature_stats_lock);
+    rolling_stats_update(&temperature_stats, temperature_c, timestamp_us);
+    taskEXIT_CRITICAL(&temperature_stats_lock);
+}
+
+static void send_temperature_stats(const twai_message_t *request) {
+    can_temp_stats_request_t req = { .window = 0 };
+    if (request->data_length_code >= CAN_MSG_TEMP_STATS_REQUEST_DLC) {
+        can_temp_stats_request_unpack(&req, request->data);
+    }
+
+    rolling_stats_summary_t summary;
+    can_receive_get_temperature_stats(&summary);
+
+    twai_message_t message = {
+        .identifier = CAN_MSG_TEMP_STATS_ID,
+        .data_length_code = CAN_MSG_TEMP_STATS_DLC,
+    };
+    const can_temp_stats_t stats = {
+        .mean = can_temp_stats_mean_encode(summary.mean),
+        .stddev = can_temp_stats_stddev_encode(summary.stddev),
+        .ema = can_temp_stats_ema_encode(summary.ema),
+        .count = summary.count > CAN_SIG_TEMP_STATS_COUNT_MAX_RAW ? CAN_SIG_TEMP_STATS_COUNT_MAX_RAW : summary.count,
+    };
+    can_temp_stats_pack(message.data, &stats);
+    esp_err_t ret = can_driver_transmit(&message, pdMS_TO_TICKS(TEMP_STATS_TX_TIMEOUT_MS));
+
+    // Window 0 is since start, 1.. are the configured windows
+    can_temp_stats_window_t window = { .window = req.window & CAN_SIG_TEMP_STATS_WINDOW_WINDOW_MAX_RAW };
+    float min = summary.min, max = summary.max;
+    if (req.window == 0) {
+        window.valid = summary.count > 0;
+    } else if (req.window <= summary.window_count) {
+        const rolling_stats_window_summary_t *w = &summary.windows[req.window - 1];
+        window.valid = w->valid;
+        window.window_s = w->window_ms / 1000;
+        min = w->min;
+        max = w->max;
+    }
+    if (window.valid) {
+        window.min = can_temp_stats_window_min_encode(min);
+        window.max = can_temp_stats_window_max_encode(max);
+    }
+    message.identifier = CAN_MSG_TEMP_STATS_WINDOW_ID;
+    message.data_length_code = CAN_MSG_TEMP_STATS_WINDOW_DLC;
+    can_temp_stats_window_pack(message.data, &window);
+    if (ret == ESP_OK) {
+        ret = can_driver_transmit(&message, pdMS_TO_TICKS(TEMP_STATS_TX_TIMEOUT_MS));
+    }
+    if (ret != ESP_OK) {
+        DLOGW(TAG_CAN_RX, "Statistics response not sent: %s", DLOG_STR(esp_err_to_name(ret)));
+    }
+}
+
+static void log_centi_temperature(int16_t centi) {
+    if (centi < 0) {
+        DLOGI(TAG_CAN_RX, "Received temperature: -%d.%02d C", -centi / 100, -centi % 100);
+    } else {
+        DLOGI(TAG_CAN_RX, "Received temperature: %d.%02d C", centi / 100, centi % 100);
+    }
+}
+
+void can_receive_get_node(int node, can_node_info_t *out_info) {
+    taskENTER_CRITICAL(&temperature_stats_lock);
+    can_node_get(&nodes, node, out_info);
+    taskEXIT_CRITICAL(&temperature_stats_lock);
+}
+
+void can_receive_get_node_counts(uint32_t *out_present, uint32_t *out_timeouts) {
+    taskENTER_CRITICAL(&temperature_stats_lock);
+    *out_present = nodes.present_count;
+    *out_timeouts = nodes.timeouts;
+    taskEXIT_CRITICAL(&temperature_stats_lock);
+}
+
+static void handle_temperature(const twai_message_t *message, int node, int8_t *legacy_sequence,
+                               int64_t timestamp_us) {
+    can_temp_batch_t batch;
+    bool sequenced;
+    if (!can_node_decode(message, &batch, &sequenced)) {
+        DLOGW(TAG_CAN_RX, "Unexpected temperature frame: ID=0x%03X DLC=%d",
+              message->identifier, message->data_length_code);
+        return;
+    }
+
+    uint32_t lost;
+    if (node >= 0) {
+        taskENTER_CRITICAL(&temperature_stats_lock);
+        lost = can_node_record(&nodes, node, &batch, sequenced, (uint32_t)(timestamp_us / 1000));
+        taskEXIT_CRITICAL(&temperature_stats_lock);
+    } else {
+        lost = sequenced ? can_node_sequence_gap(legacy_sequence, batch.sequence) : 0;
+    }
+    if (lost > 0) {
+        DLOGW(TAG_CAN_RX, "Sequence gap on ID 0x%03X: %u frame(s) lost", message->identifier, lost);
+    }
+
+    // The frame carries no per-sample time, so all samples take its receive time
+    for (uint8_t i = 0; i < batch.count; i++) {
+        if (node < 0) {
+            log_centi_temperature(batch.samples[i]);
+        } else {
+            DLOGD(TAG_CAN_RX, "Node %d: %d centi-C", node, batch.samples[i]);
+        }
+        record_temperature(can_temperature_temperature_decode(batch.samples[i]), timestamp_us);
+    }
+}
+
+void can_receive_task(void *pvParameters) {
+    ESP_LOGI(TAG_CAN_RX, "CAN Receive Task Started");
+    twai_message_t rx_message;
+    int8_t legacy_sequence = -1;
+    can_filter_plan_t *filter = &rx_filter_plan;
+    int64_t last_sweep_us = esp_timer_get_time();
+    int64_t last_frame_us = last_sweep_us;
+
+    while (1) {
+        esp_err_t espStatus = can_driver_receive(&rx_message, pdMS_TO_TICKS(CAN_NODE_SWEEP_MS));
+        int64_t rx_time_us = esp_timer_get_time();
+
+        if (espStatus == ESP_OK) {
+            last_frame_us = rx_time_us;
+            can_queue_note_receive();
+            // Drop what the hardware mask could not exclude; the sweep below
+            // still runs, as such frames may arrive more often than it is due
+            if (can_filter_accept(filter, &rx_message)) {
+                int node = can_node_from_id(&rx_message);
+                if (node >= 0 || rx_message.identifier == TEMP_CAN_ID) {
+                    handle_temperature(&rx_message, node, &legacy_sequence, rx_time_us);
+                } else if (rx_message.identifier == CAN_MSG_TEMP_STATS_REQUEST_ID) {
+                    send_temperature_stats(&rx_message);
+                }
+            }
+        } else if (espStatus != ESP_ERR_TIMEOUT) {
+            ESP_LOGE(TAG_CAN_RX, "Failed to receive message: %s", esp_err_to_name(espStatus));
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+
+        if (rx_time_us - last_sweep_us >= CAN_NODE_SWEEP_MS * 1000) {
+            last_sweep_us = rx_time_us;
+            taskENTER_CRITICAL(&temperature_stats_lock);
+            uint32_t expired = can_node_expire(&nodes, (uint32_t)(rx_time_us / 1000));
+            taskEXIT_CRITICAL(&temperature_stats_lock);
+            if (expired > 0) {
+                DLOGW(TAG_CAN_RX, "%u node(s) timed out", expired);
+            }
+            // Queue resizes happen here, between receives, as this task owns the driver
+            can_queue_poll((uint32_t)((rx_time_us - last_frame_us) / 1000));
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef CAN_RECEIVE_UTILS_H
+#define CAN_RECEIVE_UTILS_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "rolling_stats.h"
+#include "can_node_utils.h"
+
+/**
+ * @brief Set up the temperature statistics and node table. Call before can_receive_task.
+ */
+esp_err_t can_receive_stats_init(void);
+
+/**
+ * @brief Snapshot of the temperature statistics, windows ending now.
+ */
+void can_receive_get_temperature_stats(rolling_stats_summary_t *out_summary);
+
+void can_receive_reset_temperature_stats(void);
+
+/**
+ * @brief Copy of one addressed node's state.
+ */
+void can_receive_get_node(int node, can_node_info_t *out_info);
+
+void can_receive_get_node_counts(uint32_t *out_present, uint32_t *out_timeouts);
+
+/**
+ * @brief Task to receive and decode temperature frames.
+ *
+ * Accepts batched frames (see can_batch_utils.h), single int16
+ * centi-degree frames (DLC 2) and legacy float frames (DLC 4) on
+ * TEMP_CAN_ID and on the per-node IDs (see can_node_utils.h), feeding
+ * every sample into the temperature statistics.
+ * A TEMP_STATS_REQUEST frame is answered with TEMP_STATS and
+ * TEMP_STATS_WINDOW for the requested window (0 = since start,
+ * 1.. = TEMP_STATS_WINDOWS_MS in order).
+ *
+ * @param pvParameters Task parameters (not used).
+ */
+void can_receive_task(void *pvParameters);
+
+#endif // CAN_RECEIVE_UTILS_H
@@ -0,0 +1,230 @@
+#include "receiver_cli.h"
+#include "can_receive_utils.h"
+#include "can_queue_utils.h"
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "argtable3/argtable3.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char *TAG_CLI = "RECEIVER_CLI";
+
+static struct {
+    struct arg_lit *reset;
+    struct arg_end *end;
+} temp_stats_args;
+
+static int cmd_temp_stats(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &temp_stats_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, temp_stats_args.end, argv[0]);
+        return 1;
+    }
+    if (temp_stats_args.reset->count > 0) {
+        can_receive_reset_temperature_stats();
+        printf("Temperature statistics reset\n");
+        return 0;
+    }
+
+    rolling_stats_summary_t stats;
+    can_receive_get_temperature_stats(&stats);
+    if (stats.count == 0) {
+        printf("No temperature samples received yet\n");
+        return 0;
+    }
+
+    printf("Temperature statistics (%lu samples):\n", stats.count);
+    printf("- Last: %.2f C, %lld ms ago\n", stats.last, (esp_timer_get_time() - stats.last_us) / 1000);
+    printf("- Since start: min %.2f, max %.2f, mean %.2f, stddev %.3f\n",
+           stats.min, stats.max, stats.mean, stats.stddev);
+    printf("- EMA: %.2f\n", stats.ema);
+    for (size_t i = 0; i < stats.window_count; i++) {
+        const rolling_stats_window_summary_t *window = &stats.windows[i];
+        if (window->valid) {
+            printf("- Last %lu s: min %.2f, max %.2f\n", window->window_ms / 1000, window->min, window->max);
+        } else {
+            printf("- Last %lu s: no samples\n", window->window_ms / 1000);
+        }
+    }
+    return 0;
+}
+
+static int cmd_temp_nodes(int argc, char **argv)
+{
+    uint32_t present, timeouts;
+    can_receive_get_node_counts(&present, &timeouts);
+    printf("Nodes: %lu present of %d, %lu timeout(s)\n", present, CAN_NODE_COUNT, timeouts);
+
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    printf("  Node    ID     Temp(C)   Age ms    Frames  Lost  State\n");
+    for (int node = 0; node < CAN_NODE_COUNT; node++) {
+        can_node_info_t info;
+        can_receive_get_node(node, &info);
+        if (!info.seen) {
+            continue;
+        }
+        int centi = info.last_centi;
+        printf("  %4d  0x%03lX  %s%3d.%02d  %8lu  %8lu  %4u  %s\n", node, CAN_MSG_TEMPERATURE_NODE_ID(node),
+               centi < 0 ? "-" : " ", abs(centi) / 100, abs(centi) % 100, now_ms - info.last_seen_ms,
+               info.frames, info.lost_frames, info.present ? "present" : "timed out");
+    }
+    return 0;
+}
+
+static struct {
+    struct arg_lit *apply;
+    struct arg_end *end;
+} can_queue_args;
+
+static int cmd_can_queue(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &can_queue_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, can_queue_args.end, argv[0]);
+        return 1;
+    }
+
+    can_queue_stats_t stats;
+    can_queue_get_stats(&stats);
+    printf("CAN driver queues:\n");
+    printf("- RX: length %lu, peak burst %lu, recommended %lu\n",
+           stats.rx_queue_len, stats.rx_peak, stats.recommended_rx_len);
+    printf("- TX: length %lu, peak backlog %lu, recommended %lu\n",
+           stats.tx_queue_len, stats.tx_peak, stats.recommended_tx_len);
+    printf("- Lost: %lu missed (RX queue full), %lu overrun (controller FIFO), in %lu event(s)\n",
+           stats.rx_missed, stats.rx_overrun, stats.loss_events);
+    printf("- Resizes: %lu done, %lu failed%s\n", stats.resizes, stats.resize_failures,
+           stats.resize_requested ? ", one pending" : "");
+
+    if (can_queue_args.apply->count > 0) {
+        can_queue_request_resize();
+        printf("Resize requested; the receive task applies it within %d ms\n", CAN_NODE_SWEEP_MS);
+    }
+    return 0;
+}
+
+static struct {
+    struct arg_int *frames;
+    struct arg_end *end;
+} bench_nodes_args;
+
+// Per-frame cost of decode + node accounting for a growing number of active nodes
+static int cmd_bench_nodes(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &bench_nodes_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, bench_nodes_args.end, argv[0]);
+        return 1;
+    }
+    int frames = bench_nodes_args.frames->count > 0 ? bench_nodes_args.frames->ival[0] : 20000;
+    if (frames <= 0) {
+        printf("Frame count must be positive\n");
+        return 1;
+    }
+
+    // A private table, so the live one is untouched
+    can_node_table_t *table = malloc(sizeof(can_node_table_t));
+    if (table == NULL) {
+        printf("Not enough memory for a %u-byte node table\n", (unsigned)sizeof(can_node_table_t));
+        return 1;
+    }
+
+    printf("Node table: %d nodes, %u bytes; %d frames per run\n", CAN_NODE_COUNT, (unsigned)sizeof(can_node_table_t), frames);
+    printf("  Nodes  cycles/frame  max cycles  sweep cycles\n");
+    for (int active = 1; active <= CAN_NODE_COUNT; active *= 2) {
+        can_node_table_init(table);
+        uint8_t sequence[CAN_NODE_COUNT] = {0};
+        uint64_t total = 0;
+        uint32_t max = 0;
+
+        for (int i = 0; i < frames; i++) {
+            int target = i % active;
+            const int16_t samples[] = { 2000 + target, 2001 + target, 2002 + target };
+            twai_message_t message;
+            can_batch_pack(samples, 3, sequence[target]++, CAN_MSG_TEMPERATURE_NODE_ID(target), &message);
+
+            uint32_t start = esp_cpu_get_cycle_count();
+            int node = can_node_from_id(&message);
+            can_temp_batch_t batch;
+            bool sequenced;
+            if (node >= 0 && can_node_decode(&message, &batch, &sequenced)) {
+                can_node_record(table, node, &batch, sequenced, (uint32_t)i);
+            }
+            uint32_t cycles = esp_cpu_get_cycle_count() - start;
+            total += cycles;
+            max = cycles > max ? cycles : max;
+        }
+
+        // Every node present and due, the worst case for a sweep
+        uint32_t start = esp_cpu_get_cycle_count();
+        can_node_expire(table, (uint32_t)frames + CAN_NODE_TIMEOUT_MS);
+        uint32_t sweep = esp_cpu_get_cycle_count() - start;
+
+        printf("  %5d  %12lu  %10lu  %12lu\n", active, (uint32_t)(total / frames), max, sweep);
+    }
+    free(table);
+    return 0;
+}
+
+esp_err_t receiver_cli_start(void)
+{
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "receiver>";
+    esp_console_dev_uart_config_t uart_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+
+    esp_err_t ret = esp_console_new_repl_uart(&uart_config, &repl_config, &repl);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_CLI, "Failed to create console: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    esp_console_register_help_command();
+
+    temp_stats_args.reset = arg_lit0("r", "reset", "Clear the statistics");
+    temp_stats_args.end = arg_end(1);
+    const esp_console_cmd_t temp_stats_cmd = {
+        .command = "temp-stats",
+        .help = "Show received temperature statistics",
+        .hint = NULL,
+        .func = cmd_temp_stats,
+        .argtable = &temp_stats_args,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&temp_stats_cmd));
+
+    const esp_console_cmd_t temp_nodes_cmd = {
+        .command = "temp-nodes",
+        .help = "List addressed temperature nodes",
+        .hint = NULL,
+        .func = cmd_temp_nodes,
+        .argtable = NULL,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&temp_nodes_cmd));
+
+    can_queue_args.apply = arg_lit0("a", "apply", "Reinstall now with the recommended lengths (loses frames)");
+    can_queue_args.end = arg_end(1);
+    const esp_console_cmd_t can_queue_cmd = {
+        .command = "can-queue",
+        .help = "Show driver queue usage and frame losses",
+        .hint = NULL,
+        .func = cmd_can_queue,
+        .argtable = &can_queue_args,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&can_queue_cmd));
+
+    bench_nodes_args.frames = arg_int0("n", "frames", "<n>", "Frames per run (default 20000)");
+    bench_nodes_args.end = arg_end(1);
+    const esp_console_cmd_t bench_nodes_cmd = {
+        .command = "bench-nodes",
+        .help = "Measure per-frame node processing cost against node count",
+        .hint = NULL,
+        .func = cmd_bench_nodes,
+        .argtable = &bench_nodes_args,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&bench_nodes_cmd));
+
+    return esp_console_start_repl(repl);
+}
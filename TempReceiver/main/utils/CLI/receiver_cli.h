@@ -0,0 +1,16 @@
+#ifndef RECEIVER_CLI_H
+#define RECEIVER_CLI_H
+
+#include "esp_err.h"
+
+/**
+ * @brief Start a UART console with the receiver's commands.
+ *
+ * temp-stats [-r]     print (or reset) the temperature statistics
+ * temp-nodes          list addressed nodes and their presence
+ * can-queue [-a]      driver queue usage and losses (or grow the queues now)
+ * bench-nodes [-n N]  per-frame node processing cost vs. node count
+ */
+esp_err_t receiver_cli_start(void);
+
+#endif // RECEIVER_CLI_H
@@ -0,0 +1,162 @@
+#include "rolling_stats.h"
+#include <math.h>
+#include <string.h>
+
+_Static_assert((ROLLING_STATS_DEQUE_SIZE & (ROLLING_STATS_DEQUE_SIZE - 1)) == 0,
+               "ROLLING_STATS_DEQUE_SIZE must be a power of two");
+_Static_assert(ROLLING_STATS_DEQUE_SIZE > ROLLING_STATS_WINDOW_BUCKETS,
+               "a deque holds up to one point per bucket plus the current one");
+
+#define DEQUE_MASK (ROLLING_STATS_DEQUE_SIZE - 1)
+
+static inline rolling_stats_point_t *deque_front(rolling_stats_deque_t *deque)
+{
+    return &deque->points[deque->head];
+}
+
+static inline rolling_stats_point_t *deque_back(rolling_stats_deque_t *deque)
+{
+    return &deque->points[(deque->head + deque->count - 1) & DEQUE_MASK];
+}
+
+// Points whose bucket has left the window (unsigned difference survives wrap)
+static inline bool bucket_expired(uint32_t bucket, uint32_t current)
+{
+    return current - bucket >= ROLLING_STATS_WINDOW_BUCKETS;
+}
+
+static void deque_expire(rolling_stats_deque_t *deque, uint32_t current)
+{
+    while (deque->count > 0 && bucket_expired(deque_front(deque)->bucket, current)) {
+        deque->head = (deque->head + 1) & DEQUE_MASK;
+        deque->count--;
+    }
+}
+
+/*
+ * Push keeping the deque monotonic: in the min deque a new value retires
+ * every older point that is not smaller, since it outlives them. Amortized
+ * O(1), as every point is popped at most once.
+ */
+static void deque_push(rolling_stats_deque_t *deque, uint32_t bucket, float value, bool is_min)
+{
+    while (deque->count > 0) {
+        float back = deque_back(deque)->value;
+        if (is_min ? value <= back : value >= back) {
+            deque->count--;
+        } else {
+            break;
+        }
+    }
+    // A surviving point in the same bucket is more extreme and expires together with this one
+    if (deque->count > 0 && deque_back(deque)->bucket == bucket) {
+        return;
+    }
+    deque->count++;
+    *deque_back(deque) = (rolling_stats_point_t){ .bucket = bucket, .value = value };
+}
+
+// Front of the deque ignoring expired points, without modifying it
+static bool deque_peek_live(const rolling_stats_deque_t *deque, uint32_t current, float *out_value)
+{
+    for (uint8_t i = 0; i < deque->count; i++) {
+        const rolling_stats_point_t *point = &deque->points[(deque->head + i) & DEQUE_MASK];
+        if (!bucket_expired(point->bucket, current)) {
+            *out_value = point->value;
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t rolling_stats_init(rolling_stats_t *stats, float ema_alpha,
+                             const uint32_t *window_ms, size_t window_count)
+{
+    if (stats == NULL || !(ema_alpha > 0.0f && ema_alpha <= 1.0f) ||
+        window_count > ROLLING_STATS_MAX_WINDOWS || (window_count > 0 && window_ms == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < window_count; i++) {
+        if (window_ms[i] < ROLLING_STATS_WINDOW_BUCKETS) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->ema_alpha = ema_alpha;
+    stats->window_count = window_count;
+    for (size_t i = 0; i < window_count; i++) {
+        stats->windows[i].window_ms = window_ms[i];
+        stats->windows[i].bucket_us = (int64_t)window_ms[i] * 1000 / ROLLING_STATS_WINDOW_BUCKETS;
+    }
+    return ESP_OK;
+}
+
+void rolling_stats_reset(rolling_stats_t *stats)
+{
+    stats->count = 0;
+    stats->mean = 0.0;
+    stats->m2 = 0.0;
+    for (size_t i = 0; i < stats->window_count; i++) {
+        stats->windows[i].min.count = 0;
+        stats->windows[i].max.count = 0;
+    }
+}
+
+void rolling_stats_update(rolling_stats_t *stats, float value, int64_t timestamp_us)
+{
+    if (stats->count == 0) {
+        stats->min = value;
+        stats->max = value;
+        stats->ema = value;
+    } else {
+        stats->min = value < stats->min ? value : stats->min;
+        stats->max = value > stats->max ? value : stats->max;
+        stats->ema += stats->ema_alpha * (value - stats->ema);
+    }
+    stats->count++;
+    stats->last = value;
+    stats->last_us = timestamp_us;
+
+    double delta = value - stats->mean;
+    stats->mean += delta / stats->count;
+    stats->m2 += delta * (value - stats->mean);
+
+    for (size_t i = 0; i < stats->window_count; i++) {
+        rolling_stats_window_t *window = &stats->windows[i];
+        uint32_t bucket = (uint32_t)(timestamp_us / window->bucket_us);
+        deque_expire(&window->min, bucket);
+        deque_expire(&window->max, bucket);
+        deque_push(&window->min, bucket, value, true);
+        deque_push(&window->max, bucket, value, false);
+    }
+}
+
+void rolling_stats_get_summary(const rolling_stats_t *stats, int64_t now_us, rolling_stats_summary_t *out_summary)
+{
+    memset(out_summary, 0, sizeof(*out_summary));
+    out_summary->count = stats->count;
+    out_summary->window_count = stats->window_count;
+    for (size_t i = 0; i < stats->window_count; i++) {
+        out_summary->windows[i].window_ms = stats->windows[i].window_ms;
+    }
+    if (stats->count == 0) {
+        return;
+    }
+
+    out_summary->last = stats->last;
+    out_summary->last_us = stats->last_us;
+    out_summary->min = stats->min;
+    out_summary->max = stats->max;
+    out_summary->mean = (float)stats->mean;
+    out_summary->stddev = stats->count > 1 ? (float)sqrt(stats->m2 / (stats->count - 1)) : 0.0f;
+    out_summary->ema = stats->ema;
+
+    for (size_t i = 0; i < stats->window_count; i++) {
+        const rolling_stats_window_t *window = &stats->windows[i];
+        rolling_stats_window_summary_t *summary = &out_summary->windows[i];
+        uint32_t bucket = (uint32_t)(now_us / window->bucket_us);
+        summary->valid = deque_peek_live(&window->min, bucket, &summary->min) &&
+                         deque_peek_live(&window->max, bucket, &summary->max);
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef ROLLING_STATS_H
+#define ROLLING_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/*
+ * Incremental statistics for one signal, O(1) per sample in fixed memory.
+ *
+ * Since start: count, min, max, mean and variance (Welford's update, in
+ * double so long runs do not drift) and an exponential moving average.
+ *
+ * Per window (e.g. 1 s, 1 min, 1 h): min and max from two monotonic
+ * deques. Time is cut into ROLLING_STATS_WINDOW_BUCKETS buckets per
+ * window and a deque keeps at most one point per bucket, because a later
+ * sample in the same bucket expires with the earlier one and only
+ * matters if it is more extreme. A deque therefore never holds more than
+ * BUCKETS + 1 points whatever the sample rate, and the window edge is
+ * exact to one bucket (1/60 of the window).
+ *
+ * Not thread-safe: callers serialize updates and reads.
+ */
+#define ROLLING_STATS_MAX_WINDOWS       4
+#define ROLLING_STATS_WINDOW_BUCKETS    60
+#define ROLLING_STATS_DEQUE_SIZE        64      // power of two, > ROLLING_STATS_WINDOW_BUCKETS
+
+typedef struct {
+    uint32_t bucket;
+    float value;
+} rolling_stats_point_t;
+
+typedef struct {
+    rolling_stats_point_t points[ROLLING_STATS_DEQUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+} rolling_stats_deque_t;
+
+typedef struct {
+    uint32_t window_ms;
+    int64_t bucket_us;
+    rolling_stats_deque_t min;      // increasing values, front is the minimum
+    rolling_stats_deque_t max;      // decreasing values, front is the maximum
+} rolling_stats_window_t;
+
+typedef struct {
+    uint32_t count;
+    float last;
+    float min;
+    float max;
+    double mean;
+    double m2;                      // sum of squared deviations from the mean
+    float ema;
+    float ema_alpha;
+    int64_t last_us;
+    size_t window_count;
+    rolling_stats_window_t windows[ROLLING_STATS_MAX_WINDOWS];
+} rolling_stats_t;
+
+typedef struct {
+    uint32_t window_ms;
+    bool valid;                     // false if no sample fell in the window
+    float min;
+    float max;
+} rolling_stats_window_summary_t;
+
+typedef struct {
+    uint32_t count;
+    float last;
+    int64_t last_us;
+    float min;
+    float max;
+    float mean;
+    float stddev;                   // sample standard deviation
+    float ema;
+    size_t window_count;
+    rolling_stats_window_summary_t windows[ROLLING_STATS_MAX_WINDOWS];
+} rolling_stats_summary_t;
+
+/**
+ * @brief Set up an empty statistics block.
+ *
+ * @param ema_alpha Weight of a new sample in the EMA, 0 < alpha <= 1.
+ * @param window_ms Window lengths, at least ROLLING_STATS_WINDOW_BUCKETS ms each.
+ * @return ESP_ERR_INVALID_ARG for a bad alpha, window or window count.
+ */
+esp_err_t rolling_stats_init(rolling_stats_t *stats, float ema_alpha,
+                             const uint32_t *window_ms, size_t window_count);
+
+/**
+ * @brief Forget all samples, keeping the configuration.
+ */
+void rolling_stats_reset(rolling_stats_t *stats);
+
+/**
+ * @brief Add a sample. Timestamps must not go backwards.
+ */
+void rolling_stats_update(rolling_stats_t *stats, float value, int64_t timestamp_us);
+
+/**
+ * @brief Current statistics, with windows ending at now_us.
+ */
+void rolling_stats_get_summary(const rolling_stats_t *stats, int64_t now_us, rolling_stats_summary_t *out_summary);
+
+#endif // ROLLING_STATS_H
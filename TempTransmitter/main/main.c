@@ -2,21 +2,47 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 #include "utils/TempSensor/temp_sensor.h" // Include the new header for the LM35 task
 #include "utils/CAN/can_config.h"         // For temperature_queue definition
-#include "utils/CAN/can_driver_utils.h"   // For CAN driver initialization
+#include "can_driver_utils.h"   // For CAN driver initialization
 #include "utils/CAN/can_transmit_utils.h" // For CAN transmit task
+#include "utils/CAN/can_scheduler_utils.h" // For periodic CAN messages
+#include "utils/CAN/can_alert_utils.h"     // For TWAI alert dispatch
+#include "utils/CAN/can_tx_async_utils.h"  // For non-blocking CAN transmit
+#include "utils/CAN/can_error_utils.h"     // For bus-off recovery
+#include "utils/Log/deferred_log.h"        // For deferred hot-path logging
 
 static const char *TAG_MAIN = "APP_MAIN";
 
 QueueHandle_t temperature_queue = NULL;
 
+// Heartbeat: uptime [s] (u32), scheduler deadline misses (u16), dropped log records (u16)
+static bool heartbeat_producer(twai_message_t *message, void *ctx) {
+    uint32_t uptime_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    uint32_t misses = can_scheduler_get_deadline_misses();
+    uint32_t dropped = dlog_get_dropped_count();
+    can_heartbeat_t heartbeat = {
+        .uptime = uptime_s,
+        .deadline_misses = misses > UINT16_MAX ? UINT16_MAX : misses,
+        .log_dropped = dropped > UINT16_MAX ? UINT16_MAX : dropped,
+    };
+
+    message->data_length_code = CAN_MSG_HEARTBEAT_DLC;
+    can_heartbeat_pack(message->data, &heartbeat);
+    return true;
+}
+
 void app_main(void)
 {
     ESP_LOGI(TAG_MAIN, "ESP32 LM35 Temperature Sensor with CAN - Main App");
 
-    temperature_queue = xQueueCreate(10, sizeof(float)); 
+    if (dlog_init() != ESP_OK) {
+        ESP_LOGW(TAG_MAIN, "Deferred logger unavailable, hot-path logs will be lost");
+    }
+
+    temperature_queue = xQueueCreate(10, sizeof(temp_sample_t));
     if (temperature_queue == NULL) {
         ESP_LOGE(TAG_MAIN, "Failed to create temperature queue. Halting.");
         return;
@@ -31,6 +57,17 @@ void app_main(void)
     }
     ESP_LOGI(TAG_MAIN, "CAN driver initialized.");
 
+    // TX completions and error states are tracked through TWAI alerts
+    const can_error_config_t error_config = {
+        .auto_restart = CAN_AUTO_RESTART,
+        .restart_delay_ms = CAN_RESTART_DELAY_MS,
+    };
+    if (can_tx_async_init() != ESP_OK || can_error_init(&error_config) != ESP_OK ||
+        can_alert_start() != ESP_OK) {
+        ESP_LOGE(TAG_MAIN, "Failed to start CAN alert handling. Halting.");
+        return;
+    }
+
     // You can initialize other things here if needed (like NVS for calibration data persistence)
 
     // Create the temperature reader task
@@ -51,6 +88,19 @@ void app_main(void)
                 NULL); // Task handle
     ESP_LOGI(TAG_MAIN, "CAN transmit task created.");
 
+    // Periodic messages are table-driven; add further entries here
+    const can_sched_entry_t heartbeat_entry = {
+        .identifier = HEARTBEAT_CAN_ID,
+        .flags = TWAI_MSG_FLAG_NONE,
+        .period_ms = HEARTBEAT_PERIOD_MS,
+        .offset_ms = CAN_SCHED_AUTO_OFFSET,
+        .producer = heartbeat_producer,
+        .ctx = NULL,
+    };
+    if (can_scheduler_add(&heartbeat_entry, NULL) != ESP_OK || can_scheduler_start() != ESP_OK) {
+        ESP_LOGE(TAG_MAIN, "Failed to start CAN scheduler");
+    }
+
 
     ESP_LOGI(TAG_MAIN, "All tasks created. Application running.");
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "can_alert_utils.h"
+#include "can_config.h"
+#include "driver/twai.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+static const char *TAG_CAN_ALERT = "CAN_ALERT";
+
+typedef struct {
+    uint32_t alert_mask;
+    can_alert_handler_t handler;
+    void *ctx;
+} can_alert_slot_t;
+
+static can_alert_slot_t handlers[CAN_ALERT_MAX_HANDLERS];
+static volatile int handler_count = 0;
+static TaskHandle_t alert_task_handle = NULL;
+
+esp_err_t can_alert_register(uint32_t alert_mask, can_alert_handler_t handler, void *ctx) {
+    if (handler == NULL || alert_mask == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((alert_mask & CAN_ALERTS_ENABLED) != alert_mask) {
+        ESP_LOGW(TAG_CAN_ALERT, "Alerts 0x%lx are not enabled in CAN_ALERTS_ENABLED",
+                 (unsigned long)(alert_mask & ~(uint32_t)CAN_ALERTS_ENABLED));
+    }
+    if (handler_count >= CAN_ALERT_MAX_HANDLERS) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Fill the slot before publishing it to the alert task
+    handlers[handler_count].alert_mask = alert_mask;
+    handlers[handler_count].handler = handler;
+    handlers[handler_count].ctx = ctx;
+    handler_count++;
+    return ESP_OK;
+}
+
+static void can_alert_task(void *pvParameters) {
+    ESP_LOGI(TAG_CAN_ALERT, "CAN Alert Task Started");
+
+    while (1) {
+        uint32_t alerts = 0;
+        esp_err_t espStatus = twai_read_alerts(&alerts, portMAX_DELAY);
+        if (espStatus == ESP_ERR_INVALID_STATE) {
+            // Driver not installed (e.g. being reinstalled); try again shortly
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        if (espStatus != ESP_OK || alerts == 0) {
+            continue;
+        }
+
+        int count = handler_count;
+        for (int i = 0; i < count; i++) {
+            uint32_t matched = alerts & handlers[i].alert_mask;
+            if (matched) {
+                handlers[i].handler(matched, handlers[i].ctx);
+            }
+        }
+    }
+}
+
+esp_err_t can_alert_start(void) {
+    if (alert_task_handle != NULL) {
+        return ESP_OK;
+    }
+    if (xTaskCreate(can_alert_task, "can_alert_task", CAN_ALERT_TASK_STACK_SIZE, NULL,
+                    CAN_ALERT_TASK_PRIORITY, &alert_task_handle) != pdPASS) {
+        ESP_LOGE(TAG_CAN_ALERT, "Failed to create alert task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,31 @@
+#ifndef CAN_ALERT_UTILS_H
+#define CAN_ALERT_UTILS_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#define CAN_ALERT_MAX_HANDLERS      8
+#define CAN_ALERT_TASK_STACK_SIZE   4096
+#define CAN_ALERT_TASK_PRIORITY     8
+
+/**
+ * @brief Alert handler, called from the alert task with the alerts that
+ *        matched the handler's mask. Must not block.
+ */
+typedef void (*can_alert_handler_t)(uint32_t alerts, void *ctx);
+
+/**
+ * @brief Register a handler for a set of TWAI_ALERT_* bits.
+ *
+ * twai_read_alerts() has a single consumer, so every module that needs
+ * alerts registers here instead of reading them itself. The bits must
+ * also be enabled in CAN_ALERTS_ENABLED (can_config.h).
+ */
+esp_err_t can_alert_register(uint32_t alert_mask, can_alert_handler_t handler, void *ctx);
+
+/**
+ * @brief Start the task that reads alerts and dispatches them.
+ */
+esp_err_t can_alert_start(void);
+
+#endif // CAN_ALERT_UTILS_H
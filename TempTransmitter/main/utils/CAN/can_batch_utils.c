@@ -0,0 +1,50 @@
+#include "can_batch_utils.h"
+#include <string.h>
+
+bool can_batch_pack(const int16_t *samples, uint8_t count, uint8_t sequence,
+                    uint32_t identifier, twai_message_t *out_message) {
+    if (samples == NULL || out_message == NULL || count == 0 || count > CAN_BATCH_MAX_SAMPLES) {
+        return false;
+    }
+
+    // Unused sample slots are packed as zero and fall outside the DLC
+    can_temperature_batch_t batch = {
+        .sequence = sequence & CAN_BATCH_SEQ_MASK,
+        .count = count,
+        .sample0 = samples[0],
+        .sample1 = count > 1 ? samples[1] : 0,
+        .sample2 = count > 2 ? samples[2] : 0,
+    };
+
+    memset(out_message, 0, sizeof(*out_message));
+    out_message->identifier = identifier;
+    out_message->flags = TWAI_MSG_FLAG_NONE;
+    out_message->data_length_code = 1 + 2 * count;
+    can_temperature_batch_pack(out_message->data, &batch);
+    return true;
+}
+
+bool can_batch_is_batched(const twai_message_t *message) {
+    if (message == NULL || message->data_length_code == 0) {
+        return false;
+    }
+    can_temperature_batch_t batch;
+    can_temperature_batch_unpack(&batch, message->data);
+    return batch.count >= CAN_SIG_TEMPERATURE_BATCH_COUNT_MIN_RAW &&
+           message->data_length_code == 1 + 2 * batch.count;
+}
+
+bool can_batch_unpack(const twai_message_t *message, can_temp_batch_t *out_batch) {
+    if (out_batch == NULL || !can_batch_is_batched(message)) {
+        return false;
+    }
+
+    can_temperature_batch_t batch;
+    can_temperature_batch_unpack(&batch, message->data);
+    out_batch->count = batch.count;
+    out_batch->sequence = batch.sequence;
+    out_batch->samples[0] = batch.sample0;
+    out_batch->samples[1] = batch.sample1;
+    out_batch->samples[2] = batch.sample2;
+    return true;
+}
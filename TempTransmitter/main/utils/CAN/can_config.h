@@ -4,19 +4,43 @@
 #include "driver/twai.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "can_signals.h"    // generated from CANDatabase/signals.json
+#include "can_driver_config.h" // GPIOs, bitrate, queues and alerts from sdkconfig.defaults
 
-#define CAN_TX_GPIO         GPIO_NUM_21
-#define CAN_RX_GPIO         GPIO_NUM_22
+// Node address on a shared bus: 0..CAN_MSG_TEMPERATURE_NODE_COUNT-1 sends on the
+// per-node IDs (base + node), CAN_NODE_ID_LEGACY on the single-sensor IDs that
+// Base and the Debugger decode. Every transmitter on a bus needs its own ID.
+#define CAN_NODE_ID_LEGACY  (-1)
+#define CAN_NODE_ID         CAN_NODE_ID_LEGACY
 
-#define TEMP_CAN_ID         0x515
+#if CAN_NODE_ID == CAN_NODE_ID_LEGACY
+#define TEMP_CAN_ID         CAN_MSG_TEMPERATURE_ID
+#define HEARTBEAT_CAN_ID    CAN_MSG_HEARTBEAT_ID
+#else
+_Static_assert(CAN_NODE_ID >= 0 && CAN_NODE_ID < CAN_MSG_TEMPERATURE_NODE_COUNT, "CAN_NODE_ID out of range");
+#define TEMP_CAN_ID         CAN_MSG_TEMPERATURE_NODE_ID(CAN_NODE_ID)
+#define HEARTBEAT_CAN_ID    CAN_MSG_HEARTBEAT_NODE_ID(CAN_NODE_ID)
+#endif
 
-#define CAN_TX_QUEUE_LENGTH  5
-#define CAN_RX_QUEUE_LENGTH  5
+#define HEARTBEAT_PERIOD_MS CAN_MSG_HEARTBEAT_PERIOD_MS
 
-// #define CAN_TIMIMG          TWAI_TIMING_CONFIG_125KBITS()
-// #define CAN_TIMIMG          TWAI_TIMING_CONFIG_250KBITS()
-#define CAN_TIMIMG          TWAI_TIMING_CONFIG_500KBITS()
-// #define CAN_TIMIMG          TWAI_TIMING_CONFIG_1MBITS()
+#define CAN_TX_QUEUE_LENGTH  CAN_DRIVER_TX_QUEUE_LEN
+
+// Alerts delivered to can_alert_utils handlers: TX completion and error state
+// changes (CONFIG_CAN_DRIVER_ALERTS_TX and _ERROR_STATE)
+#define CAN_ALERTS_ENABLED  CAN_DRIVER_ALERTS
+
+// Bus-off handling: recover and restart in place instead of reinstalling the driver
+#define CAN_AUTO_RESTART        1
+#define CAN_RESTART_DELAY_MS    0
+
+// How long can_transmit_task waits for a TX completion when the driver queue is full
+#define CAN_TX_BACKPRESSURE_TIMEOUT_MS  100
+
+// 1: drain temperature_queue and pack up to CAN_BATCH_MAX_SAMPLES samples per frame
+// 0: one sample per frame on TEMP_CAN_ID, as 2-byte centi-degrees (TEMPERATURE
+//    message), or as a raw 4-byte float when TEMP_SAMPLE_USE_FLOAT is 1
+#define CAN_TX_BATCH_ENABLED 1
 
 extern QueueHandle_t temperature_queue;
 
@@ -0,0 +1,210 @@
+#include "can_error_utils.h"
+#include "can_alert_utils.h"
+#include "can_tx_async_utils.h"
+#include "driver/twai.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "deferred_log.h"
+
+static const char *TAG_CAN_ERROR = "CAN_ERROR";
+
+static can_error_config_t error_config = {
+    .auto_restart = true,
+    .restart_delay_ms = 0,
+};
+static volatile can_error_state_t error_state = CAN_ERROR_STATE_ACTIVE;
+static can_error_stats_t error_stats;
+static int64_t bus_off_time_us = 0;
+static esp_timer_handle_t restart_timer = NULL;
+
+static can_error_sample_t history[CAN_ERROR_HISTORY_LENGTH];
+static uint32_t history_next = 0;
+static uint32_t history_count = 0;
+static portMUX_TYPE history_lock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t last_sample_us = 0;
+
+static const char *state_names[] = {
+    "ERROR_ACTIVE", "ERROR_WARNING", "ERROR_PASSIVE", "BUS_OFF", "RECOVERING",
+};
+
+const char *can_error_state_to_name(can_error_state_t state) {
+    return state <= CAN_ERROR_STATE_RECOVERING ? state_names[state] : "UNKNOWN";
+}
+
+static void can_error_record_sample(void) {
+    int64_t now_us = esp_timer_get_time();
+    last_sample_us = now_us;
+
+    twai_status_info_t status;
+    if (twai_get_status_info(&status) != ESP_OK) {
+        return;
+    }
+
+    can_error_sample_t sample = {
+        .timestamp_ms = (uint32_t)(now_us / 1000),
+        .state = (uint8_t)error_state,
+        .tec = status.tx_error_counter > UINT8_MAX ? UINT8_MAX : status.tx_error_counter,
+        .rec = status.rx_error_counter > UINT8_MAX ? UINT8_MAX : status.rx_error_counter,
+    };
+
+    portENTER_CRITICAL(&history_lock);
+    history[history_next] = sample;
+    history_next = (history_next + 1) % CAN_ERROR_HISTORY_LENGTH;
+    if (history_count < CAN_ERROR_HISTORY_LENGTH) {
+        history_count++;
+    }
+    portEXIT_CRITICAL(&history_lock);
+}
+
+static void can_error_set_state(can_error_state_t new_state) {
+    if (new_state == error_state) {
+        return;
+    }
+    DLOGW(TAG_CAN_ERROR, "State %s -> %s", DLOG_STR(can_error_state_to_name(error_state)),
+          DLOG_STR(can_error_state_to_name(new_state)));
+    error_state = new_state;
+    can_error_record_sample();
+}
+
+static esp_err_t can_error_start_recovery(void) {
+    esp_err_t espStatus = twai_initiate_recovery();
+    if (espStatus == ESP_OK) {
+        can_error_set_state(CAN_ERROR_STATE_RECOVERING);
+    } else {
+        DLOGE(TAG_CAN_ERROR, "twai_initiate_recovery failed (0x%x)", espStatus);
+    }
+    return espStatus;
+}
+
+static void can_error_restart_timer_cb(void *arg) {
+    if (error_state == CAN_ERROR_STATE_BUS_OFF) {
+        can_error_start_recovery();
+    }
+}
+
+static void can_error_on_bus_recovered(void) {
+    // Recovery leaves the controller stopped; start it again without reinstalling
+    esp_err_t espStatus = twai_start();
+    if (espStatus != ESP_OK) {
+        DLOGE(TAG_CAN_ERROR, "twai_start after recovery failed (0x%x)", espStatus);
+        return;
+    }
+
+    uint32_t recovery_us = (uint32_t)(esp_timer_get_time() - bus_off_time_us);
+    error_stats.recoveries++;
+    error_stats.last_recovery_us = recovery_us;
+    if (recovery_us > error_stats.max_recovery_us) {
+        error_stats.max_recovery_us = recovery_us;
+    }
+    can_error_set_state(CAN_ERROR_STATE_ACTIVE);
+    DLOGI(TAG_CAN_ERROR, "Bus recovered in %lu us", (unsigned long)recovery_us);
+}
+
+static void can_error_on_alert(uint32_t alerts, void *ctx) {
+    if (alerts & TWAI_ALERT_BUS_ERROR) {
+        error_stats.bus_errors++;
+    }
+
+    if (alerts & TWAI_ALERT_BUS_OFF) {
+        bus_off_time_us = esp_timer_get_time();
+        error_stats.bus_off_count++;
+        can_error_set_state(CAN_ERROR_STATE_BUS_OFF);
+        // Frames still queued will never be sent
+        can_tx_async_flush(ESP_FAIL);
+
+        if (error_config.auto_restart) {
+            if (error_config.restart_delay_ms == 0 || restart_timer == NULL) {
+                can_error_start_recovery();
+            } else {
+                esp_timer_start_once(restart_timer, (uint64_t)error_config.restart_delay_ms * 1000);
+            }
+        }
+        return;
+    }
+
+    if (alerts & TWAI_ALERT_BUS_RECOVERED) {
+        can_error_on_bus_recovered();
+        return;
+    }
+
+    if (alerts & TWAI_ALERT_RECOVERY_IN_PROGRESS) {
+        can_error_set_state(CAN_ERROR_STATE_RECOVERING);
+    } else if (alerts & TWAI_ALERT_ERR_PASS) {
+        error_stats.passive_count++;
+        can_error_set_state(CAN_ERROR_STATE_PASSIVE);
+    } else if (alerts & TWAI_ALERT_ABOVE_ERR_WARN) {
+        error_stats.warning_count++;
+        can_error_set_state(CAN_ERROR_STATE_WARNING);
+    } else if (alerts & TWAI_ALERT_ERR_ACTIVE) {
+        // Back below 128; still a warning if either counter is 96 or more
+        twai_status_info_t status;
+        bool above_warn = twai_get_status_info(&status) == ESP_OK &&
+                          (status.tx_error_counter >= 96 || status.rx_error_counter >= 96);
+        can_error_set_state(above_warn ? CAN_ERROR_STATE_WARNING : CAN_ERROR_STATE_ACTIVE);
+    } else if (alerts & TWAI_ALERT_BELOW_ERR_WARN) {
+        can_error_set_state(CAN_ERROR_STATE_ACTIVE);
+    } else if (alerts & TWAI_ALERT_BUS_ERROR) {
+        if (esp_timer_get_time() - last_sample_us >= CAN_ERROR_SAMPLE_MIN_INTERVAL_MS * 1000) {
+            can_error_record_sample();
+        }
+    }
+}
+
+esp_err_t can_error_init(const can_error_config_t *config) {
+    if (config != NULL) {
+        error_config = *config;
+    }
+
+    if (error_config.restart_delay_ms > 0 && restart_timer == NULL) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = can_error_restart_timer_cb,
+            .arg = NULL,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "can_restart",
+            .skip_unhandled_events = true,
+        };
+        esp_err_t ret = esp_timer_create(&timer_args, &restart_timer);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG_CAN_ERROR, "Failed to create restart timer: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+
+    can_error_record_sample();
+    ESP_LOGI(TAG_CAN_ERROR, "Error state machine ready (auto restart %s, delay %lu ms)",
+             error_config.auto_restart ? "on" : "off", (unsigned long)error_config.restart_delay_ms);
+    return can_alert_register(CAN_ERROR_ALERTS, can_error_on_alert, NULL);
+}
+
+can_error_state_t can_error_get_state(void) {
+    return error_state;
+}
+
+esp_err_t can_error_request_recovery(void) {
+    if (error_state != CAN_ERROR_STATE_BUS_OFF) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return can_error_start_recovery();
+}
+
+void can_error_get_stats(can_error_stats_t *out_stats) {
+    if (out_stats != NULL) {
+        *out_stats = error_stats;
+    }
+}
+
+size_t can_error_get_history(can_error_sample_t *out_samples, size_t max_samples) {
+    if (out_samples == NULL) {
+        return 0;
+    }
+
+    portENTER_CRITICAL(&history_lock);
+    size_t count = history_count < max_samples ? history_count : max_samples;
+    uint32_t start = (history_next + CAN_ERROR_HISTORY_LENGTH - count) % CAN_ERROR_HISTORY_LENGTH;
+    for (size_t i = 0; i < count; i++) {
+        out_samples[i] = history[(start + i) % CAN_ERROR_HISTORY_LENGTH];
+    }
+    portEXIT_CRITICAL(&history_lock);
+    return count;
+}
@@ -0,0 +1,79 @@
+#ifndef CAN_ERROR_UTILS_H
+#define CAN_ERROR_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+
+#define CAN_ERROR_HISTORY_LENGTH    32
+// Bus errors arrive in bursts; sample TEC/REC for them at most this often
+#define CAN_ERROR_SAMPLE_MIN_INTERVAL_MS 10
+
+// Alerts the error state machine consumes; must be part of CAN_ALERTS_ENABLED
+#define CAN_ERROR_ALERTS    (TWAI_ALERT_ERR_ACTIVE | TWAI_ALERT_ABOVE_ERR_WARN | \
+                             TWAI_ALERT_BELOW_ERR_WARN | TWAI_ALERT_ERR_PASS | \
+                             TWAI_ALERT_BUS_OFF | TWAI_ALERT_RECOVERY_IN_PROGRESS | \
+                             TWAI_ALERT_BUS_RECOVERED | TWAI_ALERT_BUS_ERROR)
+
+typedef enum {
+    CAN_ERROR_STATE_ACTIVE = 0,     // TEC and REC below 96
+    CAN_ERROR_STATE_WARNING,        // TEC or REC at or above 96
+    CAN_ERROR_STATE_PASSIVE,        // TEC or REC at or above 128
+    CAN_ERROR_STATE_BUS_OFF,        // TEC reached 256, node is off the bus
+    CAN_ERROR_STATE_RECOVERING,     // twai_initiate_recovery() issued, waiting for 128x11 recessive bits
+} can_error_state_t;
+
+typedef struct {
+    bool auto_restart;              // initiate recovery and restart on bus-off without the application
+    uint32_t restart_delay_ms;      // hold-off before recovery, 0 for immediate
+} can_error_config_t;
+
+typedef struct {
+    uint32_t timestamp_ms;
+    uint8_t state;                  // can_error_state_t
+    uint8_t tec;
+    uint8_t rec;
+} can_error_sample_t;
+
+typedef struct {
+    uint32_t warning_count;
+    uint32_t passive_count;
+    uint32_t bus_off_count;
+    uint32_t recoveries;
+    uint32_t bus_errors;
+    uint32_t last_recovery_us;      // bus-off to running again
+    uint32_t max_recovery_us;
+} can_error_stats_t;
+
+/**
+ * @brief Register the error state machine with the alert dispatcher.
+ *
+ * Call after can_driver_init() and before can_alert_start().
+ *
+ * @param config Recovery policy, NULL for auto restart without delay.
+ */
+esp_err_t can_error_init(const can_error_config_t *config);
+
+can_error_state_t can_error_get_state(void);
+
+const char *can_error_state_to_name(can_error_state_t state);
+
+/**
+ * @brief Start bus-off recovery manually (when auto_restart is off).
+ *
+ * @return ESP_ERR_INVALID_STATE if the controller is not bus-off.
+ */
+esp_err_t can_error_request_recovery(void);
+
+void can_error_get_stats(can_error_stats_t *out_stats);
+
+/**
+ * @brief Copy the TEC/REC history, oldest first.
+ *
+ * @return Number of samples written.
+ */
+size_t can_error_get_history(can_error_sample_t *out_samples, size_t max_samples);
+
+#endif // CAN_ERROR_UTILS_H
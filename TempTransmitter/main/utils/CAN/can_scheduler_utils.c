@@ -0,0 +1,263 @@
+#include "can_scheduler_utils.h"
+#include "can_tx_async_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "deferred_log.h"
+#include <string.h>
+
+static const char *TAG_CAN_SCHED = "CAN_SCHED";
+
+typedef struct {
+    can_sched_entry_t entry;
+    uint32_t priority_key;
+    uint32_t next_due_ms;
+    can_sched_stats_t stats;
+} can_sched_slot_t;
+
+static can_sched_slot_t slots[CAN_SCHED_MAX_ENTRIES];
+static uint8_t priority_order[CAN_SCHED_MAX_ENTRIES]; // slot indices, highest priority first
+static int slot_count = 0;
+
+static esp_timer_handle_t tick_timer = NULL;
+static TaskHandle_t sched_task_handle = NULL;
+static volatile bool sched_running = false;
+static int64_t start_time_us = 0;
+
+/*
+ * Arbitration is decided by the 11-bit base ID first; for equal base IDs
+ * a standard frame beats an extended one (SRR/IDE recessive), then the
+ * 18-bit extension decides. Lower key means higher priority.
+ */
+static uint32_t can_sched_priority_key(uint32_t identifier, uint32_t flags) {
+    if (flags & TWAI_MSG_FLAG_EXTD) {
+        uint32_t base = (identifier >> 18) & 0x7FF;
+        return (base << 19) | (1U << 18) | (identifier & 0x3FFFF);
+    }
+    return (identifier & 0x7FF) << 19;
+}
+
+static uint32_t gcd_u32(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/*
+ * Pick the offset in [0, period) whose releases coincide with the fewest
+ * already scheduled messages. Two periodic releases (p1, o1) and (p2, o2)
+ * ever fall on the same tick iff o1 == o2 (mod gcd(p1, p2)).
+ */
+static uint32_t can_sched_pick_offset(uint32_t period_ms) {
+    uint32_t best_offset = 0;
+    int best_collisions = slot_count + 1;
+
+    for (uint32_t candidate = 0; candidate < period_ms; candidate += CAN_SCHED_TICK_MS) {
+        int collisions = 0;
+        for (int i = 0; i < slot_count; i++) {
+            uint32_t g = gcd_u32(period_ms, slots[i].entry.period_ms);
+            if ((candidate % g) == (slots[i].entry.offset_ms % g)) {
+                collisions++;
+            }
+        }
+        if (collisions < best_collisions) {
+            best_collisions = collisions;
+            best_offset = candidate;
+            if (collisions == 0) {
+                break;
+            }
+        }
+    }
+    return best_offset;
+}
+
+esp_err_t can_scheduler_add(const can_sched_entry_t *entry, int *out_handle) {
+    if (entry == NULL || entry->producer == NULL || entry->period_ms < CAN_SCHED_TICK_MS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (sched_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (slot_count >= CAN_SCHED_MAX_ENTRIES) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    int index = slot_count;
+    can_sched_slot_t *slot = &slots[index];
+    memset(slot, 0, sizeof(*slot));
+    slot->entry = *entry;
+    if (entry->offset_ms == CAN_SCHED_AUTO_OFFSET) {
+        slot->entry.offset_ms = can_sched_pick_offset(entry->period_ms);
+    } else {
+        slot->entry.offset_ms = entry->offset_ms % entry->period_ms;
+    }
+    slot->priority_key = can_sched_priority_key(entry->identifier, entry->flags);
+
+    // Insertion into the priority order, stable for equal keys
+    int pos = slot_count;
+    while (pos > 0 && slots[priority_order[pos - 1]].priority_key > slot->priority_key) {
+        priority_order[pos] = priority_order[pos - 1];
+        pos--;
+    }
+    priority_order[pos] = (uint8_t)index;
+    slot_count++;
+
+    ESP_LOGI(TAG_CAN_SCHED, "Scheduled ID=0x%03lX every %lu ms at offset %lu ms",
+             (unsigned long)entry->identifier, (unsigned long)entry->period_ms,
+             (unsigned long)slot->entry.offset_ms);
+    if (out_handle) {
+        *out_handle = index;
+    }
+    return ESP_OK;
+}
+
+static void can_sched_tick_callback(void *arg) {
+    if (sched_task_handle != NULL) {
+        xTaskNotifyGive(sched_task_handle);
+    }
+}
+
+static void can_sched_run_tick(uint32_t now_ms) {
+    int queued = 0;
+
+    for (int i = 0; i < slot_count; i++) {
+        can_sched_slot_t *slot = &slots[priority_order[i]];
+        if ((int32_t)(now_ms - slot->next_due_ms) < 0) {
+            continue;
+        }
+        if (queued >= CAN_SCHED_MAX_FRAMES_PER_TICK) {
+            // Leave it due; it goes out on a later tick and the lateness is accounted then
+            continue;
+        }
+
+        uint32_t period = slot->entry.period_ms;
+        uint32_t lateness = now_ms - slot->next_due_ms;
+        uint32_t missed_periods = lateness / period;
+        if (lateness > slot->stats.max_lateness_ms) {
+            slot->stats.max_lateness_ms = lateness;
+        }
+        slot->stats.deadline_misses += missed_periods;
+        slot->next_due_ms += period * (missed_periods + 1);
+
+        twai_message_t message;
+        memset(&message, 0, sizeof(message));
+        message.identifier = slot->entry.identifier;
+        message.flags = slot->entry.flags;
+        if (!slot->entry.producer(&message, slot->entry.ctx)) {
+            slot->stats.skipped++;
+            continue;
+        }
+
+        esp_err_t espStatus = can_tx_async_submit(&message, NULL, NULL);
+        if (espStatus == ESP_OK) {
+            slot->stats.sent++;
+            queued++;
+        } else {
+            slot->stats.deadline_misses++;
+            DLOGW(TAG_CAN_SCHED, "ID=0x%03lX not queued (err 0x%x)", (unsigned long)message.identifier, espStatus);
+        }
+    }
+}
+
+static void can_sched_task(void *pvParameters) {
+    while (sched_running) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!sched_running) {
+            break;
+        }
+        uint32_t now_ms = (uint32_t)((esp_timer_get_time() - start_time_us) / 1000);
+        can_sched_run_tick(now_ms);
+    }
+    sched_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t can_scheduler_start(void) {
+    if (sched_running) {
+        return ESP_OK;
+    }
+    if (sched_task_handle != NULL) {
+        // Previous task is still winding down after can_scheduler_stop()
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (tick_timer == NULL) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = can_sched_tick_callback,
+            .arg = NULL,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "can_sched_tick",
+            .skip_unhandled_events = true,
+        };
+        esp_err_t ret = esp_timer_create(&timer_args, &tick_timer);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG_CAN_SCHED, "Failed to create tick timer: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+
+    for (int i = 0; i < slot_count; i++) {
+        slots[i].next_due_ms = slots[i].entry.offset_ms;
+    }
+    start_time_us = esp_timer_get_time();
+    sched_running = true;
+
+    if (xTaskCreate(can_sched_task, "can_sched_task", CAN_SCHED_TASK_STACK_SIZE, NULL,
+                    CAN_SCHED_TASK_PRIORITY, &sched_task_handle) != pdPASS) {
+        ESP_LOGE(TAG_CAN_SCHED, "Failed to create scheduler task");
+        sched_running = false;
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = esp_timer_start_periodic(tick_timer, CAN_SCHED_TICK_MS * 1000);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_CAN_SCHED, "Failed to start tick timer: %s", esp_err_to_name(ret));
+        can_scheduler_stop();
+        return ret;
+    }
+
+    ESP_LOGI(TAG_CAN_SCHED, "Scheduler started with %d message(s), tick %d ms", slot_count, CAN_SCHED_TICK_MS);
+    return ESP_OK;
+}
+
+esp_err_t can_scheduler_stop(void) {
+    if (!sched_running) {
+        return ESP_OK;
+    }
+    esp_timer_stop(tick_timer);
+    sched_running = false;
+    if (sched_task_handle != NULL) {
+        xTaskNotifyGive(sched_task_handle);
+    }
+    return ESP_OK;
+}
+
+esp_err_t can_scheduler_get_stats(int handle, can_sched_stats_t *out_stats) {
+    if (handle < 0 || handle >= slot_count || out_stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_stats = slots[handle].stats;
+    return ESP_OK;
+}
+
+uint32_t can_scheduler_get_deadline_misses(void) {
+    uint32_t total = 0;
+    for (int i = 0; i < slot_count; i++) {
+        total += slots[i].stats.deadline_misses;
+    }
+    return total;
+}
+
+void can_scheduler_log_stats(void) {
+    for (int i = 0; i < slot_count; i++) {
+        const can_sched_slot_t *slot = &slots[priority_order[i]];
+        ESP_LOGI(TAG_CAN_SCHED, "ID=0x%03lX period=%lu ms sent=%lu skipped=%lu misses=%lu max_late=%lu ms",
+                 (unsigned long)slot->entry.identifier, (unsigned long)slot->entry.period_ms,
+                 (unsigned long)slot->stats.sent, (unsigned long)slot->stats.skipped,
+                 (unsigned long)slot->stats.deadline_misses, (unsigned long)slot->stats.max_lateness_ms);
+    }
+}
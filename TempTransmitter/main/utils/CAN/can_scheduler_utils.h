@@ -0,0 +1,83 @@
+#ifndef CAN_SCHEDULER_UTILS_H
+#define CAN_SCHEDULER_UTILS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "can_config.h"
+#include "driver/twai.h"
+
+#define CAN_SCHED_MAX_ENTRIES           32
+#define CAN_SCHED_TICK_MS               1
+#define CAN_SCHED_TASK_STACK_SIZE       4096
+#define CAN_SCHED_TASK_PRIORITY         6
+// Never hand more frames to the driver in one tick than its TX queue holds
+#define CAN_SCHED_MAX_FRAMES_PER_TICK   CAN_TX_QUEUE_LENGTH
+// Let the scheduler pick an offset that spreads releases across ticks
+#define CAN_SCHED_AUTO_OFFSET           UINT32_MAX
+
+/**
+ * @brief Payload producer for a scheduled message.
+ *
+ * Called from the scheduler task when the message is due. Identifier and
+ * flags are already set; the producer fills data and data_length_code.
+ *
+ * @return true to transmit the frame, false to skip this period.
+ */
+typedef bool (*can_sched_producer_t)(twai_message_t *message, void *ctx);
+
+typedef struct {
+    uint32_t identifier;
+    uint32_t flags;             // TWAI_MSG_FLAG_*
+    uint32_t period_ms;
+    uint32_t offset_ms;         // or CAN_SCHED_AUTO_OFFSET
+    can_sched_producer_t producer;
+    void *ctx;
+} can_sched_entry_t;
+
+typedef struct {
+    uint32_t sent;
+    uint32_t skipped;           // producer returned false
+    uint32_t deadline_misses;   // periods released late by a full period or not queued
+    uint32_t max_lateness_ms;
+} can_sched_stats_t;
+
+/**
+ * @brief Add a message to the schedule. Only allowed while stopped.
+ *
+ * Entries are kept ordered by CAN arbitration priority so that, when
+ * several frames are due in the same tick, the one that would win the
+ * bus is queued first.
+ *
+ * @param entry Message description.
+ * @param out_handle Optional handle for can_scheduler_get_stats().
+ * @return ESP_OK, ESP_ERR_INVALID_ARG, ESP_ERR_NO_MEM or ESP_ERR_INVALID_STATE.
+ */
+esp_err_t can_scheduler_add(const can_sched_entry_t *entry, int *out_handle);
+
+/**
+ * @brief Start the tick timer and scheduler task.
+ */
+esp_err_t can_scheduler_start(void);
+
+/**
+ * @brief Stop releasing frames. Entries and statistics are kept.
+ */
+esp_err_t can_scheduler_stop(void);
+
+/**
+ * @brief Get statistics for one entry.
+ */
+esp_err_t can_scheduler_get_stats(int handle, can_sched_stats_t *out_stats);
+
+/**
+ * @brief Total deadline misses over all entries.
+ */
+uint32_t can_scheduler_get_deadline_misses(void);
+
+/**
+ * @brief Log the per-entry statistics table.
+ */
+void can_scheduler_log_stats(void);
+
+#endif // CAN_SCHEDULER_UTILS_H
@@ -1,49 +1,129 @@
 #include "can_transmit_utils.h"
-#include "can_driver_utils.h"
+#include "can_batch_utils.h"
+#include "can_tx_async_utils.h"
+#include "can_error_utils.h"
 #include "can_config.h"
+#include "temp_sensor.h"
 #include "driver/twai.h"
 #include "esp_log.h"
+#include "deferred_log.h"
+#include <math.h>
 #include <string.h>
 static const char *TAG_CAN_TX = "CAN_TRANSMIT";
 
+static void can_transmit_done(const can_tx_result_t *result, void *ctx) {
+    if (result->status != ESP_OK) {
+        DLOGW(TAG_CAN_TX, "Frame ID=0x%03lX was not acknowledged", (unsigned long)result->identifier);
+    } else {
+        DLOGD(TAG_CAN_TX, "Frame ID=0x%03lX sent after %lu us", (unsigned long)result->identifier,
+              (unsigned long)(result->complete_time_us - result->enqueue_time_us));
+    }
+}
+
+static esp_err_t can_transmit_message(const twai_message_t *message) {
+    esp_err_t espStatus;
+    while ((espStatus = can_tx_async_submit(message, can_transmit_done, NULL)) == ESP_ERR_TIMEOUT) {
+        // Back-pressure: sleep until a queued frame completes instead of polling
+        if (can_tx_async_wait_for_space(pdMS_TO_TICKS(CAN_TX_BACKPRESSURE_TIMEOUT_MS)) != ESP_OK) {
+            ESP_LOGW(TAG_CAN_TX, "TX queue still full after %d ms, dropping frame", CAN_TX_BACKPRESSURE_TIMEOUT_MS);
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+
+    if (espStatus == ESP_ERR_INVALID_STATE) {
+        // Bus-off or recovering: can_error_utils restarts the controller, the frame is dropped
+        DLOGW(TAG_CAN_TX, "Frame ID=0x%03lX dropped, controller %s", (unsigned long)message->identifier,
+              DLOG_STR(can_error_state_to_name(can_error_get_state())));
+    } else if (espStatus != ESP_OK) {
+        ESP_LOGE(TAG_CAN_TX, "Failed to transmit message: %s", esp_err_to_name(espStatus));
+    }
+    return espStatus;
+}
+
+#if CAN_TX_BATCH_ENABLED
+#if TEMP_SAMPLE_USE_FLOAT
+static int16_t temperature_to_centi(temp_sample_t temperature_c) {
+    float centi = roundf(temperature_c * 100.0f);
+    if (centi > INT16_MAX) {
+        return INT16_MAX;
+    }
+    if (centi < INT16_MIN) {
+        return INT16_MIN;
+    }
+    return (int16_t)centi;
+}
+#else
+#define temperature_to_centi(sample) (sample)
+#endif
+
+void can_transmit_task(void *pvParameters) {
+    ESP_LOGI(TAG_CAN_TX, "CAN Transmit Task Started (batch mode, up to %d samples/frame)", CAN_BATCH_MAX_SAMPLES);
+    temp_sample_t sample;
+    int16_t samples[CAN_BATCH_MAX_SAMPLES];
+    uint8_t sequence = 0;
+
+    while (1) {
+        if (xQueueReceive(temperature_queue, &sample, portMAX_DELAY) == pdPASS) {
+            uint8_t count = 0;
+            samples[count++] = temperature_to_centi(sample);
+
+            // Drain whatever else is already pending, one frame per CAN_BATCH_MAX_SAMPLES
+            while (1) {
+                while (count < CAN_BATCH_MAX_SAMPLES &&
+                       xQueueReceive(temperature_queue, &sample, 0) == pdPASS) {
+                    samples[count++] = temperature_to_centi(sample);
+                }
+
+                twai_message_t message;
+                can_batch_pack(samples, count, sequence, TEMP_CAN_ID, &message);
+                if (can_transmit_message(&message) == ESP_OK) {
+                    DLOGI(TAG_CAN_TX, "Batch queued: ID=0x%03lX, Seq=%u, Samples=%u",
+                          (unsigned long)message.identifier, sequence, count);
+                }
+                sequence = (sequence + 1) & CAN_BATCH_SEQ_MASK;
+
+                if (xQueueReceive(temperature_queue, &sample, 0) != pdPASS) {
+                    break;
+                }
+                count = 0;
+                samples[count++] = temperature_to_centi(sample);
+            }
+        }
+    }
+}
+#else
 void can_transmit_task(void *pvParameters) {
     ESP_LOGI(TAG_CAN_TX, "CAN Transmit Task Started");
-    float temperature_c;
+    temp_sample_t temperature;
 
     while (1) {
-        if (xQueueReceive(temperature_queue, &temperature_c, portMAX_DELAY) == pdPASS) {
+        if (xQueueReceive(temperature_queue, &temperature, portMAX_DELAY) == pdPASS) {
             twai_message_t message;
             message.identifier = TEMP_CAN_ID;
             message.flags = TWAI_MSG_FLAG_NONE;
-            message.data_length_code = sizeof(float);
-            
-            memcpy(message.data, &temperature_c, sizeof(float));
+            message.data_length_code = sizeof(temp_sample_t);
+
+#if TEMP_SAMPLE_USE_FLOAT
+            memcpy(message.data, &temperature, sizeof(float));
+#else
+            can_temperature_t frame = { .temperature = temperature };
+            can_temperature_pack(message.data, &frame);
+#endif
 
-            for (int i = sizeof(float); i < TWAI_FRAME_MAX_DLC; i++) {
+            for (int i = sizeof(temp_sample_t); i < TWAI_FRAME_MAX_DLC; i++) {
                 message.data[i] = 0;
             }
 
-            esp_err_t espStatus = twai_transmit(&message, pdMS_TO_TICKS(1000));
-            if (espStatus == ESP_OK) {
-                ESP_LOGI(TAG_CAN_TX, "Message transmitted: ID=0x%03lX, Temp=%.2f C", message.identifier, temperature_c); 
-            }else {
-                ESP_LOGE(TAG_CAN_TX, "Failed to transmit message: %s", esp_err_to_name(espStatus));
-                if (espStatus == TWAI_ALERT_BUS_OFF) {
-                    ESP_LOGW(TAG_CAN_TX, "CAN Bus is off");
-                } else if (espStatus == ESP_ERR_INVALID_STATE){
-                    ESP_LOGW(TAG_CAN_TX, "Invalid state error, attempting to reinitialize CAN driver");
-                    // handle invalid state error, restart CAN driver
-                    can_driver_deinit();
-                    vTaskDelay(pdMS_TO_TICKS(100)); 
-                    if (can_driver_init() == ESP_OK) {
-                        ESP_LOGI(TAG_CAN_TX, "CAN driver reinitialized, retrying transmission");
-                    } else {
-                        ESP_LOGE(TAG_CAN_TX, "Failed to reinitialize CAN driver");
-                    }
-                }
+            if (can_transmit_message(&message) == ESP_OK) {
+#if TEMP_SAMPLE_USE_FLOAT
+                ESP_LOGI(TAG_CAN_TX, "Message queued: ID=0x%03lX, Temp=%.2f C", (unsigned long)message.identifier,
+                         temperature);
+#else
+                DLOGI(TAG_CAN_TX, "Message queued: ID=0x%03lX, Temp=%d centi-C", (unsigned long)message.identifier,
+                      temperature);
+#endif
             }
         }
-        
-        vTaskDelay(pdMS_TO_TICKS(10)); 
     }
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,180 @@
+#include "can_tx_async_utils.h"
+#include "can_alert_utils.h"
+#include "can_driver_utils.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG_CAN_TX_ASYNC = "CAN_TX_ASYNC";
+
+typedef struct {
+    can_tx_done_cb_t cb;
+    void *ctx;
+    uint32_t identifier;
+    int64_t enqueue_time_us;
+} can_tx_pending_t;
+
+// FIFO of frames handed to the driver; the driver sends in queue order
+static can_tx_pending_t pending[CAN_TX_ASYNC_CAPACITY];
+static uint32_t pending_head = 0;
+static uint32_t pending_count = 0;
+static uint32_t last_tx_failed_count = 0;
+
+static SemaphoreHandle_t pending_mutex = NULL;
+static SemaphoreHandle_t space_sem = NULL;
+static can_tx_async_stats_t stats;
+
+static void can_tx_async_complete(can_tx_pending_t *done, uint32_t done_count, uint32_t failed_count,
+                                  esp_err_t failure_status) {
+    int64_t now = esp_timer_get_time();
+    for (uint32_t i = 0; i < done_count; i++) {
+        // Alerts are coalesced, so failures are attributed to the most recent frames
+        bool failed = i >= done_count - failed_count;
+        if (done[i].cb) {
+            can_tx_result_t result = {
+                .identifier = done[i].identifier,
+                .status = failed ? failure_status : ESP_OK,
+                .enqueue_time_us = done[i].enqueue_time_us,
+                .complete_time_us = now,
+            };
+            done[i].cb(&result, done[i].ctx);
+        }
+    }
+    if (done_count > 0) {
+        xSemaphoreGive(space_sem);
+    }
+}
+
+static uint32_t can_tx_async_pop(can_tx_pending_t *out, uint32_t count) {
+    if (count > pending_count) {
+        count = pending_count;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = pending[pending_head];
+        pending_head = (pending_head + 1) % CAN_TX_ASYNC_CAPACITY;
+    }
+    pending_count -= count;
+    return count;
+}
+
+static void can_tx_async_on_alert(uint32_t alerts, void *ctx) {
+    can_tx_pending_t done[CAN_TX_ASYNC_CAPACITY];
+    uint32_t done_count = 0;
+    uint32_t failed_count = 0;
+
+    xSemaphoreTake(pending_mutex, portMAX_DELAY);
+    // Status is read under the lock so it is consistent with pending_count
+    twai_status_info_t status;
+    if (twai_get_status_info(&status) == ESP_OK) {
+        uint32_t still_queued = status.msgs_to_tx;
+        if (pending_count > still_queued) {
+            done_count = can_tx_async_pop(done, pending_count - still_queued);
+        }
+        failed_count = status.tx_failed_count - last_tx_failed_count;
+        last_tx_failed_count = status.tx_failed_count;
+        if (failed_count > done_count) {
+            failed_count = done_count;
+        }
+        stats.completed += done_count - failed_count;
+        stats.failed += failed_count;
+    }
+    xSemaphoreGive(pending_mutex);
+
+    can_tx_async_complete(done, done_count, failed_count, ESP_FAIL);
+}
+
+esp_err_t can_tx_async_init(void) {
+    if (pending_mutex != NULL) {
+        return ESP_OK;
+    }
+    pending_mutex = xSemaphoreCreateMutex();
+    space_sem = xSemaphoreCreateBinary();
+    if (pending_mutex == NULL || space_sem == NULL) {
+        ESP_LOGE(TAG_CAN_TX_ASYNC, "Failed to create synchronisation objects");
+        return ESP_ERR_NO_MEM;
+    }
+
+    twai_status_info_t status;
+    if (twai_get_status_info(&status) == ESP_OK) {
+        last_tx_failed_count = status.tx_failed_count;
+    }
+
+    return can_alert_register(TWAI_ALERT_TX_SUCCESS | TWAI_ALERT_TX_FAILED | TWAI_ALERT_TX_IDLE,
+                              can_tx_async_on_alert, NULL);
+}
+
+esp_err_t can_tx_async_submit(const twai_message_t *message, can_tx_done_cb_t cb, void *ctx) {
+    if (message == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (pending_mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(pending_mutex, portMAX_DELAY);
+    if (pending_count >= CAN_TX_ASYNC_CAPACITY) {
+        stats.rejected_full++;
+        xSemaphoreGive(pending_mutex);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    // Zero timeout: a full driver queue is reported to the caller, never waited on
+    esp_err_t espStatus = can_driver_transmit(message, 0);
+    if (espStatus == ESP_OK) {
+        uint32_t tail = (pending_head + pending_count) % CAN_TX_ASYNC_CAPACITY;
+        pending[tail].cb = cb;
+        pending[tail].ctx = ctx;
+        pending[tail].identifier = message->identifier;
+        pending[tail].enqueue_time_us = esp_timer_get_time();
+        pending_count++;
+        stats.submitted++;
+        if (pending_count > stats.max_in_flight) {
+            stats.max_in_flight = pending_count;
+        }
+    } else if (espStatus == ESP_ERR_TIMEOUT) {
+        stats.rejected_full++;
+    }
+    xSemaphoreGive(pending_mutex);
+    return espStatus;
+}
+
+esp_err_t can_tx_async_wait_for_space(TickType_t ticks_to_wait) {
+    if (space_sem == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (can_tx_async_in_flight() < CAN_TX_ASYNC_CAPACITY) {
+        return ESP_OK;
+    }
+    return xSemaphoreTake(space_sem, ticks_to_wait) == pdTRUE ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+uint32_t can_tx_async_in_flight(void) {
+    return pending_count;
+}
+
+void can_tx_async_flush(esp_err_t status) {
+    can_tx_pending_t done[CAN_TX_ASYNC_CAPACITY];
+    if (pending_mutex == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(pending_mutex, portMAX_DELAY);
+    uint32_t done_count = can_tx_async_pop(done, pending_count);
+    stats.failed += done_count;
+    twai_status_info_t info;
+    if (twai_get_status_info(&info) == ESP_OK) {
+        last_tx_failed_count = info.tx_failed_count;
+    }
+    xSemaphoreGive(pending_mutex);
+
+    can_tx_async_complete(done, done_count, done_count, status);
+}
+
+void can_tx_async_get_stats(can_tx_async_stats_t *out_stats) {
+    if (out_stats == NULL || pending_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(pending_mutex, portMAX_DELAY);
+    *out_stats = stats;
+    xSemaphoreGive(pending_mutex);
+}
@@ -0,0 +1,77 @@
+#ifndef CAN_TX_ASYNC_UTILS_H
+#define CAN_TX_ASYNC_UTILS_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+#include "freertos/FreeRTOS.h"
+#include "can_config.h"
+
+// Frames the driver can hold: its TX queue plus the one in the TX buffer
+#define CAN_TX_ASYNC_CAPACITY   (CAN_TX_QUEUE_LENGTH + 1)
+
+typedef struct {
+    uint32_t identifier;
+    esp_err_t status;           // ESP_OK, or ESP_FAIL if the frame was not sent
+    int64_t enqueue_time_us;
+    int64_t complete_time_us;
+} can_tx_result_t;
+
+/**
+ * @brief Completion callback. Runs in the CAN alert task; must not block.
+ */
+typedef void (*can_tx_done_cb_t)(const can_tx_result_t *result, void *ctx);
+
+typedef struct {
+    uint32_t submitted;
+    uint32_t completed;
+    uint32_t failed;
+    uint32_t rejected_full;     // submissions refused because the driver queue was full
+    uint32_t max_in_flight;
+} can_tx_async_stats_t;
+
+/**
+ * @brief Set up the in-flight tracker and register for TX alerts.
+ *
+ * Call after can_driver_init() and before can_alert_start().
+ */
+esp_err_t can_tx_async_init(void);
+
+/**
+ * @brief Queue a frame without blocking.
+ *
+ * Completion is reported through cb once TWAI_ALERT_TX_SUCCESS,
+ * TWAI_ALERT_TX_FAILED or TWAI_ALERT_TX_IDLE shows the frame has left
+ * the driver.
+ *
+ * @param message Frame to send (copied).
+ * @param cb Optional completion callback.
+ * @param ctx Passed to cb.
+ * @return ESP_OK if queued, ESP_ERR_TIMEOUT if the driver queue is full
+ *         (back-pressure, see can_tx_async_wait_for_space()), or the
+ *         twai_transmit() error.
+ */
+esp_err_t can_tx_async_submit(const twai_message_t *message, can_tx_done_cb_t cb, void *ctx);
+
+/**
+ * @brief Block until at least one in-flight frame completes.
+ *
+ * @return ESP_OK when there is room, ESP_ERR_TIMEOUT otherwise.
+ */
+esp_err_t can_tx_async_wait_for_space(TickType_t ticks_to_wait);
+
+/**
+ * @brief Number of frames queued in the driver and not yet completed.
+ */
+uint32_t can_tx_async_in_flight(void);
+
+/**
+ * @brief Complete every in-flight frame with the given status.
+ *
+ * Used when the driver drops its TX queue (bus-off, reinstall).
+ */
+void can_tx_async_flush(esp_err_t status);
+
+void can_tx_async_get_stats(can_tx_async_stats_t *out_stats);
+
+#endif // CAN_TX_ASYNC_UTILS_H
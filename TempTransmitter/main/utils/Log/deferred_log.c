@@ -0,0 +1,158 @@
+#include "deferred_log.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+static const char *TAG_DLOG = "DLOG";
+
+#define DLOG_RING_MASK (DLOG_RING_SIZE - 1)
+
+_Static_assert((DLOG_RING_SIZE & DLOG_RING_MASK) == 0, "DLOG_RING_SIZE must be a power of two");
+
+/*
+ * Bounded multi-producer / single-consumer ring. Each slot carries a
+ * sequence number: producers claim a slot with a CAS on head and
+ * publish it by advancing the slot sequence, the drain task consumes
+ * in order. Producers on the same core (tasks and ISRs preempting each
+ * other) therefore never take a lock.
+ */
+typedef struct {
+    atomic_uint sequence;
+    dlog_record_t record;
+} dlog_slot_t;
+
+typedef struct {
+    atomic_uint head;
+    uint32_t tail;
+    dlog_slot_t slots[DLOG_RING_SIZE];
+} dlog_ring_t;
+
+static dlog_ring_t rings[portNUM_PROCESSORS];
+static atomic_uint dropped_count;
+static atomic_bool rings_ready;     // zeroed slots would otherwise accept one record each
+static TaskHandle_t drain_task_handle = NULL;
+
+static void dlog_ring_reset(dlog_ring_t *ring) {
+    atomic_store(&ring->head, 0);
+    ring->tail = 0;
+    for (uint32_t i = 0; i < DLOG_RING_SIZE; i++) {
+        atomic_store(&ring->slots[i].sequence, i);
+    }
+}
+
+void dlog_write(esp_log_level_t level, const char *tag, const char *format,
+                uint32_t nargs, const uint32_t *args) {
+    if (!atomic_load_explicit(&rings_ready, memory_order_acquire)) {
+        atomic_fetch_add_explicit(&dropped_count, 1, memory_order_relaxed);
+        return;
+    }
+    dlog_ring_t *ring = &rings[xPortGetCoreID()];
+    uint32_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    dlog_slot_t *slot;
+
+    while (1) {
+        slot = &ring->slots[pos & DLOG_RING_MASK];
+        uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&dropped_count, 1, memory_order_relaxed);
+            return;
+        } else {
+            pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+
+    slot->record.timestamp_us = (uint32_t)esp_timer_get_time();
+    slot->record.format = format;
+    slot->record.tag = tag;
+    slot->record.level = (uint8_t)level;
+    slot->record.nargs = (uint8_t)nargs;
+    memcpy(slot->record.args, args, sizeof(slot->record.args));
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+}
+
+static bool dlog_ring_pop(dlog_ring_t *ring, dlog_record_t *out_record) {
+    dlog_slot_t *slot = &ring->slots[ring->tail & DLOG_RING_MASK];
+    uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if ((int32_t)(sequence - (ring->tail + 1)) < 0) {
+        return false;
+    }
+    *out_record = slot->record;
+    atomic_store_explicit(&slot->sequence, ring->tail + DLOG_RING_SIZE, memory_order_release);
+    ring->tail++;
+    return true;
+}
+
+static void dlog_print_record(const dlog_record_t *record) {
+    static const char level_chars[] = { 'N', 'E', 'W', 'I', 'D', 'V' };
+    char message[128];
+
+    snprintf(message, sizeof(message), record->format,
+             record->args[0], record->args[1], record->args[2], record->args[3]);
+
+    esp_log_level_t level = (esp_log_level_t)record->level;
+    char level_char = record->level < sizeof(level_chars) ? level_chars[record->level] : '?';
+    esp_log_write(level, record->tag, "%c (%lu) %s: %s\n", level_char,
+                  (unsigned long)(record->timestamp_us / 1000), record->tag, message);
+}
+
+uint32_t dlog_flush(void) {
+    dlog_record_t record;
+    uint32_t printed = 0;
+
+    // Single consumer: only one task may call this at a time
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        while (dlog_ring_pop(&rings[core], &record)) {
+            dlog_print_record(&record);
+            printed++;
+        }
+    }
+    return printed;
+}
+
+uint32_t dlog_get_dropped_count(void) {
+    return atomic_load_explicit(&dropped_count, memory_order_relaxed);
+}
+
+static void dlog_drain_task(void *pvParameters) {
+    uint32_t reported_dropped = 0;
+
+    while (1) {
+        dlog_flush();
+
+        uint32_t dropped = dlog_get_dropped_count();
+        if (dropped != reported_dropped) {
+            ESP_LOGW(TAG_DLOG, "%lu log record(s) dropped (total %lu)",
+                     (unsigned long)(dropped - reported_dropped), (unsigned long)dropped);
+            reported_dropped = dropped;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(DLOG_DRAIN_PERIOD_MS));
+    }
+}
+
+esp_err_t dlog_init(void) {
+    if (drain_task_handle != NULL) {
+        return ESP_OK;
+    }
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        dlog_ring_reset(&rings[core]);
+    }
+    atomic_store_explicit(&rings_ready, true, memory_order_release);
+
+    if (xTaskCreate(dlog_drain_task, "dlog_drain_task", DLOG_DRAIN_TASK_STACK_SIZE, NULL,
+                    DLOG_DRAIN_TASK_PRIORITY, &drain_task_handle) != pdPASS) {
+        ESP_LOGE(TAG_DLOG, "Failed to create drain task");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG_DLOG, "Deferred logger started (%d records/core)", DLOG_RING_SIZE);
+    return ESP_OK;
+}
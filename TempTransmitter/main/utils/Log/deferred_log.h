@@ -0,0 +1,104 @@
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+
+/*
+ * Deferred binary logger.
+ *
+ * Hot paths write a fixed-size binary record (format pointer, tag,
+ * raw 32-bit arguments and a microsecond timestamp) into a per-core
+ * lock-free ring. A low-priority drain task formats and prints the
+ * records later, so no printf/UART work happens on the caller.
+ *
+ * Restrictions compared to ESP_LOG*:
+ *  - at most DLOG_MAX_ARGS arguments, each passed as a 32-bit integer
+ *  - no floating point conversions (%f); log fixed-point values instead
+ *  - %s arguments must point to storage that outlives the record
+ *    (string literals), as only the pointer is captured; wrap them in
+ *    DLOG_STR()
+ *
+ * Records written before dlog_init() are counted as dropped, and the
+ * drain task reports them once it starts.
+ *
+ * Call sites opt in by replacing ESP_LOGx with DLOGx. With
+ * DLOG_ENABLED set to 0 the DLOGx macros fall back to ESP_LOGx. Records
+ * hold 32-bit arguments, so builds with 64-bit pointers (HostSim) must
+ * turn it off.
+ */
+#ifndef DLOG_ENABLED
+#define DLOG_ENABLED                1
+#endif
+#define DLOG_MAX_ARGS               4
+#define DLOG_RING_SIZE              64   // records per core, power of two
+#define DLOG_DRAIN_PERIOD_MS        20
+#define DLOG_DRAIN_TASK_STACK_SIZE  3072
+#define DLOG_DRAIN_TASK_PRIORITY    1
+
+typedef struct {
+    uint32_t timestamp_us;
+    const char *format;     // doubles as the format ID
+    const char *tag;
+    uint8_t level;          // esp_log_level_t
+    uint8_t nargs;
+    uint32_t args[DLOG_MAX_ARGS];
+} dlog_record_t;
+
+/**
+ * @brief Create the per-core rings and start the drain task.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task could not be created.
+ */
+esp_err_t dlog_init(void);
+
+/**
+ * @brief Append one record to the current core's ring. Never blocks.
+ *
+ * Records that do not fit are counted in dlog_get_dropped_count().
+ * Prefer the DLOGx macros over calling this directly.
+ */
+void dlog_write(esp_log_level_t level, const char *tag, const char *format,
+                uint32_t nargs, const uint32_t *args);
+
+/**
+ * @brief Number of records dropped because a ring was full.
+ */
+uint32_t dlog_get_dropped_count(void);
+
+/**
+ * @brief Format and print all pending records from the calling task.
+ *
+ * @return Number of records printed.
+ */
+uint32_t dlog_flush(void);
+
+#define DLOG_ARGC(...) DLOG_ARGC_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define DLOG_ARGC_(_0, _1, _2, _3, _4, N, ...) N
+
+#if DLOG_ENABLED
+#define DLOG_STR(str) ((uint32_t)(uintptr_t)(str))
+
+#define DLOG_WRITE(level, tag, format, ...)                                           \
+    do {                                                                              \
+        _Static_assert(DLOG_ARGC(__VA_ARGS__) <= DLOG_MAX_ARGS, "too many DLOG args"); \
+        dlog_write(level, tag, format, DLOG_ARGC(__VA_ARGS__),                        \
+                   (const uint32_t[DLOG_MAX_ARGS]){ __VA_ARGS__ });                   \
+    } while (0)
+
+#define DLOGE(tag, format, ...) DLOG_WRITE(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define DLOGW(tag, format, ...) DLOG_WRITE(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define DLOGI(tag, format, ...) DLOG_WRITE(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define DLOGD(tag, format, ...) DLOG_WRITE(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#else
+#define DLOG_STR(str) (str)
+
+#define DLOGE(tag, format, ...) ESP_LOGE(tag, format, ##__VA_ARGS__)
+#define DLOGW(tag, format, ...) ESP_LOGW(tag, format, ##__VA_ARGS__)
+#define DLOGI(tag, format, ...) ESP_LOGI(tag, format, ##__VA_ARGS__)
+#define DLOGD(tag, format, ...) ESP_LOGD(tag, format, ##__VA_ARGS__)
+#endif
+
+#endif // DEFERRED_LOG_H
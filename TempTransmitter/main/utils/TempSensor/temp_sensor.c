@@ -3,6 +3,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "deferred_log.h"
 #include "esp_adc/adc_oneshot.h"
 #include "esp_adc/adc_cali.h"
 #include "adc_utils.h"
@@ -20,6 +21,20 @@ static adc_cali_handle_t cali_handle = NULL;
 static bool do_calibration = false;
 static adc_oneshot_unit_handle_t adc_handle;
 
+#if !TEMP_SAMPLE_USE_FLOAT
+// LM35 gives 10 mV per degree C, so 1 mV is 10 centi-degrees
+static temp_sample_t lm35_centi_from_mv(int voltage_mv) {
+    int32_t centi = (int32_t)voltage_mv * 10;
+    centi = ((centi * LM35_CAL_GAIN_Q15) + (1 << 14)) >> 15;
+    centi += LM35_CAL_OFFSET_CENTI;
+    if (centi > INT16_MAX) {
+        centi = INT16_MAX;
+    } else if (centi < INT16_MIN) {
+        centi = INT16_MIN;
+    }
+    return (temp_sample_t)centi;
+}
+#endif
 
 void lm35_reader_task(void *pvParameters) {
     // ADC Oneshot Init
@@ -58,14 +73,25 @@ void lm35_reader_task(void *pvParameters) {
                 voltage_mv = (adc_raw_reading * 3100) / 4095;
             }
 
+#if TEMP_SAMPLE_USE_FLOAT
             // LM35 gives 10mV per degree Celsius
-            float temperature_c = (float)voltage_mv / 10.0;
-            ESP_LOGI(TAG_LM35, "Voltage: %d mV, Temperature: %.2f C", voltage_mv, temperature_c);
+            temp_sample_t temperature = (float)voltage_mv / 10.0;
+            ESP_LOGI(TAG_LM35, "Voltage: %d mV, Temperature: %.2f C", voltage_mv, temperature);
+#else
+            temp_sample_t temperature = lm35_centi_from_mv(voltage_mv);
+            if (temperature < 0) {
+                DLOGI(TAG_LM35, "Voltage: %d mV, Temperature: -%d.%02d C", voltage_mv,
+                      -temperature / 100, -temperature % 100);
+            } else {
+                DLOGI(TAG_LM35, "Voltage: %d mV, Temperature: %d.%02d C", voltage_mv,
+                      temperature / 100, temperature % 100);
+            }
+#endif
 
             
             // Send temperature to CAN queue
             if (temperature_queue != NULL) {
-                if (xQueueSend(temperature_queue, &temperature_c, pdMS_TO_TICKS(100)) != pdPASS) {
+                if (xQueueSend(temperature_queue, &temperature, pdMS_TO_TICKS(100)) != pdPASS) {
                     ESP_LOGE(TAG_LM35, "Failed to send temperature to queue");
                 }
             } else {
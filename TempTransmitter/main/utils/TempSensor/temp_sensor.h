@@ -1,6 +1,22 @@
 #ifndef TEMP_SENSOR_H
 #define TEMP_SENSOR_H
 
+#include <stdint.h>
+
+// 1: push float degrees C through temperature_queue (legacy FPU path)
+// 0: push int16 centi-degrees C, integer math only from ADC to CAN
+#define TEMP_SAMPLE_USE_FLOAT   0
+
+#if TEMP_SAMPLE_USE_FLOAT
+typedef float temp_sample_t;
+#else
+typedef int16_t temp_sample_t; // centi-degrees C, e.g. 2537 = 25.37 C
+#endif
+
+// Linear correction applied to the LM35 reading: centi = raw_centi * gain + offset
+#define LM35_CAL_GAIN_Q15       32768 // 1.0 in Q15
+#define LM35_CAL_OFFSET_CENTI   0
+
 void lm35_reader_task(void *pvParameters);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,206 @@
+// Messages below the configured level are compiled out (must precede esp_log.h)
+#define LOG_LOCAL_LEVEL CAN_DRIVER_LOG_LEVEL
+#include "can_driver_utils.h"
+#include "esp_log.h"
+#include "driver/gpio.h"
+#ifdef CONFIG_CAN_DRIVER_BENCH
+#include "esp_cpu.h"
+#include "freertos/task.h"
+#endif
+
+static const char *TAG_CAN_DRIVER = "CAN_DRIVER";
+
+static twai_general_config_t general_config;
+static twai_timing_config_t timing_config;
+static twai_filter_config_t filter_config;
+
+static void can_driver_build_config(void) {
+    general_config = (twai_general_config_t)TWAI_GENERAL_CONFIG_DEFAULT(CAN_DRIVER_TX_GPIO, CAN_DRIVER_RX_GPIO,
+                                                                        CAN_DRIVER_MODE);
+    general_config.tx_queue_len = CAN_DRIVER_TX_QUEUE_LEN;
+    general_config.rx_queue_len = CAN_DRIVER_RX_QUEUE_LEN;
+    general_config.alerts_enabled = CAN_DRIVER_ALERTS;
+    timing_config = (twai_timing_config_t)CAN_DRIVER_TIMING;
+
+#if defined(CONFIG_CAN_DRIVER_FILTER_SINGLE)
+    filter_config = (twai_filter_config_t){
+        .acceptance_code = CONFIG_CAN_DRIVER_FILTER_CODE,
+        .acceptance_mask = CONFIG_CAN_DRIVER_FILTER_MASK,
+        .single_filter = true,
+    };
+#elif !CAN_DRIVER_RX_ENABLED
+    // Standard remote frames on 0x7FF only, so the one-frame queue stays empty
+    filter_config = (twai_filter_config_t){
+        .acceptance_code = (0x7FFu << 21) | (1u << 20),
+        .acceptance_mask = 0x000FFFFF,
+        .single_filter = true,
+    };
+#else
+    filter_config = (twai_filter_config_t)TWAI_FILTER_CONFIG_ACCEPT_ALL();
+#endif
+}
+
+static esp_err_t can_driver_install_and_start(void) {
+    esp_err_t ret = twai_driver_install(&general_config, &timing_config, &filter_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_CAN_DRIVER, "Failed to install TWAI driver: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG_CAN_DRIVER, "TWAI driver installed (RX queue %lu, TX queue %lu)",
+             (unsigned long)general_config.rx_queue_len, (unsigned long)general_config.tx_queue_len);
+
+    ret = twai_start();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_CAN_DRIVER, "Failed to start TWAI driver: %s", esp_err_to_name(ret));
+        twai_driver_uninstall();
+        return ret;
+    }
+    ESP_LOGI(TAG_CAN_DRIVER, "TWAI driver started");
+    return ESP_OK;
+}
+
+#ifdef CONFIG_CAN_DRIVER_BENCH
+static can_driver_bench_t bench;
+
+const can_driver_bench_t *can_driver_get_bench(void) {
+    return &bench;
+}
+
+// Self-received frames on the lowest-priority ID: one transmit and one
+// receive per frame, timed around the calls only
+static void can_driver_run_bench(void) {
+    twai_message_t message = {
+        .identifier = 0x7FF,
+        .self = 1,
+        .data_length_code = 8,
+    };
+    twai_message_t received;
+    uint64_t tx_total = 0, rx_total = 0;
+    bench = (can_driver_bench_t){ .tx_cycles_min = UINT32_MAX, .rx_cycles_min = UINT32_MAX };
+
+    for (uint32_t i = 0; i < CONFIG_CAN_DRIVER_BENCH_FRAMES; i++) {
+        message.data[0] = (uint8_t)i;
+        uint32_t start = esp_cpu_get_cycle_count();
+        esp_err_t ret = can_driver_transmit(&message, 0);
+        uint32_t tx_cycles = esp_cpu_get_cycle_count() - start;
+        if (ret != ESP_OK) {
+            bench.timeouts++;
+            continue;
+        }
+
+        // Wait for the frame outside the measurement
+        twai_status_info_t status = { 0 };
+        for (int waited_ms = 0; waited_ms < 10 && status.msgs_to_rx == 0; waited_ms++) {
+            twai_get_status_info(&status);
+            if (status.msgs_to_rx == 0) {
+                vTaskDelay(1);
+            }
+        }
+        start = esp_cpu_get_cycle_count();
+        ret = can_driver_receive(&received, 0);
+        uint32_t rx_cycles = esp_cpu_get_cycle_count() - start;
+        if (ret != ESP_OK) {
+            bench.timeouts++;
+            continue;
+        }
+
+        bench.frames++;
+        tx_total += tx_cycles;
+        rx_total += rx_cycles;
+        bench.tx_cycles_min = tx_cycles < bench.tx_cycles_min ? tx_cycles : bench.tx_cycles_min;
+        bench.rx_cycles_min = rx_cycles < bench.rx_cycles_min ? rx_cycles : bench.rx_cycles_min;
+    }
+
+    if (bench.frames > 0) {
+        bench.tx_cycles_avg = (uint32_t)(tx_total / bench.frames);
+        bench.rx_cycles_avg = (uint32_t)(rx_total / bench.frames);
+    }
+    ESP_LOGI(TAG_CAN_DRIVER, "Hot path over %lu frames: transmit %lu cycles (min %lu), receive %lu cycles (min %lu)",
+             (unsigned long)bench.frames, (unsigned long)bench.tx_cycles_avg, (unsigned long)bench.tx_cycles_min,
+             (unsigned long)bench.rx_cycles_avg, (unsigned long)bench.rx_cycles_min);
+    if (bench.timeouts > 0) {
+        ESP_LOGW(TAG_CAN_DRIVER, "%lu bench frame(s) not received back", (unsigned long)bench.timeouts);
+    }
+}
+#endif
+
+esp_err_t can_driver_init(void) {
+    can_driver_build_config();
+
+#ifdef CONFIG_CAN_DRIVER_APP_SETTINGS
+    can_driver_app_settings(&general_config, &timing_config);
+#endif
+#ifdef CONFIG_CAN_DRIVER_FILTER_APP
+    esp_err_t filter_ret = can_driver_app_filter(&filter_config);
+    if (filter_ret != ESP_OK) {
+        ESP_LOGW(TAG_CAN_DRIVER, "No filter from the app (%s), accepting all frames", esp_err_to_name(filter_ret));
+        filter_config = (twai_filter_config_t)TWAI_FILTER_CONFIG_ACCEPT_ALL();
+    }
+#endif
+
+    esp_err_t ret = can_driver_install_and_start();
+#ifdef CONFIG_CAN_DRIVER_BENCH
+    if (ret == ESP_OK) {
+        can_driver_run_bench();
+    }
+#endif
+    return ret;
+}
+
+void can_driver_deinit(void) {
+    esp_err_t ret = twai_stop();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_CAN_DRIVER, "Failed to stop TWAI driver: %s", esp_err_to_name(ret));
+    } else {
+        ESP_LOGI(TAG_CAN_DRIVER, "TWAI driver stopped");
+    }
+
+    ret = twai_driver_uninstall();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG_CAN_DRIVER, "Failed to uninstall TWAI driver: %s", esp_err_to_name(ret));
+    } else {
+        ESP_LOGI(TAG_CAN_DRIVER, "TWAI driver uninstalled");
+    }
+}
+
+void can_driver_recover(void) {
+    twai_status_info_t status;
+    if (twai_get_status_info(&status) != ESP_OK) {
+        return;
+    }
+    if (status.state == TWAI_STATE_BUS_OFF) {
+        if (twai_initiate_recovery() == ESP_OK) {
+            ESP_LOGW(TAG_CAN_DRIVER, "Bus-off (TEC=%lu, REC=%lu), recovery started",
+                     (unsigned long)status.tx_error_counter, (unsigned long)status.rx_error_counter);
+        }
+    } else if (status.state == TWAI_STATE_STOPPED) {
+        if (twai_start() == ESP_OK) {
+            ESP_LOGI(TAG_CAN_DRIVER, "Bus recovered, TWAI driver restarted");
+        }
+    }
+}
+
+#ifdef CONFIG_CAN_DRIVER_REINSTALL
+void can_driver_get_queue_lengths(uint32_t *out_rx_len, uint32_t *out_tx_len) {
+    *out_rx_len = general_config.rx_queue_len;
+    *out_tx_len = general_config.tx_queue_len;
+}
+
+esp_err_t can_driver_reinstall(uint32_t rx_queue_len, uint32_t tx_queue_len) {
+    can_driver_deinit();
+
+    uint32_t old_rx_len = general_config.rx_queue_len, old_tx_len = general_config.tx_queue_len;
+    general_config.rx_queue_len = rx_queue_len;
+    general_config.tx_queue_len = tx_queue_len;
+    esp_err_t ret = can_driver_install_and_start();
+    if (ret != ESP_OK) {
+        // Most likely out of memory for the larger queues: come back as before
+        general_config.rx_queue_len = old_rx_len;
+        general_config.tx_queue_len = old_tx_len;
+        if (can_driver_install_and_start() != ESP_OK) {
+            ESP_LOGE(TAG_CAN_DRIVER, "Could not restore the TWAI driver");
+        }
+    }
+    return ret;
+}
+#endif
@@ -0,0 +1,94 @@
+#ifndef CAN_DRIVER_CONFIG_H
+#define CAN_DRIVER_CONFIG_H
+
+#include "sdkconfig.h"
+#include "driver/twai.h"
+
+/*
+ * Compile-time driver configuration, from the "CAN driver" Kconfig menu
+ * (menuconfig or the app's sdkconfig.defaults). Everything here is a
+ * constant, so disabled features drop out of the build.
+ */
+#define CAN_DRIVER_TX_GPIO      CONFIG_CAN_DRIVER_TX_GPIO
+#define CAN_DRIVER_RX_GPIO      CONFIG_CAN_DRIVER_RX_GPIO
+
+#if defined(CONFIG_CAN_DRIVER_BITRATE_125K)
+#define CAN_DRIVER_BITRATE      125000
+#define CAN_DRIVER_TIMING       TWAI_TIMING_CONFIG_125KBITS()
+#elif defined(CONFIG_CAN_DRIVER_BITRATE_250K)
+#define CAN_DRIVER_BITRATE      250000
+#define CAN_DRIVER_TIMING       TWAI_TIMING_CONFIG_250KBITS()
+#elif defined(CONFIG_CAN_DRIVER_BITRATE_800K)
+#define CAN_DRIVER_BITRATE      800000
+#define CAN_DRIVER_TIMING       TWAI_TIMING_CONFIG_800KBITS()
+#elif defined(CONFIG_CAN_DRIVER_BITRATE_1M)
+#define CAN_DRIVER_BITRATE      1000000
+#define CAN_DRIVER_TIMING       TWAI_TIMING_CONFIG_1MBITS()
+#else
+#define CAN_DRIVER_BITRATE      500000
+#define CAN_DRIVER_TIMING       TWAI_TIMING_CONFIG_500KBITS()
+#endif
+
+#if defined(CONFIG_CAN_DRIVER_MODE_NO_ACK)
+#define CAN_DRIVER_MODE         TWAI_MODE_NO_ACK
+#elif defined(CONFIG_CAN_DRIVER_MODE_LISTEN_ONLY)
+#define CAN_DRIVER_MODE         TWAI_MODE_LISTEN_ONLY
+#else
+#define CAN_DRIVER_MODE         TWAI_MODE_NORMAL
+#endif
+
+#ifdef CONFIG_CAN_DRIVER_TX
+#define CAN_DRIVER_TX_ENABLED   1
+#define CAN_DRIVER_TX_QUEUE_LEN CONFIG_CAN_DRIVER_TX_QUEUE_LEN
+#else
+#define CAN_DRIVER_TX_ENABLED   0
+#define CAN_DRIVER_TX_QUEUE_LEN 0
+#endif
+
+#ifdef CONFIG_CAN_DRIVER_RX
+#define CAN_DRIVER_RX_ENABLED   1
+#define CAN_DRIVER_RX_QUEUE_LEN CONFIG_CAN_DRIVER_RX_QUEUE_LEN
+#else
+#define CAN_DRIVER_RX_ENABLED   0
+#define CAN_DRIVER_RX_QUEUE_LEN 1   // the driver needs one; the filter keeps it empty
+#endif
+
+#ifdef CONFIG_CAN_DRIVER_ALERTS_TX
+#define CAN_DRIVER_ALERTS_TX    (TWAI_ALERT_TX_SUCCESS | TWAI_ALERT_TX_FAILED | TWAI_ALERT_TX_IDLE)
+#else
+#define CAN_DRIVER_ALERTS_TX    0
+#endif
+#ifdef CONFIG_CAN_DRIVER_ALERTS_RX
+#define CAN_DRIVER_ALERTS_RX    (TWAI_ALERT_RX_QUEUE_FULL | TWAI_ALERT_RX_FIFO_OVERRUN)
+#else
+#define CAN_DRIVER_ALERTS_RX    0
+#endif
+#ifdef CONFIG_CAN_DRIVER_ALERTS_ERROR_STATE
+#define CAN_DRIVER_ALERTS_ERROR_STATE (TWAI_ALERT_ERR_ACTIVE | TWAI_ALERT_ABOVE_ERR_WARN | \
+                                       TWAI_ALERT_BELOW_ERR_WARN | TWAI_ALERT_ERR_PASS | \
+                                       TWAI_ALERT_BUS_OFF | TWAI_ALERT_RECOVERY_IN_PROGRESS | \
+                                       TWAI_ALERT_BUS_RECOVERED | TWAI_ALERT_BUS_ERROR)
+#else
+#define CAN_DRIVER_ALERTS_ERROR_STATE 0
+#endif
+#ifdef CONFIG_CAN_DRIVER_ALERTS_ARB_LOST
+#define CAN_DRIVER_ALERTS_ARB_LOST TWAI_ALERT_ARB_LOST
+#else
+#define CAN_DRIVER_ALERTS_ARB_LOST 0
+#endif
+#define CAN_DRIVER_ALERTS       (CAN_DRIVER_ALERTS_TX | CAN_DRIVER_ALERTS_RX | \
+                                 CAN_DRIVER_ALERTS_ERROR_STATE | CAN_DRIVER_ALERTS_ARB_LOST)
+
+#if defined(CONFIG_CAN_DRIVER_LOG_LEVEL_NONE)
+#define CAN_DRIVER_LOG_LEVEL    ESP_LOG_NONE
+#elif defined(CONFIG_CAN_DRIVER_LOG_LEVEL_ERROR)
+#define CAN_DRIVER_LOG_LEVEL    ESP_LOG_ERROR
+#elif defined(CONFIG_CAN_DRIVER_LOG_LEVEL_WARN)
+#define CAN_DRIVER_LOG_LEVEL    ESP_LOG_WARN
+#elif defined(CONFIG_CAN_DRIVER_LOG_LEVEL_DEBUG)
+#define CAN_DRIVER_LOG_LEVEL    ESP_LOG_DEBUG
+#else
+#define CAN_DRIVER_LOG_LEVEL    ESP_LOG_INFO
+#endif
+
+#endif // CAN_DRIVER_CONFIG_H
@@ -0,0 +1,111 @@
+#include "sdkconfig.h"
+#ifdef CONFIG_CAN_DRIVER_CONFIG_ONLY
+#error "CONFIG_CAN_DRIVER_CONFIG_ONLY is set: include the app's own can_driver_utils.h"
+#endif
+
+#ifndef CAN_DRIVER_UTILS_H
+#define CAN_DRIVER_UTILS_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/twai.h"
+#include "can_driver_config.h"
+
+/*
+ * TWAI driver shared by the node apps, specialised at compile time by the
+ * "CAN driver" Kconfig menu (can_driver_config.h). Features that are
+ * turned off are not declared here, so code that still uses them fails to
+ * build instead of checking a flag at run time.
+ */
+
+/**
+ * @brief Install and start the driver with the configured settings.
+ */
+esp_err_t can_driver_init(void);
+void can_driver_deinit(void);
+
+/**
+ * @brief Bring the controller back from bus-off without reinstalling.
+ *
+ * Goes by the controller state, not by error codes: twai_receive() only
+ * times out while the node is bus-off. Bus-off starts recovery, and the
+ * stopped state a finished recovery leaves behind restarts the controller.
+ * Call it when a bounded receive times out or a transmit fails; a second
+ * caller finds recovery under way and does nothing.
+ */
+void can_driver_recover(void);
+
+#if CAN_DRIVER_TX_ENABLED
+/**
+ * @brief Queue a frame for transmission (twai_transmit()).
+ */
+static inline esp_err_t can_driver_transmit(const twai_message_t *message, TickType_t ticks_to_wait)
+{
+    return twai_transmit(message, ticks_to_wait);
+}
+#endif
+
+#if CAN_DRIVER_RX_ENABLED
+/**
+ * @brief Take the next received frame (twai_receive()).
+ */
+static inline esp_err_t can_driver_receive(twai_message_t *message, TickType_t ticks_to_wait)
+{
+    return twai_receive(message, ticks_to_wait);
+}
+#endif
+
+#ifdef CONFIG_CAN_DRIVER_FILTER_APP
+/**
+ * @brief Acceptance filter for can_driver_init(); defined by the app.
+ *
+ * Called once, before the driver is installed. The result is kept and
+ * reused by can_driver_reinstall().
+ */
+esp_err_t can_driver_app_filter(twai_filter_config_t *out_config);
+#endif
+
+#ifdef CONFIG_CAN_DRIVER_APP_SETTINGS
+/**
+ * @brief Bus settings for can_driver_init(); defined by the app.
+ *
+ * Both configs arrive filled from Kconfig; the app may override bitrate,
+ * mode and queue lengths, e.g. from NVS.
+ */
+void can_driver_app_settings(twai_general_config_t *g_config, twai_timing_config_t *t_config);
+#endif
+
+#ifdef CONFIG_CAN_DRIVER_REINSTALL
+/**
+ * @brief Stop, uninstall and reinstall the driver with new queue lengths.
+ *
+ * Frames arriving meanwhile are lost, and the driver's error counters
+ * restart at zero. Must run in the task that owns the driver. If the new
+ * queues cannot be allocated the old lengths are restored and the error
+ * is returned.
+ */
+esp_err_t can_driver_reinstall(uint32_t rx_queue_len, uint32_t tx_queue_len);
+
+/**
+ * @brief Queue lengths of the installed driver.
+ */
+void can_driver_get_queue_lengths(uint32_t *out_rx_len, uint32_t *out_tx_len);
+#endif
+
+#ifdef CONFIG_CAN_DRIVER_BENCH
+typedef struct {
+    uint32_t frames;            // frames sent and received back
+    uint32_t timeouts;          // frames that did not come back within 10 ms
+    uint32_t tx_cycles_avg;     // per can_driver_transmit() call
+    uint32_t tx_cycles_min;
+    uint32_t rx_cycles_avg;     // per can_driver_receive() call with a frame waiting
+    uint32_t rx_cycles_min;
+} can_driver_bench_t;
+
+/**
+ * @brief Cycle counts measured by can_driver_init().
+ */
+const can_driver_bench_t *can_driver_get_bench(void);
+#endif
+
+#endif // CAN_DRIVER_UTILS_H
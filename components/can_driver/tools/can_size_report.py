@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Flash/IRAM/DRAM size of the node apps per CAN driver configuration.
+
+Each build is one app with its sdkconfig.defaults plus an optional fragment
+from components/can_driver/configs, in its own build directory:
+
+    python3 can_size_report.py                      # default matrix
+    python3 can_size_report.py TempTransmitter:tx_only Base:quiet
+    python3 can_size_report.py --baseline <git ref> # also build <ref>, print deltas
+
+The baseline builds the same apps from a git worktree of <ref> (e.g. the
+commit before the shared component, where every app carried its own
+can_driver_utils.c) with its own sdkconfig.defaults only, fragments do not
+apply there. Needs idf.py from an exported ESP-IDF environment; no
+results are checked in, run it to get figures for a given IDF version.
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+REPO_ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", "..", ".."))
+CONFIG_DIR = os.path.join(REPO_ROOT, "components", "can_driver", "configs")
+
+DEFAULT_MATRIX = [
+    "TempTransmitter", "TempTransmitter:quiet", "TempTransmitter:tx_only",
+    "TempReceiver", "TempReceiver:quiet",
+    "Base", "Base:quiet",
+]
+
+# idf.py size --format json renamed its keys between IDF releases
+SIZE_KEYS = {
+    "flash": ["total_size", "image_size"],
+    "iram": ["used_iram", "iram_text", "used_iram_ram"],
+    "dram": ["used_dram", "used_dram_ram"],
+}
+
+
+def pick(sizes, names):
+    for name in names:
+        if name in sizes:
+            return sizes[name]
+    return None
+
+
+def build(root, app, fragment, build_root):
+    app_dir = os.path.join(root, app)
+    build_dir = os.path.join(build_root, app + ("-" + fragment if fragment else ""))
+    defaults = [os.path.join(app_dir, "sdkconfig.defaults")]
+    if fragment:
+        defaults.append(os.path.join(CONFIG_DIR, fragment + ".cfg"))
+    # A stale sdkconfig would win over the defaults, keep it next to the build
+    sdkconfig = os.path.join(build_dir, "sdkconfig")
+    if os.path.exists(sdkconfig):
+        os.remove(sdkconfig)
+    common = ["idf.py", "-C", app_dir, "-B", build_dir,
+              "-D", "SDKCONFIG=" + sdkconfig,
+              "-D", "SDKCONFIG_DEFAULTS=" + ";".join(d for d in defaults if os.path.exists(d))]
+    result = subprocess.run(common + ["build"], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    if result.returncode != 0:
+        sys.stderr.write(result.stdout[-2000:])
+        return None
+    result = subprocess.run(common + ["size", "--format", "json"], stdout=subprocess.PIPE, text=True, check=True)
+    # idf.py prints its own progress lines before the JSON
+    sizes = json.loads(result.stdout[result.stdout.index("{"):])
+    return {key: pick(sizes, names) for key, names in SIZE_KEYS.items()}
+
+
+def fmt(value, base=None):
+    if value is None:
+        return "?"
+    if base is None:
+        return str(value)
+    return f"{value} ({value - base:+d})"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("builds", nargs="*", default=DEFAULT_MATRIX, help="app[:fragment] to build")
+    parser.add_argument("--baseline", metavar="REF", help="git ref to compare against")
+    parser.add_argument("--build-root", default=os.path.join(tempfile.gettempdir(), "can_size_report"))
+    args = parser.parse_args()
+
+    baseline = {}
+    if args.baseline:
+        worktree = os.path.join(args.build_root, "baseline-src")
+        subprocess.run(["git", "-C", REPO_ROOT, "worktree", "add", "--force", "--detach", worktree, args.baseline],
+                       check=True, stdout=subprocess.DEVNULL)
+        try:
+            for app in sorted({b.split(":")[0] for b in args.builds}):
+                baseline[app] = build(worktree, app, None, os.path.join(args.build_root, "baseline"))
+        finally:
+            subprocess.run(["git", "-C", REPO_ROOT, "worktree", "remove", "--force", worktree], check=False)
+
+    print(f"{'Build':32} {'Flash':>16} {'IRAM':>16} {'DRAM':>16}")
+    failed = 0
+    for spec in args.builds:
+        app, _, fragment = spec.partition(":")
+        sizes = build(REPO_ROOT, app, fragment or None, args.build_root)
+        if sizes is None:
+            print(f"{spec:32} build failed")
+            failed += 1
+            continue
+        base = baseline.get(app) or {}
+        print(f"{spec:32} " + " ".join(f"{fmt(sizes[k], base.get(k)):>16}" for k in ("flash", "iram", "dram")))
+    if baseline:
+        print(f"\nDeltas against {args.baseline}, where each app built its own driver copy.")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())